@@ -57,6 +57,10 @@ namespace DXBC2GLSL
 		void FeedDXBC(void const * dxbc_data,
 			bool has_gs, bool has_ps, ShaderTessellatorPartitioning ds_partitioning, ShaderTessellatorOutputPrimitive ds_output_primitive,
 			GLSLVersion version, uint32_t glsl_rules);
+		// opt_passes is a combination of ShaderOptimizationPass
+		void FeedDXBC(void const * dxbc_data,
+			bool has_gs, bool has_ps, ShaderTessellatorPartitioning ds_partitioning, ShaderTessellatorOutputPrimitive ds_output_primitive,
+			GLSLVersion version, uint32_t glsl_rules, uint32_t opt_passes);
 
 		std::string const & GLSLString() const;
 
@@ -35,7 +35,9 @@
 
 #include <KFL/KFL.hpp>
 #include <vector>
+#include <memory>
 #include <cstring>
+#include <boost/noncopyable.hpp>
 #include <DXBC2GLSL/DXBC.hpp>
 #include <DXBC2GLSL/Utils.hpp>
 #include <DXBC2GLSL/ShaderDefs.hpp>
@@ -366,8 +368,73 @@ struct LabelInfo
 	uint32_t end_num; // the last insn in label etc. ret
 };
 
+// Bump allocator backing the IR of a program. Memory is only released when the arena dies.
+class ShaderIRArena : boost::noncopyable
+{
+public:
+	ShaderIRArena()
+		: cur_(nullptr), remaining_(0)
+	{
+	}
+
+	void* Allocate(size_t size, size_t alignment);
+
+private:
+	std::vector<std::unique_ptr<uint8_t[]>> blocks_;
+	uint8_t* cur_;
+	size_t remaining_;
+};
+
+// Used with std::allocate_shared, so an operand, a declaration or an instruction and its control block
+// come from the arena in one bump. Each allocation keeps the arena alive.
+template <typename T>
+class ShaderIRAllocator
+{
+	template <typename U>
+	friend class ShaderIRAllocator;
+
+public:
+	typedef T value_type;
+
+	explicit ShaderIRAllocator(std::shared_ptr<ShaderIRArena> const & arena)
+		: arena_(arena)
+	{
+	}
+	template <typename U>
+	ShaderIRAllocator(ShaderIRAllocator<U> const & rhs)
+		: arena_(rhs.arena_)
+	{
+	}
+
+	T* allocate(size_t n)
+	{
+		return static_cast<T*>(arena_->Allocate(n * sizeof(T), alignof(T)));
+	}
+	void deallocate(T* p, size_t n)
+	{
+		KFL_UNUSED(p);
+		KFL_UNUSED(n);
+	}
+
+	template <typename U>
+	bool operator==(ShaderIRAllocator<U> const & rhs) const
+	{
+		return arena_ == rhs.arena_;
+	}
+	template <typename U>
+	bool operator!=(ShaderIRAllocator<U> const & rhs) const
+	{
+		return arena_ != rhs.arena_;
+	}
+
+private:
+	std::shared_ptr<ShaderIRArena> arena_;
+};
+
 struct ShaderProgram
 {
+	std::shared_ptr<ShaderIRArena> arena;
+
 	TokenizedShaderVersion version;//program version
 	std::vector<std::shared_ptr<ShaderDecl>> dcls;//declarations
 	std::vector<std::shared_ptr<ShaderInstruction>> insns;//instructions
@@ -404,6 +471,18 @@ struct ShaderProgram
 
 std::shared_ptr<ShaderProgram> ShaderParse(DXBCContainer const & dxbc);
 
+enum ShaderOptimizationPass : uint32_t
+{
+	SOP_DeadWriteElimination = 1UL << 0,	// Removes ALU instructions whose temp results are never read, and narrows partially read masks.
+	SOP_CopyPropagation = 1UL << 1,			// Forwards the sources of plain movs within a basic block.
+	SOP_SwizzleFolding = 1UL << 2,			// Lets the copy propagation compose swizzles, e.g. mov r0.xy, r1.yx.
+
+	SOP_All = SOP_DeadWriteElimination | SOP_CopyPropagation | SOP_SwizzleFolding
+};
+
+// Runs on the parsed program before GLSLGen::FeedDXBC. The generated GLSL is equivalent but shorter.
+void ShaderOptimize(ShaderProgram& program, uint32_t passes);
+
 // Return the opcode's input type
 inline ShaderImmType GetOpInType(uint32_t opcode)
 {
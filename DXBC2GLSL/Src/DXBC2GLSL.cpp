@@ -29,10 +29,75 @@
  */
 
 #include <DXBC2GLSL/DXBC2GLSL.hpp>
-#include <KFL/CustomizedStreamBuf.hpp>
 #include <DXBC2GLSL/DXBC.hpp>
 #include <DXBC2GLSL/GLSLGen.hpp>
-#include <sstream>
+#include <ostream>
+#include <cstring>
+#include <boost/noncopyable.hpp>
+
+namespace
+{
+	// GLSLGen writes lots of tiny pieces. Buffering them keeps most of the writes out of the virtual calls.
+	class GLSLStringBuf : public std::streambuf, boost::noncopyable
+	{
+	public:
+		explicit GLSLStringBuf(std::string& str)
+			: str_(str)
+		{
+			this->setp(buff_, buff_ + sizeof(buff_));
+		}
+		~GLSLStringBuf() override
+		{
+			this->Flush();
+		}
+
+	protected:
+		int_type overflow(int_type ch) override
+		{
+			this->Flush();
+			if (!traits_type::eq_int_type(ch, traits_type::eof()))
+			{
+				*this->pptr() = traits_type::to_char_type(ch);
+				this->pbump(1);
+			}
+			return traits_type::not_eof(ch);
+		}
+
+		std::streamsize xsputn(char_type const * s, std::streamsize count) override
+		{
+			if (count > this->epptr() - this->pptr())
+			{
+				this->Flush();
+				if (count > static_cast<std::streamsize>(sizeof(buff_)))
+				{
+					str_.append(s, static_cast<size_t>(count));
+					return count;
+				}
+			}
+
+			memcpy(this->pptr(), s, static_cast<size_t>(count));
+			this->pbump(static_cast<int>(count));
+			return count;
+		}
+
+		int sync() override
+		{
+			this->Flush();
+			return 0;
+		}
+
+	private:
+		void Flush()
+		{
+			str_.append(this->pbase(), this->pptr() - this->pbase());
+			this->setp(buff_, buff_ + sizeof(buff_));
+		}
+
+	private:
+		std::string& str_;
+		char buff_[4096];
+	};
+}
 
 namespace DXBC2GLSL
 {
@@ -51,6 +116,13 @@ namespace DXBC2GLSL
 	void DXBC2GLSL::FeedDXBC(void const * dxbc_data,
 			bool has_gs, bool has_ps, ShaderTessellatorPartitioning ds_partitioning, ShaderTessellatorOutputPrimitive ds_output_primitive,
 			GLSLVersion version, uint32_t glsl_rules)
+	{
+		this->FeedDXBC(dxbc_data, has_gs, has_ps, ds_partitioning, ds_output_primitive, version, glsl_rules, 0);
+	}
+
+	void DXBC2GLSL::FeedDXBC(void const * dxbc_data,
+			bool has_gs, bool has_ps, ShaderTessellatorPartitioning ds_partitioning, ShaderTessellatorOutputPrimitive ds_output_primitive,
+			GLSLVersion version, uint32_t glsl_rules, uint32_t opt_passes)
 	{
 		dxbc_ = DXBCParse(dxbc_data);
 		if (dxbc_)
@@ -58,13 +130,21 @@ namespace DXBC2GLSL
 			if (dxbc_->shader_chunk)
 			{
 				shader_ = ShaderParse(*dxbc_);
+				if (opt_passes != 0)
+				{
+					ShaderOptimize(*shader_, opt_passes);
+				}
+
+				// Roughly 2 lines of GLSL per instruction, plus the declarations
+				glsl_.reserve(glsl_.size() + shader_->insns.size() * 64 + shader_->dcls.size() * 48 + 1024);
 
-				KlayGE::StringOutputStreamBuf glsl_buff(glsl_);
+				GLSLStringBuf glsl_buff(glsl_);
 				std::ostream ss(&glsl_buff);
 
 				GLSLGen converter;
 				converter.FeedDXBC(shader_, has_gs, has_ps, ds_partitioning, ds_output_primitive, version, glsl_rules);
 				converter.ToGLSL(ss);
+				ss.flush();
 			}
 		}
 	}
@@ -0,0 +1,418 @@
+/**
+ * @file ShaderOptimize.cpp
+ * @author Minmin Gong
+ *
+ * @section DESCRIPTION
+ *
+ * This source file is part of KlayGE
+ * For the latest info, see http://www.klayge.org
+ *
+ * @section LICENSE
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * You may alternatively use this source under the terms of
+ * the KlayGE Proprietary License (KPL). You can obtained such a license
+ * from http://www.klayge.org/licensing/.
+ */
+
+#include <DXBC2GLSL/Shader.hpp>
+
+#include <algorithm>
+
+namespace
+{
+	// Single output instructions without side effects. Every destination component is computed from the same
+	// components of the sources, except for the dot products.
+	bool IsPureALU(uint32_t opcode)
+	{
+		switch (opcode)
+		{
+		case SO_ADD:
+		case SO_AND:
+		case SO_DERIV_RTX:
+		case SO_DERIV_RTY:
+		case SO_DERIV_RTX_COARSE:
+		case SO_DERIV_RTX_FINE:
+		case SO_DERIV_RTY_COARSE:
+		case SO_DERIV_RTY_FINE:
+		case SO_DIV:
+		case SO_DP2:
+		case SO_DP3:
+		case SO_DP4:
+		case SO_EQ:
+		case SO_EXP:
+		case SO_FRC:
+		case SO_FTOI:
+		case SO_FTOU:
+		case SO_GE:
+		case SO_IADD:
+		case SO_IEQ:
+		case SO_IGE:
+		case SO_ILT:
+		case SO_IMAD:
+		case SO_IMAX:
+		case SO_IMIN:
+		case SO_INE:
+		case SO_INEG:
+		case SO_ISHL:
+		case SO_ISHR:
+		case SO_ITOF:
+		case SO_LOG:
+		case SO_LT:
+		case SO_MAD:
+		case SO_MIN:
+		case SO_MAX:
+		case SO_MOV:
+		case SO_MOVC:
+		case SO_MUL:
+		case SO_NE:
+		case SO_NOT:
+		case SO_OR:
+		case SO_ROUND_NE:
+		case SO_ROUND_NI:
+		case SO_ROUND_PI:
+		case SO_ROUND_Z:
+		case SO_RSQ:
+		case SO_SQRT:
+		case SO_ULT:
+		case SO_UGE:
+		case SO_UMAD:
+		case SO_UMAX:
+		case SO_UMIN:
+		case SO_USHR:
+		case SO_UTOF:
+		case SO_XOR:
+		case SO_RCP:
+		case SO_F32TOF16:
+		case SO_F16TOF32:
+		case SO_COUNTBITS:
+		case SO_FIRSTBIT_HI:
+		case SO_FIRSTBIT_LO:
+		case SO_FIRSTBIT_SHI:
+		case SO_UBFE:
+		case SO_IBFE:
+		case SO_BFI:
+		case SO_BFREV:
+			return true;
+
+		default:
+			return false;
+		}
+	}
+
+	bool IsPureALU(ShaderInstruction const & insn)
+	{
+		return IsPureALU(insn.opcode) && (insn.num_ops > 1);
+	}
+
+	bool IsTempRegister(ShaderOperand const & op)
+	{
+		return (SOT_TEMP == op.type) && op.HasSimpleIndex();
+	}
+
+	bool HasRelativeIndex(ShaderOperand const & op)
+	{
+		for (uint32_t i = 0; i < op.num_indices; ++ i)
+		{
+			if (op.indices[i].reg)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	uint32_t SwizzledComponents(ShaderOperand const & op, uint32_t positions)
+	{
+		if (op.comps != 4)
+		{
+			return 0xF;
+		}
+
+		switch (op.mode)
+		{
+		case SOSM_MASK:
+			return op.mask;
+
+		case SOSM_SCALAR:
+			return 1UL << op.swizzle[0];
+
+		default:
+			{
+				uint32_t comps = 0;
+				for (uint32_t i = 0; i < 4; ++ i)
+				{
+					if (positions & (1UL << i))
+					{
+						comps |= 1UL << op.swizzle[i];
+					}
+				}
+				return comps;
+			}
+		}
+	}
+
+	// The components of a source of an instruction which are actually read
+	uint32_t SourceReadMask(ShaderInstruction const & insn, ShaderOperand const & op)
+	{
+		uint32_t positions;
+		if (!IsPureALU(insn))
+		{
+			positions = 0xF;
+		}
+		else
+		{
+			switch (insn.opcode)
+			{
+			case SO_DP2:
+				positions = 0x3;
+				break;
+
+			case SO_DP3:
+				positions = 0x7;
+				break;
+
+			case SO_DP4:
+				positions = 0xF;
+				break;
+
+			default:
+				positions = (insn.ops[0]->comps == 4) ? insn.ops[0]->mask : 0xF;
+				break;
+			}
+		}
+
+		return SwizzledComponents(op, positions);
+	}
+
+	void MarkRead(std::vector<uint8_t>& temp_reads, uint32_t reg, uint32_t comps)
+	{
+		if (reg >= temp_reads.size())
+		{
+			temp_reads.resize(reg + 1, 0);
+		}
+		temp_reads[reg] |= static_cast<uint8_t>(comps);
+	}
+
+	void MarkIndexReads(std::vector<uint8_t>& temp_reads, ShaderOperand const & op)
+	{
+		for (uint32_t i = 0; i < op.num_indices; ++ i)
+		{
+			if (op.indices[i].reg)
+			{
+				ShaderOperand const & reg = *op.indices[i].reg;
+				if (SOT_TEMP == reg.type)
+				{
+					MarkRead(temp_reads, static_cast<uint32_t>(reg.indices[0].disp), SwizzledComponents(reg, 0xF));
+				}
+				MarkIndexReads(temp_reads, reg);
+			}
+		}
+	}
+
+	void CollectTempReads(std::vector<std::shared_ptr<ShaderInstruction>> const & insns, std::vector<uint8_t>& temp_reads)
+	{
+		temp_reads.clear();
+		for (auto const & insn : insns)
+		{
+			uint32_t const first_src = IsPureALU(*insn) ? 1 : 0;
+			for (uint32_t i = 0; i < insn->num_ops; ++ i)
+			{
+				ShaderOperand const & op = *insn->ops[i];
+				if ((i >= first_src) && (SOT_TEMP == op.type))
+				{
+					MarkRead(temp_reads, static_cast<uint32_t>(op.indices[0].disp), SourceReadMask(*insn, op));
+				}
+				MarkIndexReads(temp_reads, op);
+			}
+		}
+	}
+
+	void DeadWriteElimination(ShaderProgram& program)
+	{
+		std::vector<uint8_t> temp_reads;
+		bool changed = true;
+		while (changed)
+		{
+			changed = false;
+			CollectTempReads(program.insns, temp_reads);
+
+			auto const new_end = std::remove_if(program.insns.begin(), program.insns.end(),
+				[&temp_reads, &changed](std::shared_ptr<ShaderInstruction> const & insn)
+				{
+					if (!IsPureALU(*insn))
+					{
+						return false;
+					}
+
+					ShaderOperand& dst = *insn->ops[0];
+					if (!IsTempRegister(dst) || (dst.comps != 4) || (dst.mode != SOSM_MASK))
+					{
+						return false;
+					}
+
+					uint32_t const reg = static_cast<uint32_t>(dst.indices[0].disp);
+					uint32_t const live = dst.mask & ((reg < temp_reads.size()) ? temp_reads[reg] : 0);
+					if (live != dst.mask)
+					{
+						changed = true;
+						if (0 == live)
+						{
+							return true;
+						}
+						dst.mask = static_cast<uint8_t>(live);
+					}
+					return false;
+				});
+			program.insns.erase(new_end, program.insns.end());
+		}
+	}
+
+	bool IsPropagatableCopy(ShaderInstruction const & insn, bool fold_swizzles)
+	{
+		if ((insn.opcode != SO_MOV) || insn.insn.sat || (insn.num_ops != 2))
+		{
+			return false;
+		}
+
+		ShaderOperand const & dst = *insn.ops[0];
+		ShaderOperand const & src = *insn.ops[1];
+		if (!IsTempRegister(dst) || (dst.comps != 4) || (dst.mode != SOSM_MASK)
+			|| (src.comps != 4) || ((src.mode != SOSM_SWIZZLE) && (src.mode != SOSM_SCALAR))
+			|| src.neg || src.abs || HasRelativeIndex(src))
+		{
+			return false;
+		}
+
+		switch (src.type)
+		{
+		case SOT_TEMP:
+			if (!src.HasSimpleIndex() || (src.indices[0].disp == dst.indices[0].disp))
+			{
+				return false;
+			}
+			break;
+
+		case SOT_INPUT:
+			if (!src.HasSimpleIndex())
+			{
+				return false;
+			}
+			break;
+
+		case SOT_CONSTANT_BUFFER:
+			for (uint32_t i = 0; i < src.num_indices; ++ i)
+			{
+				if (!src.IsIndexSimple(i))
+				{
+					return false;
+				}
+			}
+			break;
+
+		default:
+			return false;
+		}
+
+		if (!fold_swizzles)
+		{
+			for (uint32_t i = 0; i < 4; ++ i)
+			{
+				if ((dst.mask & (1UL << i)) && (src.swizzle[i] != i))
+				{
+					return false;
+				}
+			}
+		}
+
+		return true;
+	}
+
+	bool WritesTemp(ShaderInstruction const & insn, int64_t reg)
+	{
+		ShaderOperand const & dst = *insn.ops[0];
+		return (SOT_TEMP == dst.type) && (dst.indices[0].disp == reg);
+	}
+
+	void CopyPropagation(ShaderProgram& program, bool fold_swizzles)
+	{
+		for (size_t i = 0; i < program.insns.size(); ++ i)
+		{
+			ShaderInstruction const & copy = *program.insns[i];
+			if (!IsPropagatableCopy(copy, fold_swizzles))
+			{
+				continue;
+			}
+
+			ShaderOperand const & dst = *copy.ops[0];
+			ShaderOperand const & src = *copy.ops[1];
+			int64_t const dst_reg = dst.indices[0].disp;
+
+			// Stops at the end of the basic block, or when the copy or its source is overwritten
+			for (size_t j = i + 1; j < program.insns.size(); ++ j)
+			{
+				ShaderInstruction& insn = *program.insns[j];
+				if (!IsPureALU(insn))
+				{
+					break;
+				}
+
+				for (uint32_t k = 1; k < insn.num_ops; ++ k)
+				{
+					ShaderOperand& use = *insn.ops[k];
+					if (!IsTempRegister(use) || (use.indices[0].disp != dst_reg) || (use.comps != 4)
+						|| ((use.mode != SOSM_SWIZZLE) && (use.mode != SOSM_SCALAR))
+						|| (SwizzledComponents(use, 0xF) & ~dst.mask))
+					{
+						continue;
+					}
+
+					uint8_t swizzle[4];
+					for (uint32_t c = 0; c < 4; ++ c)
+					{
+						swizzle[c] = src.swizzle[use.swizzle[c]];
+					}
+
+					uint8_t const mode = use.mode;
+					bool const neg = use.neg;
+					bool const abs = use.abs;
+					use = src;
+					use.mode = mode;
+					use.neg = neg;
+					use.abs = abs;
+					memcpy(use.swizzle, swizzle, sizeof(swizzle));
+				}
+
+				if (WritesTemp(insn, dst_reg) || ((SOT_TEMP == src.type) && WritesTemp(insn, src.indices[0].disp)))
+				{
+					break;
+				}
+			}
+		}
+	}
+}
+
+void ShaderOptimize(ShaderProgram& program, uint32_t passes)
+{
+	if (passes & (SOP_CopyPropagation | SOP_SwizzleFolding))
+	{
+		CopyPropagation(program, (passes & SOP_SwizzleFolding) != 0);
+	}
+	if (passes & SOP_DeadWriteElimination)
+	{
+		DeadWriteElimination(program);
+	}
+}
@@ -82,6 +82,26 @@ namespace
 	{
 		return lh.var_desc.start_offset < rh.var_desc.start_offset;
 	}
+
+	size_t const IR_ARENA_BLOCK_SIZE = 64 * 1024;
+}
+
+void* ShaderIRArena::Allocate(size_t size, size_t alignment)
+{
+	size_t padding = (alignment - reinterpret_cast<uintptr_t>(cur_) % alignment) % alignment;
+	if (padding + size > remaining_)
+	{
+		size_t const block_size = std::max(size + alignment, IR_ARENA_BLOCK_SIZE);
+		blocks_.emplace_back(new uint8_t[block_size]);
+		cur_ = blocks_.back().get();
+		remaining_ = block_size;
+		padding = (alignment - reinterpret_cast<uintptr_t>(cur_) % alignment) % alignment;
+	}
+
+	void* ret = cur_ + padding;
+	cur_ += padding + size;
+	remaining_ -= padding + size;
+	return ret;
 }
 
 struct ShaderParser
@@ -132,6 +152,12 @@ struct ShaderParser
 		tokens += toskip;
 	}
 
+	template <typename T>
+	std::shared_ptr<T> MakeIR()
+	{
+		return std::allocate_shared<T>(ShaderIRAllocator<T>(program->arena));
+	}
+
 	void ReadOp(ShaderOperand& op)
 	{
 		TokenizedShaderOperand optok;
@@ -237,19 +263,19 @@ struct ShaderParser
 				break;
 
 			case SOIP_RELATIVE:
-				op.indices[i].reg = KlayGE::MakeSharedPtr<ShaderOperand>();
+				op.indices[i].reg = this->MakeIR<ShaderOperand>();
 				this->ReadOp(*op.indices[i].reg);
 				break;
 
 			case SOIP_IMM32_PLUS_RELATIVE:
 				op.indices[i].disp = static_cast<int32_t>(this->Read32());
-				op.indices[i].reg = KlayGE::MakeSharedPtr<ShaderOperand>();
+				op.indices[i].reg = this->MakeIR<ShaderOperand>();
 				this->ReadOp(*op.indices[i].reg);
 				break;
 
 			case SOIP_IMM64_PLUS_RELATIVE:
 				op.indices[i].disp = this->Read64();
-				op.indices[i].reg = KlayGE::MakeSharedPtr<ShaderOperand>();
+				op.indices[i].reg = this->MakeIR<ShaderOperand>();
 				this->ReadOp(*op.indices[i].reg);
 				break;
 			}
@@ -293,7 +319,7 @@ struct ShaderParser
 				// immediate constant buffer data
 				uint32_t customlen = this->Read32() - 2;
 
-				std::shared_ptr<ShaderDecl> dcl = KlayGE::MakeSharedPtr<ShaderDecl>();
+				std::shared_ptr<ShaderDecl> dcl = this->MakeIR<ShaderDecl>();
 				program->dcls.push_back(dcl);
 
 				dcl->opcode = SO_IMMEDIATE_CONSTANT_BUFFER;
@@ -310,7 +336,7 @@ struct ShaderParser
 			{
 				// need to interleave these with the declarations or we cannot
 				// assign fork/join phase instance counts to phases
-				std::shared_ptr<ShaderDecl> dcl = KlayGE::MakeSharedPtr<ShaderDecl>();
+				std::shared_ptr<ShaderDecl> dcl = this->MakeIR<ShaderDecl>();
 				program->dcls.push_back(dcl);
 				dcl->opcode = opcode;
 			}
@@ -319,7 +345,7 @@ struct ShaderParser
 				|| ((opcode >= SO_DCL_STREAM) && (opcode <= SO_DCL_RESOURCE_STRUCTURED))
 				|| (SO_DCL_GS_INSTANCE_COUNT == opcode))
 			{
-				std::shared_ptr<ShaderDecl> dcl = KlayGE::MakeSharedPtr<ShaderDecl>();
+				std::shared_ptr<ShaderDecl> dcl = this->MakeIR<ShaderDecl>();
 				program->dcls.push_back(dcl);
 				reinterpret_cast<TokenizedShaderInstruction&>(*dcl) = insntok;
 
@@ -330,7 +356,7 @@ struct ShaderParser
 					this->ReadToken(&exttok);
 				}
 
-#define READ_OP_ANY dcl->op = KlayGE::MakeSharedPtr<ShaderOperand>(); this->ReadOp(*dcl->op);
+#define READ_OP_ANY dcl->op = this->MakeIR<ShaderOperand>(); this->ReadOp(*dcl->op);
 #define READ_OP(FILE) READ_OP_ANY
 				//check(dcl->op->file == SOT_##FILE);
 
@@ -382,7 +408,7 @@ struct ShaderParser
 					break;
 
 				case SO_DCL_INDEXABLE_TEMP:
-					dcl->op = KlayGE::MakeSharedPtr<ShaderOperand>();
+					dcl->op = this->MakeIR<ShaderOperand>();
 					dcl->op->indices[0].disp = this->Read32();
 					dcl->indexable_temp.num = this->Read32();
 					dcl->indexable_temp.comps = this->Read32();
@@ -531,7 +557,7 @@ struct ShaderParser
 				{
 					continue;
 				}
-				std::shared_ptr<ShaderInstruction> insn = KlayGE::MakeSharedPtr<ShaderInstruction>();
+				std::shared_ptr<ShaderInstruction> insn = this->MakeIR<ShaderInstruction>();
 				program->insns.push_back(insn);
 				reinterpret_cast<TokenizedShaderInstruction&>(*insn) = insntok;
 
@@ -574,7 +600,7 @@ struct ShaderParser
 				{
 					BOOST_ASSERT(tokens < insn_end);
 					BOOST_ASSERT(op_num < SM_MAX_OPS);
-					insn->ops[op_num] = KlayGE::MakeSharedPtr<ShaderOperand>();
+					insn->ops[op_num] = this->MakeIR<ShaderOperand>();
 					this->ReadOp(*insn->ops[op_num]);
 					++ op_num;
 				}
@@ -904,6 +930,7 @@ struct ShaderParser
 std::shared_ptr<ShaderProgram> ShaderParse(DXBCContainer const & dxbc)
 {
 	std::shared_ptr<ShaderProgram> program = KlayGE::MakeSharedPtr<ShaderProgram>();
+	program->arena = KlayGE::MakeSharedPtr<ShaderIRArena>();
 	ShaderParser parser(dxbc, program);
 	if (!parser.Parse())
 	{
@@ -29,9 +29,11 @@
  */
 
 #include <DXBC2GLSL/DXBC2GLSL.hpp>
+#include <chrono>
 #include <iostream>
 #include <fstream>
 #include <string>
+#include <cstring>
 
 void usage()
 {
@@ -40,43 +42,130 @@ void usage()
 	std::cerr << "Not affiliated with or endorsed by Microsoft in any way\n";
 	std::cerr << "Latest version available from http://www.klayge.org/\n";
 	std::cerr << "\n";
-	std::cerr << "Usage: DXBC2GLSLCmd FILE [OUTPUT]\n";
+	std::cerr << "Usage: DXBC2GLSLCmd [-O] FILE [OUTPUT]\n";
+	std::cerr << "       DXBC2GLSLCmd -bench FILE...\n";
+	std::cerr << "\n";
+	std::cerr << "  -O      Optimize the shader before generating GLSL\n";
+	std::cerr << "  -bench  Report the translation time and GLSL size of each file, without and with -O\n";
 	std::cerr << std::endl;
 }
 
+std::vector<char> LoadFile(char const * name)
+{
+	std::vector<char> data;
+	std::ifstream in(name, std::ios_base::in | std::ios_base::binary);
+	char c;
+	in >> std::noskipws;
+	while (in >> c)
+	{
+		data.push_back(c);
+	}
+	return data;
+}
+
+int Benchmark(int num_files, char** files)
+{
+	uint32_t const NUM_ITERATIONS = 20;
+	uint32_t const passes[] = { 0, SOP_All };
+
+	double total_time[2] = { 0, 0 };
+	size_t total_size[2] = { 0, 0 };
+	for (int i = 0; i < num_files; ++ i)
+	{
+		std::vector<char> data = LoadFile(files[i]);
+		if (data.empty())
+		{
+			std::cerr << files[i] << ": Can't be opened" << std::endl;
+			continue;
+		}
+
+		try
+		{
+			double time[2];
+			size_t size[2];
+			for (int p = 0; p < 2; ++ p)
+			{
+				auto const start = std::chrono::high_resolution_clock::now();
+				for (uint32_t iter = 0; iter < NUM_ITERATIONS; ++ iter)
+				{
+					DXBC2GLSL::DXBC2GLSL dxbc2glsl;
+					dxbc2glsl.FeedDXBC(&data[0], true, true, STP_Fractional_Odd, STOP_Triangle_CW, GSV_430,
+						DXBC2GLSL::DXBC2GLSL::DefaultRules(GSV_430), passes[p]);
+					size[p] = dxbc2glsl.GLSLString().size();
+				}
+				std::chrono::duration<double, std::milli> const elapsed = std::chrono::high_resolution_clock::now() - start;
+				time[p] = elapsed.count() / NUM_ITERATIONS;
+
+				total_time[p] += time[p];
+				total_size[p] += size[p];
+			}
+
+			std::cout << files[i] << ": " << time[0] << " ms, " << size[0] << " bytes. -O: "
+				<< time[1] << " ms, " << size[1] << " bytes" << std::endl;
+		}
+		catch (std::exception& ex)
+		{
+			std::cerr << files[i] << ": " << ex.what() << std::endl;
+		}
+	}
+
+	std::cout << std::endl;
+	std::cout << "Total: " << total_time[0] << " ms, " << total_size[0] << " bytes. -O: "
+		<< total_time[1] << " ms, " << total_size[1] << " bytes" << std::endl;
+
+	return 0;
+}
+
 int main(int argc, char** argv)
 {
-	if (argc < 2)
+	uint32_t opt_passes = 0;
+	bool bench = false;
+	int arg = 1;
+	for (; (arg < argc) && ('-' == argv[arg][0]); ++ arg)
+	{
+		if (0 == strcmp(argv[arg], "-O"))
+		{
+			opt_passes = SOP_All;
+		}
+		else if (0 == strcmp(argv[arg], "-bench"))
+		{
+			bench = true;
+		}
+		else
+		{
+			usage();
+			return 1;
+		}
+	}
+
+	if (arg >= argc)
 	{
 		usage();
 		return 1;
 	}
 
-	std::vector<char> data;
-	std::ifstream in(argv[1], std::ios_base::in | std::ios_base::binary);
+	if (bench)
+	{
+		return Benchmark(argc - arg, argv + arg);
+	}
+
+	std::vector<char> data = LoadFile(argv[arg]);
 	std::ofstream out;
 	bool screen_only = false;
-	if (argc < 3)
+	if (arg + 1 >= argc)
 	{
 		screen_only = true;
 	}
 	else
 	{
-		out.open(argv[2]);
-	}
-
-	char c;
-	in >> std::noskipws;
-	while (in >> c)
-	{
-		data.push_back(c);
+		out.open(argv[arg + 1]);
 	}
-	in.close();
 
 	try
 	{
 		DXBC2GLSL::DXBC2GLSL dxbc2glsl;
-		dxbc2glsl.FeedDXBC(&data[0], true, true, STP_Fractional_Odd, STOP_Triangle_CW, GSV_430);
+		dxbc2glsl.FeedDXBC(&data[0], true, true, STP_Fractional_Odd, STOP_Triangle_CW, GSV_430,
+			DXBC2GLSL::DXBC2GLSL::DefaultRules(GSV_430), opt_passes);
 		std::string glsl = dxbc2glsl.GLSLString();
 		if (!screen_only)
 		{
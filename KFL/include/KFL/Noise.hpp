@@ -34,6 +34,7 @@
 #pragma once
 
 #include <KFL/Math.hpp>
+#include <KFL/ArrayRef.hpp>
 
 namespace KlayGE
 {
@@ -67,9 +68,47 @@ namespace KlayGE
 			T tileable_turbulence(T x, T y, T z,
 				T w, T h, T d, int octaves, T lacunarity = T(2), T gain = T(0.5)) noexcept;
 
+			// Batch versions, out receives one value per position, so out_size must equal the number of positions. Positions are
+			// evaluated 4 at a time with SIMD, and spread over the pool if one is given. The results match the single sample versions.
+			void noise(ArrayRef<Vector_T<T, 2>> pos, T* out, size_t out_size, thread_pool* pool = nullptr);
+			void noise(ArrayRef<Vector_T<T, 3>> pos, T* out, size_t out_size, thread_pool* pool = nullptr);
+
+			void fBm(ArrayRef<Vector_T<T, 2>> pos, T* out, size_t out_size,
+				int octaves, T lacunarity = T(2), T gain = T(0.5), thread_pool* pool = nullptr);
+			void fBm(ArrayRef<Vector_T<T, 3>> pos, T* out, size_t out_size,
+				int octaves, T lacunarity = T(2), T gain = T(0.5), thread_pool* pool = nullptr);
+
+			void turbulence(ArrayRef<Vector_T<T, 2>> pos, T* out, size_t out_size,
+				int octaves, T lacunarity = T(2), T gain = T(0.5), thread_pool* pool = nullptr);
+			void turbulence(ArrayRef<Vector_T<T, 3>> pos, T* out, size_t out_size,
+				int octaves, T lacunarity = T(2), T gain = T(0.5), thread_pool* pool = nullptr);
+
+			void tileable_fBm(ArrayRef<Vector_T<T, 2>> pos, T* out, size_t out_size, T w, T h,
+				int octaves, T lacunarity = T(2), T gain = T(0.5), thread_pool* pool = nullptr);
+			void tileable_fBm(ArrayRef<Vector_T<T, 3>> pos, T* out, size_t out_size, T w, T h, T d,
+				int octaves, T lacunarity = T(2), T gain = T(0.5), thread_pool* pool = nullptr);
+
+			void tileable_turbulence(ArrayRef<Vector_T<T, 2>> pos, T* out, size_t out_size, T w, T h,
+				int octaves, T lacunarity = T(2), T gain = T(0.5), thread_pool* pool = nullptr);
+			void tileable_turbulence(ArrayRef<Vector_T<T, 3>> pos, T* out, size_t out_size, T w, T h, T d,
+				int octaves, T lacunarity = T(2), T gain = T(0.5), thread_pool* pool = nullptr);
+
 		private:
 			SimplexNoise() noexcept;
 
+			// Evaluates num positions given as separate coordinate arrays
+			void NoiseBlock(T const * x, T const * y, uint32_t num, T* out) noexcept;
+			void NoiseBlock(T const * x, T const * y, T const * z, uint32_t num, T* out) noexcept;
+
+			void FractalBatch(ArrayRef<Vector_T<T, 2>> pos, T* out, int octaves, T lacunarity, T gain, bool turbulence,
+				thread_pool* pool);
+			void FractalBatch(ArrayRef<Vector_T<T, 3>> pos, T* out, int octaves, T lacunarity, T gain, bool turbulence,
+				thread_pool* pool);
+			void TileableFractalBatch(ArrayRef<Vector_T<T, 2>> pos, T* out, T w, T h,
+				int octaves, T lacunarity, T gain, bool turbulence, thread_pool* pool);
+			void TileableFractalBatch(ArrayRef<Vector_T<T, 3>> pos, T* out, T w, T h, T d,
+				int octaves, T lacunarity, T gain, bool turbulence, thread_pool* pool);
+
 		private:
 			int p_[512];
 			Vector_T<T, 3> g_[12];
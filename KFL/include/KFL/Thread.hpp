@@ -34,6 +34,7 @@
 #pragma once
 
 #include <boost/assert.hpp>
+#include <algorithm>
 #include <thread>
 #include <condition_variable>
 #include <mutex>
@@ -612,6 +613,34 @@ namespace KlayGE
 	private:
 		std::shared_ptr<thread_pool_common_data_t> data_;
 	};
+
+	// Calls func(begin, end) on at most max_jobs contiguous sub ranges of [0, count). The first range runs on the calling
+	// thread, the others on the pool. Returns when all of them are done.
+	template <typename Func>
+	void parallel_for(thread_pool& pool, uint32_t count, uint32_t max_jobs, Func const & func)
+	{
+		uint32_t const num_jobs = std::min(max_jobs, count);
+		if (num_jobs > 1)
+		{
+			std::vector<joiner<void>> joiners(num_jobs - 1);
+			for (uint32_t i = 1; i < num_jobs; ++ i)
+			{
+				joiners[i - 1] = pool([&func, count, num_jobs, i]
+					{
+						func(i * count / num_jobs, (i + 1) * count / num_jobs);
+					});
+			}
+			func(0, count / num_jobs);
+			for (auto& joiner : joiners)
+			{
+				joiner();
+			}
+		}
+		else
+		{
+			func(0, count);
+		}
+	}
 }
 
 #endif		// _KFL_THREAD_HPP
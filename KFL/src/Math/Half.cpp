@@ -113,16 +113,18 @@ namespace KlayGE
 				e += 1;
 				m &= ~0x00000400;
 			}
+			else
+			{
+				// Zero
+				e = -(127 - 15);
+			}
 		}
 		else
 		{
 			if (31 == e)
 			{
-				if (m != 0)
-				{
-					// Nan -- preserve sign and significand bits
-					e = 0xFF - (127 - 15);
-				}
+				// Inf or NaN -- preserve sign and significand bits
+				e = 0xFF - (127 - 15);
 			}
 		}
 
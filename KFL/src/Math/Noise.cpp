@@ -30,8 +30,219 @@
 
 #include <KFL/KFL.hpp>
 
+#include <KFL/CpuInfo.hpp>
+#include <KFL/Thread.hpp>
 #include <KFL/Noise.hpp>
 
+#include <algorithm>
+#include <vector>
+
+#if defined(KLAYGE_SSE2_SUPPORT)
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+	using namespace KlayGE;
+
+	// Positions are processed in blocks of this size, with the coordinates split into separate arrays
+	uint32_t const NOISE_BLOCK = 64;
+
+	// Batches smaller than this run on the calling thread
+	size_t const MIN_PARALLEL_NOISE_SAMPLES = 16 * 1024;
+
+	// Calls func(begin, end) on blocks of at most NOISE_BLOCK positions of [0, count). Spread over the pool if there is one.
+	template <typename Func>
+	void ForEachNoiseBlock(size_t count, thread_pool* pool, Func const & func)
+	{
+		uint32_t const num_blocks = static_cast<uint32_t>((count + NOISE_BLOCK - 1) / NOISE_BLOCK);
+		auto run = [&func, count](uint32_t block_begin, uint32_t block_end)
+			{
+				size_t const end = std::min<size_t>(static_cast<size_t>(block_end) * NOISE_BLOCK, count);
+				for (size_t i = static_cast<size_t>(block_begin) * NOISE_BLOCK; i < end; i += NOISE_BLOCK)
+				{
+					func(i, std::min<size_t>(i + NOISE_BLOCK, end));
+				}
+			};
+
+		if ((pool != nullptr) && (count >= MIN_PARALLEL_NOISE_SAMPLES))
+		{
+			CPUInfo cpu;
+			parallel_for(*pool, num_blocks, static_cast<uint32_t>(cpu.NumHWThreads()), run);
+		}
+		else
+		{
+			run(0, num_blocks);
+		}
+	}
+
+#if defined(KLAYGE_SSE2_SUPPORT)
+	// Same as static_cast<int>(MathLib::floor(v)), which truncates v - 1 for non positive values
+	__m128i FloorToInt(__m128 v)
+	{
+		__m128 const positive = _mm_cmpgt_ps(v, _mm_setzero_ps());
+		__m128 const shifted = _mm_sub_ps(v, _mm_andnot_ps(positive, _mm_set1_ps(1)));
+		return _mm_cvttps_epi32(shifted);
+	}
+
+	// Contribution of one simplex corner, following the operation order of the single sample version
+	__m128 CornerContribution(__m128 radius, __m128 x, __m128 y, __m128 z, __m128 gx, __m128 gy, __m128 gz)
+	{
+		__m128 t = _mm_sub_ps(_mm_sub_ps(_mm_sub_ps(radius, _mm_mul_ps(x, x)), _mm_mul_ps(y, y)), _mm_mul_ps(z, z));
+		t = _mm_and_ps(t, _mm_cmpgt_ps(t, _mm_setzero_ps()));
+		t = _mm_mul_ps(t, t);
+		__m128 const d = _mm_add_ps(_mm_mul_ps(gx, x), _mm_add_ps(_mm_mul_ps(gy, y), _mm_mul_ps(gz, z)));
+		return _mm_mul_ps(_mm_mul_ps(t, t), d);
+	}
+
+	void SimplexNoise2x4(int const * perm, float3 const * grad, float const * x, float const * y, float* out)
+	{
+		float const F2 = 0.366025403784f;
+		float const G2 = 0.211324865405f;
+
+		__m128 const one = _mm_set1_ps(1);
+		__m128 const zero = _mm_setzero_ps();
+
+		__m128 const vx = _mm_loadu_ps(x);
+		__m128 const vy = _mm_loadu_ps(y);
+
+		__m128 const s = _mm_mul_ps(_mm_add_ps(vx, vy), _mm_set1_ps(F2));
+		__m128i const i = FloorToInt(_mm_add_ps(vx, s));
+		__m128i const j = FloorToInt(_mm_add_ps(vy, s));
+		__m128 const t = _mm_mul_ps(_mm_cvtepi32_ps(_mm_add_epi32(i, j)), _mm_set1_ps(G2));
+		__m128 const x0 = _mm_sub_ps(vx, _mm_sub_ps(_mm_cvtepi32_ps(i), t));
+		__m128 const y0 = _mm_sub_ps(vy, _mm_sub_ps(_mm_cvtepi32_ps(j), t));
+
+		__m128 const upper = _mm_cmpgt_ps(x0, y0);
+		__m128 const i1 = _mm_and_ps(upper, one);
+		__m128 const j1 = _mm_andnot_ps(upper, one);
+
+		__m128 const x1 = _mm_add_ps(_mm_sub_ps(x0, i1), _mm_set1_ps(G2));
+		__m128 const y1 = _mm_add_ps(_mm_sub_ps(y0, j1), _mm_set1_ps(G2));
+		__m128 const x2 = _mm_add_ps(_mm_sub_ps(x0, one), _mm_set1_ps(2 * G2));
+		__m128 const y2 = _mm_add_ps(_mm_sub_ps(y0, one), _mm_set1_ps(2 * G2));
+
+		__m128i const mask = _mm_set1_epi32(255);
+		alignas(16) int32_t ii[4];
+		alignas(16) int32_t jj[4];
+		alignas(16) int32_t ii1[4];
+		_mm_store_si128(reinterpret_cast<__m128i*>(ii), _mm_and_si128(i, mask));
+		_mm_store_si128(reinterpret_cast<__m128i*>(jj), _mm_and_si128(j, mask));
+		_mm_store_si128(reinterpret_cast<__m128i*>(ii1), _mm_cvttps_epi32(i1));
+
+		alignas(16) float g[3][3][4];
+		for (int l = 0; l < 4; ++ l)
+		{
+			int const gi[] =
+			{
+				perm[ii[l] + perm[jj[l]]] % 12,
+				perm[ii[l] + ii1[l] + perm[jj[l] + 1 - ii1[l]]] % 12,
+				perm[ii[l] + 1 + perm[jj[l] + 1]] % 12
+			};
+			for (int c = 0; c < 3; ++ c)
+			{
+				g[c][0][l] = grad[gi[c]].x();
+				g[c][1][l] = grad[gi[c]].y();
+				g[c][2][l] = grad[gi[c]].z();
+			}
+		}
+
+		__m128 const radius = _mm_set1_ps(0.5f);
+		__m128 n = zero;
+		n = _mm_add_ps(n, CornerContribution(radius, x0, y0, zero, _mm_load_ps(g[0][0]), _mm_load_ps(g[0][1]), _mm_load_ps(g[0][2])));
+		n = _mm_add_ps(n, CornerContribution(radius, x1, y1, zero, _mm_load_ps(g[1][0]), _mm_load_ps(g[1][1]), _mm_load_ps(g[1][2])));
+		n = _mm_add_ps(n, CornerContribution(radius, x2, y2, zero, _mm_load_ps(g[2][0]), _mm_load_ps(g[2][1]), _mm_load_ps(g[2][2])));
+
+		_mm_storeu_ps(out, _mm_mul_ps(_mm_set1_ps(70), n));
+	}
+
+	void SimplexNoise3x4(int const * perm, float3 const * grad, float const * x, float const * y, float const * z, float* out)
+	{
+		float const F3 = 1 / 3.0f;
+		float const G3 = 1 / 6.0f;
+
+		__m128 const one = _mm_set1_ps(1);
+
+		__m128 const vx = _mm_loadu_ps(x);
+		__m128 const vy = _mm_loadu_ps(y);
+		__m128 const vz = _mm_loadu_ps(z);
+
+		__m128 const s = _mm_mul_ps(_mm_add_ps(_mm_add_ps(vx, vy), vz), _mm_set1_ps(F3));
+		__m128i const i = FloorToInt(_mm_add_ps(vx, s));
+		__m128i const j = FloorToInt(_mm_add_ps(vy, s));
+		__m128i const k = FloorToInt(_mm_add_ps(vz, s));
+		__m128 const t = _mm_mul_ps(_mm_cvtepi32_ps(_mm_add_epi32(_mm_add_epi32(i, j), k)), _mm_set1_ps(G3));
+		__m128 const x0 = _mm_sub_ps(vx, _mm_sub_ps(_mm_cvtepi32_ps(i), t));
+		__m128 const y0 = _mm_sub_ps(vy, _mm_sub_ps(_mm_cvtepi32_ps(j), t));
+		__m128 const z0 = _mm_sub_ps(vz, _mm_sub_ps(_mm_cvtepi32_ps(k), t));
+
+		// Offsets of the second and third corners, the branches of the single sample version as masks
+		__m128 const x_ge_y = _mm_cmpge_ps(x0, y0);
+		__m128 const y_ge_z = _mm_cmpge_ps(y0, z0);
+		__m128 const x_ge_z = _mm_cmpge_ps(x0, z0);
+		__m128 const i1 = _mm_and_ps(_mm_and_ps(x_ge_y, x_ge_z), one);
+		__m128 const j1 = _mm_and_ps(_mm_andnot_ps(x_ge_y, y_ge_z), one);
+		__m128 const k1 = _mm_andnot_ps(_mm_or_ps(y_ge_z, x_ge_z), one);
+		__m128 const i2 = _mm_and_ps(_mm_or_ps(x_ge_y, x_ge_z), one);
+		__m128 const j2 = _mm_or_ps(_mm_andnot_ps(x_ge_y, one), _mm_and_ps(y_ge_z, one));
+		__m128 const k2 = _mm_andnot_ps(_mm_and_ps(y_ge_z, x_ge_z), one);
+
+		__m128 const x1 = _mm_add_ps(_mm_sub_ps(x0, i1), _mm_set1_ps(G3));
+		__m128 const y1 = _mm_add_ps(_mm_sub_ps(y0, j1), _mm_set1_ps(G3));
+		__m128 const z1 = _mm_add_ps(_mm_sub_ps(z0, k1), _mm_set1_ps(G3));
+		__m128 const x2 = _mm_add_ps(_mm_sub_ps(x0, i2), _mm_set1_ps(2 * G3));
+		__m128 const y2 = _mm_add_ps(_mm_sub_ps(y0, j2), _mm_set1_ps(2 * G3));
+		__m128 const z2 = _mm_add_ps(_mm_sub_ps(z0, k2), _mm_set1_ps(2 * G3));
+		__m128 const x3 = _mm_add_ps(_mm_sub_ps(x0, one), _mm_set1_ps(3 * G3));
+		__m128 const y3 = _mm_add_ps(_mm_sub_ps(y0, one), _mm_set1_ps(3 * G3));
+		__m128 const z3 = _mm_add_ps(_mm_sub_ps(z0, one), _mm_set1_ps(3 * G3));
+
+		__m128i const mask = _mm_set1_epi32(255);
+		alignas(16) int32_t cell[3][4];
+		alignas(16) int32_t offset[6][4];
+		_mm_store_si128(reinterpret_cast<__m128i*>(cell[0]), _mm_and_si128(i, mask));
+		_mm_store_si128(reinterpret_cast<__m128i*>(cell[1]), _mm_and_si128(j, mask));
+		_mm_store_si128(reinterpret_cast<__m128i*>(cell[2]), _mm_and_si128(k, mask));
+		_mm_store_si128(reinterpret_cast<__m128i*>(offset[0]), _mm_cvttps_epi32(i1));
+		_mm_store_si128(reinterpret_cast<__m128i*>(offset[1]), _mm_cvttps_epi32(j1));
+		_mm_store_si128(reinterpret_cast<__m128i*>(offset[2]), _mm_cvttps_epi32(k1));
+		_mm_store_si128(reinterpret_cast<__m128i*>(offset[3]), _mm_cvttps_epi32(i2));
+		_mm_store_si128(reinterpret_cast<__m128i*>(offset[4]), _mm_cvttps_epi32(j2));
+		_mm_store_si128(reinterpret_cast<__m128i*>(offset[5]), _mm_cvttps_epi32(k2));
+
+		alignas(16) float g[4][3][4];
+		for (int l = 0; l < 4; ++ l)
+		{
+			int const ii = cell[0][l];
+			int const jj = cell[1][l];
+			int const kk = cell[2][l];
+			int const gi[] =
+			{
+				perm[ii + perm[jj + perm[kk]]] % 12,
+				perm[ii + offset[0][l] + perm[jj + offset[1][l] + perm[kk + offset[2][l]]]] % 12,
+				perm[ii + offset[3][l] + perm[jj + offset[4][l] + perm[kk + offset[5][l]]]] % 12,
+				perm[ii + 1 + perm[jj + 1 + perm[kk + 1]]] % 12
+			};
+			for (int c = 0; c < 4; ++ c)
+			{
+				g[c][0][l] = grad[gi[c]].x();
+				g[c][1][l] = grad[gi[c]].y();
+				g[c][2][l] = grad[gi[c]].z();
+			}
+		}
+
+		__m128 const radius = _mm_set1_ps(0.6f);
+		__m128 n = _mm_setzero_ps();
+		n = _mm_add_ps(n, CornerContribution(radius, x0, y0, z0, _mm_load_ps(g[0][0]), _mm_load_ps(g[0][1]), _mm_load_ps(g[0][2])));
+		n = _mm_add_ps(n, CornerContribution(radius, x1, y1, z1, _mm_load_ps(g[1][0]), _mm_load_ps(g[1][1]), _mm_load_ps(g[1][2])));
+		n = _mm_add_ps(n, CornerContribution(radius, x2, y2, z2, _mm_load_ps(g[2][0]), _mm_load_ps(g[2][1]), _mm_load_ps(g[2][2])));
+		n = _mm_add_ps(n, CornerContribution(radius, x3, y3, z3, _mm_load_ps(g[3][0]), _mm_load_ps(g[3][1]), _mm_load_ps(g[3][2])));
+
+		_mm_storeu_ps(out, _mm_mul_ps(_mm_set1_ps(32), n));
+	}
+#endif
+}
+
 namespace KlayGE
 {
 	namespace MathLib
@@ -447,6 +658,410 @@ namespace KlayGE
 			return sum / amp_sum;
 		}
 
+		template <typename T>
+		void SimplexNoise<T>::noise(ArrayRef<Vector_T<T, 2>> pos, T* out, size_t out_size, thread_pool* pool)
+		{
+			BOOST_ASSERT(out_size == pos.size());
+			KFL_UNUSED(out_size);
+
+			ForEachNoiseBlock(pos.size(), pool, [this, pos, out](size_t begin, size_t end)
+				{
+					T x[NOISE_BLOCK];
+					T y[NOISE_BLOCK];
+					uint32_t const num = static_cast<uint32_t>(end - begin);
+					for (uint32_t i = 0; i < num; ++ i)
+					{
+						x[i] = pos[begin + i].x();
+						y[i] = pos[begin + i].y();
+					}
+					this->NoiseBlock(x, y, num, out + begin);
+				});
+		}
+
+		template <typename T>
+		void SimplexNoise<T>::noise(ArrayRef<Vector_T<T, 3>> pos, T* out, size_t out_size, thread_pool* pool)
+		{
+			BOOST_ASSERT(out_size == pos.size());
+			KFL_UNUSED(out_size);
+
+			ForEachNoiseBlock(pos.size(), pool, [this, pos, out](size_t begin, size_t end)
+				{
+					T x[NOISE_BLOCK];
+					T y[NOISE_BLOCK];
+					T z[NOISE_BLOCK];
+					uint32_t const num = static_cast<uint32_t>(end - begin);
+					for (uint32_t i = 0; i < num; ++ i)
+					{
+						x[i] = pos[begin + i].x();
+						y[i] = pos[begin + i].y();
+						z[i] = pos[begin + i].z();
+					}
+					this->NoiseBlock(x, y, z, num, out + begin);
+				});
+		}
+
+		template <typename T>
+		void SimplexNoise<T>::fBm(ArrayRef<Vector_T<T, 2>> pos, T* out, size_t out_size, int octaves, T lacunarity, T gain,
+			thread_pool* pool)
+		{
+			BOOST_ASSERT(out_size == pos.size());
+			KFL_UNUSED(out_size);
+
+			this->FractalBatch(pos, out, octaves, lacunarity, gain, false, pool);
+		}
+
+		template <typename T>
+		void SimplexNoise<T>::fBm(ArrayRef<Vector_T<T, 3>> pos, T* out, size_t out_size, int octaves, T lacunarity, T gain,
+			thread_pool* pool)
+		{
+			BOOST_ASSERT(out_size == pos.size());
+			KFL_UNUSED(out_size);
+
+			this->FractalBatch(pos, out, octaves, lacunarity, gain, false, pool);
+		}
+
+		template <typename T>
+		void SimplexNoise<T>::turbulence(ArrayRef<Vector_T<T, 2>> pos, T* out, size_t out_size, int octaves, T lacunarity, T gain,
+			thread_pool* pool)
+		{
+			BOOST_ASSERT(out_size == pos.size());
+			KFL_UNUSED(out_size);
+
+			this->FractalBatch(pos, out, octaves, lacunarity, gain, true, pool);
+		}
+
+		template <typename T>
+		void SimplexNoise<T>::turbulence(ArrayRef<Vector_T<T, 3>> pos, T* out, size_t out_size, int octaves, T lacunarity, T gain,
+			thread_pool* pool)
+		{
+			BOOST_ASSERT(out_size == pos.size());
+			KFL_UNUSED(out_size);
+
+			this->FractalBatch(pos, out, octaves, lacunarity, gain, true, pool);
+		}
+
+		template <typename T>
+		void SimplexNoise<T>::tileable_fBm(ArrayRef<Vector_T<T, 2>> pos, T* out, size_t out_size, T w, T h,
+			int octaves, T lacunarity, T gain, thread_pool* pool)
+		{
+			BOOST_ASSERT(out_size == pos.size());
+			KFL_UNUSED(out_size);
+
+			this->TileableFractalBatch(pos, out, w, h, octaves, lacunarity, gain, false, pool);
+		}
+
+		template <typename T>
+		void SimplexNoise<T>::tileable_fBm(ArrayRef<Vector_T<T, 3>> pos, T* out, size_t out_size, T w, T h, T d,
+			int octaves, T lacunarity, T gain, thread_pool* pool)
+		{
+			BOOST_ASSERT(out_size == pos.size());
+			KFL_UNUSED(out_size);
+
+			this->TileableFractalBatch(pos, out, w, h, d, octaves, lacunarity, gain, false, pool);
+		}
+
+		template <typename T>
+		void SimplexNoise<T>::tileable_turbulence(ArrayRef<Vector_T<T, 2>> pos, T* out, size_t out_size, T w, T h,
+			int octaves, T lacunarity, T gain, thread_pool* pool)
+		{
+			BOOST_ASSERT(out_size == pos.size());
+			KFL_UNUSED(out_size);
+
+			this->TileableFractalBatch(pos, out, w, h, octaves, lacunarity, gain, true, pool);
+		}
+
+		template <typename T>
+		void SimplexNoise<T>::tileable_turbulence(ArrayRef<Vector_T<T, 3>> pos, T* out, size_t out_size, T w, T h, T d,
+			int octaves, T lacunarity, T gain, thread_pool* pool)
+		{
+			BOOST_ASSERT(out_size == pos.size());
+			KFL_UNUSED(out_size);
+
+			this->TileableFractalBatch(pos, out, w, h, d, octaves, lacunarity, gain, true, pool);
+		}
+
+		template <typename T>
+		void SimplexNoise<T>::NoiseBlock(T const * x, T const * y, uint32_t num, T* out) noexcept
+		{
+			for (uint32_t i = 0; i < num; ++ i)
+			{
+				out[i] = this->noise(x[i], y[i]);
+			}
+		}
+
+		template <typename T>
+		void SimplexNoise<T>::NoiseBlock(T const * x, T const * y, T const * z, uint32_t num, T* out) noexcept
+		{
+			for (uint32_t i = 0; i < num; ++ i)
+			{
+				out[i] = this->noise(x[i], y[i], z[i]);
+			}
+		}
+
+#if defined(KLAYGE_SSE2_SUPPORT)
+		template <>
+		void SimplexNoise<float>::NoiseBlock(float const * x, float const * y, uint32_t num, float* out) noexcept
+		{
+			uint32_t i = 0;
+			for (; i + 4 <= num; i += 4)
+			{
+				SimplexNoise2x4(p_, g_, x + i, y + i, out + i);
+			}
+			if (i < num)
+			{
+				// Pads the tail to a full vector
+				float tx[4] = { 0, 0, 0, 0 };
+				float ty[4] = { 0, 0, 0, 0 };
+				float to[4];
+				std::copy(x + i, x + num, tx);
+				std::copy(y + i, y + num, ty);
+				SimplexNoise2x4(p_, g_, tx, ty, to);
+				std::copy(to, to + num - i, out + i);
+			}
+		}
+
+		template <>
+		void SimplexNoise<float>::NoiseBlock(float const * x, float const * y, float const * z, uint32_t num, float* out) noexcept
+		{
+			uint32_t i = 0;
+			for (; i + 4 <= num; i += 4)
+			{
+				SimplexNoise3x4(p_, g_, x + i, y + i, z + i, out + i);
+			}
+			if (i < num)
+			{
+				float tx[4] = { 0, 0, 0, 0 };
+				float ty[4] = { 0, 0, 0, 0 };
+				float tz[4] = { 0, 0, 0, 0 };
+				float to[4];
+				std::copy(x + i, x + num, tx);
+				std::copy(y + i, y + num, ty);
+				std::copy(z + i, z + num, tz);
+				SimplexNoise3x4(p_, g_, tx, ty, tz, to);
+				std::copy(to, to + num - i, out + i);
+			}
+		}
+#endif
+
+		template <typename T>
+		void SimplexNoise<T>::FractalBatch(ArrayRef<Vector_T<T, 2>> pos, T* out, int octaves, T lacunarity, T gain,
+			bool turbulence, thread_pool* pool)
+		{
+			ForEachNoiseBlock(pos.size(), pool, [this, pos, out, octaves, lacunarity, gain, turbulence](size_t begin, size_t end)
+				{
+					T x[NOISE_BLOCK];
+					T y[NOISE_BLOCK];
+					T n[NOISE_BLOCK];
+					T sum[NOISE_BLOCK];
+					uint32_t const num = static_cast<uint32_t>(end - begin);
+					for (uint32_t i = 0; i < num; ++ i)
+					{
+						x[i] = pos[begin + i].x();
+						y[i] = pos[begin + i].y();
+						sum[i] = 0;
+					}
+
+					T amp = 1;
+					T amp_sum = 0;
+					for (int octave = 0; octave < octaves; ++ octave)
+					{
+						this->NoiseBlock(x, y, num, n);
+						for (uint32_t i = 0; i < num; ++ i)
+						{
+							sum[i] += (turbulence ? MathLib::abs(n[i]) : n[i]) * amp;
+							x[i] *= lacunarity;
+							y[i] *= lacunarity;
+						}
+						amp_sum += amp;
+						amp *= gain;
+					}
+
+					for (uint32_t i = 0; i < num; ++ i)
+					{
+						out[begin + i] = sum[i] / amp_sum;
+					}
+				});
+		}
+
+		template <typename T>
+		void SimplexNoise<T>::FractalBatch(ArrayRef<Vector_T<T, 3>> pos, T* out, int octaves, T lacunarity, T gain,
+			bool turbulence, thread_pool* pool)
+		{
+			ForEachNoiseBlock(pos.size(), pool, [this, pos, out, octaves, lacunarity, gain, turbulence](size_t begin, size_t end)
+				{
+					T x[NOISE_BLOCK];
+					T y[NOISE_BLOCK];
+					T z[NOISE_BLOCK];
+					T n[NOISE_BLOCK];
+					T sum[NOISE_BLOCK];
+					uint32_t const num = static_cast<uint32_t>(end - begin);
+					for (uint32_t i = 0; i < num; ++ i)
+					{
+						x[i] = pos[begin + i].x();
+						y[i] = pos[begin + i].y();
+						z[i] = pos[begin + i].z();
+						sum[i] = 0;
+					}
+
+					T amp = 1;
+					T amp_sum = 0;
+					for (int octave = 0; octave < octaves; ++ octave)
+					{
+						this->NoiseBlock(x, y, z, num, n);
+						for (uint32_t i = 0; i < num; ++ i)
+						{
+							sum[i] += (turbulence ? MathLib::abs(n[i]) : n[i]) * amp;
+							x[i] *= lacunarity;
+							y[i] *= lacunarity;
+							z[i] *= lacunarity;
+						}
+						amp_sum += amp;
+						amp *= gain;
+					}
+
+					for (uint32_t i = 0; i < num; ++ i)
+					{
+						out[begin + i] = sum[i] / amp_sum;
+					}
+				});
+		}
+
+		template <typename T>
+		void SimplexNoise<T>::TileableFractalBatch(ArrayRef<Vector_T<T, 2>> pos, T* out, T w, T h,
+			int octaves, T lacunarity, T gain, bool turbulence, thread_pool* pool)
+		{
+			ForEachNoiseBlock(pos.size(), pool,
+				[this, pos, out, w, h, octaves, lacunarity, gain, turbulence](size_t begin, size_t end)
+				{
+					T x[NOISE_BLOCK];
+					T y[NOISE_BLOCK];
+					T xw[NOISE_BLOCK];
+					T yh[NOISE_BLOCK];
+					T n[4][NOISE_BLOCK];
+					T sum[NOISE_BLOCK];
+					uint32_t const num = static_cast<uint32_t>(end - begin);
+					for (uint32_t i = 0; i < num; ++ i)
+					{
+						x[i] = pos[begin + i].x();
+						y[i] = pos[begin + i].y();
+						sum[i] = 0;
+					}
+
+					T ow = w;
+					T oh = h;
+					T amp = 1;
+					T amp_sum = 0;
+					for (int octave = 0; octave < octaves; ++ octave)
+					{
+						for (uint32_t i = 0; i < num; ++ i)
+						{
+							xw[i] = x[i] - ow;
+							yh[i] = y[i] - oh;
+						}
+
+						// The same blend of 4 shifted copies as tileable_noise
+						this->NoiseBlock(x, y, num, n[0]);
+						this->NoiseBlock(xw, y, num, n[1]);
+						this->NoiseBlock(x, yh, num, n[2]);
+						this->NoiseBlock(xw, yh, num, n[3]);
+						for (uint32_t i = 0; i < num; ++ i)
+						{
+							T const tn = (n[0][i] * (ow - x[i]) * (oh - y[i])
+								+ n[1][i] * (0 + x[i]) * (oh - y[i])
+								+ n[2][i] * (ow - x[i]) * (0 + y[i])
+								+ n[3][i] * (0 + x[i]) * (0 + y[i])) / (ow * oh);
+							sum[i] += (turbulence ? MathLib::abs(tn) : tn) * amp;
+							x[i] *= lacunarity;
+							y[i] *= lacunarity;
+						}
+						amp_sum += amp;
+						ow *= lacunarity;
+						oh *= lacunarity;
+						amp *= gain;
+					}
+
+					for (uint32_t i = 0; i < num; ++ i)
+					{
+						out[begin + i] = sum[i] / amp_sum;
+					}
+				});
+		}
+
+		template <typename T>
+		void SimplexNoise<T>::TileableFractalBatch(ArrayRef<Vector_T<T, 3>> pos, T* out, T w, T h, T d,
+			int octaves, T lacunarity, T gain, bool turbulence, thread_pool* pool)
+		{
+			ForEachNoiseBlock(pos.size(), pool,
+				[this, pos, out, w, h, d, octaves, lacunarity, gain, turbulence](size_t begin, size_t end)
+				{
+					T x[NOISE_BLOCK];
+					T y[NOISE_BLOCK];
+					T z[NOISE_BLOCK];
+					T xw[NOISE_BLOCK];
+					T yh[NOISE_BLOCK];
+					T zd[NOISE_BLOCK];
+					T n[8][NOISE_BLOCK];
+					T sum[NOISE_BLOCK];
+					uint32_t const num = static_cast<uint32_t>(end - begin);
+					for (uint32_t i = 0; i < num; ++ i)
+					{
+						x[i] = pos[begin + i].x();
+						y[i] = pos[begin + i].y();
+						z[i] = pos[begin + i].z();
+						sum[i] = 0;
+					}
+
+					T ow = w;
+					T oh = h;
+					T od = d;
+					T amp = 1;
+					T amp_sum = 0;
+					for (int octave = 0; octave < octaves; ++ octave)
+					{
+						for (uint32_t i = 0; i < num; ++ i)
+						{
+							xw[i] = x[i] - ow;
+							yh[i] = y[i] - oh;
+							zd[i] = z[i] - od;
+						}
+
+						this->NoiseBlock(x, y, z, num, n[0]);
+						this->NoiseBlock(xw, y, z, num, n[1]);
+						this->NoiseBlock(x, yh, z, num, n[2]);
+						this->NoiseBlock(xw, yh, z, num, n[3]);
+						this->NoiseBlock(x, y, zd, num, n[4]);
+						this->NoiseBlock(xw, y, zd, num, n[5]);
+						this->NoiseBlock(x, yh, zd, num, n[6]);
+						this->NoiseBlock(xw, yh, zd, num, n[7]);
+						for (uint32_t i = 0; i < num; ++ i)
+						{
+							T const tn = (n[0][i] * (ow - x[i]) * (oh - y[i]) * (od - z[i])
+								+ n[1][i] * (0 + x[i]) * (oh - y[i]) * (od - z[i])
+								+ n[2][i] * (ow - x[i]) * (0 + y[i]) * (od - z[i])
+								+ n[3][i] * (0 + x[i]) * (0 + y[i]) * (od - z[i])
+								+ n[4][i] * (ow - x[i]) * (oh - y[i]) * (0 + z[i])
+								+ n[5][i] * (0 + x[i]) * (oh - y[i]) * (0 + z[i])
+								+ n[6][i] * (ow - x[i]) * (0 + y[i]) * (0 + z[i])
+								+ n[7][i] * (0 + x[i]) * (0 + y[i]) * (0 + z[i])) / (ow * oh * od);
+							sum[i] += (turbulence ? MathLib::abs(tn) : tn) * amp;
+							x[i] *= lacunarity;
+							y[i] *= lacunarity;
+							z[i] *= lacunarity;
+						}
+						amp_sum += amp;
+						ow *= lacunarity;
+						oh *= lacunarity;
+						od *= lacunarity;
+						amp *= gain;
+					}
+
+					for (uint32_t i = 0; i < num; ++ i)
+					{
+						out[begin + i] = sum[i] / amp_sum;
+					}
+				});
+		}
+
 
 		template class SimplexNoise<float>;
 	}
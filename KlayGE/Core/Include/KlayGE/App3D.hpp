@@ -174,9 +174,15 @@ namespace KlayGE
 
 		WindowPtr main_wnd_;
 
+	private:
+		// Saves the assets loaded so far as the startup manifest of the next run
+		void FinishStartup();
+
 	private:
 		ConfirmDeviceSignal confirm_device_;
 
+		std::string startup_manifest_path_;
+
 #if defined KLAYGE_PLATFORM_WINDOWS_STORE
 	public:
 		void MetroCreate();
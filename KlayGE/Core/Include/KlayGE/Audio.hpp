@@ -34,9 +34,15 @@
 #pragma once
 
 #include <KlayGE/PreDeclare.hpp>
+#include <KFL/Thread.hpp>
 #include <KFL/Vector.hpp>
 
+#include <atomic>
+#include <functional>
 #include <map>
+#include <vector>
+
+#include <boost/lockfree/spsc_queue.hpp>
 
 #include <KlayGE/AudioDataSource.hpp>
 
@@ -88,12 +94,100 @@ namespace KlayGE
 
 	protected:
 		virtual void DoReset() = 0;
+
+	protected:
+		// The whole decoded sound. Shared with the data source when it comes from a SoundData, so the backends never
+		// hold a private copy of a sound that several buffers play.
+		std::shared_ptr<std::vector<uint8_t> const> pcm_;
+	};
+
+	// Decoded audio of a music buffer. The streaming thread decodes into the ring buffer, and the backend copies out of it.
+	class KLAYGE_CORE_API AudioStream : boost::noncopyable
+	{
+	public:
+		AudioStream(AudioDataSourcePtr const & data_source, uint32_t buffer_seconds);
+
+		uint32_t BytesPerSecond() const
+		{
+			return bytes_per_sec_;
+		}
+		uint32_t BlockAlign() const
+		{
+			return block_align_;
+		}
+
+		void Loop(bool loop);
+
+		// Rewinds the data source and drops the decoded data. The stream must not be registered to a streamer.
+		void Reset();
+		// Decodes until the ring buffer is full. The stream must not be registered to a streamer.
+		void Fill();
+
+		// Consumer side. A read that comes back short before the end of the stream counts as an underrun.
+		size_t Read(void* data, size_t size);
+		bool EndOfStream() const;
+		uint32_t NumUnderruns() const;
+
+		// Producer side
+		float BufferedSeconds() const;
+		bool Full() const;
+		size_t Decode(size_t size);
+
+	private:
+		AudioDataSourcePtr data_source_;
+		uint32_t bytes_per_sec_;
+		uint32_t block_align_;
+		size_t capacity_;
+
+		boost::lockfree::spsc_queue<uint8_t> ring_;
+		std::vector<uint8_t> decode_buff_;
+
+		std::atomic<bool> loop_;
+		std::atomic<bool> source_ended_;
+		std::atomic<uint32_t> num_underruns_;
+	};
+
+	// One thread decodes all playing music. Each pass it runs the consumers of the registered streams, then decodes a chunk
+	// at a time into the stream closest to running dry, until all ring buffers are full.
+	class KLAYGE_CORE_API AudioStreamer : boost::noncopyable
+	{
+	public:
+		// Without a thread, the owner calls Update.
+		explicit AudioStreamer(bool threaded);
+		~AudioStreamer();
+
+		// consumer runs on the streaming thread. It's where a backend copies decoded data into its device queue.
+		void Register(AudioStreamPtr const & stream, std::function<void()> const & consumer);
+		// Waits for the current pass, so neither the stream nor the consumer is used after it returns
+		void Unregister(AudioStreamPtr const & stream);
+
+		void Update();
+
+		uint32_t NumUnderruns() const;
+
+	private:
+		void DoUpdate();
+		void ServiceThreadFunc();
+
+	private:
+		struct StreamEntry
+		{
+			AudioStreamPtr stream;
+			std::function<void()> consumer;
+		};
+		std::vector<StreamEntry> streams_;
+		uint32_t retired_underruns_;
+
+		mutable std::mutex streams_mutex_;
+		std::condition_variable streams_cond_;
+		bool quit_;
+		std::unique_ptr<joiner<void>> service_thread_;
 	};
 
 	class KLAYGE_CORE_API MusicBuffer : public AudioBuffer
 	{
 	public:
-		explicit MusicBuffer(AudioDataSourcePtr const & data_source);
+		MusicBuffer(AudioDataSourcePtr const & data_source, uint32_t buffer_seconds);
 		~MusicBuffer() override;
 
 		void Play(bool loop = false) override;
@@ -102,10 +196,22 @@ namespace KlayGE
 
 		bool IsSound() const override;
 
+		uint32_t NumUnderruns() const;
+
 	protected:
 		virtual void DoReset() = 0;
 		virtual void DoPlay(bool loop) = 0;
 		virtual void DoStop() = 0;
+		// Runs on the streaming thread, copies from stream_ into the device queue
+		virtual void DoUpdateBuffer() = 0;
+
+	private:
+		void StartStreaming();
+		void StopStreaming();
+
+	protected:
+		AudioStreamPtr stream_;
+		std::weak_ptr<AudioStreamer> streamer_;
 
 		static uint32_t constexpr BUFFERS_PER_SECOND = 2;
 	};
@@ -126,6 +232,8 @@ namespace KlayGE
 		size_t NumBuffer() const;
 		virtual AudioBufferPtr Buffer(size_t buff_id) const;
 
+		AudioStreamerPtr const & Streamer() const;
+
 		void Play(size_t buff_id, bool loop = false);
 		void Stop(size_t buff_id);
 		void PlayAll(bool loop = false);
@@ -148,6 +256,7 @@ namespace KlayGE
 		virtual void DoResume() = 0;
 
 	protected:
+		AudioStreamerPtr streamer_;
 		std::map<size_t, AudioBufferPtr> audio_buffs_;
 
 		float sound_vol_;
@@ -35,6 +35,10 @@
 
 #include <KlayGE/PreDeclare.hpp>
 
+#include <atomic>
+#include <mutex>
+#include <vector>
+
 namespace KlayGE
 {
 	enum AudioFormat
@@ -61,6 +65,9 @@ namespace KlayGE
 		virtual size_t Read(void* data, size_t size) = 0;
 		virtual void Reset() = 0;
 
+		// The whole decoded PCM, if the source reads from memory that others can share. Null for decoders.
+		virtual std::shared_ptr<std::vector<uint8_t> const> SharedPCM() const;
+
 		virtual ~AudioDataSource();
 
 	protected:
@@ -68,6 +75,83 @@ namespace KlayGE
 		uint32_t freq_;
 	};
 
+	// Reads decoded PCM that is shared, and never modified, by all sources of a sound. Each source only owns its cursor.
+	class KLAYGE_CORE_API PCMAudioDataSource : public AudioDataSource
+	{
+	public:
+		PCMAudioDataSource(AudioFormat format, uint32_t freq, std::shared_ptr<std::vector<uint8_t> const> const & pcm);
+
+		void Open(ResIdentifierPtr const & file) override;
+		void Close() override;
+
+		size_t Size() override;
+
+		size_t Read(void* data, size_t size) override;
+		void Reset() override;
+
+		std::shared_ptr<std::vector<uint8_t> const> SharedPCM() const override;
+
+	private:
+		std::shared_ptr<std::vector<uint8_t> const> pcm_;
+		size_t pos_;
+	};
+
+	// A sound file loaded through ResLoader, so loads of the same file share one instance and decode it only once.
+	// Short sounds keep the decoded PCM. Long ones can keep the compressed file instead, and each data source decodes it
+	// while playing, which fits MakeMusicBuffer.
+	class KLAYGE_CORE_API SoundData : boost::noncopyable
+	{
+	public:
+		SoundData();
+
+		// Only the first call loads, so racing loads of the same sound are harmless
+		void Load(ResIdentifierPtr const & file, bool compressed);
+
+		// An async load fills the data on a loader thread
+		bool Ready() const
+		{
+			return ready_;
+		}
+
+		bool Compressed() const
+		{
+			return compressed_;
+		}
+		AudioFormat Format() const
+		{
+			return format_;
+		}
+		uint32_t Freq() const
+		{
+			return freq_;
+		}
+		// Size of the decoded PCM, or of the compressed file
+		size_t DataSize() const
+		{
+			return data_ ? data_->size() : 0;
+		}
+
+		// A new cursor over the shared data. Null if the file failed to open.
+		AudioDataSourcePtr MakeDataSource() const;
+
+	private:
+		AudioDataSourcePtr OpenCompressed() const;
+
+	private:
+		std::string name_;
+		uint64_t timestamp_;
+		bool compressed_;
+		AudioFormat format_;
+		uint32_t freq_;
+		std::shared_ptr<std::vector<uint8_t> const> data_;
+
+		std::atomic<bool> ready_;
+		std::mutex load_mutex_;
+	};
+
+	KLAYGE_CORE_API SoundDataPtr SyncLoadSound(std::string_view sound_name, bool compressed = false);
+	KLAYGE_CORE_API SoundDataPtr ASyncLoadSound(std::string_view sound_name, bool compressed = false);
+
 	class KLAYGE_CORE_API AudioDataSourceFactory : boost::noncopyable
 	{
 	public:
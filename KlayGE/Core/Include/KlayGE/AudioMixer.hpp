@@ -0,0 +1,178 @@
+/**
+ * @file AudioMixer.hpp
+ * @author Minmin Gong
+ *
+ * @section DESCRIPTION
+ *
+ * This source file is part of KlayGE
+ * For the latest info, see http://www.klayge.org
+ *
+ * @section LICENSE
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * You may alternatively use this source under the terms of
+ * the KlayGE Proprietary License (KPL). You can obtained such a license
+ * from http://www.klayge.org/licensing/.
+ */
+
+#ifndef _KLAYGE_CORE_AUDIO_MIXER_HPP
+#define _KLAYGE_CORE_AUDIO_MIXER_HPP
+
+#pragma once
+
+#include <KlayGE/PreDeclare.hpp>
+#include <KFL/Math.hpp>
+
+#include <ios>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+
+namespace KlayGE
+{
+	// Clamps to [-1, 1] and rounds to nearest even, the same with or without SSE2
+	KLAYGE_CORE_API void FloatToPCM16(float const * src, int16_t* dst, uint32_t num_samples);
+
+	// Output of the software mixer. Frames are interleaved stereo floats in [-1, 1].
+	class KLAYGE_CORE_API AudioSink : boost::noncopyable
+	{
+	public:
+		virtual ~AudioSink();
+
+		virtual void Write(float const * frames, uint32_t num_frames) = 0;
+	};
+
+	class KLAYGE_CORE_API NullAudioSink : public AudioSink
+	{
+	public:
+		void Write(float const * frames, uint32_t num_frames) override;
+	};
+
+	// Writes a 16-bit stereo WAV. The conversion is deterministic, so the file can be compared across runs.
+	class KLAYGE_CORE_API WavAudioSink : public AudioSink
+	{
+	public:
+		WavAudioSink(std::shared_ptr<std::ostream> const & os, uint32_t freq);
+		~WavAudioSink() override;
+
+		void Write(float const * frames, uint32_t num_frames) override;
+
+		// Patches the sizes into the header. The destructor calls it too.
+		void Close();
+
+		uint64_t NumFrames() const
+		{
+			return num_frames_;
+		}
+
+	private:
+		void WriteHeader();
+
+	private:
+		std::shared_ptr<std::ostream> os_;
+		std::streamoff header_pos_;
+		uint32_t freq_;
+		uint64_t num_frames_;
+		std::vector<int16_t> pcm_;
+	};
+
+	// A source of the software mixer. Derived classes produce float samples interleaved by channel, at Freq().
+	// Voices are not thread safe, the owner of the mixer serializes the parameter changes with the mixing.
+	class KLAYGE_CORE_API AudioVoice : boost::noncopyable
+	{
+		friend class AudioMixer;
+
+	public:
+		AudioVoice(uint32_t num_channels, uint32_t freq);
+		virtual ~AudioVoice();
+
+		uint32_t NumChannels() const
+		{
+			return num_channels_;
+		}
+		uint32_t Freq() const
+		{
+			return freq_;
+		}
+
+		// The gains are ramped to these values over the next mixed block
+		void Gains(float left, float right);
+		// Playback rate relative to Freq(), for the doppler shift
+		void Pitch(float pitch);
+
+		// Set by the mixer once the source ended and all its frames are mixed
+		bool Finished() const
+		{
+			return finished_;
+		}
+
+	private:
+		// Fills up to num_frames frames. Fewer frames means the source ended.
+		virtual uint32_t Fetch(float* samples, uint32_t num_frames) = 0;
+
+	private:
+		uint32_t num_channels_;
+		uint32_t freq_;
+
+		float gain_left_;
+		float gain_right_;
+		float target_gain_left_;
+		float target_gain_right_;
+		float pitch_;
+
+		// Source frames from the current read position on, with the position in 32.32 fixed point relative to its start
+		std::vector<float> window_;
+		uint32_t window_frames_;
+		uint64_t pos_;
+		bool source_ended_;
+		bool finished_;
+	};
+
+	// Mixes voices into a stereo output with linear resampling. Finished voices are dropped.
+	class KLAYGE_CORE_API AudioMixer : boost::noncopyable
+	{
+	public:
+		explicit AudioMixer(uint32_t freq);
+
+		uint32_t Freq() const
+		{
+			return freq_;
+		}
+
+		void AddVoice(AudioVoicePtr const & voice);
+		void RemoveVoice(AudioVoice const * voice);
+		uint32_t NumVoices() const;
+
+		// output receives num_frames interleaved stereo frames
+		void Mix(float* output, uint32_t num_frames);
+
+		// Gains and pitch of a mono source. Inverse distance attenuation clamped to 1 unit, equal power panning, and the
+		// doppler shift at 343 units/s, as configured in the OpenAL backend.
+		static void Spatialize(float3 const & listener_pos, float3 const & listener_vel,
+			float3 const & listener_face, float3 const & listener_up,
+			float3 const & pos, float3 const & vel,
+			float& gain_left, float& gain_right, float& pitch);
+
+	private:
+		void MixVoice(AudioVoice& voice, float* output, uint32_t num_frames);
+
+	private:
+		uint32_t freq_;
+		std::vector<AudioVoicePtr> voices_;
+	};
+}
+
+#endif		// _KLAYGE_CORE_AUDIO_MIXER_HPP
@@ -30,7 +30,15 @@
 
 #include <KlayGE/PreDeclare.hpp>
 
+#include <KFL/CXX17/string_view.hpp>
+#include <KFL/Thread.hpp>
+#include <KFL/Timer.hpp>
+
+#include <atomic>
+#include <mutex>
 #include <string>
+#include <utility>
+#include <vector>
 #include <boost/assert.hpp>
 
 #include <KlayGE/RenderSettings.hpp>
@@ -95,6 +103,20 @@ namespace KlayGE
 		void LoadDevHelper();
 #endif
 
+		// Loads the configured plugins on the thread pool. The XxxInstance() calls wait for the plugin being loaded.
+		void PreloadPlugins();
+		void WaitForPlugins();
+
+		// Startup phases are recorded in order, with their durations in seconds. Thread safe.
+		void RecordStartupPhase(std::string_view name, double seconds);
+		std::vector<std::pair<std::string, double>> StartupPhases() const;
+		void LogStartupPhases() const;
+
+		StartupManifest& StartupManifestInstance()
+		{
+			return *startup_manifest_;
+		}
+
 		void AppInstance(App3DFramework& app)
 		{
 			app_ = &app;
@@ -112,43 +134,43 @@ namespace KlayGE
 
 		bool SceneManagerValid() const
 		{
-			return scene_mgr_.get() != nullptr;
+			return loaded_scene_mgr_.load(std::memory_order_acquire) != nullptr;
 		}
 		SceneManager& SceneManagerInstance();
 
 		bool RenderFactoryValid() const
 		{
-			return render_factory_.get() != nullptr;
+			return loaded_render_factory_.load(std::memory_order_acquire) != nullptr;
 		}
 		RenderFactory& RenderFactoryInstance();
 
 		bool AudioFactoryValid() const
 		{
-			return audio_factory_.get() != nullptr;
+			return loaded_audio_factory_.load(std::memory_order_acquire) != nullptr;
 		}
 		AudioFactory& AudioFactoryInstance();
 
 		bool InputFactoryValid() const
 		{
-			return input_factory_.get() != nullptr;
+			return loaded_input_factory_.load(std::memory_order_acquire) != nullptr;
 		}
 		InputFactory& InputFactoryInstance();
 
 		bool ShowFactoryValid() const
 		{
-			return show_factory_.get() != nullptr;
+			return loaded_show_factory_.load(std::memory_order_acquire) != nullptr;
 		}
 		ShowFactory& ShowFactoryInstance();
 
 		bool ScriptFactoryValid() const
 		{
-			return script_factory_.get() != nullptr;
+			return loaded_script_factory_.load(std::memory_order_acquire) != nullptr;
 		}
 		ScriptFactory& ScriptFactoryInstance();
 
 		bool AudioDataSourceFactoryValid() const
 		{
-			return audio_data_src_factory_.get() != nullptr;
+			return loaded_audio_data_src_factory_.load(std::memory_order_acquire) != nullptr;
 		}
 		AudioDataSourceFactory& AudioDataSourceFactoryInstance();
 
@@ -160,7 +182,7 @@ namespace KlayGE
 #if KLAYGE_IS_DEV_PLATFORM
 		bool DevHelperValid() const
 		{
-			return dev_helper_.get() != nullptr;
+			return loaded_dev_helper_.load(std::memory_order_acquire) != nullptr;
 		}
 		DevHelper& DevHelperInstance();
 #endif
@@ -210,7 +232,49 @@ namespace KlayGE
 		DllLoader dev_helper_loader_;
 #endif
 
+		// Set by the LoadXxx functions once a plugin is completely created. XxxValid() and XxxInstance() check these instead of
+		// the owning pointers, which a thread pool worker could be writing during PreloadPlugins.
+		std::atomic<SceneManager*> loaded_scene_mgr_ = nullptr;
+		std::atomic<RenderFactory*> loaded_render_factory_ = nullptr;
+		std::atomic<AudioFactory*> loaded_audio_factory_ = nullptr;
+		std::atomic<InputFactory*> loaded_input_factory_ = nullptr;
+		std::atomic<ShowFactory*> loaded_show_factory_ = nullptr;
+		std::atomic<ScriptFactory*> loaded_script_factory_ = nullptr;
+		std::atomic<AudioDataSourceFactory*> loaded_audio_data_src_factory_ = nullptr;
+#if KLAYGE_IS_DEV_PLATFORM
+		std::atomic<DevHelper*> loaded_dev_helper_ = nullptr;
+#endif
+
+		std::mutex scene_mgr_mutex_;
+		std::mutex render_factory_mutex_;
+		std::mutex audio_factory_mutex_;
+		std::mutex input_factory_mutex_;
+		std::mutex show_factory_mutex_;
+		std::mutex script_factory_mutex_;
+		std::mutex audio_data_src_factory_mutex_;
+#if KLAYGE_IS_DEV_PLATFORM
+		std::mutex dev_helper_mutex_;
+#endif
+
+		Timer startup_timer_;
+		mutable std::mutex startup_phases_mutex_;
+		std::vector<std::pair<std::string, double>> startup_phases_;
+
 		std::unique_ptr<thread_pool> gtp_instance_;
+		std::vector<joiner<void>> plugin_joiners_;
+		std::unique_ptr<StartupManifest> startup_manifest_;
+	};
+
+	// Records the time from its construction to its destruction as a startup phase of the context
+	class KLAYGE_CORE_API StartupPhaseTimer : boost::noncopyable
+	{
+	public:
+		explicit StartupPhaseTimer(std::string_view name);
+		~StartupPhaseTimer();
+
+	private:
+		std::string name_;
+		Timer timer_;
 	};
 }
 
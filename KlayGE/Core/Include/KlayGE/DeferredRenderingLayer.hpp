@@ -37,6 +37,7 @@
 
 #include <array>
 #include <functional>
+#include <iosfwd>
 
 #include <KlayGE/Light.hpp>
 #include <KlayGE/IndirectLightingLayer.hpp>
@@ -131,6 +132,7 @@ namespace KlayGE
 		IndirectLightingLayerPtr il_layer;
 
 		std::vector<char> light_visibles;
+		LightCullerPtr light_culler;
 
 #if DEFAULT_DEFERRED == TRIDITIONAL_DEFERRED
 		FrameBufferPtr lighting_fb;
@@ -153,11 +155,29 @@ namespace KlayGE
 
 	class KLAYGE_CORE_API DeferredRenderingLayer : boost::noncopyable
 	{
-		class DeferredRenderingJob : boost::noncopyable
+		// Resources read or written by the jobs. Used to check the ordering of the job graph and to report the lifetime of each
+		// resource.
+		enum DeferredRenderingResource
+		{
+			DRR_ShadowMaps = 0,
+			DRR_CascadedShadowMaps,
+			DRR_RSM,
+			DRR_GBuffer,
+			DRR_Depth,
+			DRR_Shadowing,
+			DRR_IndirectLighting,
+			DRR_Lighting,
+			DRR_Shading,
+			DRR_Output,
+
+			DRR_NumResources
+		};
+
+		class DeferredRenderingJob
 		{
 		public:
-			explicit DeferredRenderingJob(std::function<uint32_t()> const & job_func)
-				: func_(job_func)
+			DeferredRenderingJob(char const * name, uint32_t reads, uint32_t writes, std::function<uint32_t()> job_func)
+				: name_(name), reads_(reads), writes_(writes), func_(std::move(job_func))
 			{
 			}
 
@@ -166,7 +186,23 @@ namespace KlayGE
 				return func_();
 			}
 
+			char const * Name() const
+			{
+				return name_;
+			}
+			uint32_t Reads() const
+			{
+				return reads_;
+			}
+			uint32_t Writes() const
+			{
+				return writes_;
+			}
+
 		private:
+			char const * name_;
+			uint32_t reads_;
+			uint32_t writes_;
 			std::function<uint32_t()> func_;
 		};
 
@@ -349,6 +385,11 @@ namespace KlayGE
 
 		void Display(DisplayType display_type);
 		void DumpIntermediaTextures();
+		void DumpJobGraph(std::ostream& os) const;
+		uint32_t NumJobGraphRebuilds() const
+		{
+			return num_job_graph_rebuilds_;
+		}
 
 		uint32_t NumObjectsRendered() const;
 		uint32_t NumRenderablesRendered() const;
@@ -395,8 +436,15 @@ namespace KlayGE
 
 		void BuildLightList();
 		void BuildVisibleSceneObjList(bool& has_opaque_objs, bool& has_transparency_back_objs, bool& has_transparency_front_objs);
+		void BuildJobGraphKey(std::vector<uint64_t>& key,
+			bool has_opaque_objs, bool has_transparency_back_objs, bool has_transparency_front_objs) const;
 		void BuildPassScanList(bool has_opaque_objs, bool has_transparency_back_objs, bool has_transparency_front_objs);
-		void CheckLightVisible(uint32_t vp_index, uint32_t light_index);
+		void CompileJobGraph();
+		void UpdateLightVisibles();
+		Sphere LightVolumeBound(LightSource const & light) const;
+		void AddJob(char const * name, uint32_t reads, uint32_t writes, std::function<uint32_t()> job_func);
+		void AddBeginPerfProfileJob(PerfRange& perf);
+		void AddEndPerfProfileJob(PerfRange& perf);
 		void AppendGBufferPassScanCode(uint32_t vp_index, PassTargetBuffer pass_tb);
 		void AppendShadowPassScanCode(uint32_t light_index);
 		void AppendCascadedShadowPassScanCode(uint32_t vp_index, uint32_t light_index);
@@ -512,10 +560,17 @@ namespace KlayGE
 		LightSourcePtr default_ambient_light_;
 		LightSourcePtr merged_ambient_light_;
 		std::vector<LightSource*> lights_;
+		std::vector<Sphere> light_volume_bounds_;
 		std::vector<RenderablePtr> decals_;
 
-		std::vector<std::shared_ptr<DeferredRenderingJob>> jobs_;
-		std::vector<std::shared_ptr<DeferredRenderingJob>>::iterator curr_job_iter_;
+		std::vector<DeferredRenderingJob> jobs_;
+		std::vector<DeferredRenderingJob>::iterator curr_job_iter_;
+		std::vector<uint64_t> job_graph_key_;
+		size_t job_graph_key_hash_;
+		std::vector<uint64_t> next_job_graph_key_;
+		uint32_t num_job_graph_rebuilds_;
+		// First and last job that touches each resource
+		std::array<std::pair<int32_t, int32_t>, DRR_NumResources> resource_lifetimes_;
 
 		std::array<std::array<RenderTechnique*, 5>, LightSource::LT_NumLightTypes> technique_shadows_;
 		RenderTechnique* technique_no_lighting_;
@@ -16,6 +16,9 @@
 #pragma once
 
 #include <KlayGE/PreDeclare.hpp>
+#include <KFL/Vector.hpp>
+
+#include <vector>
 
 namespace KlayGE
 {
@@ -122,6 +125,31 @@ namespace KlayGE
 		uint32_t width_, height_;
 		bool forward_;
 	};
+
+	// Runs on the CPU, for devices without the needed shaders and for tools. The textures have to be mappable by the CPU, such as
+	// SoftwareTextures, and can be in any uncompressed format. in_imag can be null for a real input.
+	class KLAYGE_CORE_API CpuFft : public GpuFft
+	{
+	public:
+		CpuFft(uint32_t width, uint32_t height, bool forward);
+
+		void Execute(TexturePtr const & out_real, TexturePtr const & out_imag,
+			TexturePtr const & in_real, TexturePtr const & in_imag);
+
+		// In place transform of width * height texels with 4 independent channels. The scaling matches Execute.
+		void Transform(float4* real, float4* imag);
+
+	private:
+		uint32_t width_, height_;
+		bool forward_;
+
+		// exp(-2 pi i k / n) for the forward transform, the conjugates for the inverse one
+		std::vector<float2> twiddles_x_;
+		std::vector<float2> twiddles_y_;
+
+		std::vector<float4> real_;
+		std::vector<float4> imag_;
+	};
 }
 
 #endif		// _FFT_HPP
@@ -21,18 +21,49 @@
 
 #pragma once
 
+#include <KFL/ArrayRef.hpp>
+#include <KFL/Thread.hpp>
+
+#include <functional>
 #include <vector>
 
 namespace KlayGE
 {
 	// ߶ͼ
 	/////////////////////////////////////////////////////////////////////////////////
-	class HeightMap : boost::noncopyable
+	class KLAYGE_CORE_API HeightMap : boost::noncopyable
 	{
+	public:
+		// Fills heights with the heights at (xs[i], y)
+		typedef std::function<void(ArrayRef<float> xs, float y, float* heights)> HeightRowFunc;
+
+		struct TerrainMesh
+		{
+			std::vector<float3> vertices;
+			std::vector<float3> normals;
+			std::vector<uint16_t> indices;
+		};
+
 	public:
 		void BuildTerrain(float start_x, float start_y, float end_x, float end_y, float span_x, float span_y,
 			std::vector<float3>& vertices, std::vector<uint16_t>& indices,
 			std::function<float(float, float)> HeightFunc);
+
+		// Batched version. The heights are evaluated a row at a time, in blocks of rows spread over the pool if one is given.
+		// Normals come from the height differences between neighbouring vertices.
+		void BuildTerrain(float start_x, float start_y, float end_x, float end_y, float span_x, float span_y,
+			std::vector<float3>& vertices, std::vector<float3>& normals, std::vector<uint16_t>& indices,
+			HeightRowFunc const & height_row_func, thread_pool* pool = nullptr);
+
+		// Builds on the context thread pool, so terrain tiles can be streamed in without stalling the frame.
+		// height_row_func is called from worker threads.
+		static joiner<TerrainMesh> BuildTerrainAsync(float start_x, float start_y, float end_x, float end_y,
+			float span_x, float span_y, HeightRowFunc const & height_row_func);
+
+	private:
+		void DoBuildTerrain(float start_x, float start_y, float end_x, float end_y, float span_x, float span_y,
+			std::vector<float3>& vertices, std::vector<float3>* normals, std::vector<uint16_t>& indices,
+			HeightRowFunc const & height_row_func, thread_pool* pool);
 	};
 }
 
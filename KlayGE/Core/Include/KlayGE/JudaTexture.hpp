@@ -19,10 +19,14 @@
 #include <KlayGE/Texture.hpp>
 #include <KlayGE/RenderStateObject.hpp>
 #include <KlayGE/TexCompressionBC.hpp>
+#include <KFL/Thread.hpp>
 
 #include <vector>
 #include <deque>
+#include <list>
+#include <mutex>
 #include <unordered_map>
+#include <unordered_set>
 
 #include <KlayGE/LZMACodec.hpp>
 
@@ -62,8 +66,23 @@ namespace KlayGE
 
 		static uint32_t const LEVEL_SHIFT = 28;
 
+	public:
+		// Counters of the tile cache, accumulated since the texture was created
+		struct CacheStats
+		{
+			uint64_t requests;
+			uint64_t hits;
+			uint64_t uploads;
+			uint64_t evictions;
+			// Tiles queued for decoding or waiting to be uploaded
+			uint32_t pending;
+			// Tiles left in the decoding queue by the last UpdateCacheAsync
+			uint32_t queued;
+		};
+
 	public:
 		JudaTexture(uint32_t num_tiles, uint32_t tile_size, ElementFormat format);
+		~JudaTexture();
 
 		uint32_t EncodeTileID(uint32_t level, uint32_t tile_x, uint32_t tile_y) const;
 		void DecodeTileID(uint32_t& level, uint32_t& tile_x, uint32_t& tile_y, uint32_t tile_id) const;
@@ -88,9 +107,39 @@ namespace KlayGE
 
 		void SetParams(RenderEffect const & effect);
 
+		// Decodes and uploads all the missing tiles before returning
 		void UpdateCache(std::vector<uint32_t> const & tile_ids);
+		// Queues the missing tiles to be decoded on a worker thread, and uploads at most max_uploads of the decoded ones.
+		// Meant to be called once a frame. Coarser tiles and tiles covering more of the screen are decoded first, queued tiles
+		// that are not requested again are dropped.
+		void UpdateCacheAsync(std::vector<uint32_t> const & tile_ids, uint32_t max_uploads);
+
+		CacheStats Stats() const;
 
 	private:
+		struct TileRequest
+		{
+			uint32_t tile_id;
+			uint32_t level;
+			// Number of times the tile is requested in a frame
+			uint32_t coverage;
+			uint64_t tick;
+		};
+
+		// A tile with borders, ready to be copied into the cache texture
+		struct CacheTile
+		{
+			uint32_t tile_id;
+			uint32_t attr;
+			std::vector<std::vector<uint8_t>> mips;
+			std::vector<uint32_t> row_pitches;
+		};
+
+		void TouchTiles(std::vector<TileRequest>& missing, std::vector<uint32_t> const & tile_ids);
+		void BuildCacheTiles(std::vector<CacheTile>& tiles, std::vector<uint32_t> const & tile_ids);
+		void UploadCacheTiles(std::vector<CacheTile> const & tiles);
+		void StreamTiles();
+
 		void DecodeATile(std::vector<uint8_t>* data, uint32_t shuff, uint32_t mipmaps);
 		uint32_t DecodeAAttr(uint32_t shuff);
 		uint8_t* RetriveATile(uint32_t data_index);
@@ -173,15 +222,18 @@ namespace KlayGE
 		struct DecodedBlockInfo
 		{
 			std::unique_ptr<uint8_t[]> data;
-			uint64_t tick;
+			std::list<uint32_t>::iterator lru_iter;
 
-			DecodedBlockInfo(std::unique_ptr<uint8_t[]>&& d, uint64_t t)
-				: data(std::move(d)), tick(t)
+			DecodedBlockInfo(std::unique_ptr<uint8_t[]>&& d, std::list<uint32_t>::iterator iter)
+				: data(std::move(d)), lru_iter(iter)
 			{
 			}
 		};
 		std::unordered_map<uint32_t, DecodedBlockInfo> decoded_block_cache_;
-		uint64_t decode_tick_;
+		// Least recently used first
+		std::list<uint32_t> decoded_block_lru_;
+		// Decoding touches the file and the block cache, so it runs on one thread at a time
+		std::mutex decode_mutex_;
 
 	private:
 		// Cache
@@ -196,11 +248,28 @@ namespace KlayGE
 		{
 			uint32_t x, y, z;
 			uint32_t attr;
-			uint64_t tick;
+			std::list<uint32_t>::iterator lru_iter;
 		};
 		std::unordered_map<uint32_t, TileInfo> tile_info_map_;
-		std::deque<std::pair<uint32_t, uint32_t>> tile_free_list_;
+		// Cached tile IDs, least recently used first
+		std::list<uint32_t> tile_lru_;
+		std::vector<uint32_t> free_cache_slots_;
+		uint32_t num_cache_tiles_a_row_;
+		uint32_t num_cache_tiles_a_layer_;
 		uint64_t tile_tick_;
+		CacheStats stats_;
+
+	private:
+		// Streaming
+		std::mutex stream_mutex_;
+		// Sorted by ascending priority
+		std::vector<TileRequest> tile_requests_;
+		std::deque<CacheTile> decoded_tiles_;
+		bool streaming_;
+		bool stream_quit_;
+		std::unique_ptr<joiner<void>> stream_job_;
+		// Requested tiles that are not uploaded yet
+		std::unordered_set<uint32_t> in_flight_tiles_;
 	};
 }
 
@@ -0,0 +1,69 @@
+/**
+ * @file LightCuller.hpp
+ * @author Minmin Gong
+ *
+ * @section DESCRIPTION
+ *
+ * This source file is part of KlayGE
+ * For the latest info, see http://www.klayge.org
+ *
+ * @section LICENSE
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * You may alternatively use this source under the terms of
+ * the KlayGE Proprietary License (KPL). You can obtained such a license
+ * from http://www.klayge.org/licensing/.
+ */
+
+#ifndef KLAYGE_CORE_LIGHT_CULLER_HPP
+#define KLAYGE_CORE_LIGHT_CULLER_HPP
+
+#pragma once
+
+#include <KlayGE/PreDeclare.hpp>
+
+#include <vector>
+
+#include <KFL/ArrayRef.hpp>
+#include <KFL/Sphere.hpp>
+
+namespace KlayGE
+{
+	// Frustum culls local lights in batches. Every light is approximated by a bounding sphere in world space, and 4 of them are
+	// tested against the frustum planes at a time with SIMD.
+	class KLAYGE_CORE_API LightCuller : boost::noncopyable
+	{
+	public:
+		// A light with a negative radius is never visible
+		void Cull(float4x4 const & view_proj, ArrayRef<Sphere> lights);
+
+		bool LightVisible(uint32_t light) const
+		{
+			return light_visibles_[light] != 0;
+		}
+		// Indices into the light array passed to Cull, sorted ascending
+		std::vector<uint32_t> const & VisibleLights() const
+		{
+			return visible_lights_;
+		}
+
+	private:
+		std::vector<char> light_visibles_;
+		std::vector<uint32_t> visible_lights_;
+	};
+}
+
+#endif		// KLAYGE_CORE_LIGHT_CULLER_HPP
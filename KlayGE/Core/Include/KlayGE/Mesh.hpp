@@ -254,6 +254,27 @@ namespace KlayGE
 		std::tuple<Quaternion, Quaternion, float> Frame(float frame) const;
 	};
 
+	// Quantized key frames for runtime. Rotations are smallest-three quaternions packed in 3 16-bit words,
+	// translations and scales are 16-bit values normalized to the range of the track.
+	struct KLAYGE_CORE_API CompressedKeyFrameSet
+	{
+		std::vector<uint32_t> frame_id;
+		std::vector<uint16_t> rotations;
+		std::vector<uint16_t> translations;
+		std::vector<uint16_t> scales;
+
+		float3 translation_min;
+		float3 translation_extent;
+		float scale_min;
+		float scale_extent;
+
+		void Compress(KeyFrameSet const & kf);
+		void Decompress(KeyFrameSet& kf) const;
+
+		std::tuple<Quaternion, Quaternion, float> Key(uint32_t index) const;
+		std::tuple<Quaternion, Quaternion, float> Frame(float frame) const;
+	};
+
 	struct KLAYGE_CORE_API AABBKeyFrameSet
 	{
 		std::vector<uint32_t> frame_id;
@@ -310,14 +331,12 @@ namespace KlayGE
 		{
 			return bind_duals_;
 		}
-		void AttachKeyFrameSets(std::shared_ptr<std::vector<KeyFrameSet>> const & kf)
-		{
-			key_frame_sets_ = kf;
-		}
-		std::shared_ptr<std::vector<KeyFrameSet>> const & GetKeyFrameSets() const
-		{
-			return key_frame_sets_;
-		}
+		// The key frame sets are read only once attached, the other representation is cached from them.
+		// To modify them, attach a modified copy.
+		void AttachKeyFrameSets(std::shared_ptr<std::vector<KeyFrameSet> const> const & kf);
+		std::shared_ptr<std::vector<KeyFrameSet> const> const & GetKeyFrameSets() const;
+		void AttachCompressedKeyFrameSets(std::shared_ptr<std::vector<CompressedKeyFrameSet> const> const & ckf);
+		std::shared_ptr<std::vector<CompressedKeyFrameSet> const> const & GetCompressedKeyFrameSets() const;
 		uint32_t NumFrames() const
 		{
 			return num_frames_;
@@ -360,7 +379,9 @@ namespace KlayGE
 		std::vector<float4> bind_reals_;
 		std::vector<float4> bind_duals_;
 
-		std::shared_ptr<std::vector<KeyFrameSet>> key_frame_sets_;
+		// One of them is the source, the other one is generated on demand
+		mutable std::shared_ptr<std::vector<KeyFrameSet> const> key_frame_sets_;
+		mutable std::shared_ptr<std::vector<CompressedKeyFrameSet> const> compressed_key_frame_sets_;
 		float last_frame_;
 
 		uint32_t num_frames_;
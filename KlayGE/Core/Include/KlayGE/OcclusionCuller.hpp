@@ -0,0 +1,134 @@
+/**
+ * @file OcclusionCuller.hpp
+ * @author Minmin Gong
+ *
+ * @section DESCRIPTION
+ *
+ * This source file is part of KlayGE
+ * For the latest info, see http://www.klayge.org
+ *
+ * @section LICENSE
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * You may alternatively use this source under the terms of
+ * the KlayGE Proprietary License (KPL). You can obtained such a license
+ * from http://www.klayge.org/licensing/.
+ */
+
+#ifndef _KLAYGE_CORE_OCCLUSION_CULLER_HPP
+#define _KLAYGE_CORE_OCCLUSION_CULLER_HPP
+
+#pragma once
+
+#include <KlayGE/PreDeclare.hpp>
+#include <KFL/AABBox.hpp>
+#include <KFL/ArrayRef.hpp>
+#include <KFL/Math.hpp>
+
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+
+namespace KlayGE
+{
+	// Software occlusion culling on the CPU. Occluders are rasterized into a small depth buffer, with the farthest depth of each
+	// 8x8 tile kept as a second level. A box is occluded if all the pixels it covers have an occluder in front of its nearest
+	// point. Depth is in [0, 1] as in the D3D convention used by Camera.
+	class KLAYGE_CORE_API OcclusionCuller : boost::noncopyable
+	{
+	public:
+		static uint32_t constexpr TILE_SIZE = 8;
+
+	public:
+		// The size is rounded up to whole tiles
+		OcclusionCuller(uint32_t width, uint32_t height);
+
+		uint32_t Width() const
+		{
+			return width_;
+		}
+		uint32_t Height() const
+		{
+			return height_;
+		}
+
+		// Clears the depth buffer, the occluders and the statistics
+		void BeginFrame(float4x4 const & view_proj);
+
+		// Triangles in model space. They are clipped against the near plane, and are not culled by facing.
+		void AddOccluder(ArrayRef<float3> positions, ArrayRef<uint32_t> indices, float4x4 const & model);
+		// A solid box in model space. Only conservative if the occluder fills the box.
+		void AddOccluder(AABBox const & aabb, float4x4 const & model);
+
+		// Rasterizes the occluders added since BeginFrame, in bands of tiles on the thread pool
+		void Rasterize();
+
+		// Conservative. A box crossing the near plane or outside the screen is never occluded.
+		bool AABBOccluded(AABBox const & aabb_ws) const;
+		// Tests the boxes on the thread pool. occluded receives 1 for each occluded box. Returns the number of occluded boxes.
+		uint32_t TestAABBs(ArrayRef<AABBox> aabbs_ws, uint8_t* occluded);
+
+		uint32_t NumOccluderTriangles() const
+		{
+			return static_cast<uint32_t>(triangles_.size());
+		}
+		uint32_t NumTested() const
+		{
+			return num_tested_;
+		}
+		uint32_t NumOccluded() const
+		{
+			return num_occluded_;
+		}
+
+		// For debugging. Width() * Height() depths, row by row from the top.
+		ArrayRef<float> DepthBuffer() const
+		{
+			return depth_;
+		}
+		// An R8 image of the depth buffer, brighter is closer, black is no occluder
+		void DebugImage(std::vector<uint8_t>& image) const;
+
+	private:
+		struct Triangle
+		{
+			float3 v[3];
+		};
+
+		void AddClipTriangle(float4 const & c0, float4 const & c1, float4 const & c2);
+		float3 ToScreen(float4 const & clip) const;
+		void RasterizeBand(uint32_t tile_row_begin, uint32_t tile_row_end);
+		void RasterizeTriangle(Triangle const & tri, uint32_t row_begin, uint32_t row_end);
+
+	private:
+		uint32_t width_;
+		uint32_t height_;
+		uint32_t tiles_x_;
+		uint32_t tiles_y_;
+		uint32_t num_hw_threads_;
+
+		float4x4 view_proj_;
+
+		std::vector<Triangle> triangles_;
+		std::vector<float> depth_;
+		std::vector<float> tile_max_depth_;
+
+		uint32_t num_tested_;
+		uint32_t num_occluded_;
+	};
+}
+
+#endif		// _KLAYGE_CORE_OCCLUSION_CULLER_HPP
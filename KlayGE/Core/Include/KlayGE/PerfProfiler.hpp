@@ -36,9 +36,13 @@
 #include <KlayGE/PreDeclare.hpp>
 #include <KFL/Timer.hpp>
 
+#include <atomic>
+#include <chrono>
 #include <map>
+#include <mutex>
 #include <string>
 #include <tuple>
+#include <vector>
 
 namespace KlayGE
 {
@@ -66,10 +70,31 @@ namespace KlayGE
 		bool dirty_;
 	};
 
+	struct PerfTraceEvent
+	{
+		enum EventType
+		{
+			ET_Complete = 0,
+			ET_Counter
+		};
+
+		// Names must have static storage duration, usually string literals
+		char const * category;
+		char const * name;
+		EventType type;
+		uint32_t thread_id;
+		uint64_t timestamp;
+		uint64_t duration;
+		int64_t value;
+	};
+
+	class PerfTraceBuffer;
+
 	class KLAYGE_CORE_API PerfProfiler : boost::noncopyable
 	{
 	public:
 		PerfProfiler();
+		~PerfProfiler();
 
 		static PerfProfiler& Instance();
 		static void Destroy();
@@ -82,13 +107,83 @@ namespace KlayGE
 
 		void ExportToCSV(std::string const & file_name) const;
 
+		// Tracing records the scopes and counters of KLAYGE_PERF_TRACE_SCOPE and KLAYGE_PERF_TRACE_COUNTER from any thread,
+		// into a ring buffer per thread. Events of a full buffer are dropped. CollectData drains the buffers.
+		void StartTracing();
+		void StopTracing();
+		static bool Tracing()
+		{
+			return tracing_.load(std::memory_order_relaxed);
+		}
+		// In nanoseconds
+		static uint64_t TraceTimestamp()
+		{
+			return std::chrono::duration_cast<std::chrono::nanoseconds>(
+				std::chrono::steady_clock::now().time_since_epoch()).count();
+		}
+		void TraceComplete(char const * category, char const * name, uint64_t begin, uint64_t end);
+		void TraceCounter(char const * category, char const * name, int64_t value);
+
+		std::vector<PerfTraceEvent> TraceEvents();
+		uint32_t NumDroppedTraceEvents();
+		// In the Chrome JSON trace format, which Perfetto opens too
+		void ExportToChromeTrace(std::string const & file_name);
+
+	private:
+		void RecordTraceEvent(PerfTraceEvent& event);
+		void DrainTraceBuffers();
+
 	private:
 		static std::unique_ptr<PerfProfiler> perf_profiler_instance_;
 
 		std::vector<std::tuple<int, std::string, PerfRangePtr,
 			std::vector<std::tuple<uint32_t, double, double>>>> perf_ranges_;
 		uint32_t frame_id_;
+
+		static std::atomic<bool> tracing_;
+		uint32_t generation_;
+		uint64_t trace_start_;
+		std::mutex trace_mutex_;
+		std::vector<std::shared_ptr<PerfTraceBuffer>> trace_buffers_;
+		std::vector<PerfTraceEvent> trace_events_;
+	};
+
+	class PerfTraceScope : boost::noncopyable
+	{
+	public:
+		PerfTraceScope(char const * category, char const * name)
+			: category_(category), name_(name), begin_(PerfProfiler::Tracing() ? PerfProfiler::TraceTimestamp() : 0)
+		{
+		}
+		~PerfTraceScope()
+		{
+			if (begin_ != 0)
+			{
+				PerfProfiler::Instance().TraceComplete(category_, name_, begin_, PerfProfiler::TraceTimestamp());
+			}
+		}
+
+	private:
+		char const * category_;
+		char const * name_;
+		uint64_t begin_;
 	};
 }
 
+#ifndef KLAYGE_SHIP
+	#define KLAYGE_PERF_TRACE_SCOPE(category, name) KlayGE::PerfTraceScope KFL_JOIN(perf_trace_scope_, __LINE__)(category, name)
+	// value is evaluated only while tracing
+	#define KLAYGE_PERF_TRACE_COUNTER(category, name, value) \
+		do \
+		{ \
+			if (KlayGE::PerfProfiler::Tracing()) \
+			{ \
+				KlayGE::PerfProfiler::Instance().TraceCounter(category, name, static_cast<int64_t>(value)); \
+			} \
+		} while (false)
+#else
+	#define KLAYGE_PERF_TRACE_SCOPE(category, name)
+	#define KLAYGE_PERF_TRACE_COUNTER(category, name, value) do { } while (false)
+#endif
+
 #endif			// _KLAYGE_PERFPROFILER_HPP
@@ -37,6 +37,8 @@ namespace KlayGE
 {
 	struct ContextCfg;
 	class Context;
+	class StartupPhaseTimer;
+	class StartupManifest;
 	class ResLoadingDesc;
 	typedef std::shared_ptr<ResLoadingDesc> ResLoadingDescPtr;
 	class ResLoader;
@@ -46,6 +48,8 @@ namespace KlayGE
 	typedef std::shared_ptr<PerfProfiler> PerfProfilerPtr;
 
 	class SceneManager;
+	class OcclusionCuller;
+	class TransformHierarchy;
 	class SceneNode;
 	typedef std::shared_ptr<SceneNode> SceneNodePtr;
 	class SceneObjectLightSourceProxy;
@@ -158,6 +162,7 @@ namespace KlayGE
 	typedef std::shared_ptr<GraphicsBuffer> GraphicsBufferPtr;
 	class RenderLayout;
 	typedef std::shared_ptr<RenderLayout> RenderLayoutPtr;
+	class RenderCommandList;
 	class RenderGraphicsBuffer;
 	typedef std::shared_ptr<RenderGraphicsBuffer> RenderGraphicsBufferPtr;
 	struct Viewport;
@@ -261,6 +266,8 @@ namespace KlayGE
 	class LensFlareSceneObject;
 	typedef std::shared_ptr<LensFlareSceneObject> LensFlareSceneNodePtr;
 	class DeferredRenderingLayer;
+	class LightCuller;
+	typedef std::shared_ptr<LightCuller> LightCullerPtr;
 	class MultiResLayer;
 	typedef std::shared_ptr<MultiResLayer> MultiResLayerPtr;
 	class IndirectLightingLayer;
@@ -283,6 +290,8 @@ namespace KlayGE
 	typedef std::shared_ptr<GpuFftCS4> GpuFftCS4Ptr;
 	class GpuFftCS5;
 	typedef std::shared_ptr<GpuFftCS4> GpuFftCS5Ptr;
+	class CpuFft;
+	typedef std::shared_ptr<CpuFft> CpuFftPtr;
 	class SSGIPostProcess;
 	typedef std::shared_ptr<SSGIPostProcess> SSGIPostProcessPtr;
 	class SSRPostProcess;
@@ -337,8 +346,20 @@ namespace KlayGE
 	typedef std::shared_ptr<AudioBuffer> AudioBufferPtr;
 	class SoundBuffer;
 	class MusicBuffer;
+	class AudioStream;
+	typedef std::shared_ptr<AudioStream> AudioStreamPtr;
+	class AudioStreamer;
+	typedef std::shared_ptr<AudioStreamer> AudioStreamerPtr;
+	class AudioSink;
+	typedef std::shared_ptr<AudioSink> AudioSinkPtr;
+	class AudioVoice;
+	typedef std::shared_ptr<AudioVoice> AudioVoicePtr;
+	class AudioMixer;
 	class AudioDataSource;
 	typedef std::shared_ptr<AudioDataSource> AudioDataSourcePtr;
+	class PCMAudioDataSource;
+	class SoundData;
+	typedef std::shared_ptr<SoundData> SoundDataPtr;
 	class AudioFactory;
 	class AudioDataSourceFactory;
 
@@ -0,0 +1,160 @@
+/**
+ * @file RenderCommandList.hpp
+ * @author Minmin Gong
+ *
+ * @section DESCRIPTION
+ *
+ * This source file is part of KlayGE
+ * For the latest info, see http://www.klayge.org
+ *
+ * @section LICENSE
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * You may alternatively use this source under the terms of
+ * the KlayGE Proprietary License (KPL). You can obtained such a license
+ * from http://www.klayge.org/licensing/.
+ */
+
+#ifndef _KLAYGE_CORE_RENDER_COMMAND_LIST_HPP
+#define _KLAYGE_CORE_RENDER_COMMAND_LIST_HPP
+
+#pragma once
+
+#include <KlayGE/PreDeclare.hpp>
+#include <KFL/ArrayRef.hpp>
+#include <KFL/Math.hpp>
+
+#include <array>
+#include <functional>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+
+namespace KlayGE
+{
+	// Draws, dispatches, frame buffer binds and constant buffer updates, recorded to be executed later in order by
+	// RenderEngine::Execute. Recording only reads the effects, so lists can be recorded on worker threads.
+	// The commands are packed in one buffer that keeps its capacity on Reset, so recording a similar frame again
+	// doesn't allocate.
+	class KLAYGE_CORE_API RenderCommandList : boost::noncopyable
+	{
+	public:
+		enum CommandType
+		{
+			CT_Draw = 0,
+			CT_Dispatch,
+			CT_BindFrameBuffer,
+			CT_UpdateConstantBuffer,
+
+			CT_NumCommandTypes
+		};
+
+		// Commands are 8-byte aligned. size includes the header and any payload following the command.
+		struct CommandHeader
+		{
+			CommandType type;
+			uint32_t size;
+		};
+
+		struct DrawCommand
+		{
+			CommandHeader header;
+			RenderEffect const * effect;
+			RenderTechnique const * tech;
+			RenderLayout const * rl;
+		};
+
+		struct DispatchCommand
+		{
+			CommandHeader header;
+			RenderEffect const * effect;
+			RenderTechnique const * tech;
+			uint32_t tgx;
+			uint32_t tgy;
+			uint32_t tgz;
+		};
+
+		struct BindFrameBufferCommand
+		{
+			CommandHeader header;
+			uint32_t fb_index;
+		};
+
+		// Followed by size bytes of data
+		struct UpdateConstantBufferCommand
+		{
+			CommandHeader header;
+			RenderEffectConstantBuffer* cbuff;
+			uint32_t offset;
+			uint32_t size;
+		};
+
+	public:
+		RenderCommandList();
+
+		void Reset();
+
+		uint32_t NumCommands() const
+		{
+			return num_commands_;
+		}
+		uint32_t NumCommands(CommandType type) const
+		{
+			return type_counts_[type];
+		}
+
+		// The effects, techniques and layouts are referenced, they have to outlive the execution
+		void Draw(RenderEffect const & effect, RenderTechnique const & tech, RenderLayout const & rl);
+		void Dispatch(RenderEffect const & effect, RenderTechnique const & tech, uint32_t tgx, uint32_t tgy, uint32_t tgz);
+		void BindFrameBuffer(FrameBufferPtr const & fb);
+
+		// Copies data into the CPU side of the constant buffer at execution
+		void UpdateConstantBuffer(RenderEffectConstantBuffer& cbuff, uint32_t offset, void const * data, uint32_t size);
+
+		// The parameter has to be in a constant buffer. Only plain values are supported, not arrays.
+		template <typename T>
+		void SetParameter(RenderEffectParameter const & param, T const & value)
+		{
+			this->SetParameter(param, &value, sizeof(value));
+		}
+		void SetParameter(RenderEffectParameter const & param, float4x4 const & value);
+
+		// Walking the commands, for the render engines
+		CommandHeader const * FirstCommand() const;
+		CommandHeader const * NextCommand(CommandHeader const * cmd) const;
+		FrameBufferPtr const & FrameBuffer(uint32_t index) const
+		{
+			return frame_buffers_[index];
+		}
+
+	private:
+		void SetParameter(RenderEffectParameter const & param, void const * data, uint32_t size);
+		void* Allocate(CommandType type, uint32_t size);
+
+	private:
+		std::vector<uint64_t> buff_;
+		std::vector<FrameBufferPtr> frame_buffers_;
+		uint32_t num_commands_;
+		std::array<uint32_t, CT_NumCommandTypes> type_counts_;
+	};
+
+	// Calls record(*lists[i], i) for every list, in parallel on the thread pool. The lists are reset first. Executing them in
+	// order afterwards gives the same result as recording everything into one list.
+	KLAYGE_CORE_API void RecordInParallel(ArrayRef<RenderCommandList*> lists,
+		std::function<void(RenderCommandList& cmds, uint32_t index)> const & record);
+}
+
+#endif		// _KLAYGE_CORE_RENDER_COMMAND_LIST_HPP
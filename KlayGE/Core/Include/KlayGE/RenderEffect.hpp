@@ -995,6 +995,14 @@ namespace KlayGE
 		{
 			return has_tessellation_;
 		}
+		// Set by the bool annotation auto_instancing. See Renderable::AutoInstanceFormat.
+		bool AutoInstancing() const
+		{
+			return auto_instancing_;
+		}
+
+	private:
+		void UpdateAutoInstancing();
 
 	private:
 		std::string name_;
@@ -1010,6 +1018,7 @@ namespace KlayGE
 		bool is_validate_;
 		bool has_discard_;
 		bool has_tessellation_;
+		bool auto_instancing_;
 	};
 
 	class KLAYGE_CORE_API RenderPass : boost::noncopyable
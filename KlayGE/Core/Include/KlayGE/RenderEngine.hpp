@@ -102,6 +102,7 @@ namespace KlayGE
 		void Dispatch(RenderEffect const & effect, RenderTechnique const & tech, uint32_t tgx, uint32_t tgy, uint32_t tgz);
 		void DispatchIndirect(RenderEffect const & effect, RenderTechnique const & tech,
 			GraphicsBufferPtr const & buff_args, uint32_t offset);
+		void Execute(RenderCommandList const & cmds);
 		virtual void EndPass();
 		virtual void EndFrame();
 
@@ -274,6 +275,8 @@ namespace KlayGE
 		virtual void DoDispatch(RenderEffect const & effect, RenderTechnique const & tech, uint32_t tgx, uint32_t tgy, uint32_t tgz) = 0;
 		virtual void DoDispatchIndirect(RenderEffect const & effect, RenderTechnique const & tech,
 			GraphicsBufferPtr const & buff_args, uint32_t offset) = 0;
+		// Replays the commands through the calls above. An engine with native command lists can translate them instead.
+		virtual void DoExecute(RenderCommandList const & cmds);
 		virtual void DoResize(uint32_t width, uint32_t height) = 0;
 		virtual void DoDestroy() = 0;
 
@@ -308,6 +311,11 @@ namespace KlayGE
 		uint32_t num_vertices_just_rendered_;
 		uint32_t num_draws_just_called_;
 		uint32_t num_dispatches_just_called_;
+		// The calls returned by the queries, and the totals at the last traced frame
+		uint64_t num_draws_queried_;
+		uint64_t num_dispatches_queried_;
+		uint64_t num_draws_traced_;
+		uint64_t num_dispatches_traced_;
 
 		RenderDeviceCaps caps_;
 
@@ -24,6 +24,7 @@
 #include <KlayGE/PreDeclare.hpp>
 #include <KFL/ArrayRef.hpp>
 #include <vector>
+#include <KlayGE/RenderLayout.hpp>
 #include <KlayGE/RenderMaterial.hpp>
 
 namespace KlayGE
@@ -187,6 +188,16 @@ namespace KlayGE
 			return instances_[index];
 		}
 
+		// Instances without an instance format are drawn with one instanced draw per LOD if the technique has the bool
+		// annotation auto_instancing. Such a technique reads the rows of the transposed world matrix from this stream,
+		// and mvp and model_view contain no model matrix.
+		static std::vector<VertexElement> const & AutoInstanceFormat();
+
+		// Triangles of the lowest LOD in model space, for occlusion culling. They are read back from the GPU the first time
+		// after the HW resources are ready. Empty for layouts that are not indexed triangle lists, and for skinned layouts.
+		ArrayRef<float3> OccluderPositions();
+		ArrayRef<uint32_t> OccluderIndices();
+
 		virtual void ModelMatrix(float4x4 const & mat);
 		virtual void BindSceneNode(SceneNode const * node);
 		SceneNode const * CurrSceneNode() const
@@ -254,6 +265,12 @@ namespace KlayGE
 		virtual void UpdateBoundBox();
 
 		float CalcLod(float3 const & eye_pos, float fov_scale) const;
+		float CalcLod(float4x4 const & model, float3 const & eye_pos, float fov_scale) const;
+
+		void RenderAutoInstanced(RenderEffect const & effect, RenderTechnique const & tech);
+		RenderLayout& AutoInstanceLayout(uint32_t lod);
+
+		void UpdateOccluderGeometry();
 
 		// For deferred only
 		void BindDeferredEffect(RenderEffectPtr const & deferred_effect);
@@ -276,6 +293,15 @@ namespace KlayGE
 
 		int32_t active_lod_ = 0;
 
+		std::vector<RenderLayoutPtr> auto_inst_rls_;
+		GraphicsBufferPtr auto_inst_stream_;
+		std::vector<float4> auto_inst_data_;
+		std::vector<uint32_t> auto_inst_lods_;
+
+		bool occluder_geometry_ready_ = false;
+		std::vector<float3> occluder_positions_;
+		std::vector<uint32_t> occluder_indices_;
+
 		bool enabled_ = true;
 
 		// For select mode
@@ -34,6 +34,7 @@
 #pragma once
 
 #include <KlayGE/PreDeclare.hpp>
+#include <atomic>
 #include <istream>
 #include <string>
 #include <vector>
@@ -173,6 +174,8 @@ namespace KlayGE
 
 		std::unique_ptr<joiner<void>> loading_thread_;
 		volatile bool quit_;
+
+		std::atomic<uint64_t> opened_bytes_;
 	};
 }
 
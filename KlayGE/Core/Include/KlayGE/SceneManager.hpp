@@ -25,9 +25,12 @@
 
 #include <KlayGE/SceneNode.hpp>
 #include <KlayGE/Renderable.hpp>
+#include <KlayGE/TransformHierarchy.hpp>
 #include <KFL/Frustum.hpp>
 #include <KFL/Thread.hpp>
 
+#include <atomic>
+#include <condition_variable>
 #include <vector>
 #include <unordered_map>
 
@@ -43,7 +46,27 @@ namespace KlayGE
 		void Resume();
 
 		void SmallObjectThreshold(float area);
+		// Culling results are kept per view across frames. They are reused while the scene structure stays the same and no
+		// element of the view projection matrix moves by more than threshold, which is 0 by default. Only the nodes that moved
+		// since are clipped again.
+		void VisibilityCacheThreshold(float threshold);
+		void ClearVisibilityCache();
+		// Number of passes of the last frame that reused cached culling results
+		uint32_t NumVisibilityCacheHits() const;
+		// Culls the nodes hidden behind SOA_Occluder nodes after the frustum culling
+		void OcclusionCulling(bool enabled);
+		bool OcclusionCulling() const;
+		// For the statistics and the debug image of the last culled pass. nullptr if occlusion culling is disabled.
+		OcclusionCuller const * OcclusionCullerInstance() const
+		{
+			return occlusion_culler_.get();
+		}
+		// The sub thread updates the scene at this fixed interval
 		void SceneUpdateElapse(float elapse);
+		// Runs the sub thread update of the subtrees under the scene root as parallel jobs. Only for subtrees whose update
+		// callbacks don't share state. Off by default.
+		void ParallelSubThreadUpdate(bool parallel);
+		bool ParallelSubThreadUpdate() const;
 		virtual void ClipScene();
 
 		void AddCamera(CameraPtr const & camera);
@@ -78,6 +101,14 @@ namespace KlayGE
 			return overlay_root_;
 		}
 
+		// World matrices and bounds of the scene nodes, flattened
+		TransformHierarchy const & SceneTransformHierarchy() const
+		{
+			return transform_hierarchy_;
+		}
+
+		// Changes of the scene root subtree have to be made with this mutex locked, outside of the update callbacks. The overlay
+		// tree is only touched by the main thread.
 		std::mutex& MutexForUpdate()
 		{
 			return update_mutex_;
@@ -114,9 +145,16 @@ namespace KlayGE
 		virtual void DoResume() = 0;
 
 		void UpdateThreadFunc();
+		void SubThreadUpdateScene(float app_time, float frame_time);
 
 		BoundOverlap VisibleTestFromParent(SceneNode const & node, float3 const & view_dir, float3 const & eye_pos,
 			float4x4 const & view_proj);
+		void OcclusionCullScene();
+
+		float4x4 ClipViewProj(Camera const & camera) const;
+		BoundOverlap ClipNode(SceneNode const & node, Camera const & camera, float4x4 const & view_proj);
+		void ReclipChangedNodes(std::vector<BoundOverlap>& marks, uint32_t since_stamp, Camera const & camera,
+			float4x4 const & view_proj);
 
 	protected:
 		std::vector<CameraPtr> cameras_;
@@ -124,12 +162,31 @@ namespace KlayGE
 		std::vector<LightSourcePtr> lights_;
 		SceneNode scene_root_;
 		SceneNode overlay_root_;
+		TransformHierarchy transform_hierarchy_;
 
-		std::unordered_map<size_t, std::unique_ptr<BoundOverlap[]>> visible_marks_map_;
+		struct VisibilityCacheEntry
+		{
+			std::vector<BoundOverlap> marks;
+			float4x4 view_proj;
+			uint32_t build_version;
+			uint32_t change_stamp;
+			uint32_t last_used_frame;
+		};
+		// Entries not used for this many frames are dropped
+		static uint32_t constexpr VISIBILITY_CACHE_MAX_AGE = 30;
+		std::unordered_map<size_t, VisibilityCacheEntry> visibility_cache_;
+		float visibility_cache_threshold_;
+		uint32_t visibility_cache_frame_;
+		uint32_t num_visibility_cache_hits_;
 
 		float small_obj_threshold_;
 		float update_elapse_;
 
+		std::unique_ptr<OcclusionCuller> occlusion_culler_;
+		std::vector<SceneNode*> occludee_nodes_;
+		std::vector<AABBox> occludee_aabbs_;
+		std::vector<uint8_t> occluded_;
+
 		std::vector<SceneNode*> all_scene_nodes_;
 		std::vector<SceneNode*> all_overlay_nodes_;
 
@@ -150,7 +207,10 @@ namespace KlayGE
 
 		std::mutex update_mutex_;
 		std::unique_ptr<joiner<void>> update_thread_;
-		volatile bool quit_;
+		std::atomic<bool> quit_;
+		std::mutex quit_mutex_;
+		std::condition_variable quit_cond_;
+		uint32_t num_sub_thread_update_jobs_;
 
 		bool deferred_mode_;
 	};
@@ -42,6 +42,8 @@ namespace KlayGE
 {
 	class KLAYGE_CORE_API SceneNode : boost::noncopyable, public std::enable_shared_from_this<SceneNode>
 	{
+		friend class TransformHierarchy;
+
 	public:
 		enum SOAttrib
 		{
@@ -50,7 +52,9 @@ namespace KlayGE
 			SOA_Moveable = 1UL << 2,
 			SOA_Invisible = 1UL << 3,
 			SOA_NotCastShadow = 1UL << 4,
-			SOA_SSS = 1UL << 5
+			SOA_SSS = 1UL << 5,
+			// The opaque triangles of the renderables hide what is behind them in the CPU occlusion culling
+			SOA_Occluder = 1UL << 6
 		};
 
 	public:
@@ -143,6 +147,11 @@ namespace KlayGE
 		void Parent(SceneNode* so);
 		void EmitSceneChanged();
 
+		// The transform or the renderables changed
+		void MarkDirty();
+		// The children changed
+		void MarkStructureDirty();
+
 	protected:
 		std::wstring name_;
 
@@ -165,6 +174,10 @@ namespace KlayGE
 		UpdateEvent main_thread_update_event_;
 
 		bool updated_ = false;
+
+		// Set while the node is flattened into the transform hierarchy of the scene manager
+		TransformHierarchy* hierarchy_ = nullptr;
+		uint32_t hierarchy_index_ = 0;
 	};
 }
 
@@ -34,12 +34,181 @@
 #pragma once
 
 #include <string>
+#include <type_traits>
+#include <vector>
 
 #include <KFL/CXX17/any.hpp>
+#include <KFL/CXX17/string_view.hpp>
 #include <KFL/ArrayRef.hpp>
 
+#include <boost/assert.hpp>
+
 namespace KlayGE
 {
+	// An argument of a typed script call. Strings are referenced instead of copied, so an argument must not outlive the
+	// data it is built from.
+	class ScriptArg
+	{
+	public:
+		enum ArgType
+		{
+			SAT_Bool,
+			SAT_Int,
+			SAT_UInt,
+			SAT_Float,
+			SAT_String,
+			SAT_WString
+		};
+
+	public:
+		ScriptArg(bool v)
+			: type_(SAT_Bool), len_(0)
+		{
+			b_ = v;
+		}
+		template <typename T, typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value, int>::type = 0>
+		ScriptArg(T v)
+			: type_(SAT_Int), len_(0)
+		{
+			i_ = v;
+		}
+		template <typename T, typename std::enable_if<std::is_integral<T>::value && std::is_unsigned<T>::value
+			&& !std::is_same<T, bool>::value, int>::type = 0>
+		ScriptArg(T v)
+			: type_(SAT_UInt), len_(0)
+		{
+			u_ = v;
+		}
+		template <typename T, typename std::enable_if<std::is_floating_point<T>::value, int>::type = 0>
+		ScriptArg(T v)
+			: type_(SAT_Float), len_(0)
+		{
+			f_ = v;
+		}
+		ScriptArg(std::string_view v)
+			: type_(SAT_String), len_(v.size())
+		{
+			str_ = v.data();
+		}
+		ScriptArg(std::string const & v)
+			: ScriptArg(std::string_view(v))
+		{
+		}
+		ScriptArg(char const * v)
+			: ScriptArg(std::string_view(v))
+		{
+		}
+		ScriptArg(std::wstring_view v)
+			: type_(SAT_WString), len_(v.size())
+		{
+			wstr_ = v.data();
+		}
+		ScriptArg(std::wstring const & v)
+			: ScriptArg(std::wstring_view(v))
+		{
+		}
+		ScriptArg(wchar_t const * v)
+			: ScriptArg(std::wstring_view(v))
+		{
+		}
+
+		ArgType Type() const
+		{
+			return type_;
+		}
+
+		bool Bool() const
+		{
+			BOOST_ASSERT(SAT_Bool == type_);
+			return b_;
+		}
+		int64_t Int() const
+		{
+			BOOST_ASSERT(SAT_Int == type_);
+			return i_;
+		}
+		uint64_t UInt() const
+		{
+			BOOST_ASSERT(SAT_UInt == type_);
+			return u_;
+		}
+		double Float() const
+		{
+			BOOST_ASSERT(SAT_Float == type_);
+			return f_;
+		}
+		std::string_view String() const
+		{
+			BOOST_ASSERT(SAT_String == type_);
+			return std::string_view(str_, len_);
+		}
+		std::wstring_view WString() const
+		{
+			BOOST_ASSERT(SAT_WString == type_);
+			return std::wstring_view(wstr_, len_);
+		}
+
+	private:
+		ArgType type_;
+		union
+		{
+			bool b_;
+			int64_t i_;
+			uint64_t u_;
+			double f_;
+			char const * str_;
+			wchar_t const * wstr_;
+		};
+		size_t len_;
+	};
+
+	namespace Detail
+	{
+		template <typename... Args>
+		struct AreScriptArgs;
+
+		template <>
+		struct AreScriptArgs<> : std::true_type
+		{
+		};
+
+		template <typename T, typename... Args>
+		struct AreScriptArgs<T, Args...>
+			: std::integral_constant<bool, std::is_convertible<T const &, ScriptArg>::value && AreScriptArgs<Args...>::value>
+		{
+		};
+	}
+
+	// A script function resolved once. It keeps calling the same function object even if the script rebinds the name later.
+	class KLAYGE_CORE_API ScriptFunction : boost::noncopyable
+	{
+	public:
+		ScriptFunction();
+		virtual ~ScriptFunction();
+
+		virtual std::any Call(ArrayRef<std::any> args) = 0;
+		virtual std::any CallArgs(ArrayRef<ScriptArg> args) = 0;
+
+		// Typed call. The arguments are packed on the stack, without going through std::any.
+		std::any Call()
+		{
+			return this->CallArgs(ArrayRef<ScriptArg>());
+		}
+		template <typename... Args, typename std::enable_if<(sizeof...(Args) > 0) && Detail::AreScriptArgs<Args...>::value, int>::type = 0>
+		std::any Call(Args const &... args)
+		{
+			ScriptArg const packed[] = { ScriptArg(args)... };
+			return this->CallArgs(packed);
+		}
+
+		// Calls the function once for every num_args_per_call consecutive arguments. results, if not null, receives one
+		// value per call.
+		virtual void CallBatch(ArrayRef<ScriptArg> args, uint32_t num_args_per_call, std::vector<std::any>* results) = 0;
+	};
+
+	typedef std::shared_ptr<ScriptFunction> ScriptFunctionPtr;
+
+
 	class KLAYGE_CORE_API ScriptModule : boost::noncopyable
 	{
 	public:
@@ -48,7 +217,11 @@ namespace KlayGE
 
 		virtual std::any Value(std::string const & name) = 0;
 		virtual std::any Call(std::string const & func_name, ArrayRef<std::any> args) = 0;
+		// Compiled scripts are cached, running the same string again skips the parsing
 		virtual std::any RunString(std::string const & script) = 0;
+
+		// Resolves a function once for repeated calls. Null if the module has no such function.
+		virtual ScriptFunctionPtr Function(std::string const & name) = 0;
 	};
 
 	typedef std::shared_ptr<ScriptModule> ScriptModulePtr;
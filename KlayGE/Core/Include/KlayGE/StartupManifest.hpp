@@ -0,0 +1,111 @@
+/**
+ * @file StartupManifest.hpp
+ * @author Minmin Gong
+ *
+ * @section DESCRIPTION
+ *
+ * This source file is part of KlayGE
+ * For the latest info, see http://www.klayge.org
+ *
+ * @section LICENSE
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * You may alternatively use this source under the terms of
+ * the KlayGE Proprietary License (KPL). You can obtained such a license
+ * from http://www.klayge.org/licensing/.
+ */
+
+#ifndef _KLAYGE_CORE_STARTUP_MANIFEST_HPP
+#define _KLAYGE_CORE_STARTUP_MANIFEST_HPP
+
+#pragma once
+
+#include <KlayGE/PreDeclare.hpp>
+#include <KFL/CXX17/string_view.hpp>
+#include <KFL/Thread.hpp>
+
+#include <atomic>
+#include <iosfwd>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+
+namespace KlayGE
+{
+	// The effects and textures an app loads during its startup. Saved at the end of the startup, so the next run can fetch
+	// them ahead of time. The file has a "<kind> <access hint> <name>" line per asset. The names of effects loaded together
+	// are joined with '|'.
+	class KLAYGE_CORE_API StartupManifest : boost::noncopyable
+	{
+	public:
+		enum AssetKind
+		{
+			AK_Effect = 0,
+			AK_Texture
+		};
+
+		struct Asset
+		{
+			AssetKind kind;
+			uint32_t access_hint;
+			std::string name;
+		};
+
+	public:
+		StartupManifest();
+		~StartupManifest();
+
+		// Records the assets loaded between StartRecording and StopRecording, without duplicates. Thread safe.
+		void StartRecording();
+		void StopRecording();
+		bool Recording() const
+		{
+			return recording_;
+		}
+		void Record(AssetKind kind, std::string_view name, uint32_t access_hint = 0);
+		std::vector<Asset> RecordedAssets() const;
+
+		// Load reads the assets of the last run, Save writes the recorded ones
+		void Load(std::istream& is);
+		void Save(std::ostream& os) const;
+		std::vector<Asset> const & LastRunAssets() const
+		{
+			return last_run_assets_;
+		}
+
+		// Reads the files of the last run's assets on the thread pool, so that loading them hits the file cache. Doesn't need
+		// the render engine.
+		void WarmFiles();
+		// Starts the asynchronous loads of the last run's textures. Needs the render engine. The textures are held until
+		// ReleasePreloaded, so the loads of the app pick them up from the ResLoader.
+		void PreloadTextures();
+		void ReleasePreloaded();
+
+	private:
+		std::atomic<bool> recording_;
+		mutable std::mutex recorded_mutex_;
+		std::vector<Asset> recorded_assets_;
+
+		std::vector<Asset> last_run_assets_;
+		std::unique_ptr<joiner<void>> warming_job_;
+		std::vector<TexturePtr> preloaded_textures_;
+	};
+}
+
+#endif		// _KLAYGE_CORE_STARTUP_MANIFEST_HPP
@@ -367,11 +367,30 @@ namespace KlayGE
 
 	KLAYGE_CORE_API void SaveTexture(TexturePtr const & texture, std::string const & tex_name);
 
+	enum ResizeFilter
+	{
+		RF_Point,
+		RF_Linear,
+		RF_Box,
+		RF_Kaiser,
+		RF_Lanczos
+	};
+
 	KLAYGE_CORE_API void ResizeTexture(void* dst_data, uint32_t dst_row_pitch, uint32_t dst_slice_pitch, ElementFormat dst_format,
 		uint32_t dst_width, uint32_t dst_height, uint32_t dst_depth,
 		void const * src_data, uint32_t src_row_pitch, uint32_t src_slice_pitch, ElementFormat src_format,
 		uint32_t src_width, uint32_t src_height, uint32_t src_depth,
 		bool linear);
+	KLAYGE_CORE_API void ResizeTexture(void* dst_data, uint32_t dst_row_pitch, uint32_t dst_slice_pitch, ElementFormat dst_format,
+		uint32_t dst_width, uint32_t dst_height, uint32_t dst_depth,
+		void const * src_data, uint32_t src_row_pitch, uint32_t src_slice_pitch, ElementFormat src_format,
+		uint32_t src_width, uint32_t src_height, uint32_t src_depth,
+		ResizeFilter filter);
+
+	// Fills levels[1..] from levels[0]. Each level is filtered from the one above it. Compressed chains are filtered in
+	// an uncompressed format and encoded level by level.
+	KLAYGE_CORE_API void BuildMipChain(ArrayRef<ElementInitData> levels, ElementFormat format,
+		uint32_t width, uint32_t height, uint32_t depth, ResizeFilter filter);
 
 	// return the lookat and up vector in cubemap view
 	//////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,173 @@
+/**
+ * @file TransformHierarchy.hpp
+ * @author Minmin Gong
+ *
+ * @section DESCRIPTION
+ *
+ * This source file is part of KlayGE
+ * For the latest info, see http://www.klayge.org
+ *
+ * @section LICENSE
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * You may alternatively use this source under the terms of
+ * the KlayGE Proprietary License (KPL). You can obtained such a license
+ * from http://www.klayge.org/licensing/.
+ */
+
+#ifndef _KLAYGE_CORE_TRANSFORM_HIERARCHY_HPP
+#define _KLAYGE_CORE_TRANSFORM_HIERARCHY_HPP
+
+#pragma once
+
+#include <KlayGE/PreDeclare.hpp>
+#include <KFL/AABBox.hpp>
+#include <KFL/Math.hpp>
+
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+
+namespace KlayGE
+{
+	// The transforms and bounds of a scene graph, flattened into arrays sorted by depth. The children of a node are contiguous,
+	// so the world matrices are propagated top down and the bounds bottom up one level at a time, with the nodes of a large
+	// level updated in parallel. Only nodes whose local transform or renderables changed, and the nodes depending on them,
+	// are recomputed.
+	// The scene nodes in a hierarchy report their changes to it, and get their world matrices and bounds written back by
+	// Update. A change of the structure rebuilds the arrays on the next Update.
+	class KLAYGE_CORE_API TransformHierarchy : boost::noncopyable
+	{
+	public:
+		TransformHierarchy();
+		~TransformHierarchy();
+
+		// Flattens the subtree under root, or rebuilds it if the structure changed, and updates the changed nodes
+		void Update(SceneNode& root);
+		void Clear();
+
+		void Invalidate()
+		{
+			structure_dirty_ = true;
+		}
+		bool StructureDirty() const
+		{
+			return structure_dirty_;
+		}
+		void MarkDirty(uint32_t index)
+		{
+			flags_[index] |= NF_Dirty;
+		}
+		void NodeDestroyed(uint32_t index);
+
+		uint32_t NumNodes() const
+		{
+			return static_cast<uint32_t>(nodes_.size());
+		}
+		uint32_t NumLevels() const
+		{
+			return level_begins_.empty() ? 0 : static_cast<uint32_t>(level_begins_.size() - 1);
+		}
+		// Number of nodes whose world matrix or bounds were recomputed by the last Update
+		uint32_t NumNodesUpdated() const
+		{
+			return num_nodes_updated_;
+		}
+
+		// Incremented each time the arrays are rebuilt
+		uint32_t BuildVersion() const
+		{
+			return build_version_;
+		}
+		// Incremented by each Update
+		uint32_t UpdateStamp() const
+		{
+			return update_stamp_;
+		}
+		// The last Update that changed any node
+		uint32_t LastChangeStamp() const
+		{
+			return last_change_stamp_;
+		}
+		// The last Update that changed the world matrix or the bounds of the node. ~0U if the node is not in the hierarchy.
+		uint32_t ChangeStamp(SceneNode const & node) const;
+
+		SceneNode* Node(uint32_t index) const
+		{
+			return nodes_[index];
+		}
+		// The root has no parent, and gets ~0U
+		uint32_t ParentIndex(uint32_t index) const
+		{
+			return parents_[index];
+		}
+		float4x4 const & LocalTransform(uint32_t index) const
+		{
+			return local_xforms_[index];
+		}
+		float4x4 const & WorldTransform(uint32_t index) const
+		{
+			return world_xforms_[index];
+		}
+		AABBox const & LocalBound(uint32_t index) const
+		{
+			return local_bounds_[index];
+		}
+		AABBox const & WorldBound(uint32_t index) const
+		{
+			return world_bounds_[index];
+		}
+
+	private:
+		enum NodeFlag : uint8_t
+		{
+			NF_Dirty = 1U << 0,
+			NF_HasBound = 1U << 1,
+			NF_WorldChanged = 1U << 2,
+			NF_BoundChanged = 1U << 3
+		};
+
+		void Build(SceneNode& root);
+		void UpdateWorldTransforms(uint32_t begin, uint32_t end);
+		void UpdateLocalBounds(uint32_t begin, uint32_t end);
+		uint32_t WriteBack(uint32_t begin, uint32_t end);
+
+	private:
+		std::vector<SceneNode*> nodes_;
+		std::vector<uint32_t> parents_;
+		std::vector<uint32_t> first_children_;
+		std::vector<uint32_t> num_children_;
+		std::vector<uint32_t> level_begins_;
+		std::vector<uint8_t> flags_;
+
+		std::vector<float4x4> local_xforms_;
+		std::vector<float4x4> world_xforms_;
+		// Bounds of the renderables of the node itself
+		std::vector<AABBox> own_bounds_;
+		// Bounds of the subtree in the node's space, and in world space
+		std::vector<AABBox> local_bounds_;
+		std::vector<AABBox> world_bounds_;
+		std::vector<uint32_t> change_stamps_;
+
+		bool structure_dirty_;
+		uint32_t num_nodes_updated_;
+		uint32_t build_version_;
+		uint32_t update_stamp_;
+		uint32_t last_change_stamp_;
+	};
+}
+
+#endif		// _KLAYGE_CORE_TRANSFORM_HIERARCHY_HPP
@@ -165,6 +165,15 @@ namespace KlayGE
 
 		virtual void Render() = 0;
 
+		// A dialog replays its geometry until one of its controls changes. Controls that also change over time, not only
+		// through input or setters, keep their dialog rebuilt every frame while this is true.
+		virtual bool IsAnimated() const
+		{
+			return false;
+		}
+		// Makes the dialog rebuild its geometry
+		void Invalidate();
+
 		virtual bool CanHaveFocus() const
 		{
 			return false;
@@ -205,6 +214,7 @@ namespace KlayGE
 		virtual void SetEnabled(bool bEnabled)
 		{
 			enabled_ = bEnabled;
+			this->Invalidate();
 		}
 		virtual bool GetEnabled() const
 		{
@@ -213,6 +223,7 @@ namespace KlayGE
 		virtual void SetVisible(bool bVisible)
 		{
 			visible_ = bVisible;
+			this->Invalidate();
 		}
 		virtual bool GetVisible() const
 		{
@@ -238,12 +249,14 @@ namespace KlayGE
 			x_ = x;
 			y_ = y;
 			this->UpdateRects();
+			this->Invalidate();
 		}
 		void SetSize(int width, int height)
 		{
 			width_ = width;
 			height_ = height;
 			this->UpdateRects();
+			this->Invalidate();
 		}
 
 		void SetHotkey(uint8_t hotkey)
@@ -262,6 +275,7 @@ namespace KlayGE
 			{
 				element->FontColor().States[UICS_Normal] = color;
 			}
+			this->Invalidate();
 		}
 		UIElement* GetElement(uint32_t iElement) const
 		{
@@ -277,6 +291,7 @@ namespace KlayGE
 
 			// Update the data
 			*elements_[iElement] = element;
+			this->Invalidate();
 		}
 
 		bool GetIsDefault() const
@@ -286,6 +301,7 @@ namespace KlayGE
 		void SetIsDefault(bool bIsDefault)
 		{
 			is_default_ = bIsDefault;
+			this->Invalidate();
 		}
 		uint32_t GetIndex() const
 		{
@@ -339,6 +355,7 @@ namespace KlayGE
 		virtual void UpdateRects()
 		{
 			bounding_box_ = IRect(x_, y_, x_ + width_, y_ + height_);
+			this->Invalidate();
 		}
 
 		int  id_;				// ID number
@@ -368,6 +385,25 @@ namespace KlayGE
 			}
 		};
 
+		struct string_cache
+		{
+			Rect rc;
+			float depth;
+			Color clr;
+			std::wstring text;
+			uint32_t align;
+		};
+
+		// Quads, 4 vertices each, and strings emitted by a dialog. Kept until the dialog is invalidated.
+		struct GeometryCache
+		{
+			std::map<TexturePtr, std::vector<VertexFormat>> quads;
+			std::map<size_t, std::vector<string_cache>> strings;
+			uint32_t num_quads = 0;
+
+			void Clear();
+		};
+
 		UIManager();
 		~UIManager();
 
@@ -426,9 +462,21 @@ namespace KlayGE
 			return mouse_on_ui_;
 		}
 
+		// Stats of the last Render
+		uint32_t NumQuads() const
+		{
+			return num_quads_;
+		}
+		uint32_t NumQuadsRebuilt() const
+		{
+			return num_quads_rebuilt_;
+		}
+
 	private:
 		void Init();
 		void InputHandler(InputEngine const & sender, InputAction const & action);
+		void AddQuads(TexturePtr const & texture, VertexFormat const * vertices, uint32_t num_quads);
+		void RenderGeometry(GeometryCache const & geometry);
 
 	private:
 		static std::unique_ptr<UIManager> ui_mgr_instance_;
@@ -443,17 +491,15 @@ namespace KlayGE
 
 		std::array<std::vector<IRect >, UICT_Num_Control_Types> elem_texture_rcs_;
 
-		std::map<TexturePtr, RenderablePtr> rects_;
+		// One batch per texture, with its node kept across frames
+		std::map<TexturePtr, SceneNodePtr> rects_;
 
-		struct string_cache
-		{
-			Rect rc;
-			float depth;
-			Color clr;
-			std::wstring text;
-			uint32_t align;
-		};
-		std::map<size_t, std::vector<string_cache>> strings_;
+		// The geometry of the dialog being rebuilt, otherwise immediate_geometry_, which is drawn once
+		GeometryCache* curr_geometry_;
+		GeometryCache immediate_geometry_;
+
+		uint32_t num_quads_;
+		uint32_t num_quads_rebuilt_;
 
 		bool mouse_on_ui_;
 		bool inited_;
@@ -524,6 +570,7 @@ namespace KlayGE
 		void SetVisible(bool bVisible)
 		{
 			visible_ = bVisible;
+			dirty_ = true;
 		}
 		bool GetMinimized() const
 		{
@@ -532,6 +579,7 @@ namespace KlayGE
 		void SetMinimized(bool bMinimized)
 		{
 			minimized_ = bMinimized;
+			dirty_ = true;
 		}
 		void SetBackgroundColors(Color const & colorAllCorners);
 		void SetBackgroundColors(Color const & colorTopLeft, Color const & colorTopRight,
@@ -539,6 +587,7 @@ namespace KlayGE
 		void EnableCaption(bool bEnable)
 		{
 			show_caption_ = bEnable;
+			dirty_ = true;
 		}
 		bool IsCaptionEnabled() const
 		{
@@ -551,6 +600,7 @@ namespace KlayGE
 		void SetCaptionHeight(int nHeight)
 		{
 			caption_height_ = nHeight;
+			dirty_ = true;
 		}
 		void SetID(std::string const & id)
 		{
@@ -563,6 +613,7 @@ namespace KlayGE
 		void SetCaptionText(std::wstring const & strText)
 		{
 			caption_ = strText;
+			dirty_ = true;
 		}
 		int2 GetLocation() const
 		{
@@ -576,11 +627,13 @@ namespace KlayGE
 			bounding_box_.top() = y;
 			bounding_box_.right() = x + w;
 			bounding_box_.bottom() = y + h;
+			dirty_ = true;
 		}
 		void SetSize(int width, int height)
 		{
 			bounding_box_.right() = bounding_box_.left() + width;
 			bounding_box_.bottom() = bounding_box_.top() + height;
+			dirty_ = true;
 		}
 		int GetWidth() const
 		{
@@ -593,6 +646,7 @@ namespace KlayGE
 		void AlwaysInOpacity(bool opacity)
 		{
 			always_in_opacity_ = opacity;
+			dirty_ = true;
 		}
 		bool AlwaysInOpacity() const
 		{
@@ -632,6 +686,12 @@ namespace KlayGE
 
 		void FocusDefaultControl();
 
+		// The geometry is rebuilt in the next UIManager::Render
+		void Invalidate()
+		{
+			dirty_ = true;
+		}
+
 		void DrawRect(IRect const & rc, float depth, Color const & clr);
 		void DrawQuad(UIManager::VertexFormat const * vertices, float depth, TexturePtr const & texture);
 		void DrawSprite(UIElement const & element, IRect const & rcDest, float depth_bias = 0.0f);
@@ -649,6 +709,8 @@ namespace KlayGE
 		// Control events
 		bool OnCycleFocus(bool bForward);
 
+		bool NeedsRebuild() const;
+
 	private:
 		bool keyboard_input_;
 		bool mouse_input_;
@@ -683,6 +745,9 @@ namespace KlayGE
 
 		std::map<std::string, int> id_name_;
 		std::map<int, ControlLocation> id_location_;
+
+		UIManager::GeometryCache geometry_;
+		bool dirty_;
 	};
 
 	class KLAYGE_CORE_API UIStatic : public UIControl
@@ -1076,6 +1141,12 @@ namespace KlayGE
 		virtual void Render();
 		virtual void UpdateRects();
 
+		// A held arrow keeps scrolling
+		virtual bool IsAnimated() const
+		{
+			return arrow_ != CLEAR;
+		}
+
 		void SetTrackRange(size_t nStart, size_t nEnd);
 		size_t GetTrackPos() const
 		{
@@ -1179,6 +1250,11 @@ namespace KlayGE
 		virtual void    Render();
 		virtual void    UpdateRects();
 
+		virtual bool IsAnimated() const
+		{
+			return scroll_bar_.IsAnimated();
+		}
+
 		STYLE GetStyle() const
 		{
 			return style_;
@@ -1190,6 +1266,7 @@ namespace KlayGE
 		void SetStyle(STYLE style)
 		{
 			style_ = style;
+			this->Invalidate();
 		}
 		int  GetScrollBarWidth() const
 		{
@@ -1204,6 +1281,7 @@ namespace KlayGE
 		{
 			border_ = border;
 			margin_ = margin;
+			this->Invalidate();
 		}
 		int AddItem(std::wstring const & strText);
 		void SetItemData(int nIndex, std::any const & data);
@@ -1291,6 +1369,11 @@ namespace KlayGE
 		virtual void OnFocusOut();
 		virtual void Render();
 
+		virtual bool IsAnimated() const
+		{
+			return scroll_bar_.IsAnimated();
+		}
+
 		virtual void UpdateRects();
 
 		int AddItem(std::wstring const & strText);
@@ -1469,6 +1552,12 @@ namespace KlayGE
 		}
 		virtual void Render();
 
+		// The caret blinks
+		virtual bool IsAnimated() const
+		{
+			return has_focus_;
+		}
+
 		void SetText(std::wstring const & wszText, bool bSelected = false);
 		std::wstring const & GetText() const
 		{
@@ -1482,18 +1571,22 @@ namespace KlayGE
 		virtual void SetTextColor(Color const & Color)
 		{
 			text_color_ = Color;	// Text color
+			this->Invalidate();
 		}
 		void SetSelectedTextColor(Color const & Color)
 		{
 			sel_text_color_ = Color;	// Selected text color
+			this->Invalidate();
 		}
 		void SetSelectedBackColor(Color const & Color)
 		{
 			sel_bk_color_ = Color;	// Selected background color
+			this->Invalidate();
 		}
 		void SetCaretColor(Color const & Color)
 		{
 			caret_color_ = Color;	// Caret color
+			this->Invalidate();
 		}
 		void SetBorderWidth(int nBorder)
 		{
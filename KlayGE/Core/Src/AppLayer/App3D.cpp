@@ -40,6 +40,9 @@
 #include <KlayGE/UI.hpp>
 #include <KlayGE/SceneManager.hpp>
 #include <KlayGE/DeferredRenderingLayer.hpp>
+#include <KlayGE/StartupManifest.hpp>
+
+#include <fstream>
 
 #include <boost/assert.hpp>
 
@@ -535,6 +538,21 @@ namespace KlayGE
 	{
 		Context::Instance().AppInstance(*this);
 
+		// The plugins, and the files of the assets the last run loaded at startup, are read while the app sets itself up
+		Context::Instance().PreloadPlugins();
+
+		startup_manifest_path_ = ResLoader::Instance().LocalFolder() + name_ + "_startup.txt";
+		auto& manifest = Context::Instance().StartupManifestInstance();
+		{
+			std::ifstream ifs(startup_manifest_path_.c_str());
+			if (ifs)
+			{
+				manifest.Load(ifs);
+			}
+		}
+		manifest.WarmFiles();
+		manifest.StartRecording();
+
 		ContextCfg cfg = Context::Instance().Config();
 
 		if (cfg.deferred_rendering)
@@ -571,12 +589,24 @@ namespace KlayGE
 	{
 #endif
 		ContextCfg cfg = Context::Instance().Config();
-		Context::Instance().RenderFactoryInstance().RenderEngineInstance().CreateRenderWindow(name_,
-			cfg.graphics_cfg);
+		{
+			StartupPhaseTimer phase_timer("Create render window");
+			Context::Instance().RenderFactoryInstance().RenderEngineInstance().CreateRenderWindow(name_,
+				cfg.graphics_cfg);
+		}
+		{
+			StartupPhaseTimer phase_timer("Wait for plugins");
+			Context::Instance().WaitForPlugins();
+		}
 		Context::Instance().Config(cfg);
 
-		this->OnCreate();
-		this->OnResize(cfg.graphics_cfg.width, cfg.graphics_cfg.height);
+		Context::Instance().StartupManifestInstance().PreloadTextures();
+
+		{
+			StartupPhaseTimer phase_timer("Create app");
+			this->OnCreate();
+			this->OnResize(cfg.graphics_cfg.width, cfg.graphics_cfg.height);
+		}
 	}
 
 	void App3DFramework::Destroy()
@@ -810,6 +840,11 @@ namespace KlayGE
 		if (0 == pass)
 		{
 			this->UpdateStats();
+			if (2 == total_num_frames_)
+			{
+				// The first frame is done
+				this->FinishStartup();
+			}
 			this->DoUpdateOverlay();
 
 			ResLoader::Instance().Update();
@@ -850,6 +885,19 @@ namespace KlayGE
 		timer_.restart();
 	}
 
+	void App3DFramework::FinishStartup()
+	{
+		auto& manifest = Context::Instance().StartupManifestInstance();
+		manifest.StopRecording();
+		manifest.ReleasePreloaded();
+		{
+			std::ofstream ofs(startup_manifest_path_.c_str());
+			manifest.Save(ofs);
+		}
+
+		Context::Instance().LogStartupPhases();
+	}
+
 	uint32_t App3DFramework::TotalNumFrames() const
 	{
 		return total_num_frames_;
@@ -29,9 +29,124 @@
  */
 
 #include <KlayGE/KlayGE.hpp>
+#include <KFL/CustomizedStreamBuf.hpp>
+#include <KFL/Hash.hpp>
+#include <KFL/ResIdentifier.hpp>
+#include <KFL/Util.hpp>
+#include <KlayGE/Context.hpp>
+#include <KlayGE/ResLoader.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <istream>
+
+#include <boost/assert.hpp>
 
 #include <KlayGE/AudioDataSource.hpp>
 
+namespace
+{
+	using namespace KlayGE;
+
+	class SoundLoadingDesc : public ResLoadingDesc
+	{
+	private:
+		struct SoundDesc
+		{
+			std::string res_name;
+			bool compressed;
+
+			std::shared_ptr<SoundDataPtr> sound;
+		};
+
+	public:
+		SoundLoadingDesc(std::string_view res_name, bool compressed)
+		{
+			sound_desc_.res_name = std::string(res_name);
+			sound_desc_.compressed = compressed;
+			sound_desc_.sound = MakeSharedPtr<SoundDataPtr>();
+		}
+
+		uint64_t Type() const override
+		{
+			static uint64_t const type = CT_HASH("SoundLoadingDesc");
+			return type;
+		}
+
+		bool StateLess() const override
+		{
+			return true;
+		}
+
+		std::shared_ptr<void> CreateResource() override
+		{
+			*sound_desc_.sound = MakeSharedPtr<SoundData>();
+			return *sound_desc_.sound;
+		}
+
+		void SubThreadStage() override
+		{
+			this->Load();
+		}
+
+		void MainThreadStage() override
+		{
+			this->Load();
+		}
+
+		bool HasSubThreadStage() const override
+		{
+			return true;
+		}
+
+		bool Match(ResLoadingDesc const & rhs) const override
+		{
+			if (this->Type() == rhs.Type())
+			{
+				SoundLoadingDesc const & sld = static_cast<SoundLoadingDesc const &>(rhs);
+				return (sound_desc_.res_name == sld.sound_desc_.res_name)
+					&& (sound_desc_.compressed == sld.sound_desc_.compressed);
+			}
+			return false;
+		}
+
+		void CopyDataFrom(ResLoadingDesc const & rhs) override
+		{
+			BOOST_ASSERT(this->Type() == rhs.Type());
+
+			SoundLoadingDesc const & sld = static_cast<SoundLoadingDesc const &>(rhs);
+			sound_desc_.res_name = sld.sound_desc_.res_name;
+			sound_desc_.compressed = sld.sound_desc_.compressed;
+			sound_desc_.sound = sld.sound_desc_.sound;
+		}
+
+		std::shared_ptr<void> CloneResourceFrom(std::shared_ptr<void> const & resource) override
+		{
+			return resource;
+		}
+
+		std::shared_ptr<void> Resource() const override
+		{
+			return *sound_desc_.sound;
+		}
+
+	private:
+		void Load()
+		{
+			SoundDataPtr const & sound = *sound_desc_.sound;
+			BOOST_ASSERT(sound);
+
+			if (!sound->Ready())
+			{
+				sound->Load(ResLoader::Instance().Open(sound_desc_.res_name), sound_desc_.compressed);
+			}
+		}
+
+	private:
+		SoundDesc sound_desc_;
+	};
+}
+
 namespace KlayGE
 {
 	AudioDataSource::~AudioDataSource()
@@ -48,6 +163,147 @@ namespace KlayGE
 		return freq_;
 	}
 
+	std::shared_ptr<std::vector<uint8_t> const> AudioDataSource::SharedPCM() const
+	{
+		return std::shared_ptr<std::vector<uint8_t> const>();
+	}
+
+
+	PCMAudioDataSource::PCMAudioDataSource(AudioFormat format, uint32_t freq,
+			std::shared_ptr<std::vector<uint8_t> const> const & pcm)
+		: pcm_(pcm), pos_(0)
+	{
+		BOOST_ASSERT(pcm_);
+
+		format_ = format;
+		freq_ = freq;
+	}
+
+	void PCMAudioDataSource::Open(ResIdentifierPtr const & file)
+	{
+		KFL_UNUSED(file);
+
+		// The PCM is given to the constructor
+		pos_ = 0;
+	}
+
+	void PCMAudioDataSource::Close()
+	{
+		pos_ = 0;
+	}
+
+	size_t PCMAudioDataSource::Size()
+	{
+		return pcm_->size();
+	}
+
+	size_t PCMAudioDataSource::Read(void* data, size_t size)
+	{
+		size_t const read_size = std::min(size, pcm_->size() - pos_);
+		if (read_size > 0)
+		{
+			memcpy(data, pcm_->data() + pos_, read_size);
+			pos_ += read_size;
+		}
+		return read_size;
+	}
+
+	void PCMAudioDataSource::Reset()
+	{
+		pos_ = 0;
+	}
+
+	std::shared_ptr<std::vector<uint8_t> const> PCMAudioDataSource::SharedPCM() const
+	{
+		return pcm_;
+	}
+
+
+	SoundData::SoundData()
+		: timestamp_(0), compressed_(false), format_(AF_Unknown), freq_(0), ready_(false)
+	{
+	}
+
+	void SoundData::Load(ResIdentifierPtr const & file, bool compressed)
+	{
+		std::lock_guard<std::mutex> lock(load_mutex_);
+
+		if (ready_)
+		{
+			return;
+		}
+
+		compressed_ = compressed;
+		if (file)
+		{
+			name_ = file->ResName();
+			timestamp_ = file->Timestamp();
+
+			AudioDataSourcePtr source;
+			if (compressed)
+			{
+				auto data = MakeSharedPtr<std::vector<uint8_t>>();
+				file->seekg(0, std::ios_base::end);
+				data->resize(static_cast<size_t>(file->tellg()));
+				file->seekg(0, std::ios_base::beg);
+				file->read(data->data(), data->size());
+				data_ = data;
+
+				source = this->OpenCompressed();
+			}
+			else
+			{
+				source = Context::Instance().AudioDataSourceFactoryInstance().MakeAudioDataSource();
+				source->Open(file);
+
+				auto pcm = MakeSharedPtr<std::vector<uint8_t>>(source->Size());
+				pcm->resize(source->Read(pcm->data(), pcm->size()));
+				data_ = pcm;
+			}
+
+			format_ = source->Format();
+			freq_ = source->Freq();
+			source->Close();
+		}
+
+		ready_ = true;
+	}
+
+	AudioDataSourcePtr SoundData::MakeDataSource() const
+	{
+		BOOST_ASSERT(ready_);
+
+		if (!data_)
+		{
+			return AudioDataSourcePtr();
+		}
+
+		if (compressed_)
+		{
+			return this->OpenCompressed();
+		}
+		else
+		{
+			return MakeSharedPtr<PCMAudioDataSource>(format_, freq_, data_);
+		}
+	}
+
+	AudioDataSourcePtr SoundData::OpenCompressed() const
+	{
+		// The stream buffer holds a reference to the file, which lives as long as any source decoding from it
+		auto const data = data_;
+		std::shared_ptr<std::streambuf> buf(new MemInputStreamBuf(data->data(), data->size()),
+			[data](std::streambuf* p)
+			{
+				delete p;
+			});
+		auto is = MakeSharedPtr<std::istream>(buf.get());
+
+		AudioDataSourcePtr source = Context::Instance().AudioDataSourceFactoryInstance().MakeAudioDataSource();
+		source->Open(MakeSharedPtr<ResIdentifier>(name_, timestamp_, is, buf));
+		return source;
+	}
+
 
 	void AudioDataSourceFactory::Suspend()
 	{
@@ -58,4 +314,15 @@ namespace KlayGE
 	{
 		this->DoResume();
 	}
+
+
+	SoundDataPtr SyncLoadSound(std::string_view sound_name, bool compressed)
+	{
+		return ResLoader::Instance().SyncQueryT<SoundData>(MakeSharedPtr<SoundLoadingDesc>(sound_name, compressed));
+	}
+
+	SoundDataPtr ASyncLoadSound(std::string_view sound_name, bool compressed)
+	{
+		return ResLoader::Instance().ASyncQueryT<SoundData>(MakeSharedPtr<SoundLoadingDesc>(sound_name, compressed));
+	}
 }
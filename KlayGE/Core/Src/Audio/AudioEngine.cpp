@@ -37,7 +37,8 @@
 namespace KlayGE
 {
 	AudioEngine::AudioEngine()
-		: sound_vol_(1), music_vol_(1)
+		: streamer_(MakeSharedPtr<AudioStreamer>(true)),
+			sound_vol_(1), music_vol_(1)
 	{
 	}
 
@@ -110,6 +111,11 @@ namespace KlayGE
 		KFL_UNREACHABLE("Invalid buffer id");
 	}
 
+	AudioStreamerPtr const & AudioEngine::Streamer() const
+	{
+		return streamer_;
+	}
+
 	void AudioEngine::SoundVolume(float vol)
 	{
 		sound_vol_ = vol;
@@ -0,0 +1,436 @@
+/**
+ * @file AudioMixer.cpp
+ * @author Minmin Gong
+ *
+ * @section DESCRIPTION
+ *
+ * This source file is part of KlayGE
+ * For the latest info, see http://www.klayge.org
+ *
+ * @section LICENSE
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * You may alternatively use this source under the terms of
+ * the KlayGE Proprietary License (KPL). You can obtained such a license
+ * from http://www.klayge.org/licensing/.
+ */
+
+#include <KlayGE/KlayGE.hpp>
+#include <KFL/Util.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <ostream>
+
+#include <boost/assert.hpp>
+
+#if defined(KLAYGE_SSE2_SUPPORT)
+#include <emmintrin.h>
+#endif
+
+#include <KlayGE/AudioMixer.hpp>
+
+namespace
+{
+	using namespace KlayGE;
+
+	uint64_t constexpr ONE_FRAME = 1ULL << 32;
+	float constexpr MAX_PITCH = 8;
+
+	float constexpr REFERENCE_DISTANCE = 1;
+	float constexpr SPEED_OF_SOUND = 343;
+
+	// The top 24 bits of the fraction, exact in a float
+	float Frac(uint64_t pos)
+	{
+		return static_cast<float>(static_cast<uint32_t>(pos) >> 8) * (1.0f / (1UL << 24));
+	}
+
+	// Linear resampling of num_frames frames starting at the 32.32 position pos, accumulated into interleaved stereo output.
+	// A mono source goes to both sides. The gain of frame j is gain + gain_step * j.
+	template <uint32_t NUM_CHANNELS>
+	void MixFrames(float const * src, uint64_t pos, uint64_t step, float* output, uint32_t num_frames,
+		float gain_left, float gain_right, float gain_step_left, float gain_step_right)
+	{
+		uint32_t j = 0;
+
+#if defined(KLAYGE_SSE2_SUPPORT)
+		__m128 const ramp = _mm_set_ps(3, 2, 1, 0);
+		__m128 const gl = _mm_set1_ps(gain_left);
+		__m128 const gr = _mm_set1_ps(gain_right);
+		__m128 const dgl = _mm_set1_ps(gain_step_left);
+		__m128 const dgr = _mm_set1_ps(gain_step_right);
+
+		if ((ONE_FRAME == step) && (0 == static_cast<uint32_t>(pos)))
+		{
+			// Same rate and aligned, no interpolation
+			float const * s = src + (pos >> 32) * NUM_CHANNELS;
+			for (; j + 4 <= num_frames; j += 4)
+			{
+				__m128 const frame = _mm_add_ps(_mm_set1_ps(static_cast<float>(j)), ramp);
+				__m128 const gain_l = _mm_add_ps(gl, _mm_mul_ps(dgl, frame));
+				__m128 const gain_r = _mm_add_ps(gr, _mm_mul_ps(dgr, frame));
+
+				__m128 lo;
+				__m128 hi;
+				if (1 == NUM_CHANNELS)
+				{
+					__m128 const v = _mm_loadu_ps(s + j);
+					lo = _mm_unpacklo_ps(_mm_mul_ps(v, gain_l), _mm_mul_ps(v, gain_r));
+					hi = _mm_unpackhi_ps(_mm_mul_ps(v, gain_l), _mm_mul_ps(v, gain_r));
+				}
+				else
+				{
+					lo = _mm_mul_ps(_mm_loadu_ps(s + j * 2 + 0), _mm_unpacklo_ps(gain_l, gain_r));
+					hi = _mm_mul_ps(_mm_loadu_ps(s + j * 2 + 4), _mm_unpackhi_ps(gain_l, gain_r));
+				}
+
+				_mm_storeu_ps(output + j * 2 + 0, _mm_add_ps(_mm_loadu_ps(output + j * 2 + 0), lo));
+				_mm_storeu_ps(output + j * 2 + 4, _mm_add_ps(_mm_loadu_ps(output + j * 2 + 4), hi));
+			}
+		}
+		else
+		{
+			for (; j + 4 <= num_frames; j += 4)
+			{
+				uint64_t const p0 = pos + step * (j + 0);
+				uint64_t const p1 = pos + step * (j + 1);
+				uint64_t const p2 = pos + step * (j + 2);
+				uint64_t const p3 = pos + step * (j + 3);
+				float const * s0 = src + (p0 >> 32) * NUM_CHANNELS;
+				float const * s1 = src + (p1 >> 32) * NUM_CHANNELS;
+				float const * s2 = src + (p2 >> 32) * NUM_CHANNELS;
+				float const * s3 = src + (p3 >> 32) * NUM_CHANNELS;
+				__m128 const frac = _mm_set_ps(Frac(p3), Frac(p2), Frac(p1), Frac(p0));
+
+				__m128 const a_l = _mm_set_ps(s3[0], s2[0], s1[0], s0[0]);
+				__m128 const b_l = _mm_set_ps(s3[NUM_CHANNELS], s2[NUM_CHANNELS], s1[NUM_CHANNELS], s0[NUM_CHANNELS]);
+				__m128 const v_l = _mm_add_ps(a_l, _mm_mul_ps(_mm_sub_ps(b_l, a_l), frac));
+				__m128 v_r;
+				if (1 == NUM_CHANNELS)
+				{
+					v_r = v_l;
+				}
+				else
+				{
+					__m128 const a_r = _mm_set_ps(s3[1], s2[1], s1[1], s0[1]);
+					__m128 const b_r = _mm_set_ps(s3[3], s2[3], s1[3], s0[3]);
+					v_r = _mm_add_ps(a_r, _mm_mul_ps(_mm_sub_ps(b_r, a_r), frac));
+				}
+
+				__m128 const frame = _mm_add_ps(_mm_set1_ps(static_cast<float>(j)), ramp);
+				__m128 const l = _mm_mul_ps(v_l, _mm_add_ps(gl, _mm_mul_ps(dgl, frame)));
+				__m128 const r = _mm_mul_ps(v_r, _mm_add_ps(gr, _mm_mul_ps(dgr, frame)));
+
+				_mm_storeu_ps(output + j * 2 + 0, _mm_add_ps(_mm_loadu_ps(output + j * 2 + 0), _mm_unpacklo_ps(l, r)));
+				_mm_storeu_ps(output + j * 2 + 4, _mm_add_ps(_mm_loadu_ps(output + j * 2 + 4), _mm_unpackhi_ps(l, r)));
+			}
+		}
+#endif
+
+		for (; j < num_frames; ++ j)
+		{
+			uint64_t const p = pos + step * j;
+			float const * s = src + (p >> 32) * NUM_CHANNELS;
+			float const frac = Frac(p);
+
+			float const v_l = s[0] + (s[NUM_CHANNELS] - s[0]) * frac;
+			float const v_r = (1 == NUM_CHANNELS) ? v_l : s[1] + (s[3] - s[1]) * frac;
+
+			float const frame = static_cast<float>(j);
+			output[j * 2 + 0] += v_l * (gain_left + gain_step_left * frame);
+			output[j * 2 + 1] += v_r * (gain_right + gain_step_right * frame);
+		}
+	}
+
+	template <typename T>
+	void WriteLE(std::ostream& os, T value)
+	{
+		value = Native2LE(value);
+		os.write(reinterpret_cast<char const *>(&value), sizeof(value));
+	}
+}
+
+namespace KlayGE
+{
+	void FloatToPCM16(float const * src, int16_t* dst, uint32_t num_samples)
+	{
+		uint32_t i = 0;
+
+#if defined(KLAYGE_SSE2_SUPPORT)
+		__m128 const one = _mm_set1_ps(1);
+		__m128 const minus_one = _mm_set1_ps(-1);
+		__m128 const scale = _mm_set1_ps(32767);
+		for (; i + 8 <= num_samples; i += 8)
+		{
+			__m128 const v0 = _mm_mul_ps(_mm_max_ps(_mm_min_ps(_mm_loadu_ps(src + i + 0), one), minus_one), scale);
+			__m128 const v1 = _mm_mul_ps(_mm_max_ps(_mm_min_ps(_mm_loadu_ps(src + i + 4), one), minus_one), scale);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i),
+				_mm_packs_epi32(_mm_cvtps_epi32(v0), _mm_cvtps_epi32(v1)));
+		}
+#endif
+
+		// lrint rounds to nearest even, as _mm_cvtps_epi32 does
+		for (; i < num_samples; ++ i)
+		{
+			dst[i] = static_cast<int16_t>(std::lrint(std::min(std::max(src[i], -1.0f), 1.0f) * 32767));
+		}
+	}
+
+
+	AudioSink::~AudioSink()
+	{
+	}
+
+
+	void NullAudioSink::Write(float const * frames, uint32_t num_frames)
+	{
+		KFL_UNUSED(frames);
+		KFL_UNUSED(num_frames);
+	}
+
+
+	WavAudioSink::WavAudioSink(std::shared_ptr<std::ostream> const & os, uint32_t freq)
+		: os_(os), header_pos_(os->tellp()), freq_(freq), num_frames_(0)
+	{
+		this->WriteHeader();
+	}
+
+	WavAudioSink::~WavAudioSink()
+	{
+		this->Close();
+	}
+
+	void WavAudioSink::Write(float const * frames, uint32_t num_frames)
+	{
+		pcm_.resize(num_frames * 2);
+		FloatToPCM16(frames, pcm_.data(), num_frames * 2);
+		for (auto& sample : pcm_)
+		{
+			sample = Native2LE(sample);
+		}
+		os_->write(reinterpret_cast<char const *>(pcm_.data()), pcm_.size() * sizeof(pcm_[0]));
+
+		num_frames_ += num_frames;
+	}
+
+	void WavAudioSink::Close()
+	{
+		if (header_pos_ >= 0)
+		{
+			std::streamoff const end_pos = os_->tellp();
+			os_->seekp(header_pos_);
+			this->WriteHeader();
+			os_->seekp(end_pos);
+		}
+		os_->flush();
+	}
+
+	void WavAudioSink::WriteHeader()
+	{
+		uint16_t constexpr NUM_CHANNELS = 2;
+		uint16_t constexpr BITS_PER_SAMPLE = 16;
+		uint16_t constexpr BLOCK_ALIGN = NUM_CHANNELS * BITS_PER_SAMPLE / 8;
+		uint32_t const data_size = static_cast<uint32_t>(num_frames_ * BLOCK_ALIGN);
+
+		os_->write("RIFF", 4);
+		WriteLE<uint32_t>(*os_, 36 + data_size);
+		os_->write("WAVE", 4);
+
+		os_->write("fmt ", 4);
+		WriteLE<uint32_t>(*os_, 16);
+		WriteLE<uint16_t>(*os_, 1);
+		WriteLE<uint16_t>(*os_, NUM_CHANNELS);
+		WriteLE<uint32_t>(*os_, freq_);
+		WriteLE<uint32_t>(*os_, freq_ * BLOCK_ALIGN);
+		WriteLE<uint16_t>(*os_, BLOCK_ALIGN);
+		WriteLE<uint16_t>(*os_, BITS_PER_SAMPLE);
+
+		os_->write("data", 4);
+		WriteLE<uint32_t>(*os_, data_size);
+	}
+
+
+	AudioVoice::AudioVoice(uint32_t num_channels, uint32_t freq)
+		: num_channels_(num_channels), freq_(freq),
+			gain_left_(0), gain_right_(0), target_gain_left_(0), target_gain_right_(0), pitch_(1),
+			window_frames_(0), pos_(0), source_ended_(false), finished_(false)
+	{
+		BOOST_ASSERT((1 == num_channels) || (2 == num_channels));
+	}
+
+	AudioVoice::~AudioVoice()
+	{
+	}
+
+	void AudioVoice::Gains(float left, float right)
+	{
+		target_gain_left_ = left;
+		target_gain_right_ = right;
+	}
+
+	void AudioVoice::Pitch(float pitch)
+	{
+		pitch_ = pitch;
+	}
+
+
+	AudioMixer::AudioMixer(uint32_t freq)
+		: freq_(freq)
+	{
+	}
+
+	void AudioMixer::AddVoice(AudioVoicePtr const & voice)
+	{
+		BOOST_ASSERT(std::find(voices_.begin(), voices_.end(), voice) == voices_.end());
+
+		// Starts at the target gains, instead of fading in from silence
+		voice->gain_left_ = voice->target_gain_left_;
+		voice->gain_right_ = voice->target_gain_right_;
+		voices_.push_back(voice);
+	}
+
+	void AudioMixer::RemoveVoice(AudioVoice const * voice)
+	{
+		auto iter = std::find_if(voices_.begin(), voices_.end(),
+			[voice](AudioVoicePtr const & v) { return v.get() == voice; });
+		if (iter != voices_.end())
+		{
+			voices_.erase(iter);
+		}
+	}
+
+	uint32_t AudioMixer::NumVoices() const
+	{
+		return static_cast<uint32_t>(voices_.size());
+	}
+
+	void AudioMixer::Mix(float* output, uint32_t num_frames)
+	{
+		memset(output, 0, num_frames * 2 * sizeof(output[0]));
+		if (0 == num_frames)
+		{
+			return;
+		}
+
+		for (auto const & voice : voices_)
+		{
+			this->MixVoice(*voice, output, num_frames);
+		}
+
+		voices_.erase(std::remove_if(voices_.begin(), voices_.end(),
+			[](AudioVoicePtr const & voice) { return voice->Finished(); }), voices_.end());
+	}
+
+	void AudioMixer::MixVoice(AudioVoice& voice, float* output, uint32_t num_frames)
+	{
+		if (voice.finished_)
+		{
+			return;
+		}
+
+		uint32_t const num_channels = voice.num_channels_;
+		float const pitch = std::min(std::max(voice.pitch_, 0.0f), MAX_PITCH);
+		uint64_t const step = std::max<uint64_t>(
+			static_cast<uint64_t>(static_cast<double>(pitch) * voice.freq_ / freq_ * ONE_FRAME + 0.5), 1);
+
+		// One more frame than the last read position, for the interpolation
+		uint32_t const needed = static_cast<uint32_t>((voice.pos_ + step * (num_frames - 1)) >> 32) + 2;
+		if (voice.window_.size() < needed * num_channels)
+		{
+			voice.window_.resize(needed * num_channels);
+		}
+		if ((voice.window_frames_ < needed) && !voice.source_ended_)
+		{
+			uint32_t const requested = needed - voice.window_frames_;
+			uint32_t const fetched = voice.Fetch(&voice.window_[voice.window_frames_ * num_channels], requested);
+			BOOST_ASSERT(fetched <= requested);
+			voice.window_frames_ += fetched;
+			voice.source_ended_ = (fetched < requested);
+		}
+		if (voice.window_frames_ < needed)
+		{
+			std::fill(voice.window_.begin() + voice.window_frames_ * num_channels, voice.window_.begin() + needed * num_channels,
+				0.0f);
+		}
+
+		uint32_t num_valid_frames = num_frames;
+		if (voice.source_ended_)
+		{
+			uint64_t const end_pos = static_cast<uint64_t>(voice.window_frames_) << 32;
+			num_valid_frames = (voice.pos_ < end_pos)
+				? static_cast<uint32_t>(std::min<uint64_t>((end_pos - voice.pos_ + step - 1) / step, num_frames)) : 0;
+		}
+
+		float const gain_step_left = (voice.target_gain_left_ - voice.gain_left_) / num_frames;
+		float const gain_step_right = (voice.target_gain_right_ - voice.gain_right_) / num_frames;
+		if (1 == num_channels)
+		{
+			MixFrames<1>(voice.window_.data(), voice.pos_, step, output, num_valid_frames,
+				voice.gain_left_, voice.gain_right_, gain_step_left, gain_step_right);
+		}
+		else
+		{
+			MixFrames<2>(voice.window_.data(), voice.pos_, step, output, num_valid_frames,
+				voice.gain_left_, voice.gain_right_, gain_step_left, gain_step_right);
+		}
+		voice.gain_left_ = voice.target_gain_left_;
+		voice.gain_right_ = voice.target_gain_right_;
+
+		voice.pos_ += step * num_frames;
+		uint32_t const consumed = static_cast<uint32_t>(std::min<uint64_t>(voice.pos_ >> 32, voice.window_frames_));
+		if (consumed > 0)
+		{
+			memmove(voice.window_.data(), &voice.window_[consumed * num_channels],
+				(voice.window_frames_ - consumed) * num_channels * sizeof(float));
+			voice.window_frames_ -= consumed;
+			voice.pos_ -= static_cast<uint64_t>(consumed) << 32;
+		}
+
+		voice.finished_ = voice.source_ended_ && ((voice.pos_ >> 32) >= voice.window_frames_);
+	}
+
+	void AudioMixer::Spatialize(float3 const & listener_pos, float3 const & listener_vel,
+		float3 const & listener_face, float3 const & listener_up,
+		float3 const & pos, float3 const & vel,
+		float& gain_left, float& gain_right, float& pitch)
+	{
+		float3 const to_source = pos - listener_pos;
+		float const dist = MathLib::length(to_source);
+
+		float pan = 0;
+		pitch = 1;
+		if (dist > 1e-6f)
+		{
+			float3 const dir = to_source / dist;
+
+			float3 const right = MathLib::normalize(MathLib::cross(listener_up, listener_face));
+			pan = MathLib::clamp(MathLib::dot(dir, right), -1.0f, 1.0f);
+
+			// Velocities projected on the source to listener direction. Limiting them keeps the pitch in [1/3, 3].
+			float const max_speed = SPEED_OF_SOUND / 2;
+			float const listener_speed = MathLib::clamp(-MathLib::dot(dir, listener_vel), -max_speed, max_speed);
+			float const source_speed = MathLib::clamp(-MathLib::dot(dir, vel), -max_speed, max_speed);
+			pitch = (SPEED_OF_SOUND - listener_speed) / (SPEED_OF_SOUND - source_speed);
+		}
+
+		float const attenuation = REFERENCE_DISTANCE / std::max(dist, REFERENCE_DISTANCE);
+		float const angle = (pan + 1) * (PI / 4);
+		gain_left = attenuation * std::cos(angle);
+		gain_right = attenuation * std::sin(angle);
+	}
+}
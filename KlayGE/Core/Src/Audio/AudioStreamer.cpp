@@ -0,0 +1,276 @@
+/**
+ * @file AudioStreamer.cpp
+ * @author Minmin Gong
+ *
+ * @section DESCRIPTION
+ *
+ * This source file is part of KlayGE
+ * For the latest info, see http://www.klayge.org
+ *
+ * @section LICENSE
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * You may alternatively use this source under the terms of
+ * the KlayGE Proprietary License (KPL). You can obtained such a license
+ * from http://www.klayge.org/licensing/.
+ */
+
+#include <KlayGE/KlayGE.hpp>
+#include <KFL/ErrorHandling.hpp>
+#include <KlayGE/AudioDataSource.hpp>
+#include <KlayGE/Context.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <queue>
+
+#include <boost/assert.hpp>
+
+#include <KlayGE/Audio.hpp>
+
+namespace
+{
+	using namespace KlayGE;
+
+	// Each decoding step covers 1/8 second, small enough to switch to a starving stream quickly
+	uint32_t constexpr DECODES_PER_SECOND = 8;
+	// Device queues hold at least half a second, polling them 10 times a second keeps them topped up
+	uint32_t constexpr UPDATES_PER_SECOND = 10;
+
+	uint32_t FormatBlockAlign(AudioFormat format)
+	{
+		switch (format)
+		{
+		case AF_Mono8:
+			return 1;
+
+		case AF_Mono16:
+		case AF_Stereo8:
+			return 2;
+
+		case AF_Stereo16:
+			return 4;
+
+		default:
+			KFL_UNREACHABLE("Invalid audio format");
+		}
+	}
+}
+
+namespace KlayGE
+{
+	AudioStream::AudioStream(AudioDataSourcePtr const & data_source, uint32_t buffer_seconds)
+		: data_source_(data_source),
+			bytes_per_sec_(FormatBlockAlign(data_source->Format()) * data_source->Freq()),
+			block_align_(FormatBlockAlign(data_source->Format())),
+			capacity_(std::max(bytes_per_sec_ * buffer_seconds, bytes_per_sec_ / DECODES_PER_SECOND)),
+			ring_(capacity_ + 1),
+			loop_(false), source_ended_(false), num_underruns_(0)
+	{
+		capacity_ -= capacity_ % block_align_;
+	}
+
+	void AudioStream::Loop(bool loop)
+	{
+		loop_ = loop;
+	}
+
+	void AudioStream::Reset()
+	{
+		ring_.reset();
+		data_source_->Reset();
+		source_ended_ = false;
+	}
+
+	void AudioStream::Fill()
+	{
+		while (this->Decode(capacity_) > 0);
+	}
+
+	size_t AudioStream::Read(void* data, size_t size)
+	{
+		size_t const read_size = ring_.pop(static_cast<uint8_t*>(data), size);
+		if ((read_size < size) && !source_ended_)
+		{
+			++ num_underruns_;
+		}
+		return read_size;
+	}
+
+	bool AudioStream::EndOfStream() const
+	{
+		return source_ended_ && (0 == ring_.read_available());
+	}
+
+	uint32_t AudioStream::NumUnderruns() const
+	{
+		return num_underruns_;
+	}
+
+	float AudioStream::BufferedSeconds() const
+	{
+		return static_cast<float>(capacity_ - std::min(ring_.write_available(), capacity_)) / bytes_per_sec_;
+	}
+
+	bool AudioStream::Full() const
+	{
+		return source_ended_ || (ring_.write_available() < block_align_);
+	}
+
+	size_t AudioStream::Decode(size_t size)
+	{
+		size = std::min(size, ring_.write_available());
+		size -= size % block_align_;
+		decode_buff_.resize(size);
+
+		size_t decoded = 0;
+		bool rewound = false;
+		while ((decoded < size) && !source_ended_)
+		{
+			size_t const read_size = data_source_->Read(&decode_buff_[decoded], size - decoded);
+			if (read_size > 0)
+			{
+				decoded += read_size;
+				rewound = false;
+			}
+			else if (loop_ && !rewound)
+			{
+				data_source_->Reset();
+				rewound = true;
+			}
+			else
+			{
+				source_ended_ = true;
+			}
+		}
+
+		ring_.push(decode_buff_.data(), decoded);
+		return decoded;
+	}
+
+
+	AudioStreamer::AudioStreamer(bool threaded)
+		: retired_underruns_(0), quit_(false)
+	{
+		if (threaded)
+		{
+			service_thread_ = MakeUniquePtr<joiner<void>>(Context::Instance().ThreadPool()(
+				[this] { this->ServiceThreadFunc(); }));
+		}
+	}
+
+	AudioStreamer::~AudioStreamer()
+	{
+		if (service_thread_)
+		{
+			{
+				std::lock_guard<std::mutex> lock(streams_mutex_);
+				quit_ = true;
+			}
+			streams_cond_.notify_one();
+			(*service_thread_)();
+		}
+	}
+
+	void AudioStreamer::Register(AudioStreamPtr const & stream, std::function<void()> const & consumer)
+	{
+		{
+			std::lock_guard<std::mutex> lock(streams_mutex_);
+			BOOST_ASSERT(std::find_if(streams_.begin(), streams_.end(),
+				[&stream](StreamEntry const & entry) { return entry.stream == stream; }) == streams_.end());
+			streams_.push_back({ stream, consumer });
+		}
+		streams_cond_.notify_one();
+	}
+
+	void AudioStreamer::Unregister(AudioStreamPtr const & stream)
+	{
+		std::lock_guard<std::mutex> lock(streams_mutex_);
+		auto iter = std::find_if(streams_.begin(), streams_.end(),
+			[&stream](StreamEntry const & entry) { return entry.stream == stream; });
+		if (iter != streams_.end())
+		{
+			retired_underruns_ += iter->stream->NumUnderruns();
+			streams_.erase(iter);
+		}
+	}
+
+	void AudioStreamer::Update()
+	{
+		std::lock_guard<std::mutex> lock(streams_mutex_);
+		this->DoUpdate();
+	}
+
+	uint32_t AudioStreamer::NumUnderruns() const
+	{
+		std::lock_guard<std::mutex> lock(streams_mutex_);
+		uint32_t num = retired_underruns_;
+		for (auto const & entry : streams_)
+		{
+			num += entry.stream->NumUnderruns();
+		}
+		return num;
+	}
+
+	void AudioStreamer::DoUpdate()
+	{
+		for (auto const & entry : streams_)
+		{
+			if (entry.consumer)
+			{
+				entry.consumer();
+			}
+		}
+
+		// The stream with the least buffered audio has the earliest deadline
+		typedef std::pair<float, AudioStream*> DeadlineType;
+		std::priority_queue<DeadlineType, std::vector<DeadlineType>, std::greater<DeadlineType>> deadlines;
+		for (auto const & entry : streams_)
+		{
+			if (!entry.stream->Full())
+			{
+				deadlines.emplace(entry.stream->BufferedSeconds(), entry.stream.get());
+			}
+		}
+		while (!deadlines.empty())
+		{
+			AudioStream* stream = deadlines.top().second;
+			deadlines.pop();
+
+			if ((stream->Decode(stream->BytesPerSecond() / DECODES_PER_SECOND) > 0) && !stream->Full())
+			{
+				deadlines.emplace(stream->BufferedSeconds(), stream);
+			}
+		}
+	}
+
+	void AudioStreamer::ServiceThreadFunc()
+	{
+		std::unique_lock<std::mutex> lock(streams_mutex_);
+		while (!quit_)
+		{
+			if (streams_.empty())
+			{
+				streams_cond_.wait(lock);
+			}
+			else
+			{
+				this->DoUpdate();
+				streams_cond_.wait_for(lock, std::chrono::milliseconds(1000 / UPDATES_PER_SECOND));
+			}
+		}
+	}
+}
@@ -30,18 +30,23 @@
 
 #include <KlayGE/KlayGE.hpp>
 #include <KlayGE/AudioDataSource.hpp>
+#include <KlayGE/AudioFactory.hpp>
+#include <KlayGE/Context.hpp>
 
 #include <KlayGE/Audio.hpp>
 
 namespace KlayGE
 {
-	MusicBuffer::MusicBuffer(AudioDataSourcePtr const & data_source)
-		: AudioBuffer(data_source)
+	MusicBuffer::MusicBuffer(AudioDataSourcePtr const & data_source, uint32_t buffer_seconds)
+		: AudioBuffer(data_source),
+			stream_(MakeSharedPtr<AudioStream>(data_source, buffer_seconds)),
+			streamer_(Context::Instance().AudioFactoryInstance().AudioEngineInstance().Streamer())
 	{
 	}
 
 	MusicBuffer::~MusicBuffer()
 	{
+		this->StopStreaming();
 	}
 
 	bool MusicBuffer::IsSound() const
@@ -51,23 +56,57 @@ namespace KlayGE
 
 	void MusicBuffer::Reset()
 	{
-		this->Stop();
+		this->StopStreaming();
+		this->DoStop();
 
+		stream_->Reset();
 		this->DoReset();
 	}
 
 	void MusicBuffer::Play(bool loop)
 	{
+		this->StopStreaming();
 		this->DoStop();
+
+		if (stream_->EndOfStream())
+		{
+			stream_->Reset();
+		}
+		stream_->Loop(loop);
+		stream_->Fill();
+
 		this->DoPlay(loop);
+		this->StartStreaming();
 	}
 
 	void MusicBuffer::Stop()
 	{
+		this->StopStreaming();
 		if (this->IsPlaying())
 		{
 			this->DoStop();
-			data_source_->Reset();
+			stream_->Reset();
+		}
+	}
+
+	uint32_t MusicBuffer::NumUnderruns() const
+	{
+		return stream_->NumUnderruns();
+	}
+
+	void MusicBuffer::StartStreaming()
+	{
+		if (auto streamer = streamer_.lock())
+		{
+			streamer->Register(stream_, [this] { this->DoUpdateBuffer(); });
+		}
+	}
+
+	void MusicBuffer::StopStreaming()
+	{
+		if (auto streamer = streamer_.lock())
+		{
+			streamer->Unregister(stream_);
 		}
 	}
 }
@@ -36,8 +36,17 @@
 namespace KlayGE
 {
 	SoundBuffer::SoundBuffer(AudioDataSourcePtr const & data_source)
-		: AudioBuffer(data_source)
+		: AudioBuffer(data_source),
+			pcm_(data_source->SharedPCM())
 	{
+		if (!pcm_)
+		{
+			data_source_->Reset();
+
+			auto pcm = MakeSharedPtr<std::vector<uint8_t>>(data_source_->Size());
+			pcm->resize(data_source_->Read(pcm->data(), pcm->size()));
+			pcm_ = pcm;
+		}
 	}
 
 	SoundBuffer::~SoundBuffer()
@@ -33,6 +33,7 @@
 #include <KlayGE/ScriptFactory.hpp>
 #include <KlayGE/AudioDataSource.hpp>
 #include <KlayGE/ResLoader.hpp>
+#include <KlayGE/StartupManifest.hpp>
 #include <KFL/XMLDom.hpp>
 #include <KlayGE/DeferredRenderingLayer.hpp>
 #include <KlayGE/PerfProfiler.hpp>
@@ -125,29 +126,42 @@ namespace KlayGE
 #endif
 
 		gtp_instance_ = MakeUniquePtr<thread_pool>(1, 16);
+		startup_manifest_ = MakeUniquePtr<StartupManifest>();
 	}
 
 	Context::~Context()
 	{
+		this->WaitForPlugins();
 	}
 
 	void Context::DestroyAll()
 	{
+		this->WaitForPlugins();
+
+		loaded_scene_mgr_.store(nullptr, std::memory_order_relaxed);
 		scene_mgr_.reset();
+		startup_manifest_.reset();
 
 		ResLoader::Destroy();
 		PerfProfiler::Destroy();
 		UIManager::Destroy();
 
 		deferred_rendering_layer_.reset();
+		loaded_show_factory_.store(nullptr, std::memory_order_relaxed);
 		show_factory_.reset();
+		loaded_render_factory_.store(nullptr, std::memory_order_relaxed);
 		render_factory_.reset();
+		loaded_audio_factory_.store(nullptr, std::memory_order_relaxed);
 		audio_factory_.reset();
+		loaded_input_factory_.store(nullptr, std::memory_order_relaxed);
 		input_factory_.reset();
+		loaded_script_factory_.store(nullptr, std::memory_order_relaxed);
 		script_factory_.reset();
+		loaded_audio_data_src_factory_.store(nullptr, std::memory_order_relaxed);
 		audio_data_src_factory_.reset();
 
 #if KLAYGE_IS_DEV_PLATFORM
+		loaded_dev_helper_.store(nullptr, std::memory_order_relaxed);
 		dev_helper_.reset();
 #endif
 
@@ -181,6 +195,9 @@ namespace KlayGE
 
 	void Context::Suspend()
 	{
+		// The plugins are accessed directly below
+		this->WaitForPlugins();
+
 		if (scene_mgr_)
 		{
 			scene_mgr_->Suspend();
@@ -265,7 +282,7 @@ namespace KlayGE
 	{
 #if defined(KLAYGE_PLATFORM_WINDOWS_DESKTOP)
 		static char const * available_rfs_array[] = { "D3D11", "OpenGL", "OpenGLES", "D3D12" };
-		static char const * available_afs_array[] = { "OpenAL", "XAudio" };
+		static char const * available_afs_array[] = { "OpenAL", "XAudio", "SoftAudio" };
 		static char const * available_adsfs_array[] = { "OggVorbis" };
 		static char const * available_ifs_array[] = { "MsgInput" };
 		static char const * available_sfs_array[] = { "DShow", "MFShow" };
@@ -279,7 +296,7 @@ namespace KlayGE
 		static char const * available_scfs_array[] = { "Python" };
 #elif defined(KLAYGE_PLATFORM_LINUX)
 		static char const * available_rfs_array[] = { "OpenGL" };
-		static char const * available_afs_array[] = { "OpenAL" };
+		static char const * available_afs_array[] = { "OpenAL", "SoftAudio" };
 		static char const * available_adsfs_array[] = { "OggVorbis" };
 		static char const * available_ifs_array[] = { "NullInput" };
 		static char const * available_sfs_array[] = { "NullShow" };
@@ -300,7 +317,7 @@ namespace KlayGE
 		static char const * available_scfs_array[] = { "NullScript" };
 #elif defined(KLAYGE_PLATFORM_DARWIN)
 		static char const * available_rfs_array[] = { "OpenGL" };
-		static char const * available_afs_array[] = { "OpenAL" };
+		static char const * available_afs_array[] = { "OpenAL", "SoftAudio" };
 		static char const * available_adsfs_array[] = { "OggVorbis" };
 		static char const * available_ifs_array[] = { "MsgInput" };
 		static char const * available_sfs_array[] = { "NullShow" };
@@ -964,6 +981,9 @@ namespace KlayGE
 
 	void Context::LoadRenderFactory(std::string const & rf_name)
 	{
+		StartupPhaseTimer phase_timer("Load render factory");
+
+		loaded_render_factory_.store(nullptr, std::memory_order_relaxed);
 		render_factory_.reset();
 
 #ifndef KLAYGE_STATIC_LINK_PLUGINS
@@ -989,10 +1009,15 @@ namespace KlayGE
 		KFL_UNUSED(rf_name);
 		MakeRenderFactory(render_factory_);
 #endif
+
+		loaded_render_factory_.store(render_factory_.get(), std::memory_order_release);
 	}
 
 	void Context::LoadAudioFactory(std::string const & af_name)
 	{
+		StartupPhaseTimer phase_timer("Load audio factory");
+
+		loaded_audio_factory_.store(nullptr, std::memory_order_relaxed);
 		audio_factory_.reset();
 
 #ifndef KLAYGE_STATIC_LINK_PLUGINS
@@ -1018,10 +1043,15 @@ namespace KlayGE
 		KFL_UNUSED(af_name);
 		MakeAudioFactory(audio_factory_);
 #endif
+
+		loaded_audio_factory_.store(audio_factory_.get(), std::memory_order_release);
 	}
 
 	void Context::LoadInputFactory(std::string const & if_name)
 	{
+		StartupPhaseTimer phase_timer("Load input factory");
+
+		loaded_input_factory_.store(nullptr, std::memory_order_relaxed);
 		input_factory_.reset();
 
 #ifndef KLAYGE_STATIC_LINK_PLUGINS
@@ -1047,10 +1077,15 @@ namespace KlayGE
 		KFL_UNUSED(if_name);
 		MakeInputFactory(input_factory_);
 #endif
+
+		loaded_input_factory_.store(input_factory_.get(), std::memory_order_release);
 	}
 
 	void Context::LoadShowFactory(std::string const & sf_name)
 	{
+		StartupPhaseTimer phase_timer("Load show factory");
+
+		loaded_show_factory_.store(nullptr, std::memory_order_relaxed);
 		show_factory_.reset();
 
 #ifndef KLAYGE_STATIC_LINK_PLUGINS
@@ -1076,10 +1111,15 @@ namespace KlayGE
 		KFL_UNUSED(sf_name);
 		MakeShowFactory(show_factory_);
 #endif
+
+		loaded_show_factory_.store(show_factory_.get(), std::memory_order_release);
 	}
 
 	void Context::LoadScriptFactory(std::string const & sf_name)
 	{
+		StartupPhaseTimer phase_timer("Load script factory");
+
+		loaded_script_factory_.store(nullptr, std::memory_order_relaxed);
 		script_factory_.reset();
 
 #ifndef KLAYGE_STATIC_LINK_PLUGINS
@@ -1105,10 +1145,15 @@ namespace KlayGE
 		KFL_UNUSED(sf_name);
 		MakeScriptFactory(script_factory_);
 #endif
+
+		loaded_script_factory_.store(script_factory_.get(), std::memory_order_release);
 	}
 
 	void Context::LoadSceneManager(std::string const & sm_name)
 	{
+		StartupPhaseTimer phase_timer("Load scene manager");
+
+		loaded_scene_mgr_.store(nullptr, std::memory_order_relaxed);
 		scene_mgr_.reset();
 
 #ifndef KLAYGE_STATIC_LINK_PLUGINS
@@ -1134,10 +1179,15 @@ namespace KlayGE
 		KFL_UNUSED(sm_name);
 		MakeSceneManager(scene_mgr_);
 #endif
+
+		loaded_scene_mgr_.store(scene_mgr_.get(), std::memory_order_release);
 	}
 
 	void Context::LoadAudioDataSourceFactory(std::string const & adsf_name)
 	{
+		StartupPhaseTimer phase_timer("Load audio data source factory");
+
+		loaded_audio_data_src_factory_.store(nullptr, std::memory_order_relaxed);
 		audio_data_src_factory_.reset();
 
 #ifndef KLAYGE_STATIC_LINK_PLUGINS
@@ -1163,11 +1213,16 @@ namespace KlayGE
 		KFL_UNUSED(adsf_name);
 		MakeAudioDataSourceFactory(audio_data_src_factory_);
 #endif
+
+		loaded_audio_data_src_factory_.store(audio_data_src_factory_.get(), std::memory_order_release);
 	}
 
 #if KLAYGE_IS_DEV_PLATFORM
 	void Context::LoadDevHelper()
 	{
+		StartupPhaseTimer phase_timer("Load dev helper");
+
+		loaded_dev_helper_.store(nullptr, std::memory_order_relaxed);
 		dev_helper_.reset();
 
 		dev_helper_loader_.Free();
@@ -1186,112 +1241,203 @@ namespace KlayGE
 			LogError() << "Loading " << path << " failed" << std::endl;
 			dev_helper_loader_.Free();
 		}
+
+		loaded_dev_helper_.store(dev_helper_.get(), std::memory_order_release);
 	}
 #endif
 
 	SceneManager& Context::SceneManagerInstance()
 	{
-		if (!scene_mgr_)
+		SceneManager* sm = loaded_scene_mgr_.load(std::memory_order_acquire);
+		if (!sm)
 		{
-			std::lock_guard<std::mutex> lock(singleton_mutex);
+			std::lock_guard<std::mutex> lock(scene_mgr_mutex_);
 			if (!scene_mgr_)
 			{
 				this->LoadSceneManager(cfg_.scene_manager_name);
 			}
+			sm = scene_mgr_.get();
 		}
-		return *scene_mgr_;
+		return *sm;
 	}
 
 	RenderFactory& Context::RenderFactoryInstance()
 	{
-		if (!render_factory_)
+		RenderFactory* rf = loaded_render_factory_.load(std::memory_order_acquire);
+		if (!rf)
 		{
-			std::lock_guard<std::mutex> lock(singleton_mutex);
+			std::lock_guard<std::mutex> lock(render_factory_mutex_);
 			if (!render_factory_)
 			{
 				this->LoadRenderFactory(cfg_.render_factory_name);
 			}
+			rf = render_factory_.get();
 		}
-		return *render_factory_;
+		return *rf;
 	}
 
 	AudioFactory& Context::AudioFactoryInstance()
 	{
-		if (!audio_factory_)
+		AudioFactory* af = loaded_audio_factory_.load(std::memory_order_acquire);
+		if (!af)
 		{
-			std::lock_guard<std::mutex> lock(singleton_mutex);
+			std::lock_guard<std::mutex> lock(audio_factory_mutex_);
 			if (!audio_factory_)
 			{
 				this->LoadAudioFactory(cfg_.audio_factory_name);
 			}
+			af = audio_factory_.get();
 		}
-		return *audio_factory_;
+		return *af;
 	}
 
 	InputFactory& Context::InputFactoryInstance()
 	{
-		if (!input_factory_)
+		InputFactory* inf = loaded_input_factory_.load(std::memory_order_acquire);
+		if (!inf)
 		{
-			std::lock_guard<std::mutex> lock(singleton_mutex);
+			std::lock_guard<std::mutex> lock(input_factory_mutex_);
 			if (!input_factory_)
 			{
 				this->LoadInputFactory(cfg_.input_factory_name);
 			}
+			inf = input_factory_.get();
 		}
-		return *input_factory_;
+		return *inf;
 	}
 
 	ShowFactory& Context::ShowFactoryInstance()
 	{
-		if (!show_factory_)
+		ShowFactory* sf = loaded_show_factory_.load(std::memory_order_acquire);
+		if (!sf)
 		{
-			std::lock_guard<std::mutex> lock(singleton_mutex);
+			std::lock_guard<std::mutex> lock(show_factory_mutex_);
 			if (!show_factory_)
 			{
 				this->LoadShowFactory(cfg_.show_factory_name);
 			}
+			sf = show_factory_.get();
 		}
-		return *show_factory_;
+		return *sf;
 	}
 
 	ScriptFactory& Context::ScriptFactoryInstance()
 	{
-		if (!script_factory_)
+		ScriptFactory* sf = loaded_script_factory_.load(std::memory_order_acquire);
+		if (!sf)
 		{
-			std::lock_guard<std::mutex> lock(singleton_mutex);
+			std::lock_guard<std::mutex> lock(script_factory_mutex_);
 			if (!script_factory_)
 			{
 				this->LoadScriptFactory(cfg_.script_factory_name);
 			}
+			sf = script_factory_.get();
 		}
-		return *script_factory_;
+		return *sf;
 	}
 
 	AudioDataSourceFactory& Context::AudioDataSourceFactoryInstance()
 	{
-		if (!audio_data_src_factory_)
+		AudioDataSourceFactory* adsf = loaded_audio_data_src_factory_.load(std::memory_order_acquire);
+		if (!adsf)
 		{
-			std::lock_guard<std::mutex> lock(singleton_mutex);
+			std::lock_guard<std::mutex> lock(audio_data_src_factory_mutex_);
 			if (!audio_data_src_factory_)
 			{
 				this->LoadAudioDataSourceFactory(cfg_.audio_data_source_factory_name);
 			}
+			adsf = audio_data_src_factory_.get();
 		}
-		return *audio_data_src_factory_;
+		return *adsf;
 	}
 
 #if KLAYGE_IS_DEV_PLATFORM
 	DevHelper& Context::DevHelperInstance()
 	{
-		if (!dev_helper_)
+		DevHelper* dh = loaded_dev_helper_.load(std::memory_order_acquire);
+		if (!dh)
 		{
-			std::lock_guard<std::mutex> lock(singleton_mutex);
+			std::lock_guard<std::mutex> lock(dev_helper_mutex_);
 			if (!dev_helper_)
 			{
 				this->LoadDevHelper();
 			}
+			dh = dev_helper_.get();
 		}
-		return *dev_helper_;
+		return *dh;
 	}
 #endif
+
+	void Context::PreloadPlugins()
+	{
+		this->WaitForPlugins();
+
+		// The names are copied, since Config could change cfg_ while the plugins are loading
+		auto preload = [this](bool (Context::*valid)() const, void (Context::*load)(std::string const &),
+			std::mutex& mutex, std::string const & name)
+		{
+			if (!name.empty() && !(this->*valid)())
+			{
+				plugin_joiners_.push_back((*gtp_instance_)([this, valid, load, &mutex, name]
+					{
+						std::lock_guard<std::mutex> lock(mutex);
+						if (!(this->*valid)())
+						{
+							(this->*load)(name);
+						}
+					}));
+			}
+		};
+
+		preload(&Context::RenderFactoryValid, &Context::LoadRenderFactory, render_factory_mutex_, cfg_.render_factory_name);
+		preload(&Context::AudioFactoryValid, &Context::LoadAudioFactory, audio_factory_mutex_, cfg_.audio_factory_name);
+		preload(&Context::InputFactoryValid, &Context::LoadInputFactory, input_factory_mutex_, cfg_.input_factory_name);
+		preload(&Context::ShowFactoryValid, &Context::LoadShowFactory, show_factory_mutex_, cfg_.show_factory_name);
+		preload(&Context::ScriptFactoryValid, &Context::LoadScriptFactory, script_factory_mutex_, cfg_.script_factory_name);
+		preload(&Context::SceneManagerValid, &Context::LoadSceneManager, scene_mgr_mutex_, cfg_.scene_manager_name);
+		preload(&Context::AudioDataSourceFactoryValid, &Context::LoadAudioDataSourceFactory, audio_data_src_factory_mutex_,
+			cfg_.audio_data_source_factory_name);
+	}
+
+	void Context::WaitForPlugins()
+	{
+		for (auto& joiner : plugin_joiners_)
+		{
+			joiner();
+		}
+		plugin_joiners_.clear();
+	}
+
+	void Context::RecordStartupPhase(std::string_view name, double seconds)
+	{
+		std::lock_guard<std::mutex> lock(startup_phases_mutex_);
+		startup_phases_.emplace_back(std::string(name), seconds);
+	}
+
+	std::vector<std::pair<std::string, double>> Context::StartupPhases() const
+	{
+		std::lock_guard<std::mutex> lock(startup_phases_mutex_);
+		return startup_phases_;
+	}
+
+	void Context::LogStartupPhases() const
+	{
+		std::lock_guard<std::mutex> lock(startup_phases_mutex_);
+		for (auto const & phase : startup_phases_)
+		{
+			LogInfo() << "Startup phase \"" << phase.first << "\": " << phase.second * 1000 << " ms" << std::endl;
+		}
+		LogInfo() << "Startup total: " << startup_timer_.elapsed() * 1000 << " ms" << std::endl;
+	}
+
+
+	StartupPhaseTimer::StartupPhaseTimer(std::string_view name)
+		: name_(name)
+	{
+	}
+
+	StartupPhaseTimer::~StartupPhaseTimer()
+	{
+		Context::Instance().RecordStartupPhase(name_, timer_.elapsed());
+	}
 }
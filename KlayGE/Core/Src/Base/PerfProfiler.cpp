@@ -33,19 +33,109 @@
 #include <KlayGE/RenderEngine.hpp>
 #include <KlayGE/Query.hpp>
 
+#include <algorithm>
 #include <fstream>
+#include <iomanip>
 #include <mutex>
 
 #include <KlayGE/PerfProfiler.hpp>
 
 namespace
 {
+	using namespace KlayGE;
+
 	std::mutex singleton_mutex;
+
+	std::atomic<uint32_t> profiler_generation(0);
+
+	void WriteJsonString(std::ostream& os, char const * str)
+	{
+		os << '"';
+		for (char const * p = str; *p != '\0'; ++ p)
+		{
+			if (('"' == *p) || ('\\' == *p))
+			{
+				os << '\\';
+			}
+			os << *p;
+		}
+		os << '"';
+	}
+}
+
+namespace KlayGE
+{
+	// Written by its thread only, read by the holder of the profiler's trace mutex
+	class PerfTraceBuffer : boost::noncopyable
+	{
+	public:
+		static uint32_t constexpr CAPACITY = 1UL << 14;
+
+	public:
+		explicit PerfTraceBuffer(uint32_t thread_id)
+			: thread_id_(thread_id), events_(CAPACITY), head_(0), tail_(0), num_dropped_(0)
+		{
+		}
+
+		uint32_t ThreadId() const
+		{
+			return thread_id_;
+		}
+
+		void Push(PerfTraceEvent const & event)
+		{
+			uint32_t const head = head_.load(std::memory_order_relaxed);
+			if (head - tail_.load(std::memory_order_acquire) == CAPACITY)
+			{
+				num_dropped_.fetch_add(1, std::memory_order_relaxed);
+			}
+			else
+			{
+				events_[head & (CAPACITY - 1)] = event;
+				head_.store(head + 1, std::memory_order_release);
+			}
+		}
+
+		void Drain(std::vector<PerfTraceEvent>& events)
+		{
+			uint32_t const tail = tail_.load(std::memory_order_relaxed);
+			uint32_t const head = head_.load(std::memory_order_acquire);
+			for (uint32_t i = tail; i != head; ++ i)
+			{
+				events.push_back(events_[i & (CAPACITY - 1)]);
+			}
+			tail_.store(head, std::memory_order_release);
+		}
+
+		uint32_t NumDropped() const
+		{
+			return num_dropped_.load(std::memory_order_relaxed);
+		}
+
+	private:
+		uint32_t const thread_id_;
+		std::vector<PerfTraceEvent> events_;
+		std::atomic<uint32_t> head_;
+		std::atomic<uint32_t> tail_;
+		std::atomic<uint32_t> num_dropped_;
+	};
+}
+
+namespace
+{
+	// The buffer outlives the profiler it belongs to, the generation tells whether it's still registered
+	struct ThreadTraceBuffer
+	{
+		std::shared_ptr<PerfTraceBuffer> buffer;
+		uint32_t generation = 0;
+	};
+	thread_local ThreadTraceBuffer thread_trace_buffer;
 }
 
 namespace KlayGE
 {
 	std::unique_ptr<PerfProfiler> PerfProfiler::perf_profiler_instance_;
+	std::atomic<bool> PerfProfiler::tracing_(false);
 
 	PerfRange::PerfRange()
 		: cpu_time_(0), gpu_time_(0), dirty_(false)
@@ -111,8 +201,13 @@ namespace KlayGE
 
 
 	PerfProfiler::PerfProfiler()
-		: frame_id_(0)
+		: frame_id_(0), generation_(++ profiler_generation), trace_start_(0)
+	{
+	}
+
+	PerfProfiler::~PerfProfiler()
 	{
+		tracing_ = false;
 	}
 
 	PerfProfiler& PerfProfiler::Instance()
@@ -152,6 +247,11 @@ namespace KlayGE
 
 	void PerfProfiler::CollectData()
 	{
+		if (Tracing())
+		{
+			this->DrainTraceBuffers();
+		}
+
 		if (Context::Instance().Config().perf_profiler)
 		{
 			for (auto& range : perf_ranges_)
@@ -193,4 +293,137 @@ namespace KlayGE
 			ofs << std::endl;
 		}
 	}
+
+	void PerfProfiler::StartTracing()
+	{
+		{
+			std::lock_guard<std::mutex> lock(trace_mutex_);
+			for (auto& buffer : trace_buffers_)
+			{
+				std::vector<PerfTraceEvent> stale_events;
+				buffer->Drain(stale_events);
+			}
+			trace_events_.clear();
+			trace_start_ = TraceTimestamp();
+		}
+
+		tracing_ = true;
+	}
+
+	void PerfProfiler::StopTracing()
+	{
+		tracing_ = false;
+	}
+
+	void PerfProfiler::TraceComplete(char const * category, char const * name, uint64_t begin, uint64_t end)
+	{
+		PerfTraceEvent event;
+		event.category = category;
+		event.name = name;
+		event.type = PerfTraceEvent::ET_Complete;
+		event.timestamp = begin;
+		event.duration = end - begin;
+		event.value = 0;
+		this->RecordTraceEvent(event);
+	}
+
+	void PerfProfiler::TraceCounter(char const * category, char const * name, int64_t value)
+	{
+		PerfTraceEvent event;
+		event.category = category;
+		event.name = name;
+		event.type = PerfTraceEvent::ET_Counter;
+		event.timestamp = TraceTimestamp();
+		event.duration = 0;
+		event.value = value;
+		this->RecordTraceEvent(event);
+	}
+
+	void PerfProfiler::RecordTraceEvent(PerfTraceEvent& event)
+	{
+		auto& tb = thread_trace_buffer;
+		if (tb.generation != generation_)
+		{
+			std::lock_guard<std::mutex> lock(trace_mutex_);
+			tb.buffer = MakeSharedPtr<PerfTraceBuffer>(static_cast<uint32_t>(trace_buffers_.size() + 1));
+			tb.generation = generation_;
+			trace_buffers_.push_back(tb.buffer);
+		}
+
+		event.thread_id = tb.buffer->ThreadId();
+		tb.buffer->Push(event);
+	}
+
+	void PerfProfiler::DrainTraceBuffers()
+	{
+		std::lock_guard<std::mutex> lock(trace_mutex_);
+		for (auto& buffer : trace_buffers_)
+		{
+			buffer->Drain(trace_events_);
+		}
+	}
+
+	std::vector<PerfTraceEvent> PerfProfiler::TraceEvents()
+	{
+		this->DrainTraceBuffers();
+
+		std::lock_guard<std::mutex> lock(trace_mutex_);
+		return trace_events_;
+	}
+
+	uint32_t PerfProfiler::NumDroppedTraceEvents()
+	{
+		std::lock_guard<std::mutex> lock(trace_mutex_);
+		uint32_t num = 0;
+		for (auto const & buffer : trace_buffers_)
+		{
+			num += buffer->NumDropped();
+		}
+		return num;
+	}
+
+	void PerfProfiler::ExportToChromeTrace(std::string const & file_name)
+	{
+		auto events = this->TraceEvents();
+		std::stable_sort(events.begin(), events.end(),
+			[](PerfTraceEvent const & lhs, PerfTraceEvent const & rhs)
+			{
+				return lhs.timestamp < rhs.timestamp;
+			});
+
+		std::ofstream ofs(file_name.c_str());
+		ofs << std::fixed << std::setprecision(3);
+		ofs << "{\"traceEvents\":[" << std::endl;
+		bool first = true;
+		for (auto const & event : events)
+		{
+			if (event.timestamp < trace_start_)
+			{
+				continue;
+			}
+
+			if (!first)
+			{
+				ofs << ',' << std::endl;
+			}
+			first = false;
+
+			// Chrome traces are in microseconds
+			ofs << "{\"name\":";
+			WriteJsonString(ofs, event.name);
+			ofs << ",\"cat\":";
+			WriteJsonString(ofs, event.category);
+			ofs << ",\"pid\":0,\"tid\":" << event.thread_id
+				<< ",\"ts\":" << (event.timestamp - trace_start_) / 1000.0;
+			if (PerfTraceEvent::ET_Complete == event.type)
+			{
+				ofs << ",\"ph\":\"X\",\"dur\":" << event.duration / 1000.0 << '}';
+			}
+			else
+			{
+				ofs << ",\"ph\":\"C\",\"args\":{\"value\":" << event.value << "}}";
+			}
+		}
+		ofs << std::endl << "],\"displayTimeUnit\":\"ns\"}" << std::endl;
+	}
 }
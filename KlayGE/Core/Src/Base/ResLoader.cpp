@@ -32,6 +32,7 @@
 #include <KFL/Hash.hpp>
 #include <KFL/Util.hpp>
 #include <KlayGE/Package.hpp>
+#include <KlayGE/PerfProfiler.hpp>
 #include <KFL/CXX17/filesystem.hpp>
 
 #if defined KLAYGE_PLATFORM_LINUX
@@ -101,7 +102,7 @@ namespace KlayGE
 	std::unique_ptr<ResLoader> ResLoader::res_loader_instance_;
 
 	ResLoader::ResLoader()
-		: quit_(false)
+		: quit_(false), opened_bytes_(0)
 	{
 #if defined KLAYGE_PLATFORM_WINDOWS
 #if defined KLAYGE_PLATFORM_WINDOWS_DESKTOP
@@ -680,6 +681,18 @@ namespace KlayGE
 #else
 						uint64_t timestamp = std::filesystem::last_write_time(res_path);
 #endif
+#if defined(KLAYGE_CXX17_LIBRARY_FILESYSTEM_SUPPORT) || defined(KLAYGE_TS_LIBRARY_FILESYSTEM_SUPPORT)
+						uint64_t file_size = std::filesystem::file_size(res_path, ec);
+						if (ec)
+						{
+							file_size = 0;
+						}
+#else
+						uint64_t const file_size = std::filesystem::file_size(res_path);
+#endif
+						opened_bytes_ += file_size;
+						KLAYGE_PERF_TRACE_COUNTER("ResLoader", "Opened bytes", opened_bytes_.load());
+
 						// The static_cast is a workaround for a bug in clang/c2
 						return MakeSharedPtr<ResIdentifier>(name, timestamp,
 							MakeSharedPtr<std::ifstream>(res_name.c_str(), static_cast<std::ios_base::openmode>(std::ios_base::binary)));
@@ -738,6 +751,8 @@ namespace KlayGE
 
 	std::shared_ptr<void> ResLoader::SyncQuery(ResLoadingDescPtr const & res_desc)
 	{
+		KLAYGE_PERF_TRACE_SCOPE("ResLoader", "SyncQuery");
+
 		this->RemoveUnrefResources();
 
 		std::shared_ptr<void> loaded_res = this->FindMatchLoadedResource(res_desc);
@@ -801,6 +816,8 @@ namespace KlayGE
 
 	std::shared_ptr<void> ResLoader::ASyncQuery(ResLoadingDescPtr const & res_desc)
 	{
+		KLAYGE_PERF_TRACE_SCOPE("ResLoader", "ASyncQuery");
+
 		this->RemoveUnrefResources();
 
 		std::shared_ptr<void> res;
@@ -905,6 +922,8 @@ namespace KlayGE
 		{
 			loaded_res_.emplace_back(res_desc, std::weak_ptr<void>(res));
 		}
+
+		KLAYGE_PERF_TRACE_COUNTER("ResLoader", "Loaded resources", loaded_res_.size());
 	}
 
 	std::shared_ptr<void> ResLoader::FindMatchLoadedResource(ResLoadingDescPtr const & res_desc)
@@ -969,6 +988,8 @@ namespace KlayGE
 				}
 				else
 				{
+					KLAYGE_PERF_TRACE_SCOPE("ResLoader", "MainThreadStage");
+
 					res_desc->MainThreadStage();
 					res = res_desc->Resource();
 					this->AddLoadedResource(res_desc, res);
@@ -1003,6 +1024,8 @@ namespace KlayGE
 			{
 				if (LS_Loading == *res_pair.second)
 				{
+					KLAYGE_PERF_TRACE_SCOPE("ResLoader", "SubThreadStage");
+
 					res_pair.first->SubThreadStage();
 					*res_pair.second = LS_Complete;
 				}
@@ -0,0 +1,237 @@
+/**
+ * @file StartupManifest.cpp
+ * @author Minmin Gong
+ *
+ * @section DESCRIPTION
+ *
+ * This source file is part of KlayGE
+ * For the latest info, see http://www.klayge.org
+ *
+ * @section LICENSE
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * You may alternatively use this source under the terms of
+ * the KlayGE Proprietary License (KPL). You can obtained such a license
+ * from http://www.klayge.org/licensing/.
+ */
+
+#include <KlayGE/KlayGE.hpp>
+#include <KFL/CpuInfo.hpp>
+#include <KFL/CXX17/filesystem.hpp>
+#include <KFL/ErrorHandling.hpp>
+#include <KFL/ResIdentifier.hpp>
+#include <KlayGE/Context.hpp>
+#include <KlayGE/ResLoader.hpp>
+#include <KlayGE/Texture.hpp>
+
+#include <algorithm>
+#include <istream>
+#include <ostream>
+
+#include <KlayGE/StartupManifest.hpp>
+
+namespace
+{
+	using namespace KlayGE;
+
+	std::vector<std::string> SplitEffectNames(std::string const & names)
+	{
+		std::vector<std::string> ret;
+		std::string::size_type begin = 0;
+		for (;;)
+		{
+			auto const end = names.find('|', begin);
+			ret.push_back(names.substr(begin, end - begin));
+			if (end == std::string::npos)
+			{
+				break;
+			}
+			begin = end + 1;
+		}
+		return ret;
+	}
+
+	void ReadFile(std::string_view name)
+	{
+		ResIdentifierPtr res = ResLoader::Instance().Open(name);
+		if (res)
+		{
+			std::vector<char> buffer(64 * 1024);
+			do
+			{
+				res->read(buffer.data(), buffer.size());
+			} while (res->gcount() == static_cast<int64_t>(buffer.size()));
+		}
+	}
+
+	void WarmAsset(StartupManifest::Asset const & asset)
+	{
+		switch (asset.kind)
+		{
+		case StartupManifest::AK_Effect:
+			{
+				// The sources, and the compiled effect named as in RenderEffectTemplate::Load
+				auto const names = SplitEffectNames(asset.name);
+				std::string connected_name;
+				for (size_t i = 0; i < names.size(); ++ i)
+				{
+					ReadFile(names[i]);
+
+					connected_name += std::filesystem::path(names[i]).stem().string();
+					if (i != names.size() - 1)
+					{
+						connected_name += '+';
+					}
+				}
+				ReadFile(connected_name + ".kfx");
+			}
+			break;
+
+		case StartupManifest::AK_Texture:
+			ReadFile(asset.name);
+			break;
+
+		default:
+			KFL_UNREACHABLE("Invalid asset kind");
+		}
+	}
+}
+
+namespace KlayGE
+{
+	StartupManifest::StartupManifest()
+		: recording_(false)
+	{
+	}
+
+	StartupManifest::~StartupManifest()
+	{
+		this->ReleasePreloaded();
+	}
+
+	void StartupManifest::StartRecording()
+	{
+		recording_ = true;
+	}
+
+	void StartupManifest::StopRecording()
+	{
+		recording_ = false;
+	}
+
+	void StartupManifest::Record(AssetKind kind, std::string_view name, uint32_t access_hint)
+	{
+		if (recording_ && !name.empty())
+		{
+			std::lock_guard<std::mutex> lock(recorded_mutex_);
+			auto iter = std::find_if(recorded_assets_.begin(), recorded_assets_.end(),
+				[kind, name, access_hint](Asset const & asset)
+				{
+					return (asset.kind == kind) && (asset.access_hint == access_hint) && (asset.name == name);
+				});
+			if (iter == recorded_assets_.end())
+			{
+				recorded_assets_.push_back(Asset{ kind, access_hint, std::string(name) });
+			}
+		}
+	}
+
+	std::vector<StartupManifest::Asset> StartupManifest::RecordedAssets() const
+	{
+		std::lock_guard<std::mutex> lock(recorded_mutex_);
+		return recorded_assets_;
+	}
+
+	void StartupManifest::Load(std::istream& is)
+	{
+		last_run_assets_.clear();
+
+		uint32_t kind;
+		uint32_t access_hint;
+		while (is >> kind >> access_hint)
+		{
+			std::string name;
+			is.get();
+			std::getline(is, name);
+			if (!name.empty() && (name.back() == '\r'))
+			{
+				name.pop_back();
+			}
+
+			if ((kind <= AK_Texture) && !name.empty())
+			{
+				last_run_assets_.push_back(Asset{ static_cast<AssetKind>(kind), access_hint, std::move(name) });
+			}
+		}
+	}
+
+	void StartupManifest::Save(std::ostream& os) const
+	{
+		std::lock_guard<std::mutex> lock(recorded_mutex_);
+		for (auto const & asset : recorded_assets_)
+		{
+			os << static_cast<uint32_t>(asset.kind) << ' ' << asset.access_hint << ' ' << asset.name << '\n';
+		}
+	}
+
+	void StartupManifest::WarmFiles()
+	{
+		if (last_run_assets_.empty())
+		{
+			return;
+		}
+
+		// Spread from a job of its own, so the caller doesn't wait for the files
+		auto& tp = Context::Instance().ThreadPool();
+		warming_job_ = MakeUniquePtr<joiner<void>>(tp([this, &tp]
+			{
+				CPUInfo cpu;
+				parallel_for(tp, static_cast<uint32_t>(last_run_assets_.size()), static_cast<uint32_t>(cpu.NumHWThreads()),
+					[this](uint32_t begin, uint32_t end)
+					{
+						for (uint32_t i = begin; i < end; ++ i)
+						{
+							WarmAsset(last_run_assets_[i]);
+						}
+					});
+			}));
+	}
+
+	void StartupManifest::PreloadTextures()
+	{
+		// Not recorded, or the textures an app stops using would stay in the manifest forever
+		bool const recording = recording_.exchange(false);
+		for (auto const & asset : last_run_assets_)
+		{
+			if (AK_Texture == asset.kind)
+			{
+				preloaded_textures_.push_back(ASyncLoadTexture(asset.name, asset.access_hint));
+			}
+		}
+		recording_ = recording;
+	}
+
+	void StartupManifest::ReleasePreloaded()
+	{
+		if (warming_job_)
+		{
+			(*warming_job_)();
+			warming_job_.reset();
+		}
+
+		preloaded_textures_.clear();
+	}
+}
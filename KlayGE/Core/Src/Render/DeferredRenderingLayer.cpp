@@ -32,6 +32,7 @@
 #include <KFL/ErrorHandling.hpp>
 #include <KFL/Util.hpp>
 #include <KFL/Math.hpp>
+#include <KFL/Hash.hpp>
 #include <KlayGE/ResLoader.hpp>
 #include <KlayGE/Renderable.hpp>
 #include <KlayGE/RenderableHelper.hpp>
@@ -51,7 +52,11 @@
 #include <KlayGE/SSRPostProcess.hpp>
 #include <KlayGE/SSSBlur.hpp>
 #include <KlayGE/PerfProfiler.hpp>
+#include <KlayGE/LightCuller.hpp>
 
+#include <iterator>
+#include <ostream>
+#include <sstream>
 #include <string>
 
 #include <KlayGE/DeferredRenderingLayer.hpp>
@@ -416,7 +421,9 @@ namespace KlayGE
 		: active_viewport_(0),
 			sss_enabled_(true), translucency_enabled_(true),
 			ssr_enabled_(true), taa_enabled_(true),
-			light_scale_(1), illum_(0), indirect_scale_(1.0f),
+			light_scale_(1),
+			job_graph_key_hash_(0), num_job_graph_rebuilds_(0),
+			illum_(0), indirect_scale_(1.0f),
 			curr_cascade_index_(-1), force_line_mode_(false),
 			dr_debug_pp_(MakeSharedPtr<DeferredRenderingDebugPostProcess>()),
 			display_type_(DT_Final)
@@ -1376,7 +1383,18 @@ namespace KlayGE
 			bool has_transparency_front_objs = false;
 			this->BuildVisibleSceneObjList(has_opaque_objs, has_transparency_back_objs, has_transparency_front_objs);
 
-			this->BuildPassScanList(has_opaque_objs, has_transparency_back_objs, has_transparency_front_objs);
+			this->UpdateLightVisibles();
+
+			this->BuildJobGraphKey(next_job_graph_key_, has_opaque_objs, has_transparency_back_objs, has_transparency_front_objs);
+			size_t const job_graph_key_hash = HashRange(next_job_graph_key_.begin(), next_job_graph_key_.end());
+			// A hash match still compares the whole key, a collision mustn't replay a stale graph
+			if (jobs_.empty() || (job_graph_key_hash != job_graph_key_hash_) || (next_job_graph_key_ != job_graph_key_))
+			{
+				this->BuildPassScanList(has_opaque_objs, has_transparency_back_objs, has_transparency_front_objs);
+				this->CompileJobGraph();
+				job_graph_key_.swap(next_job_graph_key_);
+				job_graph_key_hash_ = job_graph_key_hash;
+			}
 
 			num_objects_rendered_ = 0;
 			num_renderables_rendered_ = 0;
@@ -1393,7 +1411,7 @@ namespace KlayGE
 		{
 			BOOST_ASSERT(curr_job_iter_ != jobs_.end());
 
-			urv = (*curr_job_iter_)->Run();
+			urv = curr_job_iter_->Run();
 			++ curr_job_iter_;
 		}
 
@@ -1583,12 +1601,45 @@ namespace KlayGE
 			});
 	}
 
+	void DeferredRenderingLayer::BuildJobGraphKey(std::vector<uint64_t>& key,
+		bool has_opaque_objs, bool has_transparency_back_objs, bool has_transparency_front_objs) const
+	{
+		// Everything the shape of the job graph depends on. Per-frame data, such as cameras and light visibilities, is consumed by
+		// the jobs themselves and doesn't belong here.
+		key.clear();
+		key.push_back(has_opaque_objs);
+		key.push_back(has_transparency_back_objs);
+		key.push_back(has_transparency_front_objs);
+		key.push_back(has_reflective_objs_);
+		key.push_back(has_simple_forward_objs_);
+		key.push_back(has_vdm_objs_);
+		key.push_back(display_type_);
+		key.push_back(static_cast<uint64_t>(illum_));
+		key.push_back(reinterpret_cast<uintptr_t>(rsm_fb_.get()));
+		key.push_back(static_cast<uint64_t>(cascaded_shadow_index_));
+
+		key.push_back(lights_.size());
+		for (auto const * light : lights_)
+		{
+			key.push_back(light->Enabled());
+			key.push_back(light->Type());
+			key.push_back(static_cast<uint64_t>(light->Attrib()));
+		}
+
+		key.push_back(viewports_.size());
+		for (auto const & pvp : viewports_)
+		{
+			key.push_back(pvp.attrib);
+			key.push_back(pvp.num_cascades);
+		}
+	}
+
 	void DeferredRenderingLayer::BuildPassScanList(bool has_opaque_objs, bool has_transparency_back_objs, bool has_transparency_front_objs)
 	{
 		jobs_.clear();
 
 #ifndef KLAYGE_SHIP
-		jobs_.push_back(MakeSharedPtr<DeferredRenderingJob>([this] { return this->BeginPerfProfileDRJob(*shadow_map_perf_); }));
+		this->AddBeginPerfProfileJob(*shadow_map_perf_);
 #endif
 		for (uint32_t i = 0; i < lights_.size(); ++ i)
 		{
@@ -1599,7 +1650,7 @@ namespace KlayGE
 			}
 		}
 #ifndef KLAYGE_SHIP
-		jobs_.push_back(MakeSharedPtr<DeferredRenderingJob>([this] { return this->EndPerfProfileDRJob(*shadow_map_perf_); } ));
+		this->AddEndPerfProfileJob(*shadow_map_perf_);
 #endif
 
 #ifdef KLAYGE_DEBUG
@@ -1614,27 +1665,13 @@ namespace KlayGE
 				no_viewport = false;
 #endif
 
-				jobs_.push_back(MakeSharedPtr<DeferredRenderingJob>([this, vpi] { return this->SwitchViewportDRJob(vpi); }));
+				this->AddJob("SwitchViewport", 0, 0, [this, vpi] { return this->SwitchViewportDRJob(vpi); });
 
 				pvp.g_buffer_enables[PTB_Opaque] = (pvp.attrib & VPAM_NoOpaque) ? false : has_opaque_objs;
 				pvp.g_buffer_enables[PTB_TransparencyBack] = (pvp.attrib & VPAM_NoTransparencyBack) ? false : has_transparency_back_objs;
 				pvp.g_buffer_enables[PTB_TransparencyFront]
 					= (pvp.attrib & VPAM_NoTransparencyFront) ? false : has_transparency_front_objs;
 
-				pvp.light_visibles.resize(lights_.size());
-				for (uint32_t li = 0; li < lights_.size(); ++ li)
-				{
-					auto const & light = *lights_[li];
-					if (light.Enabled())
-					{
-						this->CheckLightVisible(vpi, li);
-					}
-					else
-					{
-						pvp.light_visibles[li] = false;
-					}
-				}
-
 				for (uint32_t i = PTB_Opaque; i < PTB_None; ++ i)
 				{
 					PassTargetBuffer const pass_tb = static_cast<PassTargetBuffer>(i);
@@ -1653,40 +1690,34 @@ namespace KlayGE
 
 					if (pvp.g_buffer_enables[i])
 					{
-						jobs_.push_back(MakeSharedPtr<DeferredRenderingJob>(
+						this->AddJob("Shadowing",
+							(1UL << DRR_ShadowMaps) | (1UL << DRR_CascadedShadowMaps) | (1UL << DRR_GBuffer) | (1UL << DRR_Depth),
+							1UL << DRR_Shadowing,
 							[this, vpi, pass_tb]
 							{
 								return this->ShadowingDRJob(viewports_[vpi], pass_tb);
-							}));
+							});
 						if (!(pvp.attrib & VPAM_NoGI))
 						{
 #ifndef KLAYGE_SHIP
-							jobs_.push_back(MakeSharedPtr<DeferredRenderingJob>(
-								[this, pass_tb]
-								{
-									return this->BeginPerfProfileDRJob(*indirect_lighting_perfs_[pass_tb]);
-								}));
+							this->AddBeginPerfProfileJob(*indirect_lighting_perfs_[pass_tb]);
 #endif
 							for (uint32_t li = 0; li < lights_.size(); ++ li)
 							{
 								auto const & light = *lights_[li];
 								if (light.Enabled())
 								{
+									// Visibility of the light is checked when the job runs, so camera motion doesn't rebuild the graph
 									if ((LightSource::LT_Spot == light.Type()) && (PTB_Opaque == pass_tb)
 										&& (light.Attrib() & LightSource::LSA_IndirectLighting)
-										&& rsm_fb_ && (illum_ != 1)
-										&& pvp.light_visibles[li])
+										&& rsm_fb_ && (illum_ != 1))
 									{
 										this->AppendIndirectLightingPassScanCode(vpi, li);
 									}
 								}
 							}
 #ifndef KLAYGE_SHIP
-							jobs_.push_back(MakeSharedPtr<DeferredRenderingJob>(
-								[this, pass_tb]
-								{
-									return this->EndPerfProfileDRJob(*indirect_lighting_perfs_[pass_tb]);
-								}));
+							this->AddEndPerfProfileJob(*indirect_lighting_perfs_[pass_tb]);
 #endif
 						}
 
@@ -1694,14 +1725,14 @@ namespace KlayGE
 					}
 				}
 
-				jobs_.push_back(MakeSharedPtr<DeferredRenderingJob>(
+				this->AddJob("PostEffects", (1UL << DRR_Shading) | (1UL << DRR_Depth), 1UL << DRR_Output,
 					[this, vpi]
 					{
 						return this->PostEffectsDRJob(viewports_[vpi]);
-					}));
+					});
 				if (has_simple_forward_objs_ && !(pvp.attrib & VPAM_NoSimpleForward))
 				{
-					jobs_.push_back(MakeSharedPtr<DeferredRenderingJob>([this] { return this->SimpleForwardDRJob(); }));
+					this->AddJob("SimpleForward", 1UL << DRR_Depth, 1UL << DRR_Output, [this] { return this->SimpleForwardDRJob(); });
 				}
 			}
 		}
@@ -1713,11 +1744,11 @@ namespace KlayGE
 #endif
 			)
 		{
-			jobs_.push_back(MakeSharedPtr<DeferredRenderingJob>([this] { return this->VisualizeLightingDRJob(); }));
+			this->AddJob("VisualizeLighting", 1UL << DRR_Lighting, 1UL << DRR_Output, [this] { return this->VisualizeLightingDRJob(); });
 		}
 		else
 		{
-			jobs_.push_back(MakeSharedPtr<DeferredRenderingJob>([this] { return this->FinishingDRJob(); }));
+			this->AddJob("Finishing", 1UL << DRR_Output, 0, [this] { return this->FinishingDRJob(); });
 		}
 
 #ifdef KLAYGE_DEBUG
@@ -1728,14 +1759,160 @@ namespace KlayGE
 #endif
 	}
 
-	void DeferredRenderingLayer::CheckLightVisible(uint32_t vp_index, uint32_t light_index)
+	void DeferredRenderingLayer::CompileJobGraph()
 	{
-		SceneManager& scene_mgr = Context::Instance().SceneManagerInstance();
+		resource_lifetimes_.fill(std::make_pair(-1, -1));
 
-		PerViewport& pvp = viewports_[vp_index];
-		auto const & light = *lights_[light_index];
+		uint32_t written = 0;
+		for (size_t i = 0; i < jobs_.size(); ++ i)
+		{
+			auto const & job = jobs_[i];
+			uint32_t const touched = job.Reads() | job.Writes();
+			for (uint32_t r = 0; r < DRR_NumResources; ++ r)
+			{
+				if (touched & (1UL << r))
+				{
+					auto& lifetime = resource_lifetimes_[r];
+					if (lifetime.first < 0)
+					{
+						lifetime.first = static_cast<int32_t>(i);
+					}
+					lifetime.second = static_cast<int32_t>(i);
+				}
+			}
+
+#ifdef KLAYGE_DEBUG
+			// Shadow maps are optional inputs of the shadowing pass, the rest must be produced before being consumed.
+			uint32_t const optional_inputs = (1UL << DRR_ShadowMaps) | (1UL << DRR_CascadedShadowMaps) | (1UL << DRR_RSM)
+				| (1UL << DRR_Shadowing) | (1UL << DRR_IndirectLighting);
+			uint32_t const missing = job.Reads() & ~written & ~optional_inputs;
+			if (missing != 0)
+			{
+				LogWarn() << "Job " << i << " (" << job.Name() << ") reads resources 0x" << std::hex << missing << std::dec
+					<< " that no earlier job writes." << std::endl;
+			}
+#endif
+			written |= job.Writes();
+		}
+
+		++ num_job_graph_rebuilds_;
+
+#ifdef KLAYGE_DEBUG
+		std::ostringstream ss;
+		this->DumpJobGraph(ss);
+		LogDebug() << ss.str();
+#endif
+	}
+
+	void DeferredRenderingLayer::DumpJobGraph(std::ostream& os) const
+	{
+		static char const * resource_names[] =
+		{
+			"ShadowMaps",
+			"CascadedShadowMaps",
+			"RSM",
+			"GBuffer",
+			"Depth",
+			"Shadowing",
+			"IndirectLighting",
+			"Lighting",
+			"Shading",
+			"Output"
+		};
+		KLAYGE_STATIC_ASSERT(std::size(resource_names) == DRR_NumResources);
+
+		auto dump_resources = [&os](uint32_t mask)
+		{
+			bool first = true;
+			for (uint32_t r = 0; r < DRR_NumResources; ++ r)
+			{
+				if (mask & (1UL << r))
+				{
+					os << (first ? "" : ", ") << resource_names[r];
+					first = false;
+				}
+			}
+		};
+
+		os << "Deferred rendering job graph (" << jobs_.size() << " jobs, " << num_job_graph_rebuilds_ << " rebuilds):" << std::endl;
+		for (size_t i = 0; i < jobs_.size(); ++ i)
+		{
+			auto const & job = jobs_[i];
+			os << "  " << i << ": " << job.Name();
+			if (job.Reads() != 0)
+			{
+				os << " reads [";
+				dump_resources(job.Reads());
+				os << "]";
+			}
+			if (job.Writes() != 0)
+			{
+				os << " writes [";
+				dump_resources(job.Writes());
+				os << "]";
+			}
+			os << std::endl;
+		}
+
+		os << "Resource lifetimes:" << std::endl;
+		for (uint32_t r = 0; r < DRR_NumResources; ++ r)
+		{
+			auto const & lifetime = resource_lifetimes_[r];
+			if (lifetime.first >= 0)
+			{
+				os << "  " << resource_names[r] << ": [" << lifetime.first << ", " << lifetime.second << "]" << std::endl;
+			}
+		}
+	}
+
+	void DeferredRenderingLayer::UpdateLightVisibles()
+	{
+		// Lights without a volume get an empty bound. They are never visible to the culling and are handled separately below.
+		light_volume_bounds_.resize(lights_.size());
+		for (uint32_t li = 0; li < lights_.size(); ++ li)
+		{
+			auto const & light = *lights_[li];
+			light_volume_bounds_[li] = light.Enabled() ? this->LightVolumeBound(light) : Sphere(float3(0, 0, 0), -1);
+		}
+
+		for (uint32_t vpi = 0; vpi < viewports_.size(); ++ vpi)
+		{
+			PerViewport& pvp = viewports_[vpi];
+			if (pvp.attrib & VPAM_Enabled)
+			{
+				if (!pvp.light_culler)
+				{
+					pvp.light_culler = MakeSharedPtr<LightCuller>();
+				}
+
+				Camera const & camera = *pvp.frame_buffer->GetViewport()->camera;
+				pvp.light_culler->Cull(camera.ViewMatrix() * camera.ProjMatrix(), MakeArrayRef(light_volume_bounds_));
+
+				pvp.light_visibles.resize(lights_.size());
+				for (uint32_t li = 0; li < lights_.size(); ++ li)
+				{
+					auto const & light = *lights_[li];
+					if (!light.Enabled())
+					{
+						pvp.light_visibles[li] = false;
+					}
+					else if ((LightSource::LT_Ambient == light.Type()) || (LightSource::LT_Directional == light.Type()))
+					{
+						pvp.light_visibles[li] = true;
+					}
+					else
+					{
+						pvp.light_visibles[li] = pvp.light_culler->LightVisible(li);
+					}
+				}
+			}
+		}
+	}
 
+	Sphere DeferredRenderingLayer::LightVolumeBound(LightSource const & light) const
+	{
 		float light_scale = std::min(light.Range() * 0.01f, 1.0f) * light_scale_;
+		AABBox aabb;
 		switch (light.Type())
 		{
 		case LightSource::LT_Spot:
@@ -1744,7 +1921,7 @@ namespace KlayGE
 				float const scale = light.CosOuterInner().w();
 				float4x4 mat = MathLib::scaling(scale * light_scale, scale * light_scale, light_scale);
 				float4x4 light_model = mat * inv_light_view;
-				pvp.light_visibles[light_index] = (scene_mgr.AABBVisible(MathLib::transform_aabb(cone_aabb_, light_model)) != BO_No);
+				aabb = MathLib::transform_aabb(cone_aabb_, light_model);
 			}
 			break;
 
@@ -1755,43 +1932,55 @@ namespace KlayGE
 				float3 const & p = light.Position();
 				float4x4 light_model = MathLib::scaling(light_scale, light_scale, light_scale)
 					* MathLib::translation(p);
-				pvp.light_visibles[light_index] = (scene_mgr.AABBVisible(MathLib::transform_aabb(box_aabb_, light_model)) != BO_No);
+				aabb = MathLib::transform_aabb(box_aabb_, light_model);
 			}
 			break;
 
 		default:
-			pvp.light_visibles[light_index] = true;
-			break;
+			return Sphere(float3(0, 0, 0), -1);
 		}
+
+		return Sphere(aabb.Center(), MathLib::length(aabb.HalfSize()));
+	}
+
+	void DeferredRenderingLayer::AddJob(char const * name, uint32_t reads, uint32_t writes, std::function<uint32_t()> job_func)
+	{
+		jobs_.emplace_back(name, reads, writes, std::move(job_func));
+	}
+
+	void DeferredRenderingLayer::AddBeginPerfProfileJob(PerfRange& perf)
+	{
+		this->AddJob("BeginPerfProfile", 0, 0, [this, &perf] { return this->BeginPerfProfileDRJob(perf); });
+	}
+
+	void DeferredRenderingLayer::AddEndPerfProfileJob(PerfRange& perf)
+	{
+		this->AddJob("EndPerfProfile", 0, 0, [this, &perf] { return this->EndPerfProfileDRJob(perf); });
 	}
 
 	void DeferredRenderingLayer::AppendGBufferPassScanCode(uint32_t vp_index, PassTargetBuffer pass_tb)
 	{
 #ifndef KLAYGE_SHIP
-		jobs_.push_back(MakeSharedPtr<DeferredRenderingJob>(
-			[this, pass_tb]
-			{
-				return this->BeginPerfProfileDRJob(*gbuffer_perfs_[pass_tb]);
-			}));
+		this->AddBeginPerfProfileJob(*gbuffer_perfs_[pass_tb]);
 #endif
-		jobs_.push_back(MakeSharedPtr<DeferredRenderingJob>(
+		this->AddJob("GBufferGeneration", 0, (1UL << DRR_GBuffer) | (1UL << DRR_Depth),
 			[this, vp_index, pass_tb]
 			{
 				return this->GBufferGenerationDRJob(viewports_[vp_index], ComposePassType(PRT_MRT, pass_tb, PC_GBuffer));
-			}));
-		jobs_.push_back(MakeSharedPtr<DeferredRenderingJob>([this] { return this->RenderingStatsDRJob(); }));
-		jobs_.push_back(MakeSharedPtr<DeferredRenderingJob>(
+			});
+		this->AddJob("RenderingStats", 0, 0, [this] { return this->RenderingStatsDRJob(); });
+		this->AddJob("GBufferProcessing", (1UL << DRR_GBuffer) | (1UL << DRR_Depth), 1UL << DRR_Depth,
 			[this, vp_index]
 			{
 				return this->GBufferProcessingDRJob(viewports_[vp_index]);
-			}));
+			});
 		if (pass_tb == PTB_Opaque)
 		{
-			jobs_.push_back(MakeSharedPtr<DeferredRenderingJob>(
+			this->AddJob("OpaqueGBufferProcessing", (1UL << DRR_GBuffer) | (1UL << DRR_Depth), 1UL << DRR_GBuffer,
 				[this, vp_index]
 				{
 					return this->OpaqueGBufferProcessingDRJob(viewports_[vp_index]);
-				}));
+				});
 			if ((DeferredRenderingLayer::DT_Position == display_type_)
 				|| (DeferredRenderingLayer::DT_Normal == display_type_)
 				|| (DeferredRenderingLayer::DT_Depth == display_type_)
@@ -1799,15 +1988,12 @@ namespace KlayGE
 				|| (DeferredRenderingLayer::DT_Specular == display_type_)
 				|| (DeferredRenderingLayer::DT_Shininess == display_type_))
 			{
-				jobs_.push_back(MakeSharedPtr<DeferredRenderingJob>([this] { return this->VisualizeGBufferDRJob(); }));
+				this->AddJob("VisualizeGBuffer", (1UL << DRR_GBuffer) | (1UL << DRR_Depth), 1UL << DRR_Output,
+					[this] { return this->VisualizeGBufferDRJob(); });
 			}
 		}
 #ifndef KLAYGE_SHIP
-		jobs_.push_back(MakeSharedPtr<DeferredRenderingJob>(
-			[this, pass_tb]
-			{
-				return this->EndPerfProfileDRJob(*gbuffer_perfs_[pass_tb]);
-			}));
+		this->AddEndPerfProfileJob(*gbuffer_perfs_[pass_tb]);
 #endif
 	}
 
@@ -1849,16 +2035,16 @@ namespace KlayGE
 
 				if (sm_seq != 0)
 				{
-					jobs_.push_back(MakeSharedPtr<DeferredRenderingJob>(
-						[this, shadow_pt, light_index]
-						{
-							return this->ShadowMapGenerationDRJob(viewports_[0], shadow_pt, light_index, 0);
-						}));
-					jobs_.push_back(MakeSharedPtr<DeferredRenderingJob>(
-						[this, shadow_pt, light_index]
-						{
-							return this->ShadowMapGenerationDRJob(viewports_[0], shadow_pt, light_index, 1);
-						}));
+					uint32_t const writes = (PT_GenReflectiveShadowMap == shadow_pt)
+						? ((1UL << DRR_ShadowMaps) | (1UL << DRR_RSM)) : (1UL << DRR_ShadowMaps);
+					for (int j = 0; j < 2; ++ j)
+					{
+						this->AddJob("ShadowMapGeneration", 0, writes,
+							[this, shadow_pt, light_index, j]
+							{
+								return this->ShadowMapGenerationDRJob(viewports_[0], shadow_pt, light_index, j);
+							});
+					}
 				}
 			}
 			break;
@@ -1870,11 +2056,11 @@ namespace KlayGE
 			{
 				for (int j = 0; j < 7; ++ j)
 				{
-					jobs_.push_back(MakeSharedPtr<DeferredRenderingJob>(
+					this->AddJob("ShadowMapGeneration", 0, 1UL << DRR_ShadowMaps,
 						[this, shadow_pt, light_index, j]
 						{
 							return this->ShadowMapGenerationDRJob(viewports_[0], shadow_pt, light_index, j);
-						}));
+						});
 				}
 			}
 			break;
@@ -1893,102 +2079,89 @@ namespace KlayGE
 		BOOST_ASSERT(LightSource::LT_Directional == lights_[light_index]->Type());
 
 #ifndef KLAYGE_SHIP
-		jobs_.push_back(MakeSharedPtr<DeferredRenderingJob>([this] { return this->BeginPerfProfileDRJob(*shadow_map_perf_); }));
+		this->AddBeginPerfProfileJob(*shadow_map_perf_);
 #endif
 
 		PerViewport& pvp = viewports_[vp_index];
 		for (uint32_t i = 0; i < pvp.num_cascades + 1; ++ i)
 		{
-			jobs_.push_back(MakeSharedPtr<DeferredRenderingJob>(
+			this->AddJob("CascadedShadowMapGeneration", 1UL << DRR_Depth, 1UL << DRR_CascadedShadowMaps,
 				[this, vp_index, light_index, i]
 				{
 					return this->ShadowMapGenerationDRJob(viewports_[vp_index], PT_GenCascadedShadowMap, light_index, i);
-				}));
+				});
 		}
 
 #ifndef KLAYGE_SHIP
-		jobs_.push_back(MakeSharedPtr<DeferredRenderingJob>([this] { return this->EndPerfProfileDRJob(*shadow_map_perf_); }));
+		this->AddEndPerfProfileJob(*shadow_map_perf_);
 #endif
 	}
 
 	void DeferredRenderingLayer::AppendIndirectLightingPassScanCode(uint32_t vp_index, uint32_t light_index)
 	{
-		jobs_.push_back(MakeSharedPtr<DeferredRenderingJob>(
+		this->AddJob("IndirectLighting", (1UL << DRR_RSM) | (1UL << DRR_GBuffer) | (1UL << DRR_Depth), 1UL << DRR_IndirectLighting,
 			[this, vp_index, light_index]
 			{
 				return this->IndirectLightingDRJob(viewports_[vp_index], light_index);
-			}));
+			});
 	}
 
 	void DeferredRenderingLayer::AppendShadingPassScanCode(uint32_t vp_index, PassTargetBuffer pass_tb)
 	{
-		jobs_.push_back(MakeSharedPtr<DeferredRenderingJob>(
+		uint32_t const g_buffer_reads = (1UL << DRR_GBuffer) | (1UL << DRR_Depth);
+
+		this->AddJob("Shading", g_buffer_reads | (1UL << DRR_Shadowing) | (1UL << DRR_IndirectLighting),
+			(1UL << DRR_Lighting) | (1UL << DRR_Shading),
 			[this, vp_index, pass_tb]
 			{
 				return this->ShadingDRJob(viewports_[vp_index], ComposePassType(PRT_None, pass_tb, PC_Shading), 0);
-			}));
+			});
 
 		if (has_reflective_objs_)
 		{
 #ifndef KLAYGE_SHIP
-			jobs_.push_back(MakeSharedPtr<DeferredRenderingJob>(
-				[this, pass_tb]
-				{
-					return this->BeginPerfProfileDRJob(*reflection_perfs_[pass_tb]);
-				}));
+			this->AddBeginPerfProfileJob(*reflection_perfs_[pass_tb]);
 #endif
-			jobs_.push_back(MakeSharedPtr<DeferredRenderingJob>(
+			this->AddJob("Reflection", g_buffer_reads | (1UL << DRR_Shading), 1UL << DRR_Shading,
 				[this, vp_index, pass_tb]
 				{
 					return this->ReflectionDRJob(viewports_[vp_index], ComposePassType(PRT_None, pass_tb, PC_Reflection));
-				}));
+				});
 #ifndef KLAYGE_SHIP
-			jobs_.push_back(MakeSharedPtr<DeferredRenderingJob>(
-				[this, pass_tb]
-				{
-					return this->EndPerfProfileDRJob(*reflection_perfs_[pass_tb]);
-				}));
+			this->AddEndPerfProfileJob(*reflection_perfs_[pass_tb]);
 #endif
 		}
 
 		if (has_vdm_objs_)
 		{
 #ifndef KLAYGE_SHIP
-			jobs_.push_back(MakeSharedPtr<DeferredRenderingJob>([this] { return this->BeginPerfProfileDRJob(*vdm_perf_); }));
+			this->AddBeginPerfProfileJob(*vdm_perf_);
 #endif
-			jobs_.push_back(MakeSharedPtr<DeferredRenderingJob>(
+			this->AddJob("VDM", 1UL << DRR_Depth, 1UL << DRR_Shading,
 				[this, vp_index]
 				{
 					return this->VDMDRJob(viewports_[vp_index]);
-				}));
+				});
 #ifndef KLAYGE_SHIP
-			jobs_.push_back(MakeSharedPtr<DeferredRenderingJob>([this] { return this->EndPerfProfileDRJob(*vdm_perf_); }));
+			this->AddEndPerfProfileJob(*vdm_perf_);
 #endif
 		}
 
 #ifndef KLAYGE_SHIP
-		jobs_.push_back(MakeSharedPtr<DeferredRenderingJob>(
-			[this, pass_tb]
-			{
-				return this->BeginPerfProfileDRJob(*special_shading_perfs_[pass_tb]);
-			}));
+		this->AddBeginPerfProfileJob(*special_shading_perfs_[pass_tb]);
 #endif
-		jobs_.push_back(MakeSharedPtr<DeferredRenderingJob>(
+		this->AddJob("SpecialShading", g_buffer_reads, 1UL << DRR_Shading,
 			[this, vp_index, pass_tb]
 			{
 				return this->SpecialShadingDRJob(viewports_[vp_index] , ComposePassType(PRT_None, pass_tb, PC_SpecialShading));
-			}));
-		jobs_.push_back(MakeSharedPtr<DeferredRenderingJob>(
+			});
+		this->AddJob("MergeShadingAndDepth", (1UL << DRR_Shading) | (1UL << DRR_Depth), 1UL << DRR_Shading,
 			[this, vp_index, pass_tb]
 			{
 				return this->MergeShadingAndDepthDRJob(viewports_[vp_index] , pass_tb);
-			}));
+			});
 #ifndef KLAYGE_SHIP
-		jobs_.push_back(MakeSharedPtr<DeferredRenderingJob>(
-			[this, pass_tb]
-			{
-				return this->EndPerfProfileDRJob(*special_shading_perfs_[pass_tb]);
-			}));
+		this->AddEndPerfProfileJob(*special_shading_perfs_[pass_tb]);
 #endif
 	}
 
@@ -4201,8 +4374,11 @@ namespace KlayGE
 
 	uint32_t DeferredRenderingLayer::IndirectLightingDRJob(PerViewport const & pvp, int32_t org_no)
 	{
-		depth_to_esm_pp_->Apply();
-		pvp.il_layer->UpdateRSM(*rsm_fb_->GetViewport()->camera, *lights_[org_no]);
+		if (pvp.light_visibles[org_no])
+		{
+			depth_to_esm_pp_->Apply();
+			pvp.il_layer->UpdateRSM(*rsm_fb_->GetViewport()->camera, *lights_[org_no]);
+		}
 		return 0;
 	}
 
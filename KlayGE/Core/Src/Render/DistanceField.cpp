@@ -27,10 +27,46 @@
  * the KlayGE Proprietary License (KPL). You can obtained such a license
  * from http://www.klayge.org/licensing/.
  */
-
 #include <KlayGE/KlayGE.hpp>
+#include <KFL/CpuInfo.hpp>
+#include <KFL/Thread.hpp>
+#include <KlayGE/Context.hpp>
+
+#include <algorithm>
+#include <limits>
+
+#if defined(KLAYGE_SSE2_SUPPORT)
+#include <emmintrin.h>
+#endif
+
 #include <KlayGE/DistanceField.hpp>
 
+namespace
+{
+	using namespace KlayGE;
+
+	// Images smaller than this are processed on the calling thread. KFontGen already distributes glyphs over threads, and
+	// splitting a single glyph further only adds overhead.
+	uint32_t const MIN_PARALLEL_PIXELS = 256 * 256;
+
+	// Half size of the window around the nearest covered pixel searched for a closer anti-aliased edge
+	int const SITE_SEARCH_RADIUS = 2;
+
+	// Feature offset of pixels that have no covered pixel to point to
+	int const NO_SITE = std::numeric_limits<int>::max();
+
+	// Number of jobs to spread num_pixels of work over
+	uint32_t NumJobs(uint32_t num_pixels)
+	{
+		if (num_pixels >= MIN_PARALLEL_PIXELS)
+		{
+			CPUInfo cpu;
+			return static_cast<uint32_t>(cpu.NumHWThreads());
+		}
+		return 1;
+	}
+}
+
 namespace KlayGE
 {
 	float EdgeDistance(float2 const & grad, float val)
@@ -88,104 +124,295 @@ namespace KlayGE
 		return di + df;
 	}
 
-	bool UpdateDistance(int x, int y, int dx, int dy, std::vector<float> const & img, int width,
-		std::vector<float2> const & grad, std::vector<int2>& dist_xy, std::vector<float>& dist)
+	// Offset to the nearest covered pixel in the same row, positive if it's on the left. INT_MAX if the row has no coverage.
+	void RowFeatureTransform(float const * src, int width, int* dst)
 	{
-		float const EPSILON = 1e-3f;
+#if defined(KLAYGE_SSE2_SUPPORT)
+		int const vec_width = width & ~3;
+#else
+		int const vec_width = 0;
+#endif
+
+		int x = 0;
+		int site = -1;
+#if defined(KLAYGE_SSE2_SUPPORT)
+		// 4 pixels at a time. The last covered pixel so far is a running maximum, found with 2 shifted maximums inside the
+		// vector and the carry from the previous one. Sites are stored as x + 1, so 0 means none and the shifted in zeros
+		// don't matter.
+		__m128 const zero = _mm_setzero_ps();
+		__m128 const lane_x = _mm_set_ps(3, 2, 1, 0);
+		__m128i const no_site = _mm_set1_epi32(NO_SITE);
+
+		__m128 carry = zero;
+		for (; x < vec_width; x += 4)
+		{
+			__m128 const pos_1 = _mm_add_ps(_mm_set1_ps(static_cast<float>(x + 1)), lane_x);
+			__m128 s = _mm_and_ps(_mm_cmpgt_ps(_mm_loadu_ps(src + x), zero), pos_1);
+			s = _mm_max_ps(s, _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(s), 4)));
+			s = _mm_max_ps(s, _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(s), 8)));
+			s = _mm_max_ps(s, carry);
+			carry = _mm_shuffle_ps(s, s, _MM_SHUFFLE(3, 3, 3, 3));
+
+			__m128i const none = _mm_castps_si128(_mm_cmpeq_ps(s, zero));
+			__m128i const d = _mm_cvttps_epi32(_mm_sub_ps(pos_1, s));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x),
+				_mm_or_si128(_mm_andnot_si128(none, d), _mm_and_si128(none, no_site)));
+		}
+		site = static_cast<int>(_mm_cvtss_f32(carry)) - 1;
+#endif
+		for (; x < width; ++ x)
+		{
+			if (src[x] > 0)
+			{
+				site = x;
+			}
+			dst[x] = (site < 0) ? NO_SITE : x - site;
+		}
 
-		bool changed = false;
-		int addr = y * width + x;
-		float old_dist = dist[addr];
-		if (old_dist > 0)
+		// Backward, replacing the offset if a covered pixel on the right is strictly closer
+		site = -1;
+		for (x = width - 1; x >= vec_width; -- x)
 		{
-			int offset_addr = (y + dy) * width + (x + dx);
-			int2 new_dist_xy = dist_xy[offset_addr] - int2(dx, dy);
-			float new_dist = AADist(img, grad, width, offset_addr, dist_xy[offset_addr], new_dist_xy);
-			if (new_dist < old_dist - EPSILON)
+			if (src[x] > 0)
+			{
+				site = x;
+			}
+			if ((site >= 0) && (site - x < std::abs(dst[x])))
 			{
-				dist_xy[addr] = new_dist_xy;
-				dist[addr] = new_dist;
-				changed = true;
+				dst[x] = x - site;
 			}
 		}
+#if defined(KLAYGE_SSE2_SUPPORT)
+		// Same running maximum from the right, with sites stored as width - x
+		__m128 const width_v = _mm_set1_ps(static_cast<float>(width));
+		carry = _mm_set1_ps((site < 0) ? 0.0f : static_cast<float>(width - site));
+		for (x = vec_width - 4; x >= 0; x -= 4)
+		{
+			__m128 const pos = _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), lane_x);
+			__m128 s = _mm_and_ps(_mm_cmpgt_ps(_mm_loadu_ps(src + x), zero), _mm_sub_ps(width_v, pos));
+			s = _mm_max_ps(s, _mm_castsi128_ps(_mm_srli_si128(_mm_castps_si128(s), 4)));
+			s = _mm_max_ps(s, _mm_castsi128_ps(_mm_srli_si128(_mm_castps_si128(s), 8)));
+			s = _mm_max_ps(s, carry);
+			carry = _mm_shuffle_ps(s, s, _MM_SHUFFLE(0, 0, 0, 0));
 
-		return changed;
+			__m128i const cur = _mm_loadu_si128(reinterpret_cast<__m128i const *>(dst + x));
+			__m128 const right_dist = _mm_sub_ps(_mm_sub_ps(width_v, s), pos);
+			__m128i const closer = _mm_castps_si128(_mm_and_ps(_mm_cmpgt_ps(s, zero),
+				_mm_cmplt_ps(right_dist, _mm_cvtepi32_ps(cur))));
+			__m128i const d = _mm_cvttps_epi32(_mm_sub_ps(zero, right_dist));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x),
+				_mm_or_si128(_mm_and_si128(closer, d), _mm_andnot_si128(closer, cur)));
+		}
+#endif
 	}
 
-	void AAEuclideanDistance(std::vector<float> const & img, std::vector<float2> const & grad,
-		int width, int height, std::vector<float>& dist)
+#if defined(KLAYGE_SSE2_SUPPORT)
+	// AADist of 4 candidate sites. offset is from the site to the pixel and val the clamped coverage of the site. A site with
+	// no coverage is at 1e10. Since the pixel itself has none, the offset is never 0 for a site that counts, and EdgeDistance
+	// always uses the offset as the gradient.
+	__m128 AADist4(__m128 offset_x, __m128 offset_y, __m128 val)
+	{
+		__m128 const zero = _mm_setzero_ps();
+		__m128 const half = _mm_set1_ps(0.5f);
+		__m128 const one = _mm_set1_ps(1);
+		__m128 const abs_mask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+
+		__m128 const di = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(offset_x, offset_x), _mm_mul_ps(offset_y, offset_y)));
+		__m128 const inv_di = _mm_div_ps(one, _mm_max_ps(di, one));
+		__m128 const ax = _mm_and_ps(offset_x, abs_mask);
+		__m128 const ay = _mm_and_ps(offset_y, abs_mask);
+		__m128 const nx = _mm_mul_ps(_mm_max_ps(ax, ay), inv_di);
+		__m128 const ny = _mm_mul_ps(_mm_min_ps(ax, ay), inv_di);
+
+		// The 3 cases of EdgeDistance. An axis aligned gradient falls in the middle one with the same result.
+		__m128 const v1 = _mm_div_ps(_mm_mul_ps(half, ny), _mm_max_ps(nx, half));
+		__m128 const two_nxy = _mm_add_ps(_mm_mul_ps(nx, ny), _mm_mul_ps(nx, ny));
+		__m128 const half_sum = _mm_mul_ps(half, _mm_add_ps(nx, ny));
+		__m128 const df_low = _mm_sub_ps(half_sum, _mm_sqrt_ps(_mm_mul_ps(two_nxy, val)));
+		__m128 const df_mid = _mm_mul_ps(_mm_sub_ps(half, val), nx);
+		__m128 const df_high = _mm_sub_ps(_mm_sqrt_ps(_mm_mul_ps(two_nxy, _mm_sub_ps(one, val))), half_sum);
+
+		__m128 const is_low = _mm_cmplt_ps(val, v1);
+		__m128 const is_mid = _mm_cmplt_ps(val, _mm_sub_ps(one, v1));
+		__m128 df = _mm_or_ps(_mm_and_ps(is_mid, df_mid), _mm_andnot_ps(is_mid, df_high));
+		df = _mm_or_ps(_mm_and_ps(is_low, df_low), _mm_andnot_ps(is_low, df));
+
+		__m128 const empty = _mm_cmpeq_ps(val, zero);
+		return _mm_or_ps(_mm_and_ps(empty, _mm_set1_ps(1e10f)), _mm_andnot_ps(empty, _mm_add_ps(di, df)));
+	}
+#endif
+
+	// The pixel with the nearest center isn't always the one with the nearest edge inside, so the pixels in a small window
+	// around it are tried as well. This replaces the local refinement done by the propagation passes of the anti-aliased EDT.
+	float SiteWindowDistance(std::vector<float> const & img, std::vector<float2> const & grad,
+		int width, int height, int x, int y, int2 const & site)
 	{
-		std::vector<int2> dist_xy(img.size(), int2(0, 0));
+		int const x0 = std::max(site.x() - SITE_SEARCH_RADIUS, 0);
+		int const x1 = std::min(site.x() + SITE_SEARCH_RADIUS, width - 1);
+		int const y0 = std::max(site.y() - SITE_SEARCH_RADIUS, 0);
+		int const y1 = std::min(site.y() + SITE_SEARCH_RADIUS, height - 1);
+
+#if defined(KLAYGE_SSE2_SUPPORT)
+		KFL_UNUSED(grad);
 
-		for (size_t i = 0; i < img.size(); ++ i)
+		int const WINDOW_SIZE = (SITE_SEARCH_RADIUS * 2 + 1) * (SITE_SEARCH_RADIUS * 2 + 1);
+		alignas(16) float offset_x[(WINDOW_SIZE + 3) & ~3];
+		alignas(16) float offset_y[(WINDOW_SIZE + 3) & ~3];
+		alignas(16) float val[(WINDOW_SIZE + 3) & ~3];
+		int num = 0;
+		for (int cy = y0; cy <= y1; ++ cy)
 		{
-			if (img[i] <= 0)
+			for (int cx = x0; cx <= x1; ++ cx)
 			{
-				dist[i] = 1e10f;
+				offset_x[num] = static_cast<float>(x - cx);
+				offset_y[num] = static_cast<float>(y - cy);
+				val[num] = MathLib::clamp(img[cy * width + cx], 0.0f, 1.0f);
+				++ num;
 			}
-			else if (img[i] < 1)
-			{
-				dist[i] = EdgeDistance(grad[i], img[i]);
-			}
-			else
+		}
+		for (; num & 3; ++ num)
+		{
+			offset_x[num] = 0;
+			offset_y[num] = 0;
+			val[num] = 0;
+		}
+
+		__m128 best = _mm_set1_ps(1e10f);
+		for (int i = 0; i < num; i += 4)
+		{
+			best = _mm_min_ps(best, AADist4(_mm_load_ps(offset_x + i), _mm_load_ps(offset_y + i), _mm_load_ps(val + i)));
+		}
+		best = _mm_min_ps(best, _mm_shuffle_ps(best, best, _MM_SHUFFLE(1, 0, 3, 2)));
+		best = _mm_min_ps(best, _mm_shuffle_ps(best, best, _MM_SHUFFLE(2, 3, 0, 1)));
+		return _mm_cvtss_f32(best);
+#else
+		int const addr = y * width + x;
+		float best_dist = 1e10f;
+		for (int cy = y0; cy <= y1; ++ cy)
+		{
+			for (int cx = x0; cx <= x1; ++ cx)
 			{
-				dist[i] = 0;
+				int2 const offset(x - cx, y - cy);
+				best_dist = std::min(best_dist, AADist(img, grad, width, addr, offset, offset));
 			}
 		}
+		return best_dist;
+#endif
+	}
 
-		bool changed;
-		do
-		{
-			changed = false;
+	// Exact Euclidean feature transform, separable in rows and columns (Felzenszwalb & Huttenlocher). For every pixel, finds
+	// the offset to the nearest pixel that has coverage. Pixels with no coverage anywhere get an offset of INT_MAX.
+	void EuclideanFeatureTransform(std::vector<float> const & img, int width, int height, std::vector<int2>& dist_xy)
+	{
+		std::vector<int> row_dx(img.size());
+		parallel_for(Context::Instance().ThreadPool(), height, NumJobs(height * width),
+			[&img, &row_dx, width](uint32_t y_begin, uint32_t y_end)
+			{
+				for (uint32_t y = y_begin; y < y_end; ++ y)
+				{
+					RowFeatureTransform(&img[y * width], width, &row_dx[y * width]);
+				}
+			});
 
-			for (int y = 1; y < height; ++ y)
+		// Columns: lower envelope of the parabolas (y - q)^2 + row_dx(q)^2
+		dist_xy.resize(img.size());
+		parallel_for(Context::Instance().ThreadPool(), width, NumJobs(width * height),
+			[&row_dx, &dist_xy, width, height](uint32_t x_begin, uint32_t x_end)
 			{
-				// Scan right, propagate distances from above & left
-				for (int x = 0; x < width; ++ x)
+				std::vector<int> sites(height);
+				std::vector<float> bounds(height + 1);
+				std::vector<int64_t> f(height);
+
+				for (uint32_t x = x_begin; x < x_end; ++ x)
 				{
-					if (x > 0)
+					int k = -1;
+					for (int q = 0; q < height; ++ q)
 					{
-						changed |= UpdateDistance(x, y, -1, +0, img, width, grad, dist_xy, dist);
-						changed |= UpdateDistance(x, y, -1, -1, img, width, grad, dist_xy, dist);
+						int const dx = row_dx[q * width + x];
+						if (dx == NO_SITE)
+						{
+							continue;
+						}
+
+						f[q] = static_cast<int64_t>(dx) * dx + static_cast<int64_t>(q) * q;
+						float s = 0;
+						while (k >= 0)
+						{
+							int const v = sites[k];
+							s = static_cast<float>(f[q] - f[v]) / (2 * (q - v));
+							if (s > bounds[k])
+							{
+								break;
+							}
+							-- k;
+						}
+
+						++ k;
+						sites[k] = q;
+						bounds[k] = (0 == k) ? -1e10f : s;
 					}
-					changed |= UpdateDistance(x, y, +0, -1, img, width, grad, dist_xy, dist);
-					if (x < width - 1)
+
+					if (k < 0)
 					{
-						changed |= UpdateDistance(x, y, +1, -1, img, width, grad, dist_xy, dist);
+						for (int y = 0; y < height; ++ y)
+						{
+							dist_xy[y * width + x] = int2(NO_SITE, NO_SITE);
+						}
 					}
-				}
+					else
+					{
+						bounds[k + 1] = 1e10f;
 
-				// Scan left, propagate distance from right
-				for (int x = width - 2; x >= 0; -- x)
-				{
-					changed |= UpdateDistance(x, y, +1, +0, img, width, grad, dist_xy, dist);
+						int j = 0;
+						for (int y = 0; y < height; ++ y)
+						{
+							while (bounds[j + 1] < y)
+							{
+								++ j;
+							}
+
+							int const v = sites[j];
+							dist_xy[y * width + x] = int2(row_dx[v * width + x], y - v);
+						}
+					}
 				}
-			}
+			});
+	}
+
+	void AAEuclideanDistance(std::vector<float> const & img, std::vector<float2> const & grad,
+		int width, int height, std::vector<float>& dist)
+	{
+		std::vector<int2> dist_xy;
+		EuclideanFeatureTransform(img, width, height, dist_xy);
 
-			for (int y = height - 2; y >= 0; -- y)
+		parallel_for(Context::Instance().ThreadPool(), height, NumJobs(height * width),
+			[&img, &grad, &dist_xy, &dist, width, height](uint32_t y_begin, uint32_t y_end)
 			{
-				// Scan left, propagate distances from below & right
-				for (int x = width - 1; x >= 0; -- x)
+				for (int y = y_begin; y < static_cast<int>(y_end); ++ y)
 				{
-					if (x < width - 1)
+					for (int x = 0; x < width; ++ x)
 					{
-						changed |= UpdateDistance(x, y, +1, +0, img, width, grad, dist_xy, dist);
-						changed |= UpdateDistance(x, y, +1, +1, img, width, grad, dist_xy, dist);
-					}
-					changed |= UpdateDistance(x, y, +0, +1, img, width, grad, dist_xy, dist);
-					if (x > 0)
-					{
-						changed |= UpdateDistance(x, y, -1, +1, img, width, grad, dist_xy, dist);
+						int const addr = y * width + x;
+						if (img[addr] >= 1)
+						{
+							dist[addr] = 0;
+						}
+						else if (img[addr] > 0)
+						{
+							dist[addr] = EdgeDistance(grad[addr], img[addr]);
+						}
+						else if (dist_xy[addr].x() == NO_SITE)
+						{
+							dist[addr] = 1e10f;
+						}
+						else
+						{
+							int2 const site(x - dist_xy[addr].x(), y - dist_xy[addr].y());
+							dist[addr] = SiteWindowDistance(img, grad, width, height, x, y, site);
+						}
 					}
 				}
-
-				// Scan right, propagate distance from left
-				for (int x = 1; x < width; ++ x)
-				{
-					changed |= UpdateDistance(x, y, -1, +0, img, width, grad, dist_xy, dist);
-				}
-			}
-		} while (changed);
+			});
 	}
 
 	template KLAYGE_CORE_API void Downsample2x(std::vector<float> const & input_data, uint32_t input_width, uint32_t input_height,
@@ -202,16 +429,20 @@ namespace KlayGE
 
 		output_data.resize(output_width * output_height);
 
-		for (uint32_t y = 0; y < output_height; ++ y)
-		{
-			for (uint32_t x = 0; x < output_width; ++ x)
+		parallel_for(Context::Instance().ThreadPool(), output_height, NumJobs(output_height * output_width * 4),
+			[&input_data, &output_data, input_width, output_width](uint32_t y_begin, uint32_t y_end)
 			{
-				output_data[y * output_width + x] = (input_data[(y * 2 + 0) * input_width + (x * 2 + 0)]
-					+ input_data[(y * 2 + 0) * input_width + (x * 2 + 1)]
-					+ input_data[(y * 2 + 1) * input_width + (x * 2 + 0)]
-					+ input_data[(y * 2 + 1) * input_width + (x * 2 + 1)]) * 0.25f;
-			}
-		}
+				for (uint32_t y = y_begin; y < y_end; ++ y)
+				{
+					T const * src0 = &input_data[(y * 2 + 0) * input_width];
+					T const * src1 = &input_data[(y * 2 + 1) * input_width];
+					T* dst = &output_data[y * output_width];
+					for (uint32_t x = 0; x < output_width; ++ x)
+					{
+						dst[x] = (src0[x * 2 + 0] + src0[x * 2 + 1] + src1[x * 2 + 0] + src1[x * 2 + 1]) * 0.25f;
+					}
+				}
+			});
 	}
 
 	void ComputeGradient(std::vector<float> const & img, int w, int h, std::vector<float2>& grad)
@@ -220,20 +451,31 @@ namespace KlayGE
 		BOOST_ASSERT(grad.size() == static_cast<size_t>(w * h));
 
 		grad.assign(w * h, float2(0, 0));
-		for (int y = 1; y < h - 1; ++ y)
+		if ((w < 3) || (h < 3))
 		{
-			for (int x = 1; x < w - 1; ++ x)
+			return;
+		}
+
+		parallel_for(Context::Instance().ThreadPool(), h - 2, NumJobs((h - 2) * w), [&img, &grad, w](uint32_t y_begin, uint32_t y_end)
 			{
-				int addr = y * w + x;
-				if ((img[addr] > 0) && (img[addr] < 1))
+				for (uint32_t y = y_begin + 1; y < y_end + 1; ++ y)
 				{
-					float s0 = -img[addr - w - 1] + img[addr + w + 1];
-					float s1 = -img[addr + w - 1] + img[addr - w + 1];
-					grad[addr] = MathLib::normalize(float2(s0 + s1 - SQRT2 * (img[addr - 1] - img[addr + 1]),
-						s0 - s1 - SQRT2 * (img[addr - w] - img[addr + w])));
+					float const * row = &img[y * w];
+					float const * above = row - w;
+					float const * below = row + w;
+					float2* dst = &grad[y * w];
+					for (int x = 1; x < w - 1; ++ x)
+					{
+						if ((row[x] > 0) && (row[x] < 1))
+						{
+							float s0 = -above[x - 1] + below[x + 1];
+							float s1 = -below[x - 1] + above[x + 1];
+							dst[x] = MathLib::normalize(float2(s0 + s1 - SQRT2 * (row[x - 1] - row[x + 1]),
+								s0 - s1 - SQRT2 * (above[x] - below[x])));
+						}
+					}
 				}
-			}
-		}
+			});
 	}
 
 	void ComputeDistance(std::vector<float> const & aa_2x_data, uint32_t input_width, uint32_t input_height,
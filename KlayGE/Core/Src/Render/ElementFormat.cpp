@@ -37,6 +37,566 @@
 #include <KFL/Math.hpp>
 #include <KFL/Half.hpp>
 
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+#if defined(KLAYGE_SSE2_SUPPORT)
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+	using namespace KlayGE;
+
+	union FNI
+	{
+		float f;
+		uint32_t i;
+	};
+
+	// Little-endian load of a small element. Assembling the bytes avoids the store forwarding stall of a short memcpy into
+	// a wider variable.
+	template <uint32_t size>
+	uint64_t LoadElement(uint8_t const * p)
+	{
+		uint64_t bits = 0;
+		for (uint32_t b = 0; b < size; ++ b)
+		{
+			bits |= static_cast<uint64_t>(p[b]) << (b * 8);
+		}
+		return bits;
+	}
+
+	// Per-value tables for 8-bit channels. They hold exactly what the scalar formulas produce, so table and formula paths
+	// give identical results.
+	class UNorm8Tables final
+	{
+	public:
+		static UNorm8Tables const & Instance()
+		{
+			static UNorm8Tables const tables;
+			return tables;
+		}
+
+		float SRGBToLinear(uint8_t v) const
+		{
+			return srgb_to_linear_[v];
+		}
+
+		uint8_t LinearToSRGB(float v) const
+		{
+			FNI const fni = { v };
+			if (fni.i >= ONE_BITS)
+			{
+				// Negative values and NaN go to 0, like the scalar formula
+				return ((fni.i & 0x80000000U) || (fni.i > 0x7F800000U)) ? 0 : 255;
+			}
+
+			// A bucket spans 2^16 ulps, which is less than one sRGB step, so the scan moves at most a couple of times
+			uint32_t k = srgb_buckets_[fni.i >> 16];
+			while ((k < 255) && (v >= srgb_thresholds_[k]))
+			{
+				++ k;
+			}
+			return static_cast<uint8_t>(k);
+		}
+
+	private:
+		UNorm8Tables()
+		{
+			for (uint32_t i = 0; i < 256; ++ i)
+			{
+				srgb_to_linear_[i] = MathLib::srgb_to_linear(i / 255.0f);
+			}
+
+			// srgb_thresholds_[k - 1] is the smallest linear value encoded to k. Positive floats are ordered like their bits,
+			// so a binary search on the bits finds it exactly.
+			FNI const one = { 1.0f };
+			for (int k = 1; k < 256; ++ k)
+			{
+				uint32_t lo = 0;
+				uint32_t hi = one.i;
+				while (lo < hi)
+				{
+					uint32_t const mid = lo + (hi - lo) / 2;
+					FNI v;
+					v.i = mid;
+					if (EncodeSRGB(v.f) >= k)
+					{
+						hi = mid;
+					}
+					else
+					{
+						lo = mid + 1;
+					}
+				}
+
+				FNI threshold;
+				threshold.i = lo;
+				srgb_thresholds_[k - 1] = threshold.f;
+			}
+
+			for (uint32_t i = 0; i < srgb_buckets_.size(); ++ i)
+			{
+				FNI start;
+				start.i = i << 16;
+				srgb_buckets_[i] = static_cast<uint8_t>(std::upper_bound(srgb_thresholds_.begin(), srgb_thresholds_.end(), start.f)
+					- srgb_thresholds_.begin());
+			}
+		}
+
+		static int EncodeSRGB(float v)
+		{
+			return MathLib::clamp(static_cast<int>(MathLib::linear_to_srgb(v) * 255.0f + 0.5f), 0, 255);
+		}
+
+	private:
+		static uint32_t constexpr ONE_BITS = 0x3F800000U;
+
+		std::array<float, 256> srgb_to_linear_;
+		std::array<float, 255> srgb_thresholds_;
+		std::array<uint8_t, (ONE_BITS >> 16)> srgb_buckets_;
+	};
+
+#if defined(KLAYGE_SSE2_SUPPORT)
+	// Lanes hold a 5-bit exponent at bits 23-27 and the mantissa right below it, sign cleared. That is the layout of half,
+	// float11 and float10 after a shift.
+	__m128 SmallFloatToFloat(__m128i bits)
+	{
+		__m128i const exp_mask = _mm_set1_epi32(0x1F << 23);
+		__m128i const exp = _mm_and_si128(bits, exp_mask);
+		__m128i o = _mm_add_epi32(bits, _mm_set1_epi32((127 - 15) << 23));
+
+		// Inf and NaN go to exponent 255
+		__m128i const is_inf_nan = _mm_cmpeq_epi32(exp, exp_mask);
+		o = _mm_add_epi32(o, _mm_and_si128(is_inf_nan, _mm_set1_epi32((128 - 16) << 23)));
+
+		// Zero and denormals are renormalized by a float subtraction
+		__m128i const is_denorm = _mm_cmpeq_epi32(exp, _mm_setzero_si128());
+		__m128 const denorm = _mm_sub_ps(_mm_castsi128_ps(_mm_add_epi32(o, _mm_set1_epi32(1 << 23))),
+			_mm_castsi128_ps(_mm_set1_epi32(113 << 23)));
+
+		return _mm_or_ps(_mm_and_ps(_mm_castsi128_ps(is_denorm), denorm),
+			_mm_andnot_ps(_mm_castsi128_ps(is_denorm), _mm_castsi128_ps(o)));
+	}
+
+	// Lanes hold half bits in their low 16 bits
+	__m128 HalfToFloat(__m128i h)
+	{
+		__m128i const sign = _mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(0x8000)), 16);
+		__m128 const abs_f = SmallFloatToFloat(_mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(0x7FFF)), 13));
+		return _mm_or_ps(abs_f, _mm_castsi128_ps(sign));
+	}
+
+	// Rounds like half(float). Returns false when a lane needs the scalar path: half denormals, overflow, Inf or NaN.
+	bool FloatToHalf(__m128 v, __m128i& h)
+	{
+		__m128i const i = _mm_castps_si128(v);
+		__m128i const abs_i = _mm_and_si128(i, _mm_set1_epi32(0x7FFFFFFF));
+		__m128i const exp = _mm_srli_epi32(abs_i, 23);
+
+		__m128i const is_normal = _mm_and_si128(_mm_cmpgt_epi32(exp, _mm_set1_epi32(127 - 15)),
+			_mm_cmplt_epi32(exp, _mm_set1_epi32(127 + 16)));
+		__m128i const is_zero = _mm_cmplt_epi32(exp, _mm_set1_epi32(127 - 25));
+		if (_mm_movemask_ps(_mm_castsi128_ps(_mm_or_si128(is_normal, is_zero))) != 0xF)
+		{
+			return false;
+		}
+
+		__m128i const sign = _mm_and_si128(_mm_srli_epi32(i, 16), _mm_set1_epi32(0x8000));
+		__m128i const rebiased = _mm_sub_epi32(abs_i, _mm_set1_epi32((127 - 15) << 23));
+		__m128i const rounded = _mm_srli_epi32(_mm_add_epi32(rebiased, _mm_set1_epi32(0x1000)), 13);
+		h = _mm_and_si128(is_normal, _mm_or_si128(sign, rounded));
+		return true;
+	}
+
+	// Converts 4 channels to UNORM8 with the same rounding as the scalar formula, the result is in the low 32 bits
+	uint32_t PackUNorm8(__m128 v)
+	{
+		__m128i const i = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(v, _mm_set1_ps(255.0f)), _mm_set1_ps(0.5f)));
+		__m128i const packed = _mm_packus_epi16(_mm_packs_epi32(i, i), _mm_setzero_si128());
+		return static_cast<uint32_t>(_mm_cvtsi128_si32(packed));
+	}
+
+	// All ones in the first num_channels lanes
+	__m128 ChannelMask(uint32_t num_channels)
+	{
+		return _mm_cmplt_ps(_mm_set_ps(3, 2, 1, 0), _mm_set1_ps(static_cast<float>(num_channels)));
+	}
+
+	__m128 LoadColor(Color const & clr)
+	{
+		return _mm_loadu_ps(&clr[0]);
+	}
+
+	void StoreColor(Color& clr, __m128 v)
+	{
+		_mm_storeu_ps(&clr[0], v);
+	}
+#endif
+
+	// ABGR8 and ARGB8 to float. swap_rb selects ARGB8.
+	void UNorm8x4ToABGR32F(uint8_t const * p, uint32_t num_elems, Color* output, bool swap_rb)
+	{
+		uint32_t i = 0;
+#if defined(KLAYGE_SSE2_SUPPORT)
+		__m128 const inv_scale = _mm_set1_ps(255.0f);
+		__m128i const zero = _mm_setzero_si128();
+		for (; i + 4 <= num_elems; i += 4, p += 16, output += 4)
+		{
+			__m128i const bytes = _mm_loadu_si128(reinterpret_cast<__m128i const *>(p));
+			__m128i const words_lo = _mm_unpacklo_epi8(bytes, zero);
+			__m128i const words_hi = _mm_unpackhi_epi8(bytes, zero);
+			__m128 clrs[] =
+			{
+				_mm_div_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(words_lo, zero)), inv_scale),
+				_mm_div_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(words_lo, zero)), inv_scale),
+				_mm_div_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(words_hi, zero)), inv_scale),
+				_mm_div_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(words_hi, zero)), inv_scale)
+			};
+			for (uint32_t j = 0; j < 4; ++ j)
+			{
+				if (swap_rb)
+				{
+					clrs[j] = _mm_shuffle_ps(clrs[j], clrs[j], _MM_SHUFFLE(3, 0, 1, 2));
+				}
+				StoreColor(output[j], clrs[j]);
+			}
+		}
+#endif
+		uint32_t const r = swap_rb ? 2 : 0;
+		uint32_t const b = swap_rb ? 0 : 2;
+		for (; i < num_elems; ++ i, p += 4, ++ output)
+		{
+			*output = Color(p[r] / 255.0f, p[1] / 255.0f, p[b] / 255.0f, p[3] / 255.0f);
+		}
+	}
+
+	// 1 to 3 UNORM8 channels to float, missing channels are filled with (0, 0, 0, 1)
+	template <uint32_t num_channels>
+	void UNorm8ToABGR32F(uint8_t const * p, uint32_t num_elems, Color* output)
+	{
+#if defined(KLAYGE_SSE2_SUPPORT)
+		__m128 const channel_mask = ChannelMask(num_channels);
+		__m128 const fill = _mm_andnot_ps(channel_mask, _mm_set_ps(1, 0, 0, 0));
+		__m128i const zero = _mm_setzero_si128();
+		for (uint32_t i = 0; i < num_elems; ++ i, p += num_channels, ++ output)
+		{
+			uint32_t const bits = static_cast<uint32_t>(LoadElement<num_channels>(p));
+			__m128i const words = _mm_unpacklo_epi8(_mm_cvtsi32_si128(static_cast<int>(bits)), zero);
+			__m128 const v = _mm_div_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(words, zero)), _mm_set1_ps(255.0f));
+			StoreColor(*output, _mm_or_ps(_mm_and_ps(v, channel_mask), fill));
+		}
+#else
+		for (uint32_t i = 0; i < num_elems; ++ i, p += num_channels, ++ output)
+		{
+			Color clr(0, 0, 0, 1);
+			for (uint32_t c = 0; c < num_channels; ++ c)
+			{
+				clr[c] = p[c] / 255.0f;
+			}
+			*output = clr;
+		}
+#endif
+	}
+
+	// Float to 1 to 4 UNORM8 channels stored in r, g, b, a order. swap_rb selects ARGB8.
+	template <uint32_t elem_size>
+	void ABGR32FToUNorm8(Color const * input, uint32_t num_elems, uint8_t* p, bool swap_rb)
+	{
+#if defined(KLAYGE_SSE2_SUPPORT)
+		uint32_t i = 0;
+		if (4 == elem_size)
+		{
+			__m128 const scale = _mm_set1_ps(255.0f);
+			__m128 const bias = _mm_set1_ps(0.5f);
+			for (; i + 4 <= num_elems; i += 4, input += 4, p += 16)
+			{
+				__m128i clrs[4];
+				for (uint32_t j = 0; j < 4; ++ j)
+				{
+					__m128 v = LoadColor(input[j]);
+					if (swap_rb)
+					{
+						v = _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 0, 1, 2));
+					}
+					clrs[j] = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(v, scale), bias));
+				}
+				__m128i const packed = _mm_packus_epi16(_mm_packs_epi32(clrs[0], clrs[1]), _mm_packs_epi32(clrs[2], clrs[3]));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(p), packed);
+			}
+		}
+		for (; i < num_elems; ++ i, ++ input, p += elem_size)
+		{
+			__m128 v = LoadColor(*input);
+			if (swap_rb)
+			{
+				v = _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 0, 1, 2));
+			}
+			uint32_t const packed = PackUNorm8(v);
+			std::memcpy(p, &packed, elem_size);
+		}
+#else
+		for (uint32_t i = 0; i < num_elems; ++ i, ++ input, p += elem_size)
+		{
+			float const channels[] = { swap_rb ? input->b() : input->r(), input->g(), swap_rb ? input->r() : input->b(), input->a() };
+			for (uint32_t c = 0; c < elem_size; ++ c)
+			{
+				p[c] = static_cast<uint8_t>(MathLib::clamp(static_cast<int>(channels[c] * 255.0f + 0.5f), 0, 255));
+			}
+		}
+#endif
+	}
+
+	// 1 to 4 half channels to float, missing channels are filled with (0, 0, 0, 1)
+	template <uint32_t num_channels>
+	void HalfToABGR32F(uint8_t const * p, uint32_t num_elems, Color* output)
+	{
+#if defined(KLAYGE_SSE2_SUPPORT)
+		__m128 const channel_mask = ChannelMask(num_channels);
+		__m128 const fill = _mm_andnot_ps(channel_mask, _mm_set_ps(1, 0, 0, 0));
+		uint32_t constexpr elem_size = num_channels * sizeof(uint16_t);
+		for (uint32_t i = 0; i < num_elems; ++ i, p += elem_size, ++ output)
+		{
+			uint64_t const bits = LoadElement<elem_size>(p);
+			__m128i const halves = _mm_unpacklo_epi16(_mm_set_epi32(0, 0, static_cast<int>(bits >> 32), static_cast<int>(bits)),
+				_mm_setzero_si128());
+			__m128 const v = _mm_and_ps(HalfToFloat(halves), channel_mask);
+			StoreColor(*output, _mm_or_ps(v, fill));
+		}
+#else
+		for (uint32_t i = 0; i < num_elems; ++ i, p += num_channels * sizeof(uint16_t), ++ output)
+		{
+			Color clr(0, 0, 0, 1);
+			for (uint32_t c = 0; c < num_channels; ++ c)
+			{
+				clr[c] = reinterpret_cast<half const *>(p)[c];
+			}
+			*output = clr;
+		}
+#endif
+	}
+
+	// Float to 1 to 4 half channels
+	template <uint32_t num_channels>
+	void ABGR32FToHalf(Color const * input, uint32_t num_elems, uint8_t* p)
+	{
+		uint32_t constexpr elem_size = num_channels * sizeof(uint16_t);
+#if defined(KLAYGE_SSE2_SUPPORT)
+		__m128 const channel_mask = ChannelMask(num_channels);
+#endif
+		for (uint32_t i = 0; i < num_elems; ++ i, ++ input, p += elem_size)
+		{
+#if defined(KLAYGE_SSE2_SUPPORT)
+			// Unused lanes are zeroed so they never force the scalar path
+			__m128i h;
+			if (FloatToHalf(_mm_and_ps(LoadColor(*input), channel_mask), h))
+			{
+				// Sign extends so the saturating pack keeps the bits
+				h = _mm_srai_epi32(_mm_slli_epi32(h, 16), 16);
+				uint64_t bits;
+				_mm_storel_epi64(reinterpret_cast<__m128i*>(&bits), _mm_packs_epi32(h, h));
+				std::memcpy(p, &bits, elem_size);
+				continue;
+			}
+#endif
+			half* s = reinterpret_cast<half*>(p);
+			for (uint32_t c = 0; c < num_channels; ++ c)
+			{
+				s[c] = half((*input)[c]);
+			}
+		}
+	}
+
+	void A2BGR10ToABGR32F(uint8_t const * p, uint32_t num_elems, Color* output)
+	{
+#if defined(KLAYGE_SSE2_SUPPORT)
+		__m128i const mask = _mm_set_epi32(0x03, 0x03FF, 0x03FF, 0x03FF);
+		__m128 const scale = _mm_set_ps(3.0f, 1023.0f, 1023.0f, 1023.0f);
+		for (uint32_t i = 0; i < num_elems; ++ i, p += 4, ++ output)
+		{
+			uint32_t s;
+			std::memcpy(&s, p, sizeof(s));
+			__m128i const channels = _mm_and_si128(_mm_set_epi32(s >> 30, s >> 20, s >> 10, s), mask);
+			StoreColor(*output, _mm_div_ps(_mm_cvtepi32_ps(channels), scale));
+		}
+#else
+		for (uint32_t i = 0; i < num_elems; ++ i, p += 4, ++ output)
+		{
+			uint32_t const s = *reinterpret_cast<uint32_t const *>(p);
+			*output = Color((s & 0x03FF) / 1023.0f, ((s >> 10) & 0x03FF) / 1023.0f,
+				((s >> 20) & 0x03FF) / 1023.0f, ((s >> 30) & 0x03) / 3.0f);
+		}
+#endif
+	}
+
+	void ABGR32FToA2BGR10(Color const * input, uint32_t num_elems, uint8_t* p)
+	{
+#if defined(KLAYGE_SSE2_SUPPORT)
+		__m128 const scale = _mm_set_ps(3.0f, 1023.0f, 1023.0f, 1023.0f);
+		for (uint32_t i = 0; i < num_elems; ++ i, ++ input, p += 4)
+		{
+			// Clamping before the truncation gives the same result as clamping the integers
+			__m128 const v = _mm_min_ps(_mm_max_ps(_mm_add_ps(_mm_mul_ps(LoadColor(*input), scale), _mm_set1_ps(0.5f)),
+				_mm_setzero_ps()), scale);
+			alignas(16) int32_t channels[4];
+			_mm_store_si128(reinterpret_cast<__m128i*>(channels), _mm_cvttps_epi32(v));
+			uint32_t const s = channels[0] | (channels[1] << 10) | (channels[2] << 20) | (static_cast<uint32_t>(channels[3]) << 30);
+			std::memcpy(p, &s, sizeof(s));
+		}
+#else
+		for (uint32_t i = 0; i < num_elems; ++ i, ++ input, p += 4)
+		{
+			int r = MathLib::clamp(static_cast<int>(input->r() * 1023.0f + 0.5f), 0, 1023);
+			int g = MathLib::clamp(static_cast<int>(input->g() * 1023.0f + 0.5f), 0, 1023);
+			int b = MathLib::clamp(static_cast<int>(input->b() * 1023.0f + 0.5f), 0, 1023);
+			int a = MathLib::clamp(static_cast<int>(input->a() * 3.0f + 0.5f), 0, 3);
+
+			*reinterpret_cast<uint32_t*>(p) = r | (g << 10) | (b << 20) | (a << 30);
+		}
+#endif
+	}
+
+#if defined(KLAYGE_SSE2_SUPPORT)
+	void B10G11R11FToABGR32F(uint8_t const * p, uint32_t num_elems, Color* output)
+	{
+		for (uint32_t i = 0; i < num_elems; ++ i, p += 4, ++ output)
+		{
+			// E5B5 E5G6 E5R6
+			uint32_t s;
+			std::memcpy(&s, p, sizeof(s));
+			__m128i const bits = _mm_set_epi32(0, ((s >> 22) & 0x03FF) << 18, ((s >> 11) & 0x07FF) << 17, (s & 0x07FF) << 17);
+			StoreColor(*output, _mm_add_ps(SmallFloatToFloat(bits), _mm_set_ps(1, 0, 0, 0)));
+		}
+	}
+#endif
+
+	void SRGB8ToABGR32F(uint8_t const * p, uint32_t num_elems, Color* output, bool swap_rb)
+	{
+		auto const & tables = UNorm8Tables::Instance();
+		uint32_t const r = swap_rb ? 2 : 0;
+		uint32_t const b = swap_rb ? 0 : 2;
+		for (uint32_t i = 0; i < num_elems; ++ i, p += 4, ++ output)
+		{
+			*output = Color(tables.SRGBToLinear(p[r]), tables.SRGBToLinear(p[1]), tables.SRGBToLinear(p[b]),
+				tables.SRGBToLinear(p[3]));
+		}
+	}
+
+	void ABGR32FToSRGB8(Color const * input, uint32_t num_elems, uint8_t* p, bool swap_rb)
+	{
+		auto const & tables = UNorm8Tables::Instance();
+		uint32_t const r = swap_rb ? 2 : 0;
+		uint32_t const b = swap_rb ? 0 : 2;
+		for (uint32_t i = 0; i < num_elems; ++ i, ++ input, p += 4)
+		{
+			p[r] = tables.LinearToSRGB(input->r());
+			p[1] = tables.LinearToSRGB(input->g());
+			p[b] = tables.LinearToSRGB(input->b());
+			p[3] = tables.LinearToSRGB(input->a());
+		}
+	}
+
+	// Byte positions of r, g, b and a in 8-bit UNORM formats, -1 for missing channels. Converting between these formats only
+	// moves bytes around.
+	struct UNorm8Layout
+	{
+		uint32_t size;
+		bool srgb;
+		int8_t offsets[4];
+	};
+
+	bool GetUNorm8Layout(ElementFormat fmt, UNorm8Layout& layout)
+	{
+		switch (fmt)
+		{
+		case EF_A8:
+			layout = { 1, false, { -1, -1, -1, 0 } };
+			return true;
+
+		case EF_R8:
+			layout = { 1, false, { 0, -1, -1, -1 } };
+			return true;
+
+		case EF_GR8:
+			layout = { 2, false, { 0, 1, -1, -1 } };
+			return true;
+
+		case EF_BGR8:
+			layout = { 3, false, { 0, 1, 2, -1 } };
+			return true;
+
+		case EF_ABGR8:
+			layout = { 4, false, { 0, 1, 2, 3 } };
+			return true;
+
+		case EF_ARGB8:
+			layout = { 4, false, { 2, 1, 0, 3 } };
+			return true;
+
+		case EF_ABGR8_SRGB:
+			layout = { 4, true, { 0, 1, 2, 3 } };
+			return true;
+
+		case EF_ARGB8_SRGB:
+			layout = { 4, true, { 2, 1, 0, 3 } };
+			return true;
+
+		default:
+			return false;
+		}
+	}
+
+	void SwapRB8(uint8_t const * p, uint32_t num_elems, uint8_t* output)
+	{
+		uint32_t i = 0;
+#if defined(KLAYGE_SSE2_SUPPORT)
+		__m128i const ga_mask = _mm_set1_epi32(0xFF00FF00);
+		__m128i const low_mask = _mm_set1_epi32(0x000000FF);
+		for (; i + 4 <= num_elems; i += 4, p += 16, output += 16)
+		{
+			__m128i const v = _mm_loadu_si128(reinterpret_cast<__m128i const *>(p));
+			__m128i const swapped = _mm_or_si128(_mm_and_si128(v, ga_mask),
+				_mm_or_si128(_mm_and_si128(_mm_srli_epi32(v, 16), low_mask), _mm_slli_epi32(_mm_and_si128(v, low_mask), 16)));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(output), swapped);
+		}
+#endif
+		for (; i < num_elems; ++ i, p += 4, output += 4)
+		{
+			output[0] = p[2];
+			output[1] = p[1];
+			output[2] = p[0];
+			output[3] = p[3];
+		}
+	}
+
+	void ConvertUNorm8(UNorm8Layout const & dst_layout, uint8_t* output, UNorm8Layout const & src_layout, uint8_t const * p,
+		uint32_t num_elems)
+	{
+		if ((4 == dst_layout.size) && (4 == src_layout.size) && (dst_layout.offsets[0] == src_layout.offsets[2]))
+		{
+			SwapRB8(p, num_elems, output);
+			return;
+		}
+
+		// Missing channels read as (0, 0, 0, 1), the same as ConvertToABGR32F fills in
+		uint8_t const defaults[] = { 0, 0, 0, 255 };
+		for (uint32_t i = 0; i < num_elems; ++ i, p += src_layout.size, output += dst_layout.size)
+		{
+			for (uint32_t c = 0; c < 4; ++ c)
+			{
+				int const dst_offset = dst_layout.offsets[c];
+				if (dst_offset >= 0)
+				{
+					int const src_offset = src_layout.offsets[c];
+					output[dst_offset] = (src_offset >= 0) ? p[src_offset] : defaults[c];
+				}
+			}
+		}
+	}
+}
+
 namespace KlayGE
 {
 	void ConvertToABGR32F(ElementFormat fmt, void const * input, uint32_t num_elems, Color* output)
@@ -77,17 +637,11 @@ namespace KlayGE
 			break;
 
 		case EF_R8:
-			for (uint32_t i = 0; i < num_elems; ++ i, p += elem_size, ++ output)
-			{
-				*output = Color(*p / 255.0f, 0, 0, 1);
-			}
+			UNorm8ToABGR32F<1>(p, num_elems, output);
 			break;
 
 		case EF_GR8:
-			for (uint32_t i = 0; i < num_elems; ++ i, p += elem_size, ++ output)
-			{
-				*output = Color(p[0] / 255.0f, p[1] / 255.0f, 0, 1);
-			}
+			UNorm8ToABGR32F<2>(p, num_elems, output);
 			break;
 
 		case EF_SIGNED_GR8:
@@ -99,10 +653,7 @@ namespace KlayGE
 			break;
 
 		case EF_BGR8:
-			for (uint32_t i = 0; i < num_elems; ++ i, p += elem_size, ++ output)
-			{
-				*output = Color(p[0] / 255.0f, p[1] / 255.0f, p[2] / 255.0f, 1);
-			}
+			UNorm8ToABGR32F<3>(p, num_elems, output);
 			break;
 
 		case EF_SIGNED_BGR8:
@@ -114,17 +665,11 @@ namespace KlayGE
 			break;
 
 		case EF_ARGB8:
-			for (uint32_t i = 0; i < num_elems; ++ i, p += elem_size, ++ output)
-			{
-				*output = Color(p[2] / 255.0f, p[1] / 255.0f, p[0] / 255.0f, p[3] / 255.0f);
-			}
+			UNorm8x4ToABGR32F(p, num_elems, output, true);
 			break;
 
 		case EF_ABGR8:
-			for (uint32_t i = 0; i < num_elems; ++ i, p += elem_size, ++ output)
-			{
-				*output = Color(p[0] / 255.0f, p[1] / 255.0f, p[2] / 255.0f, p[3] / 255.0f);
-			}
+			UNorm8x4ToABGR32F(p, num_elems, output, false);
 			break;
 
 		case EF_SIGNED_ABGR8:
@@ -136,12 +681,7 @@ namespace KlayGE
 			break;
 
 		case EF_A2BGR10:
-			for (uint32_t i = 0; i < num_elems; ++ i, p += elem_size, ++ output)
-			{
-				uint32_t const s = *reinterpret_cast<uint32_t const *>(p);
-				*output = Color((s & 0x03FF) / 1023.0f, ((s >> 10) & 0x03FF) / 1023.0f,
-					((s >> 20) & 0x03FF) / 1023.0f, ((s >> 30) & 0x03) / 3.0f);
-			}
+			A2BGR10ToABGR32F(p, num_elems, output);
 			break;
 
 		case EF_SIGNED_A2BGR10:
@@ -538,22 +1078,17 @@ namespace KlayGE
 
 
 		case EF_R16F:
-			for (uint32_t i = 0; i < num_elems; ++ i, p += elem_size, ++ output)
-			{
-				half const s = *reinterpret_cast<half const *>(p);
-				*output = Color(s, 0, 0, 1);
-			}
+			HalfToABGR32F<1>(p, num_elems, output);
 			break;
 
 		case EF_GR16F:
-			for (uint32_t i = 0; i < num_elems; ++ i, p += elem_size, ++ output)
-			{
-				half const * s = reinterpret_cast<half const *>(p);
-				*output = Color(s[0], s[1], 0, 1);
-			}
+			HalfToABGR32F<2>(p, num_elems, output);
 			break;
 
 		case EF_B10G11R11F:
+#if defined(KLAYGE_SSE2_SUPPORT)
+			B10G11R11FToABGR32F(p, num_elems, output);
+#else
 			for (uint32_t i = 0; i < num_elems; ++ i, p += elem_size, ++ output)
 			{
 				// E5B5 E5G6 E5R6
@@ -575,7 +1110,7 @@ namespace KlayGE
 
 					if (0x1F == exponent) // INF or NAN
 					{
-						result[0].i = 0x7F800000 | (mantissa << 17);
+						result[j].i = 0x7F800000 | (mantissa << 17);
 					}
 					else
 					{
@@ -609,12 +1144,12 @@ namespace KlayGE
 				}
 
 				// Z Channel (5-bit mantissa)
-				mantissa = (s >> 22) & 0x3F;
+				mantissa = (s >> 22) & 0x1F;
 				exponent = (s >> 27) & 0x1F;
 
 				if (0x1F == exponent) // INF or NAN
 				{
-					result[2].i = 0x7F800000 | (mantissa << 17);
+					result[2].i = 0x7F800000 | (mantissa << 18);
 				}
 				else
 				{
@@ -643,22 +1178,15 @@ namespace KlayGE
 
 				*output = Color(result[0].f, result[1].f, result[2].f, 1);
 			}
+#endif
 			break;
 
 		case EF_BGR16F:
-			for (uint32_t i = 0; i < num_elems; ++ i, p += elem_size, ++ output)
-			{
-				half const * s = reinterpret_cast<half const *>(p);
-				*output = Color(s[0], s[1], s[2], 1);
-			}
+			HalfToABGR32F<3>(p, num_elems, output);
 			break;
 
 		case EF_ABGR16F:
-			for (uint32_t i = 0; i < num_elems; ++ i, p += elem_size, ++ output)
-			{
-				half const * s = reinterpret_cast<half const *>(p);
-				*output = Color(s[0], s[1], s[2], s[3]);
-			}
+			HalfToABGR32F<4>(p, num_elems, output);
 			break;
 
 		case EF_R32F:
@@ -720,23 +1248,11 @@ namespace KlayGE
 
 
 		case EF_ARGB8_SRGB:
-			for (uint32_t i = 0; i < num_elems; ++ i, p += elem_size, ++ output)
-			{
-				*output = Color(MathLib::srgb_to_linear(p[2] / 255.0f),
-					MathLib::srgb_to_linear(p[1] / 255.0f),
-					MathLib::srgb_to_linear(p[0] / 255.0f),
-					MathLib::srgb_to_linear(p[3] / 255.0f));
-			}
+			SRGB8ToABGR32F(p, num_elems, output, true);
 			break;
 
 		case EF_ABGR8_SRGB:
-			for (uint32_t i = 0; i < num_elems; ++ i, p += elem_size, ++ output)
-			{
-				*output = Color(MathLib::srgb_to_linear(p[0] / 255.0f),
-					MathLib::srgb_to_linear(p[1] / 255.0f),
-					MathLib::srgb_to_linear(p[2] / 255.0f),
-					MathLib::srgb_to_linear(p[3] / 255.0f));
-			}
+			SRGB8ToABGR32F(p, num_elems, output, false);
 			break;
 
 		default:
@@ -794,18 +1310,11 @@ namespace KlayGE
 			break;
 
 		case EF_R8:
-			for (uint32_t i = 0; i < num_elems; ++ i, ++ input, p += elem_size)
-			{
-				*p = static_cast<uint8_t>(MathLib::clamp(static_cast<int>(input->r() * 255.0f + 0.5f), 0, 255));
-			}
+			ABGR32FToUNorm8<1>(input, num_elems, p, false);
 			break;
 
 		case EF_GR8:
-			for (uint32_t i = 0; i < num_elems; ++ i, ++ input, p += elem_size)
-			{
-				p[0] = static_cast<uint8_t>(MathLib::clamp(static_cast<int>(input->r() * 255.0f + 0.5f), 0, 255));
-				p[1] = static_cast<uint8_t>(MathLib::clamp(static_cast<int>(input->g() * 255.0f + 0.5f), 0, 255));
-			}
+			ABGR32FToUNorm8<2>(input, num_elems, p, false);
 			break;
 
 		case EF_SIGNED_GR8:
@@ -817,12 +1326,7 @@ namespace KlayGE
 			break;
 
 		case EF_BGR8:
-			for (uint32_t i = 0; i < num_elems; ++ i, ++ input, p += elem_size)
-			{
-				p[0] = static_cast<uint8_t>(MathLib::clamp(static_cast<int>(input->r() * 255.0f + 0.5f), 0, 255));
-				p[1] = static_cast<uint8_t>(MathLib::clamp(static_cast<int>(input->g() * 255.0f + 0.5f), 0, 255));
-				p[2] = static_cast<uint8_t>(MathLib::clamp(static_cast<int>(input->b() * 255.0f + 0.5f), 0, 255));
-			}
+			ABGR32FToUNorm8<3>(input, num_elems, p, false);
 			break;
 
 		case EF_SIGNED_BGR8:
@@ -835,23 +1339,11 @@ namespace KlayGE
 			break;
 
 		case EF_ARGB8:
-			for (uint32_t i = 0; i < num_elems; ++ i, ++ input, p += elem_size)
-			{
-				p[0] = static_cast<uint8_t>(MathLib::clamp(static_cast<int>(input->b() * 255.0f + 0.5f), 0, 255));
-				p[1] = static_cast<uint8_t>(MathLib::clamp(static_cast<int>(input->g() * 255.0f + 0.5f), 0, 255));
-				p[2] = static_cast<uint8_t>(MathLib::clamp(static_cast<int>(input->r() * 255.0f + 0.5f), 0, 255));
-				p[3] = static_cast<uint8_t>(MathLib::clamp(static_cast<int>(input->a() * 255.0f + 0.5f), 0, 255));
-			}
+			ABGR32FToUNorm8<4>(input, num_elems, p, true);
 			break;
 
 		case EF_ABGR8:
-			for (uint32_t i = 0; i < num_elems; ++ i, ++ input, p += elem_size)
-			{
-				p[0] = static_cast<uint8_t>(MathLib::clamp(static_cast<int>(input->r() * 255.0f + 0.5f), 0, 255));
-				p[1] = static_cast<uint8_t>(MathLib::clamp(static_cast<int>(input->g() * 255.0f + 0.5f), 0, 255));
-				p[2] = static_cast<uint8_t>(MathLib::clamp(static_cast<int>(input->b() * 255.0f + 0.5f), 0, 255));
-				p[3] = static_cast<uint8_t>(MathLib::clamp(static_cast<int>(input->a() * 255.0f + 0.5f), 0, 255));
-			}
+			ABGR32FToUNorm8<4>(input, num_elems, p, false);
 			break;
 
 		case EF_SIGNED_ABGR8:
@@ -865,15 +1357,7 @@ namespace KlayGE
 			break;
 
 		case EF_A2BGR10:
-			for (uint32_t i = 0; i < num_elems; ++ i, ++ input, p += elem_size)
-			{
-				int r = MathLib::clamp(static_cast<int>(input->r() * 1023.0f + 0.5f), 0, 1023);
-				int g = MathLib::clamp(static_cast<int>(input->g() * 1023.0f + 0.5f), 0, 1023);
-				int b = MathLib::clamp(static_cast<int>(input->b() * 1023.0f + 0.5f), 0, 1023);
-				int a = MathLib::clamp(static_cast<int>(input->a() * 3.0f + 0.5f), 0, 3);
-
-				*reinterpret_cast<uint32_t*>(p) = r | (g << 10) | (b << 20) | (a << 30);
-			}
+			ABGR32FToA2BGR10(input, num_elems, p);
 			break;
 
 		case EF_SIGNED_A2BGR10:
@@ -1292,20 +1776,11 @@ namespace KlayGE
 
 
 		case EF_R16F:
-			for (uint32_t i = 0; i < num_elems; ++ i, ++ input, p += elem_size)
-			{
-				half* s = reinterpret_cast<half*>(p);
-				*s = half(input->r());
-			}
+			ABGR32FToHalf<1>(input, num_elems, p);
 			break;
 
 		case EF_GR16F:
-			for (uint32_t i = 0; i < num_elems; ++ i, ++ input, p += elem_size)
-			{
-				half* s = reinterpret_cast<half*>(p);
-				s[0] = half(input->r());
-				s[1] = half(input->g());
-			}
+			ABGR32FToHalf<2>(input, num_elems, p);
 			break;
 
 		case EF_B10G11R11F:
@@ -1426,24 +1901,11 @@ namespace KlayGE
 			break;
 
 		case EF_BGR16F:
-			for (uint32_t i = 0; i < num_elems; ++ i, ++ input, p += elem_size)
-			{
-				half* s = reinterpret_cast<half*>(p);
-				s[0] = half(input->r());
-				s[1] = half(input->g());
-				s[2] = half(input->b());
-			}
+			ABGR32FToHalf<3>(input, num_elems, p);
 			break;
 
 		case EF_ABGR16F:
-			for (uint32_t i = 0; i < num_elems; ++ i, ++ input, p += elem_size)
-			{
-				half* s = reinterpret_cast<half*>(p);
-				s[0] = half(input->r());
-				s[1] = half(input->g());
-				s[2] = half(input->b());
-				s[3] = half(input->a());
-			}
+			ABGR32FToHalf<4>(input, num_elems, p);
 			break;
 
 		case EF_R32F:
@@ -1511,27 +1973,45 @@ namespace KlayGE
 
 
 		case EF_ARGB8_SRGB:
-			for (uint32_t i = 0; i < num_elems; ++ i, ++ input, p += elem_size)
-			{
-				p[0] = static_cast<uint8_t>(MathLib::clamp(static_cast<int>(MathLib::linear_to_srgb(input->b()) * 255.0f + 0.5f), 0, 255));
-				p[1] = static_cast<uint8_t>(MathLib::clamp(static_cast<int>(MathLib::linear_to_srgb(input->g()) * 255.0f + 0.5f), 0, 255));
-				p[2] = static_cast<uint8_t>(MathLib::clamp(static_cast<int>(MathLib::linear_to_srgb(input->r()) * 255.0f + 0.5f), 0, 255));
-				p[3] = static_cast<uint8_t>(MathLib::clamp(static_cast<int>(MathLib::linear_to_srgb(input->a()) * 255.0f + 0.5f), 0, 255));
-			}
+			ABGR32FToSRGB8(input, num_elems, p, true);
 			break;
 
 		case EF_ABGR8_SRGB:
-			for (uint32_t i = 0; i < num_elems; ++ i, ++ input, p += elem_size)
-			{
-				p[0] = static_cast<uint8_t>(MathLib::clamp(static_cast<int>(MathLib::linear_to_srgb(input->r()) * 255.0f + 0.5f), 0, 255));
-				p[1] = static_cast<uint8_t>(MathLib::clamp(static_cast<int>(MathLib::linear_to_srgb(input->g()) * 255.0f + 0.5f), 0, 255));
-				p[2] = static_cast<uint8_t>(MathLib::clamp(static_cast<int>(MathLib::linear_to_srgb(input->b()) * 255.0f + 0.5f), 0, 255));
-				p[3] = static_cast<uint8_t>(MathLib::clamp(static_cast<int>(MathLib::linear_to_srgb(input->a()) * 255.0f + 0.5f), 0, 255));
-			}
+			ABGR32FToSRGB8(input, num_elems, p, false);
 			break;
 
 		default:
 			KFL_UNREACHABLE("Not supported element format");
 		}
 	}
+
+	void ConvertFormat(ElementFormat dst_fmt, void* output, ElementFormat src_fmt, void const * input, uint32_t num_elems)
+	{
+		if (dst_fmt == src_fmt)
+		{
+			std::memcpy(output, input, num_elems * NumFormatBytes(src_fmt));
+			return;
+		}
+
+		uint8_t* dst = static_cast<uint8_t*>(output);
+		uint8_t const * src = static_cast<uint8_t const *>(input);
+
+		UNorm8Layout dst_layout;
+		UNorm8Layout src_layout;
+		if (GetUNorm8Layout(dst_fmt, dst_layout) && GetUNorm8Layout(src_fmt, src_layout) && (dst_layout.srgb == src_layout.srgb))
+		{
+			ConvertUNorm8(dst_layout, dst, src_layout, src, num_elems);
+			return;
+		}
+
+		uint32_t const dst_elem_size = NumFormatBytes(dst_fmt);
+		uint32_t const src_elem_size = NumFormatBytes(src_fmt);
+		std::array<Color, 256> tmp;
+		for (uint32_t i = 0; i < num_elems; i += static_cast<uint32_t>(tmp.size()))
+		{
+			uint32_t const n = std::min(num_elems - i, static_cast<uint32_t>(tmp.size()));
+			ConvertToABGR32F(src_fmt, src + i * src_elem_size, n, tmp.data());
+			ConvertFromABGR32F(dst_fmt, tmp.data(), n, dst + i * dst_elem_size);
+		}
+	}
 }
@@ -18,13 +18,223 @@
 #include <KFL/Half.hpp>
 #include <KlayGE/RenderEffect.hpp>
 #include <KlayGE/FrameBuffer.hpp>
-
+#include <KlayGE/Texture.hpp>
+#include <KlayGE/ElementFormat.hpp>
+#include <KFL/CpuInfo.hpp>
+#include <KFL/Thread.hpp>
+#include <KlayGE/Context.hpp>
+
+#include <algorithm>
+#include <cmath>
 #include <tuple>
 
+#if defined(KLAYGE_SSE_SUPPORT)
+#include <xmmintrin.h>
+#endif
+
 #include <boost/assert.hpp>
 
 #include <KlayGE/FFT.hpp>
 
+namespace
+{
+	using namespace KlayGE;
+
+	// Transforms smaller than this run on the calling thread
+	uint32_t const MIN_PARALLEL_FFT_PIXELS = 128 * 128;
+
+	// Columns are transformed in groups, so the gathering reads whole cache lines
+	uint32_t const FFT_COLUMN_GROUP = 4;
+
+	// Every element holds 4 independent channels sharing the twiddles, so a butterfly is the same operation on all lanes
+#if defined(KLAYGE_SSE_SUPPORT)
+	typedef __m128 FftVec;
+
+	FftVec FftLoad(float4 const & v)
+	{
+		return _mm_loadu_ps(&v[0]);
+	}
+	void FftStore(float4& v, FftVec x)
+	{
+		_mm_storeu_ps(&v[0], x);
+	}
+	FftVec FftSplat(float v)
+	{
+		return _mm_set1_ps(v);
+	}
+	FftVec FftAdd(FftVec a, FftVec b)
+	{
+		return _mm_add_ps(a, b);
+	}
+	FftVec FftSub(FftVec a, FftVec b)
+	{
+		return _mm_sub_ps(a, b);
+	}
+	FftVec FftMul(FftVec a, FftVec b)
+	{
+		return _mm_mul_ps(a, b);
+	}
+#else
+	typedef float4 FftVec;
+
+	FftVec FftLoad(float4 const & v)
+	{
+		return v;
+	}
+	void FftStore(float4& v, FftVec const & x)
+	{
+		v = x;
+	}
+	FftVec FftSplat(float v)
+	{
+		return float4(v);
+	}
+	FftVec FftAdd(FftVec const & a, FftVec const & b)
+	{
+		return a + b;
+	}
+	FftVec FftSub(FftVec const & a, FftVec const & b)
+	{
+		return a - b;
+	}
+	FftVec FftMul(FftVec const & a, FftVec const & b)
+	{
+		return a * b;
+	}
+#endif
+
+	// (re, im) * (wr, wi)
+	void FftComplexMul(FftVec& re, FftVec& im, FftVec const & wr, FftVec const & wi)
+	{
+		FftVec const r = FftSub(FftMul(re, wr), FftMul(im, wi));
+		im = FftAdd(FftMul(re, wi), FftMul(im, wr));
+		re = r;
+	}
+
+	// One radix-4 Stockham stage, s interleaved sub-transforms of length n. sign is 1 for the forward transform, -1 for the
+	// inverse one.
+	void FftRadix4(float4* dst_re, float4* dst_im, float4 const * src_re, float4 const * src_im,
+		uint32_t n, uint32_t s, float2 const * twiddles, float sign)
+	{
+		uint32_t const quarter = n / 4 * s;
+		FftVec const pos_sign = FftSplat(sign);
+		FftVec const neg_sign = FftSplat(-sign);
+		for (uint32_t p = 0; p < n / 4; ++ p)
+		{
+			float2 const & w1 = twiddles[p * s];
+			float2 const & w2 = twiddles[2 * p * s];
+			float2 const & w3 = twiddles[3 * p * s];
+			FftVec const w1r = FftSplat(w1.x());
+			FftVec const w1i = FftSplat(w1.y());
+			FftVec const w2r = FftSplat(w2.x());
+			FftVec const w2i = FftSplat(w2.y());
+			FftVec const w3r = FftSplat(w3.x());
+			FftVec const w3i = FftSplat(w3.y());
+
+			float4 const * sr = src_re + p * s;
+			float4 const * si = src_im + p * s;
+			float4* dr = dst_re + 4 * p * s;
+			float4* di = dst_im + 4 * p * s;
+			for (uint32_t q = 0; q < s; ++ q)
+			{
+				FftVec const ar = FftLoad(sr[q]);
+				FftVec const ai = FftLoad(si[q]);
+				FftVec const br = FftLoad(sr[q + quarter]);
+				FftVec const bi = FftLoad(si[q + quarter]);
+				FftVec const cr = FftLoad(sr[q + 2 * quarter]);
+				FftVec const ci = FftLoad(si[q + 2 * quarter]);
+				FftVec const er = FftLoad(sr[q + 3 * quarter]);
+				FftVec const ei = FftLoad(si[q + 3 * quarter]);
+
+				FftVec const apc_r = FftAdd(ar, cr);
+				FftVec const apc_i = FftAdd(ai, ci);
+				FftVec const amc_r = FftSub(ar, cr);
+				FftVec const amc_i = FftSub(ai, ci);
+				FftVec const bpe_r = FftAdd(br, er);
+				FftVec const bpe_i = FftAdd(bi, ei);
+				// (b - e) * -sign * i
+				FftVec const rot_r = FftMul(FftSub(bi, ei), pos_sign);
+				FftVec const rot_i = FftMul(FftSub(br, er), neg_sign);
+
+				FftStore(dr[q], FftAdd(apc_r, bpe_r));
+				FftStore(di[q], FftAdd(apc_i, bpe_i));
+
+				FftVec yr = FftAdd(amc_r, rot_r);
+				FftVec yi = FftAdd(amc_i, rot_i);
+				FftComplexMul(yr, yi, w1r, w1i);
+				FftStore(dr[q + s], yr);
+				FftStore(di[q + s], yi);
+
+				yr = FftSub(apc_r, bpe_r);
+				yi = FftSub(apc_i, bpe_i);
+				FftComplexMul(yr, yi, w2r, w2i);
+				FftStore(dr[q + 2 * s], yr);
+				FftStore(di[q + 2 * s], yi);
+
+				yr = FftSub(amc_r, rot_r);
+				yi = FftSub(amc_i, rot_i);
+				FftComplexMul(yr, yi, w3r, w3i);
+				FftStore(dr[q + 3 * s], yr);
+				FftStore(di[q + 3 * s], yi);
+			}
+		}
+	}
+
+	// The last stage when log2(n) is odd. Its twiddles are all 1.
+	void FftRadix2(float4* dst_re, float4* dst_im, float4 const * src_re, float4 const * src_im, uint32_t s)
+	{
+		for (uint32_t q = 0; q < s; ++ q)
+		{
+			FftVec const ar = FftLoad(src_re[q]);
+			FftVec const ai = FftLoad(src_im[q]);
+			FftVec const br = FftLoad(src_re[q + s]);
+			FftVec const bi = FftLoad(src_im[q + s]);
+			FftStore(dst_re[q], FftAdd(ar, br));
+			FftStore(dst_im[q], FftAdd(ai, bi));
+			FftStore(dst_re[q + s], FftSub(ar, br));
+			FftStore(dst_im[q + s], FftSub(ai, bi));
+		}
+	}
+
+	// Stockham autosort transform of n elements, which needs no bit reversal. Stages ping-pong between the data and tmp.
+	// Returns true if the result ended up in tmp.
+	bool Fft1D(float4* re, float4* im, float4* tmp_re, float4* tmp_im, uint32_t n, float2 const * twiddles, float sign)
+	{
+		float4* src_re = re;
+		float4* src_im = im;
+		float4* dst_re = tmp_re;
+		float4* dst_im = tmp_im;
+
+		uint32_t s = 1;
+		for (; n >= 4; n /= 4, s *= 4)
+		{
+			FftRadix4(dst_re, dst_im, src_re, src_im, n, s, twiddles, sign);
+			std::swap(src_re, dst_re);
+			std::swap(src_im, dst_im);
+		}
+		if (2 == n)
+		{
+			FftRadix2(dst_re, dst_im, src_re, src_im, s);
+			std::swap(src_re, dst_re);
+			std::swap(src_im, dst_im);
+		}
+
+		return src_re != re;
+	}
+
+	void InitTwiddles(std::vector<float2>& twiddles, uint32_t n, bool forward)
+	{
+		double const pi = 3.14159265358979323846;
+
+		twiddles.resize(n);
+		for (uint32_t k = 0; k < n; ++ k)
+		{
+			double const phase = 2 * pi * k / n;
+			twiddles[k] = float2(static_cast<float>(cos(phase)), static_cast<float>(forward ? -sin(phase) : sin(phase)));
+		}
+	}
+}
+
 namespace KlayGE
 {
 	GpuFftPS::GpuFftPS(uint32_t width, uint32_t height, bool forward)
@@ -530,4 +740,138 @@ namespace KlayGE
 		}
 		re.Dispatch(*effect_, *tech, grid_x, grid_y, 1);
 	}
+
+	CpuFft::CpuFft(uint32_t width, uint32_t height, bool forward)
+		: width_(width), height_(height), forward_(forward)
+	{
+		BOOST_ASSERT(0 == (width_ & (width_ - 1)));
+		BOOST_ASSERT(0 == (height_ & (height_ - 1)));
+
+		InitTwiddles(twiddles_x_, width_, forward_);
+		InitTwiddles(twiddles_y_, height_, forward_);
+	}
+
+	void CpuFft::Execute(TexturePtr const & out_real, TexturePtr const & out_imag,
+			TexturePtr const & in_real, TexturePtr const & in_imag)
+	{
+		KLAYGE_STATIC_ASSERT(sizeof(Color) == sizeof(float4));
+
+		real_.resize(width_ * height_);
+		imag_.resize(width_ * height_);
+
+		{
+			Texture::Mapper mapper(*in_real, 0, 0, TMA_Read_Only, 0, 0, width_, height_);
+			uint8_t const * p = mapper.Pointer<uint8_t>();
+			for (uint32_t y = 0; y < height_; ++ y)
+			{
+				ConvertToABGR32F(in_real->Format(), p + y * mapper.RowPitch(), width_, reinterpret_cast<Color*>(&real_[y * width_]));
+			}
+		}
+		if (in_imag)
+		{
+			Texture::Mapper mapper(*in_imag, 0, 0, TMA_Read_Only, 0, 0, width_, height_);
+			uint8_t const * p = mapper.Pointer<uint8_t>();
+			for (uint32_t y = 0; y < height_; ++ y)
+			{
+				ConvertToABGR32F(in_imag->Format(), p + y * mapper.RowPitch(), width_, reinterpret_cast<Color*>(&imag_[y * width_]));
+			}
+		}
+		else
+		{
+			std::fill(imag_.begin(), imag_.end(), float4(0, 0, 0, 0));
+		}
+
+		this->Transform(real_.data(), imag_.data());
+
+		{
+			Texture::Mapper mapper(*out_real, 0, 0, TMA_Write_Only, 0, 0, width_, height_);
+			uint8_t* p = mapper.Pointer<uint8_t>();
+			for (uint32_t y = 0; y < height_; ++ y)
+			{
+				ConvertFromABGR32F(out_real->Format(), reinterpret_cast<Color const *>(&real_[y * width_]), width_,
+					p + y * mapper.RowPitch());
+			}
+		}
+		{
+			Texture::Mapper mapper(*out_imag, 0, 0, TMA_Write_Only, 0, 0, width_, height_);
+			uint8_t* p = mapper.Pointer<uint8_t>();
+			for (uint32_t y = 0; y < height_; ++ y)
+			{
+				ConvertFromABGR32F(out_imag->Format(), reinterpret_cast<Color const *>(&imag_[y * width_]), width_,
+					p + y * mapper.RowPitch());
+			}
+		}
+	}
+
+	void CpuFft::Transform(float4* real, float4* imag)
+	{
+		uint32_t const width = width_;
+		uint32_t const height = height_;
+		float const sign = forward_ ? 1.0f : -1.0f;
+
+		uint32_t num_jobs = 1;
+		if (width * height >= MIN_PARALLEL_FFT_PIXELS)
+		{
+			CPUInfo cpu;
+			num_jobs = static_cast<uint32_t>(cpu.NumHWThreads());
+		}
+		auto& tp = Context::Instance().ThreadPool();
+
+		float2 const * twiddles_x = twiddles_x_.data();
+		parallel_for(tp, height, num_jobs, [real, imag, width, sign, twiddles_x](uint32_t begin, uint32_t end)
+			{
+				std::vector<float4> tmp(width * 2);
+				for (uint32_t y = begin; y < end; ++ y)
+				{
+					float4* row_re = real + y * width;
+					float4* row_im = imag + y * width;
+					if (Fft1D(row_re, row_im, &tmp[0], &tmp[width], width, twiddles_x, sign))
+					{
+						std::copy(tmp.begin(), tmp.begin() + width, row_re);
+						std::copy(tmp.begin() + width, tmp.end(), row_im);
+					}
+				}
+			});
+
+		float const scale = forward_ ? 1.0f : 1.0f / (width * height);
+		uint32_t const group = std::min(width, FFT_COLUMN_GROUP);
+		float2 const * twiddles_y = twiddles_y_.data();
+		parallel_for(tp, width / group, num_jobs, [real, imag, width, height, group, sign, scale, twiddles_y](
+			uint32_t begin, uint32_t end)
+			{
+				// Per column of the group: real, imag, and their ping-pong buffers
+				std::vector<float4> lines(height * 4 * group);
+				for (uint32_t g = begin; g < end; ++ g)
+				{
+					uint32_t const x0 = g * group;
+					for (uint32_t y = 0; y < height; ++ y)
+					{
+						for (uint32_t c = 0; c < group; ++ c)
+						{
+							lines[(c * 4 + 0) * height + y] = real[y * width + x0 + c];
+							lines[(c * 4 + 1) * height + y] = imag[y * width + x0 + c];
+						}
+					}
+
+					float4 const * col_re[FFT_COLUMN_GROUP];
+					float4 const * col_im[FFT_COLUMN_GROUP];
+					for (uint32_t c = 0; c < group; ++ c)
+					{
+						float4* line = &lines[c * 4 * height];
+						bool const in_tmp = Fft1D(line, line + height, line + height * 2, line + height * 3, height, twiddles_y, sign);
+						col_re[c] = in_tmp ? line + height * 2 : line;
+						col_im[c] = in_tmp ? line + height * 3 : line + height;
+					}
+
+					for (uint32_t y = 0; y < height; ++ y)
+					{
+						for (uint32_t c = 0; c < group; ++ c)
+						{
+							real[y * width + x0 + c] = col_re[c][y] * scale;
+							imag[y * width + x0 + c] = col_im[c][y] * scale;
+						}
+					}
+				}
+			});
+	}
 }
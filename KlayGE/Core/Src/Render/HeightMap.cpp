@@ -14,18 +14,149 @@
 /////////////////////////////////////////////////////////////////////////////////
 
 #include <KlayGE/KlayGE.hpp>
+#include <KFL/CpuInfo.hpp>
+#include <KFL/Thread.hpp>
 #include <KFL/Vector.hpp>
+#include <KlayGE/Context.hpp>
+
+#include <algorithm>
+
+#if defined(KLAYGE_SSE_SUPPORT)
+#include <xmmintrin.h>
+#endif
 
 #include <KlayGE/HeightMap.hpp>
 
+namespace
+{
+	using namespace KlayGE;
+
+	uint32_t const MIN_PARALLEL_TERRAIN_VERTICES = 128 * 128;
+
+	// Calls func(begin, end) on ranges of [0, count). Spread over the pool if there is one and the work is large enough.
+	template <typename Func>
+	void ParallelFor(uint32_t count, uint32_t item_size, thread_pool* pool, Func const & func)
+	{
+		if ((pool != nullptr) && (count * item_size >= MIN_PARALLEL_TERRAIN_VERTICES))
+		{
+			CPUInfo cpu;
+			parallel_for(*pool, count, static_cast<uint32_t>(cpu.NumHWThreads()), func);
+		}
+		else
+		{
+			func(0, count);
+		}
+	}
+
+	// 1 / (coord[next] - coord[prev]) for every vertex, 0 if there is no neighbour to take the difference to
+	std::vector<float> InvCentralSpans(std::vector<float> const & coords)
+	{
+		uint32_t const num = static_cast<uint32_t>(coords.size());
+		std::vector<float> ret(num);
+		for (uint32_t i = 0; i < num; ++ i)
+		{
+			float const span = coords[std::min(i + 1, num - 1)] - coords[(i > 0) ? i - 1 : 0];
+			ret[i] = (span != 0) ? 1 / span : 0;
+		}
+		return ret;
+	}
+
+	float3 SlopeNormal(float dhdx, float dhdz)
+	{
+		return MathLib::normalize(float3(-dhdx, 1, -dhdz));
+	}
+
+	// Normals of a row. Differences are central inside the grid and one sided on its borders.
+	void RowNormals(float const * heights, float const * prev_heights, float const * next_heights,
+		float const * inv_dx, float inv_dz, uint32_t num_x, float3* normals)
+	{
+		auto scalar_normal = [=](uint32_t x)
+			{
+				uint32_t const left = (x > 0) ? x - 1 : 0;
+				uint32_t const right = std::min(x + 1, num_x - 1);
+				return SlopeNormal((heights[right] - heights[left]) * inv_dx[x], (next_heights[x] - prev_heights[x]) * inv_dz);
+			};
+
+		normals[0] = scalar_normal(0);
+
+		uint32_t x = 1;
+#if defined(KLAYGE_SSE_SUPPORT)
+		__m128 const one = _mm_set1_ps(1);
+		__m128 const neg_dz = _mm_set1_ps(-inv_dz);
+		for (; x + 4 < num_x; x += 4)
+		{
+			__m128 const nx = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(heights + x - 1), _mm_loadu_ps(heights + x + 1)),
+				_mm_loadu_ps(inv_dx + x));
+			__m128 const nz = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(next_heights + x), _mm_loadu_ps(prev_heights + x)), neg_dz);
+			__m128 const inv_len = _mm_div_ps(one,
+				_mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, nx), one), _mm_mul_ps(nz, nz))));
+
+			alignas(16) float n[3][4];
+			_mm_store_ps(n[0], _mm_mul_ps(nx, inv_len));
+			_mm_store_ps(n[1], inv_len);
+			_mm_store_ps(n[2], _mm_mul_ps(nz, inv_len));
+			for (uint32_t i = 0; i < 4; ++ i)
+			{
+				normals[x + i] = float3(n[0][i], n[1][i], n[2][i]);
+			}
+		}
+#endif
+		for (; x < num_x; ++ x)
+		{
+			normals[x] = scalar_normal(x);
+		}
+	}
+}
+
 namespace KlayGE
 {
 	void HeightMap::BuildTerrain(float start_x, float start_y, float end_x, float end_y, float span_x, float span_y,
 		std::vector<float3>& vertices, std::vector<uint16_t>& indices,
 		std::function<float(float, float)> HeightFunc)
+	{
+		this->DoBuildTerrain(start_x, start_y, end_x, end_y, span_x, span_y, vertices, nullptr, indices,
+			[&HeightFunc](ArrayRef<float> xs, float y, float* heights)
+			{
+				for (size_t i = 0; i < xs.size(); ++ i)
+				{
+					heights[i] = HeightFunc(xs[i], y);
+				}
+			},
+			nullptr);
+	}
+
+	void HeightMap::BuildTerrain(float start_x, float start_y, float end_x, float end_y, float span_x, float span_y,
+		std::vector<float3>& vertices, std::vector<float3>& normals, std::vector<uint16_t>& indices,
+		HeightRowFunc const & height_row_func, thread_pool* pool)
+	{
+		this->DoBuildTerrain(start_x, start_y, end_x, end_y, span_x, span_y, vertices, &normals, indices,
+			height_row_func, pool);
+	}
+
+	joiner<HeightMap::TerrainMesh> HeightMap::BuildTerrainAsync(float start_x, float start_y, float end_x, float end_y,
+		float span_x, float span_y, HeightRowFunc const & height_row_func)
+	{
+		auto& pool = Context::Instance().ThreadPool();
+		return pool([start_x, start_y, end_x, end_y, span_x, span_y, height_row_func, &pool]
+			{
+				TerrainMesh mesh;
+				HeightMap builder;
+				builder.BuildTerrain(start_x, start_y, end_x, end_y, span_x, span_y,
+					mesh.vertices, mesh.normals, mesh.indices, height_row_func, &pool);
+				return mesh;
+			});
+	}
+
+	void HeightMap::DoBuildTerrain(float start_x, float start_y, float end_x, float end_y, float span_x, float span_y,
+		std::vector<float3>& vertices, std::vector<float3>* normals, std::vector<uint16_t>& indices,
+		HeightRowFunc const & height_row_func, thread_pool* pool)
 	{
 		vertices.resize(0);
 		indices.resize(0);
+		if (normals)
+		{
+			normals->resize(0);
+		}
 
 		if ((end_x - start_x) * span_x < 0)
 		{
@@ -38,34 +169,91 @@ namespace KlayGE
 
 		uint16_t const num_x = static_cast<uint16_t>((end_x - start_x) / span_x);
 		uint16_t const num_y = static_cast<uint16_t>((end_y - start_y) / span_y);
+		BOOST_ASSERT(static_cast<uint32_t>(num_x) * num_y <= 0x10000);
+		if ((0 == num_x) || (0 == num_y))
+		{
+			return;
+		}
 
+		// Accumulated the same way as the vertices were always placed
+		std::vector<float> xs(num_x);
 		float pos_x = start_x;
+		for (uint16_t x = 0; x < num_x; ++ x)
+		{
+			pos_x += span_x;
+			xs[x] = pos_x;
+		}
+		std::vector<float> ys(num_y);
 		float pos_y = start_y;
 		for (uint16_t y = 0; y < num_y; ++ y)
 		{
-			pos_x = start_x;
-			for (uint16_t x = 0; x < num_x; ++ x)
+			ys[y] = pos_y;
+			pos_y += span_y;
+		}
+
+		std::vector<float> heights(num_x * num_y);
+		ParallelFor(num_y, num_x, pool, [&height_row_func, &xs, &ys, &heights, num_x](uint32_t y_begin, uint32_t y_end)
 			{
-				pos_x += span_x;
+				for (uint32_t y = y_begin; y < y_end; ++ y)
+				{
+					height_row_func(xs, ys[y], &heights[y * num_x]);
+				}
+			});
 
-				float3 vec(pos_x, HeightFunc(pos_x, pos_y), pos_y);
-				vertices.push_back(vec);
-			}
-			pos_y += span_y;
+		vertices.resize(num_x * num_y);
+		std::vector<float> inv_dx;
+		std::vector<float> inv_dz;
+		if (normals)
+		{
+			normals->resize(vertices.size());
+			inv_dx = InvCentralSpans(xs);
+			inv_dz = InvCentralSpans(ys);
 		}
 
-		for (uint16_t y = 0; y < num_y - 1; ++ y)
+		// Indices of a cell relative to its first vertex
+		uint16_t const cell_indices[] =
 		{
-			for (uint16_t x = 0; x < num_x - 1; ++ x)
+			0, num_x, static_cast<uint16_t>(num_x + 1),
+			static_cast<uint16_t>(num_x + 1), 1, 0
+		};
+		uint32_t const num_cells_x = (num_x > 1) ? num_x - 1 : 0;
+		uint32_t const num_cells_y = (num_y > 1) ? num_y - 1 : 0;
+		indices.resize(num_cells_x * num_cells_y * std::size(cell_indices));
+
+		ParallelFor(num_y, num_x, pool,
+			[&xs, &ys, &heights, &vertices, normals, &inv_dx, &inv_dz, &cell_indices, &indices, num_x, num_y,
+				num_cells_x, num_cells_y](uint32_t y_begin, uint32_t y_end)
 			{
-				indices.push_back((y + 0) * num_x + (x + 0));
-				indices.push_back((y + 1) * num_x + (x + 0));
-				indices.push_back((y + 1) * num_x + (x + 1));
+				for (uint32_t y = y_begin; y < y_end; ++ y)
+				{
+					float const * row_heights = &heights[y * num_x];
+					float3* row_vertices = &vertices[y * num_x];
+					for (uint32_t x = 0; x < num_x; ++ x)
+					{
+						row_vertices[x] = float3(xs[x], row_heights[x], ys[y]);
+					}
 
-				indices.push_back((y + 1) * num_x + (x + 1));
-				indices.push_back((y + 0) * num_x + (x + 1));
-				indices.push_back((y + 0) * num_x + (x + 0));
-			}
-		}
+					if (normals)
+					{
+						RowNormals(row_heights, &heights[((y > 0) ? y - 1 : 0) * num_x],
+							&heights[std::min<uint32_t>(y + 1, num_y - 1) * num_x], &inv_dx[0], inv_dz[y], num_x,
+							&(*normals)[y * num_x]);
+					}
+
+					if (y < num_cells_y)
+					{
+						uint16_t* row_indices = &indices[y * num_cells_x * std::size(cell_indices)];
+						for (uint32_t x = 0; x < num_cells_x; ++ x)
+						{
+							uint16_t const base = static_cast<uint16_t>(y * num_x + x);
+							for (auto index : cell_indices)
+							{
+								*row_indices = static_cast<uint16_t>(base + index);
+								++ row_indices;
+							}
+						}
+					}
+				}
+			});
 	}
 }
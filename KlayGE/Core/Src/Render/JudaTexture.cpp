@@ -118,8 +118,17 @@ namespace KlayGE
 		: root_(MakeSharedPtr<quadtree_node>()),
 			num_tiles_(num_tiles), tile_size_(tile_size), format_(format),
 			texel_size_(NumFormatBytes(format)),
-			decode_tick_(0), tile_tick_(0)
+			cache_tile_border_size_(0), cache_tile_size_(tile_size),
+			num_cache_tiles_a_row_(0), num_cache_tiles_a_layer_(0), tile_tick_(0),
+			streaming_(false), stream_quit_(false)
 	{
+		stats_.requests = 0;
+		stats_.hits = 0;
+		stats_.uploads = 0;
+		stats_.evictions = 0;
+		stats_.pending = 0;
+		stats_.queued = 0;
+
 		BOOST_ASSERT(num_tiles_ <= MAX_NUM_TILES);
 		BOOST_ASSERT(tile_size_ <= MAX_TILE_SIZE);
 		BOOST_ASSERT(0 == (tile_size_ & (tile_size_ - 1)));
@@ -179,6 +188,18 @@ namespace KlayGE
 		}
 	}
 
+	JudaTexture::~JudaTexture()
+	{
+		{
+			std::lock_guard<std::mutex> lock(stream_mutex_);
+			stream_quit_ = true;
+		}
+		if (stream_job_)
+		{
+			(*stream_job_)();
+		}
+	}
+
 	uint32_t JudaTexture::EncodeTileID(uint32_t level, uint32_t tile_x, uint32_t tile_y) const
 	{
 		BOOST_ASSERT(level <= MAX_TREE_LEVEL);
@@ -448,8 +469,6 @@ namespace KlayGE
 
 	void JudaTexture::DecodeATile(std::vector<uint8_t>* data, uint32_t shuff, uint32_t mipmaps)
 	{
-		++ decode_tick_;
-
 		uint32_t const full_tile_bytes = cache_tile_size_ * cache_tile_size_ * texel_size_;
 		uint32_t target_level = this->ShuffLevel(shuff);
 
@@ -617,36 +636,14 @@ namespace KlayGE
 			auto iter = decoded_block_cache_.find(data_index);
 			if (iter != decoded_block_cache_.end())
 			{
-				iter->second.tick = decode_tick_;
+				decoded_block_lru_.splice(decoded_block_lru_.end(), decoded_block_lru_, iter->second.lru_iter);
 			}
 			else
 			{
 				if (decoded_block_cache_.size() >= 64)
 				{
-					auto min_iter = decoded_block_cache_.begin();
-					uint64_t min_tick = min_iter->second.tick;
-					for (auto dbiter = decoded_block_cache_.begin();
-						dbiter != decoded_block_cache_.end(); ++ dbiter)
-					{
-						if (dbiter->second.tick < min_tick)
-						{
-							min_tick = dbiter->second.tick;
-							min_iter = dbiter;
-						}
-					}
-
-					for (auto dbiter = decoded_block_cache_.begin();
-						dbiter != decoded_block_cache_.end();)
-					{
-						if (dbiter->second.tick == min_tick)
-						{
-							dbiter = decoded_block_cache_.erase(dbiter);
-						}
-						else
-						{
-							++ dbiter;
-						}
-					}
+					decoded_block_cache_.erase(decoded_block_lru_.front());
+					decoded_block_lru_.pop_front();
 				}
 
 				uint32_t const full_tile_bytes = tile_size_ * tile_size_ * texel_size_;
@@ -667,7 +664,8 @@ namespace KlayGE
 					memset(data.get(), 0, full_tile_bytes);
 				}
 
-				iter = decoded_block_cache_.emplace(data_index, DecodedBlockInfo(std::move(data), decode_tick_)).first;
+				decoded_block_lru_.push_back(data_index);
+				iter = decoded_block_cache_.emplace(data_index, DecodedBlockInfo(std::move(data), std::prev(decoded_block_lru_.end()))).first;
 			}
 
 			return iter->second.data.get();
@@ -1204,7 +1202,15 @@ namespace KlayGE
 
 			tex_indirect_ = rf.MakeTexture2D(num_tiles_, num_tiles_, 1, 1, EF_ABGR8, 1, 0, EAH_GPU_Read);
 
-			tile_free_list_.emplace_back(0, pages);
+			num_cache_tiles_a_row_ = s;
+			num_cache_tiles_a_layer_ = s * s;
+			uint32_t const num_layers = tex_cache_ ? tex_cache_->ArraySize() : static_cast<uint32_t>(tex_cache_array_.size());
+			uint32_t const num_slots = std::min(pages, num_cache_tiles_a_layer_ * num_layers);
+			free_cache_slots_.resize(num_slots);
+			for (uint32_t i = 0; i < num_slots; ++ i)
+			{
+				free_cache_slots_[i] = num_slots - 1 - i;
+			}
 		}
 	}
 
@@ -1253,138 +1259,276 @@ namespace KlayGE
 
 		++ tile_tick_;
 
-		uint32_t const tex_width = tex_cache_ ? tex_cache_->Width(0) : tex_cache_array_[0]->Width(0);
-		uint32_t const tex_height = tex_cache_ ? tex_cache_->Height(0) : tex_cache_array_[0]->Height(0);
-		uint32_t const tex_layer = tex_cache_ ? tex_cache_->ArraySize() : static_cast<uint32_t>(tex_cache_array_.size());
-		uint32_t const tile_with_border_size = cache_tile_size_ + cache_tile_border_size_ * 2;
+		std::vector<TileRequest> missing;
+		this->TouchTiles(missing, tile_ids);
+
+		std::vector<uint32_t> missing_ids(missing.size());
+		for (size_t i = 0; i < missing.size(); ++ i)
+		{
+			missing_ids[i] = missing[i].tile_id;
+		}
+
+		std::vector<CacheTile> tiles;
+		this->BuildCacheTiles(tiles, missing_ids);
+		this->UploadCacheTiles(tiles);
+	}
+
+	void JudaTexture::UpdateCacheAsync(std::vector<uint32_t> const & tile_ids, uint32_t max_uploads)
+	{
+		BOOST_ASSERT(tex_cache_ || !tex_cache_array_.empty());
+
+		++ tile_tick_;
+
+		std::vector<TileRequest> missing;
+		this->TouchTiles(missing, tile_ids);
+
+		std::unordered_map<uint32_t, size_t> missing_map;
+		for (size_t i = 0; i < missing.size(); ++ i)
+		{
+			missing_map.emplace(missing[i].tile_id, i);
+		}
+
+		std::vector<CacheTile> tiles;
+		{
+			std::lock_guard<std::mutex> lock(stream_mutex_);
+
+			// Requests still in the queue take the priority of this frame
+			for (auto& request : tile_requests_)
+			{
+				auto iter = missing_map.find(request.tile_id);
+				if (iter != missing_map.end())
+				{
+					request = missing[iter->second];
+				}
+			}
+			// The others are out of view now, don't spend decoding time on them
+			auto const stale_begin = std::partition(tile_requests_.begin(), tile_requests_.end(),
+				[this](TileRequest const & request)
+				{
+					return request.tick == tile_tick_;
+				});
+			for (auto iter = stale_begin; iter != tile_requests_.end(); ++ iter)
+			{
+				in_flight_tiles_.erase(iter->tile_id);
+			}
+			tile_requests_.erase(stale_begin, tile_requests_.end());
+
+			for (auto const & request : missing)
+			{
+				if (in_flight_tiles_.insert(request.tile_id).second)
+				{
+					tile_requests_.push_back(request);
+				}
+			}
+			std::sort(tile_requests_.begin(), tile_requests_.end(),
+				[](TileRequest const & lhs, TileRequest const & rhs)
+				{
+					if (lhs.level != rhs.level)
+					{
+						return lhs.level > rhs.level;
+					}
+					return lhs.coverage < rhs.coverage;
+				});
+
+			stats_.queued = static_cast<uint32_t>(tile_requests_.size());
+
+			if (!streaming_ && !tile_requests_.empty())
+			{
+				streaming_ = true;
+				stream_job_ = MakeUniquePtr<joiner<void>>(Context::Instance().ThreadPool()([this] { this->StreamTiles(); }));
+			}
+
+			while (!decoded_tiles_.empty() && (tiles.size() < max_uploads))
+			{
+				tiles.push_back(std::move(decoded_tiles_.front()));
+				decoded_tiles_.pop_front();
+			}
+		}
+
+		for (auto const & tile : tiles)
+		{
+			in_flight_tiles_.erase(tile.tile_id);
+		}
+		this->UploadCacheTiles(tiles);
+	}
+
+	JudaTexture::CacheStats JudaTexture::Stats() const
+	{
+		CacheStats ret = stats_;
+		ret.pending = static_cast<uint32_t>(in_flight_tiles_.size());
+		return ret;
+	}
+
+	void JudaTexture::TouchTiles(std::vector<TileRequest>& missing, std::vector<uint32_t> const & tile_ids)
+	{
+		size_t const CACHED = static_cast<size_t>(-1);
 
-		uint32_t const num_cache_tiles_a_row = tex_width / tile_with_border_size;
-		uint32_t const num_cache_tiles_a_layer = num_cache_tiles_a_row * tex_height / tile_with_border_size;
-		uint32_t const num_cache_total_tiles = num_cache_tiles_a_layer * tex_layer;
+		// Maps a tile to its index in missing, or CACHED
+		std::unordered_map<uint32_t, size_t> seen;
+		for (auto const tile_id : tile_ids)
+		{
+			auto iter = seen.find(tile_id);
+			if (iter != seen.end())
+			{
+				if (iter->second != CACHED)
+				{
+					++ missing[iter->second].coverage;
+				}
+			}
+			else
+			{
+				++ stats_.requests;
+
+				auto tmiter = tile_info_map_.find(tile_id);
+				if (tmiter != tile_info_map_.end())
+				{
+					// Exists in cache
+
+					tile_lru_.splice(tile_lru_.end(), tile_lru_, tmiter->second.lru_iter);
+					++ stats_.hits;
+					seen.emplace(tile_id, CACHED);
+				}
+				else
+				{
+					TileRequest request;
+					request.tile_id = tile_id;
+					uint32_t tile_x, tile_y;
+					this->DecodeTileID(request.level, tile_x, tile_y, tile_id);
+					request.coverage = 1;
+					request.tick = tile_tick_;
+
+					seen.emplace(tile_id, missing.size());
+					missing.push_back(request);
+				}
+			}
+		}
+	}
+
+	void JudaTexture::BuildCacheTiles(std::vector<CacheTile>& tiles, std::vector<uint32_t> const & tile_ids)
+	{
+		std::lock_guard<std::mutex> lock(decode_mutex_);
+
+		TexturePtr const & cache_tex = tex_cache_ ? tex_cache_ : tex_cache_array_[0];
+		uint32_t const tile_with_border_size = cache_tile_size_ + cache_tile_border_size_ * 2;
 
 		std::unordered_map<uint32_t, uint32_t> neighbor_id_map;
 		std::vector<uint32_t> all_neighbor_ids;
 		std::vector<uint32_t> neighbor_ids;
 		std::vector<uint32_t> tile_attrs;
 		std::vector<bool> in_same_image;
-		auto& tim = tile_info_map_;
 		for (size_t i = 0; i < tile_ids.size(); ++ i)
 		{
-			auto tmiter = tim.find(tile_ids[i]);
-			if (tmiter != tim.end())
-			{
-				// Exists in cache
-
-				tmiter->second.tick = tile_tick_;
-			}
-			else
-			{
-				uint32_t level, tile_x, tile_y;
-				this->DecodeTileID(level, tile_x, tile_y, tile_ids[i]);
+			uint32_t level, tile_x, tile_y;
+			this->DecodeTileID(level, tile_x, tile_y, tile_ids[i]);
 
-				std::array<uint32_t, 9> new_tile_id_with_neighbors;
-				new_tile_id_with_neighbors.fill(0xFFFFFFFF);
-				new_tile_id_with_neighbors[0] = tile_ids[i];
+			std::array<uint32_t, 9> new_tile_id_with_neighbors;
+			new_tile_id_with_neighbors.fill(0xFFFFFFFF);
+			new_tile_id_with_neighbors[0] = tile_ids[i];
 
-				std::array<bool, 9> new_in_same_image;
-				new_in_same_image.fill(false);
-				new_in_same_image[0] = true;
+			std::array<bool, 9> new_in_same_image;
+			new_in_same_image.fill(false);
+			new_in_same_image[0] = true;
 
-				uint32_t attr = this->DecodeAAttr(this->Pos2Shuff(level, tile_x, tile_y));
-				tile_attrs.push_back(attr);
-				if (attr != 0xFFFFFFFF)
-				{
-					std::array<int32_t, 9> new_tile_id_x;
-					std::array<int32_t, 9> new_tile_id_y;
+			uint32_t attr = this->DecodeAAttr(this->Pos2Shuff(level, tile_x, tile_y));
+			tile_attrs.push_back(attr);
+			if (attr != 0xFFFFFFFF)
+			{
+				std::array<int32_t, 9> new_tile_id_x;
+				std::array<int32_t, 9> new_tile_id_y;
 
-					int32_t left = tile_x - 1;
-					int32_t right = tile_x + 1;
-					int32_t up = tile_y - 1;
-					int32_t down = tile_y + 1;
+				int32_t left = tile_x - 1;
+				int32_t right = tile_x + 1;
+				int32_t up = tile_y - 1;
+				int32_t down = tile_y + 1;
 
-					ImageEntry const & entry = image_entries_[attr];
-					if (TAM_Wrap == (entry.addr_u_v & 0xF))
-					{
-						left = entry.x + (left - entry.x + entry.w) % entry.w;
-						right = entry.x + (right - entry.x + entry.w) % entry.w;
-					}
-					if (TAM_Wrap == ((entry.addr_u_v >> 4) & 0xF))
-					{
-						up = entry.y + (up - entry.y + entry.h) % entry.h;
-						down = entry.y + (down - entry.y + entry.h) % entry.h;
-					}
+				ImageEntry const & entry = image_entries_[attr];
+				if (TAM_Wrap == (entry.addr_u_v & 0xF))
+				{
+					left = entry.x + (left - entry.x + entry.w) % entry.w;
+					right = entry.x + (right - entry.x + entry.w) % entry.w;
+				}
+				if (TAM_Wrap == ((entry.addr_u_v >> 4) & 0xF))
+				{
+					up = entry.y + (up - entry.y + entry.h) % entry.h;
+					down = entry.y + (down - entry.y + entry.h) % entry.h;
+				}
 
-					new_tile_id_x[1] = left;
-					new_tile_id_y[1] = up;
-					new_tile_id_x[2] = tile_x;
-					new_tile_id_y[2] = up;
-					new_tile_id_x[3] = right;
-					new_tile_id_y[3] = up;
-
-					new_tile_id_x[4] = left;
-					new_tile_id_y[4] = tile_y;
-					new_tile_id_x[5] = right;
-					new_tile_id_y[5] = tile_y;
-
-					new_tile_id_x[6] = left;
-					new_tile_id_y[6] = down;
-					new_tile_id_x[7] = tile_x;
-					new_tile_id_y[7] = down;
-					new_tile_id_x[8] = right;
-					new_tile_id_y[8] = down;
-
-					for (int j = 1; j < 9; ++ j)
+				new_tile_id_x[1] = left;
+				new_tile_id_y[1] = up;
+				new_tile_id_x[2] = tile_x;
+				new_tile_id_y[2] = up;
+				new_tile_id_x[3] = right;
+				new_tile_id_y[3] = up;
+
+				new_tile_id_x[4] = left;
+				new_tile_id_y[4] = tile_y;
+				new_tile_id_x[5] = right;
+				new_tile_id_y[5] = tile_y;
+
+				new_tile_id_x[6] = left;
+				new_tile_id_y[6] = down;
+				new_tile_id_x[7] = tile_x;
+				new_tile_id_y[7] = down;
+				new_tile_id_x[8] = right;
+				new_tile_id_y[8] = down;
+
+				for (int j = 1; j < 9; ++ j)
+				{
+					if ((new_tile_id_x[j] >= 0) && (new_tile_id_y[j] >= 0)
+						&& (new_tile_id_x[j] < static_cast<int32_t>(num_tiles_) - 1)
+						&& (new_tile_id_y[j] < static_cast<int32_t>(num_tiles_) - 1))
 					{
-						if ((new_tile_id_x[j] >= 0) && (new_tile_id_y[j] >= 0)
-							&& (new_tile_id_x[j] < static_cast<int32_t>(num_tiles_) - 1)
-							&& (new_tile_id_y[j] < static_cast<int32_t>(num_tiles_) - 1))
+						new_tile_id_with_neighbors[j] = this->EncodeTileID(level, new_tile_id_x[j], new_tile_id_y[j]);
+						if (new_tile_id_with_neighbors[j] != 0xFFFFFFFF)
 						{
-							new_tile_id_with_neighbors[j] = this->EncodeTileID(level, new_tile_id_x[j], new_tile_id_y[j]);
-							if (new_tile_id_with_neighbors[j] != 0xFFFFFFFF)
+							if (attr == this->DecodeAAttr(this->Pos2Shuff(level, new_tile_id_x[j], new_tile_id_y[j])))
 							{
-								if (attr == this->DecodeAAttr(this->Pos2Shuff(level, new_tile_id_x[j], new_tile_id_y[j])))
-								{
-									new_in_same_image[j] = true;
-								}
+								new_in_same_image[j] = true;
 							}
 						}
-						else
-						{
-							new_tile_id_with_neighbors[j] = 0xFFFFFFFF;
-						}
+					}
+					else
+					{
+						new_tile_id_with_neighbors[j] = 0xFFFFFFFF;
 					}
 				}
+			}
 
-				for (size_t j = 0; j < new_tile_id_with_neighbors.size(); ++ j)
+			for (size_t j = 0; j < new_tile_id_with_neighbors.size(); ++ j)
+			{
+				if (new_tile_id_with_neighbors[j] != 0xFFFFFFFF)
 				{
-					if (new_tile_id_with_neighbors[j] != 0xFFFFFFFF)
+					if (neighbor_id_map.find(new_tile_id_with_neighbors[j]) == neighbor_id_map.end())
 					{
-						if (neighbor_id_map.find(new_tile_id_with_neighbors[j]) == neighbor_id_map.end())
-						{
-							neighbor_id_map.emplace(new_tile_id_with_neighbors[j], static_cast<uint32_t>(neighbor_ids.size()));
-							neighbor_ids.push_back(new_tile_id_with_neighbors[j]);
-						}
+						neighbor_id_map.emplace(new_tile_id_with_neighbors[j], static_cast<uint32_t>(neighbor_ids.size()));
+						neighbor_ids.push_back(new_tile_id_with_neighbors[j]);
 					}
-					all_neighbor_ids.push_back(new_tile_id_with_neighbors[j]);
-					in_same_image.push_back(new_in_same_image[j]);
 				}
+				all_neighbor_ids.push_back(new_tile_id_with_neighbors[j]);
+				in_same_image.push_back(new_in_same_image[j]);
 			}
 		}
 
-		uint32_t mipmaps = tex_cache_->NumMipMaps();
+		uint32_t const mipmaps = cache_tex->NumMipMaps();
+		ElementFormat const format = cache_tex->Format();
 		std::vector<std::vector<uint8_t>> neighbor_data;
 		this->DecodeTiles(neighbor_data, neighbor_ids, mipmaps);
 
-		TileInfo tile_info;
-		tile_info.tick = tile_tick_;
+		tiles.resize(all_neighbor_ids.size() / 9);
 		for (size_t i = 0; i < all_neighbor_ids.size(); i += 9)
 		{
-			tile_info.attr = tile_attrs[i / 9];
+			CacheTile& tile = tiles[i / 9];
+			tile.tile_id = all_neighbor_ids[i];
+			tile.attr = tile_attrs[i / 9];
+			tile.mips.resize(mipmaps);
+			tile.row_pitches.resize(mipmaps);
+
+			uint32_t const attr = tile.attr;
 			uint8_t border_clr[4];
 			TexAddressingMode addr_u, addr_v;
-			if (tile_info.attr != 0xFFFFFFFF)
+			if (attr != 0xFFFFFFFF)
 			{
-				ImageEntry const & entry = image_entries_[tile_info.attr];
+				ImageEntry const & entry = image_entries_[attr];
 				addr_u = static_cast<TexAddressingMode>(entry.addr_u_v & 0xF);
 				addr_v = static_cast<TexAddressingMode>((entry.addr_u_v >> 4) & 0xF);
 				texel_op_.from_float4(border_clr, &entry.border_clr.r());
@@ -1396,77 +1540,6 @@ namespace KlayGE
 				border_clr[0] = border_clr[1] = border_clr[2] = border_clr[3] = 0;
 			}
 
-			if (tile_info_map_.size() < num_cache_total_tiles)
-			{
-				// Still has space in cache
-
-				uint32_t const s = tile_free_list_.front().first;
-				tile_info.z = s / num_cache_tiles_a_layer;
-				tile_info.y = (s - tile_info.z * num_cache_tiles_a_layer) / num_cache_tiles_a_row;
-				tile_info.x = s - tile_info.z * num_cache_tiles_a_layer - tile_info.y * num_cache_tiles_a_row;
-
-				++ tile_free_list_.front().first;
-				if (tile_free_list_.front().first == tile_free_list_.front().second)
-				{
-					tile_free_list_.pop_front();
-				}
-			}
-			else
-			{
-				// Find tiles that are not used for the longest time
-
-				uint64_t min_tick = tim.begin()->second.tick;
-				auto min_tileiter = tim.begin();
-				for (auto tileiter = tim.begin(); tileiter != tim.end(); ++ tileiter)
-				{
-					if (tileiter->second.tick < min_tick)
-					{
-						min_tick = tileiter->second.tick;
-						min_tileiter = tileiter;
-					}
-				}
-
-				tile_info.x = min_tileiter->second.x;
-				tile_info.y = min_tileiter->second.y;
-				tile_info.z = min_tileiter->second.z;
-
-				for (auto tileiter = tim.begin(); tileiter != tim.end();)
-				{
-					if (tileiter->second.tick == min_tick)
-					{
-						uint32_t const id = tileiter->second.z * num_cache_tiles_a_layer + tileiter->second.y * num_cache_tiles_a_row + tileiter->second.x;
-						auto freeiter = tile_free_list_.begin();
-						while ((freeiter != tile_free_list_.end()) && (freeiter->second <= id))
-						{
-							++ freeiter;
-						}
-						tile_free_list_.emplace(freeiter, id, id + 1);
-
-						tileiter = tim.erase(tileiter);
-					}
-					else
-					{
-						 ++ tileiter;
-					}
-				}
-				for (auto freeiter = tile_free_list_.begin(); freeiter != tile_free_list_.end() - 1;)
-				{
-					auto nextiter = freeiter;
-					++ nextiter;
-
-					if (freeiter->second == nextiter->first)
-					{
-						freeiter->second = nextiter->second;
-						freeiter = tile_free_list_.erase(nextiter);
-						-- freeiter;
-					}
-					else
-					{
-						++ freeiter;
-					}
-				}
-			}
-
 			std::array<uint32_t, 9> index_with_neighbors = { { 0 } };
 			for (size_t j = 0; j < index_with_neighbors.size(); ++ j)
 			{
@@ -1527,7 +1600,7 @@ namespace KlayGE
 					}
 					else
 					{
-						if (tile_info.attr != 0xFFFFFFFF)
+						if (attr != 0xFFFFFFFF)
 						{
 							std::vector<int32_t> border_coords_x(mip_border_size * mip_border_size);
 							std::vector<int32_t> border_coords_y(mip_border_size * mip_border_size);
@@ -1640,7 +1713,7 @@ namespace KlayGE
 					}
 					else
 					{
-						if (tile_info.attr != 0xFFFFFFFF)
+						if (attr != 0xFFFFFFFF)
 						{
 							std::vector<int32_t> border_coords_x(mip_tile_size * mip_border_size);
 							std::vector<int32_t> border_coords_y(mip_tile_size * mip_border_size);
@@ -1750,7 +1823,7 @@ namespace KlayGE
 					}
 					else
 					{
-						if (tile_info.attr != 0xFFFFFFFF)
+						if (attr != 0xFFFFFFFF)
 						{
 							std::vector<int32_t> border_coords_x(mip_border_size * mip_border_size);
 							std::vector<int32_t> border_coords_y(mip_border_size * mip_border_size);
@@ -1864,7 +1937,7 @@ namespace KlayGE
 					}
 					else
 					{
-						if (tile_info.attr != 0xFFFFFFFF)
+						if (attr != 0xFFFFFFFF)
 						{
 							std::vector<int32_t> border_coords_x(mip_border_size * mip_tile_size);
 							std::vector<int32_t> border_coords_y(mip_border_size * mip_tile_size);
@@ -1977,7 +2050,7 @@ namespace KlayGE
 					}
 					else
 					{
-						if (tile_info.attr != 0xFFFFFFFF)
+						if (attr != 0xFFFFFFFF)
 						{
 							std::vector<int32_t> border_coords_x(mip_border_size * mip_tile_size);
 							std::vector<int32_t> border_coords_y(mip_border_size * mip_tile_size);
@@ -2091,7 +2164,7 @@ namespace KlayGE
 					}
 					else
 					{
-						if (tile_info.attr != 0xFFFFFFFF)
+						if (attr != 0xFFFFFFFF)
 						{
 							std::vector<int32_t> border_coords_x(mip_border_size * mip_border_size);
 							std::vector<int32_t> border_coords_y(mip_border_size * mip_border_size);
@@ -2204,7 +2277,7 @@ namespace KlayGE
 					}
 					else
 					{
-						if (tile_info.attr != 0xFFFFFFFF)
+						if (attr != 0xFFFFFFFF)
 						{
 							std::vector<int32_t> border_coords_x(mip_tile_size * mip_border_size);
 							std::vector<int32_t> border_coords_y(mip_tile_size * mip_border_size);
@@ -2314,7 +2387,7 @@ namespace KlayGE
 					}
 					else
 					{
-						if (tile_info.attr != 0xFFFFFFFF)
+						if (attr != 0xFFFFFFFF)
 						{
 							std::vector<int32_t> border_coords_x(mip_border_size * mip_border_size);
 							std::vector<int32_t> border_coords_y(mip_border_size * mip_border_size);
@@ -2419,29 +2492,6 @@ namespace KlayGE
 					}
 				}
 
-				ElementFormat format;
-				if (tex_cache_)
-				{
-					format = tex_cache_->Format();
-				}
-				else
-				{
-					format = tex_cache_array_[tile_info.z]->Format();
-				}
-
-				TexturePtr target_tex;
-				uint32_t target_array_index;
-				if (tex_cache_)
-				{
-					target_tex = tex_cache_;
-					target_array_index = tile_info.z;
-				}
-				else
-				{
-					target_tex = tex_cache_array_[tile_info.z];
-					target_array_index = 0;
-				}
-
 				if (IsCompressedFormat(format))
 				{
 					uint32_t const block_width = BlockWidth(format);
@@ -2528,36 +2578,168 @@ namespace KlayGE
 							&bc[0], bc_row_pitch, bc_slice_pitch, p_argb, row_pitch, slice_pitch, TCM_Quality);
 					}
 
-					target_tex->UpdateSubresource2D(target_array_index, l,
-						tile_info.x * mip_tile_with_border_size, tile_info.y * mip_tile_with_border_size,
-						mip_tile_with_border_size, mip_tile_with_border_size,
-						&bc[0], bc_row_pitch);
+					tile.mips[l].swap(bc);
+					tile.row_pitches[l] = bc_row_pitch;
 				}
 				else
 				{
-					target_tex->UpdateSubresource2D(target_array_index, l,
-						tile_info.x * mip_tile_with_border_size, tile_info.y * mip_tile_with_border_size,
-						mip_tile_with_border_size, mip_tile_with_border_size,
-						&tex_a_tile_data[0], mip_tile_with_border_size * texel_size_);
+					tile.mips[l].swap(tex_a_tile_data);
+					tile.row_pitches[l] = mip_tile_with_border_size * texel_size_;
 				}
 
 				mip_tile_size /= 2;
 				mip_tile_with_border_size /= 2;
 				mip_border_size /= 2;
 			}
+		}
+	}
+
+	void JudaTexture::UploadCacheTiles(std::vector<CacheTile> const & tiles)
+	{
+		uint32_t const tile_with_border_size = cache_tile_size_ + cache_tile_border_size_ * 2;
+
+		// Page table entries, keyed by their position in the indirect texture
+		std::vector<std::pair<uint32_t, std::array<uint8_t, 4>>> indirect_entries;
+		indirect_entries.reserve(tiles.size());
+
+		for (auto const & tile : tiles)
+		{
+			if (tile_info_map_.find(tile.tile_id) != tile_info_map_.end())
+			{
+				// Already uploaded by a synchronous update
+				continue;
+			}
 
-			uint8_t const a_tile_indirect[] =
+			TileInfo tile_info;
+			tile_info.attr = tile.attr;
+			if (!free_cache_slots_.empty())
 			{
-				static_cast<uint8_t>(tile_info.x),
-				static_cast<uint8_t>(tile_info.y),
-				static_cast<uint8_t>(tile_info.z),
-				0
-			};
+				uint32_t const s = free_cache_slots_.back();
+				free_cache_slots_.pop_back();
+
+				tile_info.z = s / num_cache_tiles_a_layer_;
+				tile_info.y = (s - tile_info.z * num_cache_tiles_a_layer_) / num_cache_tiles_a_row_;
+				tile_info.x = s - tile_info.z * num_cache_tiles_a_layer_ - tile_info.y * num_cache_tiles_a_row_;
+			}
+			else
+			{
+				// Reuses the slot of the tile that is not used for the longest time
+
+				BOOST_ASSERT(!tile_lru_.empty());
+
+				auto victim_iter = tile_info_map_.find(tile_lru_.front());
+				tile_info.x = victim_iter->second.x;
+				tile_info.y = victim_iter->second.y;
+				tile_info.z = victim_iter->second.z;
+
+				tile_info_map_.erase(victim_iter);
+				tile_lru_.pop_front();
+				++ stats_.evictions;
+			}
+
+			TexturePtr const & target_tex = tex_cache_ ? tex_cache_ : tex_cache_array_[tile_info.z];
+			uint32_t const target_array_index = tex_cache_ ? tile_info.z : 0;
+
+			uint32_t mip_tile_with_border_size = tile_with_border_size;
+			for (uint32_t l = 0; l < tile.mips.size(); ++ l)
+			{
+				target_tex->UpdateSubresource2D(target_array_index, l,
+					tile_info.x * mip_tile_with_border_size, tile_info.y * mip_tile_with_border_size,
+					mip_tile_with_border_size, mip_tile_with_border_size,
+					&tile.mips[l][0], tile.row_pitches[l]);
+
+				mip_tile_with_border_size /= 2;
+			}
+
 			uint32_t level, tile_x, tile_y;
-			this->DecodeTileID(level, tile_x, tile_y, all_neighbor_ids[i]);
-			tex_indirect_->UpdateSubresource2D(0, 0, tile_x, tile_y, 1, 1, a_tile_indirect, sizeof(a_tile_indirect));
+			this->DecodeTileID(level, tile_x, tile_y, tile.tile_id);
+			std::array<uint8_t, 4> const a_tile_indirect =
+			{
+				{
+					static_cast<uint8_t>(tile_info.x),
+					static_cast<uint8_t>(tile_info.y),
+					static_cast<uint8_t>(tile_info.z),
+					0
+				}
+			};
+			indirect_entries.emplace_back(tile_y * num_tiles_ + tile_x, a_tile_indirect);
 
-			tim.emplace(all_neighbor_ids[i], tile_info);
+			tile_lru_.push_back(tile.tile_id);
+			tile_info.lru_iter = std::prev(tile_lru_.end());
+			tile_info_map_.emplace(tile.tile_id, tile_info);
+			++ stats_.uploads;
+		}
+
+		// One update for each run of adjacent entries in a row. The last entry of a position wins.
+		std::stable_sort(indirect_entries.begin(), indirect_entries.end(),
+			[](std::pair<uint32_t, std::array<uint8_t, 4>> const & lhs, std::pair<uint32_t, std::array<uint8_t, 4>> const & rhs)
+			{
+				return lhs.first < rhs.first;
+			});
+		std::vector<uint8_t> run;
+		size_t i = 0;
+		while (i < indirect_entries.size())
+		{
+			uint32_t const start = indirect_entries[i].first;
+			uint32_t end = start;
+			run.clear();
+			while ((i < indirect_entries.size()) && (indirect_entries[i].first <= end)
+				&& ((indirect_entries[i].first == start) || (indirect_entries[i].first % num_tiles_ != 0)))
+			{
+				auto const & entry = indirect_entries[i].second;
+				if (indirect_entries[i].first == end)
+				{
+					run.insert(run.end(), entry.begin(), entry.end());
+					++ end;
+				}
+				else
+				{
+					// Same position as the previous entry
+					std::copy(entry.begin(), entry.end(), run.end() - entry.size());
+				}
+				++ i;
+			}
+
+			uint32_t const num = end - start;
+			tex_indirect_->UpdateSubresource2D(0, 0, start % num_tiles_, start / num_tiles_, num, 1, &run[0], num * 4);
+		}
+	}
+
+	void JudaTexture::StreamTiles()
+	{
+		uint32_t const BATCH_SIZE = 8;
+
+		std::vector<uint32_t> tile_ids;
+		std::vector<CacheTile> tiles;
+		for (;;)
+		{
+			tile_ids.clear();
+			{
+				std::lock_guard<std::mutex> lock(stream_mutex_);
+				if (stream_quit_ || tile_requests_.empty())
+				{
+					streaming_ = false;
+					break;
+				}
+
+				while (!tile_requests_.empty() && (tile_ids.size() < BATCH_SIZE))
+				{
+					tile_ids.push_back(tile_requests_.back().tile_id);
+					tile_requests_.pop_back();
+				}
+			}
+
+			// Decoded as a batch, so neighbours shared by the tiles are only decoded once
+			tiles.clear();
+			this->BuildCacheTiles(tiles, tile_ids);
+
+			{
+				std::lock_guard<std::mutex> lock(stream_mutex_);
+				for (auto& tile : tiles)
+				{
+					decoded_tiles_.push_back(std::move(tile));
+				}
+			}
 		}
 	}
 }
@@ -0,0 +1,89 @@
+/**
+ * @file LightCuller.cpp
+ * @author Minmin Gong
+ *
+ * @section DESCRIPTION
+ *
+ * This source file is part of KlayGE
+ * For the latest info, see http://www.klayge.org
+ *
+ * @section LICENSE
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * You may alternatively use this source under the terms of
+ * the KlayGE Proprietary License (KPL). You can obtained such a license
+ * from http://www.klayge.org/licensing/.
+ */
+
+#include <KlayGE/KlayGE.hpp>
+#include <KFL/Math.hpp>
+#include <KFL/SIMDMath.hpp>
+
+#include <algorithm>
+
+#include <KlayGE/LightCuller.hpp>
+
+namespace KlayGE
+{
+	void LightCuller::Cull(float4x4 const & view_proj, ArrayRef<Sphere> lights)
+	{
+		Frustum frustum;
+		frustum.ClipMatrix(view_proj, MathLib::inverse(view_proj));
+
+		uint32_t const num_lights = static_cast<uint32_t>(lights.size());
+		light_visibles_.assign(num_lights, 0);
+		visible_lights_.clear();
+
+		// 4 lights at a time, in SoA layout. The signed distance to every plane is computed in parallel and the minimum tells if
+		// a sphere is completely outside of any plane.
+		for (uint32_t i = 0; i < num_lights; i += 4)
+		{
+			float4 xs, ys, zs, rs;
+			for (uint32_t j = 0; j < 4; ++ j)
+			{
+				Sphere const & light = lights[std::min(i + j, num_lights - 1)];
+				xs[j] = light.Center().x();
+				ys[j] = light.Center().y();
+				zs[j] = light.Center().z();
+				rs[j] = light.Radius();
+			}
+
+			SIMDVectorF4 const vx = SIMDMathLib::LoadVector4(xs);
+			SIMDVectorF4 const vy = SIMDMathLib::LoadVector4(ys);
+			SIMDVectorF4 const vz = SIMDMathLib::LoadVector4(zs);
+			SIMDVectorF4 const vr = SIMDMathLib::LoadVector4(rs);
+
+			SIMDVectorF4 min_dist = SIMDMathLib::SetVector(1e30f);
+			for (uint32_t p = 0; p < 6; ++ p)
+			{
+				Plane const & plane = frustum.FrustumPlane(p);
+				SIMDVectorF4 const dist = vx * plane.a() + vy * plane.b() + vz * plane.c() + vr + plane.d();
+				min_dist = SIMDMathLib::Minimize(min_dist, dist);
+			}
+
+			float4 dists;
+			SIMDMathLib::StoreVector4(dists, min_dist);
+			for (uint32_t j = 0; (j < 4) && (i + j < num_lights); ++ j)
+			{
+				if ((dists[j] >= 0) && (lights[i + j].Radius() >= 0))
+				{
+					light_visibles_[i + j] = 1;
+					visible_lights_.push_back(i + j);
+				}
+			}
+		}
+	}
+}
@@ -38,6 +38,7 @@
 #include <KFL/Hash.hpp>
 #include <KlayGE/DeferredRenderingLayer.hpp>
 #include <KlayGE/SceneManager.hpp>
+#include <KlayGE/PerfProfiler.hpp>
 
 #include <algorithm>
 #include <fstream>
@@ -50,7 +51,71 @@ namespace
 {
 	using namespace KlayGE;
 
-	uint32_t const MODEL_BIN_VERSION = 16;
+	uint32_t const MODEL_BIN_VERSION = 18;
+
+	uint16_t QuantizeUNorm16(float v, float min_v, float extent)
+	{
+		float const n = (extent > 0) ? (v - min_v) / extent : 0.0f;
+		return static_cast<uint16_t>(MathLib::clamp(static_cast<int32_t>(n * 65535 + 0.5f), 0, 65535));
+	}
+
+	float DequantizeUNorm16(uint16_t v, float min_v, float extent)
+	{
+		return min_v + v * (extent / 65535);
+	}
+
+	// Smallest-three encoding. The 3 smallest components are quantized to 15 bits, the index of the largest one is
+	// stored in the top bits of the first 2 words.
+	void EncodeQuaternion(Quaternion const & quat, uint16_t* words)
+	{
+		uint32_t largest = 0;
+		for (uint32_t i = 1; i < 4; ++ i)
+		{
+			if (MathLib::abs(quat[i]) > MathLib::abs(quat[largest]))
+			{
+				largest = i;
+			}
+		}
+
+		float const sign = (quat[largest] < 0) ? -1.0f : 1.0f;
+		uint32_t w = 0;
+		for (uint32_t i = 0; i < 4; ++ i)
+		{
+			if (i != largest)
+			{
+				float const v = quat[i] * sign * SQRT2 * 0.5f + 0.5f;
+				words[w] = static_cast<uint16_t>(MathLib::clamp(static_cast<int32_t>(v * 32767 + 0.5f), 0, 32767));
+				++ w;
+			}
+		}
+
+		words[0] |= static_cast<uint16_t>((largest >> 1) << 15);
+		words[1] |= static_cast<uint16_t>((largest & 1) << 15);
+	}
+
+	Quaternion DecodeQuaternion(uint16_t const * words)
+	{
+		uint32_t const largest = ((words[0] >> 15) << 1) | (words[1] >> 15);
+
+		float const scale = 2 / (32767 * SQRT2);
+		float const bias = -1 / SQRT2;
+		float const a = (words[0] & 0x7FFF) * scale + bias;
+		float const b = (words[1] & 0x7FFF) * scale + bias;
+		float const c = (words[2] & 0x7FFF) * scale + bias;
+		float const d = MathLib::sqrt(std::max(1 - (a * a + b * b + c * c), 0.0f));
+
+		switch (largest)
+		{
+		case 0:
+			return Quaternion(d, a, b, c);
+		case 1:
+			return Quaternion(a, d, b, c);
+		case 2:
+			return Quaternion(a, b, d, c);
+		default:
+			return Quaternion(a, b, c, d);
+		}
+	}
 
 	class RenderModelLoadingDesc : public ResLoadingDesc
 	{
@@ -669,6 +734,96 @@ namespace KlayGE
 		return ret;
 	}
 
+	void CompressedKeyFrameSet::Compress(KeyFrameSet const & kf)
+	{
+		uint32_t const num_kf = static_cast<uint32_t>(kf.frame_id.size());
+
+		std::vector<float3> trans(num_kf);
+		float3 trans_min(+1e10f, +1e10f, +1e10f);
+		float3 trans_max(-1e10f, -1e10f, -1e10f);
+		scale_min = +1e10f;
+		float scale_max = -1e10f;
+		for (uint32_t i = 0; i < num_kf; ++ i)
+		{
+			trans[i] = MathLib::udq_to_trans(kf.bind_real[i], kf.bind_dual[i]);
+			trans_min = MathLib::minimize(trans_min, trans[i]);
+			trans_max = MathLib::maximize(trans_max, trans[i]);
+			scale_min = std::min(scale_min, kf.bind_scale[i]);
+			scale_max = std::max(scale_max, kf.bind_scale[i]);
+		}
+		if (num_kf == 0)
+		{
+			trans_min = trans_max = float3(0, 0, 0);
+			scale_min = scale_max = 1;
+		}
+		translation_min = trans_min;
+		translation_extent = trans_max - trans_min;
+		scale_extent = scale_max - scale_min;
+
+		frame_id = kf.frame_id;
+		rotations.resize(num_kf * 3);
+		translations.resize(num_kf * 3);
+		scales.resize(num_kf);
+		for (uint32_t i = 0; i < num_kf; ++ i)
+		{
+			EncodeQuaternion(kf.bind_real[i], &rotations[i * 3]);
+			for (uint32_t j = 0; j < 3; ++ j)
+			{
+				translations[i * 3 + j] = QuantizeUNorm16(trans[i][j], translation_min[j], translation_extent[j]);
+			}
+			scales[i] = QuantizeUNorm16(kf.bind_scale[i], scale_min, scale_extent);
+		}
+	}
+
+	void CompressedKeyFrameSet::Decompress(KeyFrameSet& kf) const
+	{
+		uint32_t const num_kf = static_cast<uint32_t>(frame_id.size());
+
+		kf.frame_id = frame_id;
+		kf.bind_real.resize(num_kf);
+		kf.bind_dual.resize(num_kf);
+		kf.bind_scale.resize(num_kf);
+		for (uint32_t i = 0; i < num_kf; ++ i)
+		{
+			std::tie(kf.bind_real[i], kf.bind_dual[i], kf.bind_scale[i]) = this->Key(i);
+		}
+	}
+
+	std::tuple<Quaternion, Quaternion, float> CompressedKeyFrameSet::Key(uint32_t index) const
+	{
+		Quaternion const real = DecodeQuaternion(&rotations[index * 3]);
+		float3 const trans(DequantizeUNorm16(translations[index * 3 + 0], translation_min.x(), translation_extent.x()),
+			DequantizeUNorm16(translations[index * 3 + 1], translation_min.y(), translation_extent.y()),
+			DequantizeUNorm16(translations[index * 3 + 2], translation_min.z(), translation_extent.z()));
+		return std::make_tuple(real, MathLib::quat_trans_to_udq(real, trans), DequantizeUNorm16(scales[index], scale_min, scale_extent));
+	}
+
+	std::tuple<Quaternion, Quaternion, float> CompressedKeyFrameSet::Frame(float frame) const
+	{
+		if (frame_id.size() == 1)
+		{
+			return this->Key(0);
+		}
+		else
+		{
+			frame = std::fmod(frame, static_cast<float>(frame_id.back() + 1));
+
+			auto iter = std::upper_bound(frame_id.begin(), frame_id.end(), frame);
+			int index = static_cast<int>(iter - frame_id.begin());
+
+			int index0 = index - 1;
+			int index1 = index % frame_id.size();
+			int frame0 = frame_id[index0];
+			int frame1 = frame_id[index1];
+			float factor = (frame - frame0) / (frame1 - frame0);
+
+			auto const key0 = this->Key(index0);
+			auto const key1 = this->Key(index1);
+			auto dq = MathLib::sclerp(std::get<0>(key0), std::get<1>(key0), std::get<0>(key1), std::get<1>(key1), factor);
+			return std::make_tuple(dq.first, dq.second, MathLib::lerp(std::get<2>(key0), std::get<2>(key1), factor));
+		}
+	}
+
 	AABBox AABBKeyFrameSet::Frame(float frame) const
 	{
 		if (frame_id.size() == 1)
@@ -705,12 +860,55 @@ namespace KlayGE
 	{
 	}
 
+	void SkinnedModel::AttachKeyFrameSets(std::shared_ptr<std::vector<KeyFrameSet> const> const & kf)
+	{
+		key_frame_sets_ = kf;
+		compressed_key_frame_sets_.reset();
+	}
+
+	std::shared_ptr<std::vector<KeyFrameSet> const> const & SkinnedModel::GetKeyFrameSets() const
+	{
+		if (!key_frame_sets_ && compressed_key_frame_sets_)
+		{
+			auto kfs = MakeSharedPtr<std::vector<KeyFrameSet>>(compressed_key_frame_sets_->size());
+			for (size_t i = 0; i < compressed_key_frame_sets_->size(); ++ i)
+			{
+				(*compressed_key_frame_sets_)[i].Decompress((*kfs)[i]);
+			}
+			key_frame_sets_ = kfs;
+		}
+		return key_frame_sets_;
+	}
+
+	void SkinnedModel::AttachCompressedKeyFrameSets(std::shared_ptr<std::vector<CompressedKeyFrameSet> const> const & ckf)
+	{
+		compressed_key_frame_sets_ = ckf;
+		key_frame_sets_.reset();
+	}
+
+	std::shared_ptr<std::vector<CompressedKeyFrameSet> const> const & SkinnedModel::GetCompressedKeyFrameSets() const
+	{
+		if (!compressed_key_frame_sets_ && key_frame_sets_)
+		{
+			auto ckfs = MakeSharedPtr<std::vector<CompressedKeyFrameSet>>(key_frame_sets_->size());
+			for (size_t i = 0; i < key_frame_sets_->size(); ++ i)
+			{
+				(*ckfs)[i].Compress((*key_frame_sets_)[i]);
+			}
+			compressed_key_frame_sets_ = ckfs;
+		}
+		return compressed_key_frame_sets_;
+	}
+
 	void SkinnedModel::BuildBones(float frame)
 	{
+		KLAYGE_PERF_TRACE_SCOPE("Animation", "BuildBones");
+
+		auto const & ckfs = *this->GetCompressedKeyFrameSets();
 		for (size_t i = 0; i < joints_.size(); ++ i)
 		{
 			Joint& joint = joints_[i];
-			KeyFrameSet const & kf = (*key_frame_sets_)[i];
+			CompressedKeyFrameSet const & kf = ckfs[i];
 
 			std::tuple<Quaternion, Quaternion, float> key_dq = kf.Frame(frame);
 
@@ -776,6 +974,8 @@ namespace KlayGE
 
 	void SkinnedModel::UpdateBinds()
 	{
+		KLAYGE_PERF_TRACE_SCOPE("Animation", "UpdateBinds");
+
 		bind_reals_.resize(joints_.size());
 		bind_duals_.resize(joints_.size());
 		for (size_t i = 0; i < joints_.size(); ++ i)
@@ -925,7 +1125,7 @@ namespace KlayGE
 				joints[i] = src_skinned_model.GetJoint(i);
 			}
 			skinned_model.AssignJoints(joints.begin(), joints.end());
-			skinned_model.AttachKeyFrameSets(src_skinned_model.GetKeyFrameSets());
+			skinned_model.AttachCompressedKeyFrameSets(src_skinned_model.GetCompressedKeyFrameSets());
 
 			skinned_model.NumFrames(src_skinned_model.NumFrames());
 			skinned_model.FrameRate(src_skinned_model.FrameRate());
@@ -1066,7 +1266,7 @@ namespace KlayGE
 		std::vector<std::pair<SceneNodePtr, std::vector<uint16_t>>> nodes;
 		std::vector<Joint> joints;
 		std::shared_ptr<std::vector<AnimationAction>> actions;
-		std::shared_ptr<std::vector<KeyFrameSet>> kfs;
+		std::shared_ptr<std::vector<CompressedKeyFrameSet>> kfs;
 		uint32_t num_frames = 0;
 		uint32_t frame_rate = 0;
 		std::vector<std::shared_ptr<AABBKeyFrameSet>> frame_pos_bbs;
@@ -1384,7 +1584,7 @@ namespace KlayGE
 			decoded->read(&frame_rate, sizeof(frame_rate));
 			frame_rate = LE2Native(frame_rate);
 
-			kfs = MakeSharedPtr<std::vector<KeyFrameSet>>(joints.size());
+			kfs = MakeSharedPtr<std::vector<CompressedKeyFrameSet>>(joints.size());
 			for (uint32_t kf_index = 0; kf_index < num_kfs; ++ kf_index)
 			{
 				uint32_t joint_index = kf_index;
@@ -1393,32 +1593,42 @@ namespace KlayGE
 				decoded->read(&num_kf, sizeof(num_kf));
 				num_kf = LE2Native(num_kf);
 
-				KeyFrameSet kf;
+				CompressedKeyFrameSet kf;
+				decoded->read(&kf.translation_min, sizeof(kf.translation_min));
+				decoded->read(&kf.translation_extent, sizeof(kf.translation_extent));
+				for (uint32_t j = 0; j < 3; ++ j)
+				{
+					kf.translation_min[j] = LE2Native(kf.translation_min[j]);
+					kf.translation_extent[j] = LE2Native(kf.translation_extent[j]);
+				}
+				decoded->read(&kf.scale_min, sizeof(kf.scale_min));
+				kf.scale_min = LE2Native(kf.scale_min);
+				decoded->read(&kf.scale_extent, sizeof(kf.scale_extent));
+				kf.scale_extent = LE2Native(kf.scale_extent);
+
 				kf.frame_id.resize(num_kf);
-				kf.bind_real.resize(num_kf);
-				kf.bind_dual.resize(num_kf);
-				kf.bind_scale.resize(num_kf);
-				for (uint32_t k_index = 0; k_index < num_kf; ++ k_index)
+				kf.rotations.resize(num_kf * 3);
+				kf.translations.resize(num_kf * 3);
+				kf.scales.resize(num_kf);
+				decoded->read(kf.frame_id.data(), kf.frame_id.size() * sizeof(kf.frame_id[0]));
+				decoded->read(kf.rotations.data(), kf.rotations.size() * sizeof(kf.rotations[0]));
+				decoded->read(kf.translations.data(), kf.translations.size() * sizeof(kf.translations[0]));
+				decoded->read(kf.scales.data(), kf.scales.size() * sizeof(kf.scales[0]));
+				for (auto& frame_id : kf.frame_id)
+				{
+					frame_id = LE2Native(frame_id);
+				}
+				for (auto& rotation : kf.rotations)
+				{
+					rotation = LE2Native(rotation);
+				}
+				for (auto& translation : kf.translations)
 				{
-					decoded->read(&kf.frame_id[k_index], sizeof(kf.frame_id[k_index]));
-					kf.frame_id[k_index] = LE2Native(kf.frame_id[k_index]);
-					decoded->read(&kf.bind_real[k_index], sizeof(kf.bind_real[k_index]));
-					kf.bind_real[k_index][0] = LE2Native(kf.bind_real[k_index][0]);
-					kf.bind_real[k_index][1] = LE2Native(kf.bind_real[k_index][1]);
-					kf.bind_real[k_index][2] = LE2Native(kf.bind_real[k_index][2]);
-					kf.bind_real[k_index][3] = LE2Native(kf.bind_real[k_index][3]);
-					decoded->read(&kf.bind_dual[k_index], sizeof(kf.bind_dual[k_index]));
-					kf.bind_dual[k_index][0] = LE2Native(kf.bind_dual[k_index][0]);
-					kf.bind_dual[k_index][1] = LE2Native(kf.bind_dual[k_index][1]);
-					kf.bind_dual[k_index][2] = LE2Native(kf.bind_dual[k_index][2]);
-					kf.bind_dual[k_index][3] = LE2Native(kf.bind_dual[k_index][3]);
-
-					float flip = MathLib::SignBit(kf.bind_real[k_index].w());
-
-					kf.bind_scale[k_index] = MathLib::length(kf.bind_real[k_index]);
-					kf.bind_real[k_index] /= kf.bind_scale[k_index];
-
-					kf.bind_scale[k_index] *= flip;
+					translation = LE2Native(translation);
+				}
+				for (auto& scale : kf.scales)
+				{
+					scale = LE2Native(scale);
 				}
 
 				if (joint_index < num_joints)
@@ -1546,7 +1756,7 @@ namespace KlayGE
 				SkinnedModelPtr skinned_model = checked_pointer_cast<SkinnedModel>(model);
 
 				skinned_model->AssignJoints(joints.begin(), joints.end());
-				skinned_model->AttachKeyFrameSets(kfs);
+				skinned_model->AttachCompressedKeyFrameSets(kfs);
 
 				skinned_model->NumFrames(num_frames);
 				skinned_model->FrameRate(frame_rate);
@@ -1797,7 +2007,7 @@ namespace KlayGE
 		}
 	}
 
-	void WriteKeyFramesChunk(uint32_t num_frames, uint32_t frame_rate, std::vector<KeyFrameSet>& kfs,
+	void WriteKeyFramesChunk(uint32_t num_frames, uint32_t frame_rate, std::vector<CompressedKeyFrameSet> const & kfs,
 		std::ostream& os)
 	{
 		num_frames = Native2LE(num_frames);
@@ -1807,28 +2017,44 @@ namespace KlayGE
 
 		for (size_t i = 0; i < kfs.size(); ++ i)
 		{
-			uint32_t num_kf = Native2LE(static_cast<uint32_t>(kfs[i].frame_id.size()));
+			auto const & kf = kfs[i];
+
+			uint32_t num_kf = Native2LE(static_cast<uint32_t>(kf.frame_id.size()));
 			os.write(reinterpret_cast<char*>(&num_kf), sizeof(num_kf));
 
-			for (size_t j = 0; j < kfs[i].frame_id.size(); ++ j)
+			float3 translation_min;
+			float3 translation_extent;
+			for (uint32_t j = 0; j < 3; ++ j)
 			{
-				Quaternion bind_real = kfs[i].bind_real[j];
-				Quaternion bind_dual = kfs[i].bind_dual[j];
-				float bind_scale = kfs[i].bind_scale[j];
-
-				uint32_t frame_id = Native2LE(kfs[i].frame_id[j]);
+				translation_min[j] = Native2LE(kf.translation_min[j]);
+				translation_extent[j] = Native2LE(kf.translation_extent[j]);
+			}
+			os.write(reinterpret_cast<char*>(&translation_min), sizeof(translation_min));
+			os.write(reinterpret_cast<char*>(&translation_extent), sizeof(translation_extent));
+			float scale_min = Native2LE(kf.scale_min);
+			os.write(reinterpret_cast<char*>(&scale_min), sizeof(scale_min));
+			float scale_extent = Native2LE(kf.scale_extent);
+			os.write(reinterpret_cast<char*>(&scale_extent), sizeof(scale_extent));
+
+			for (auto frame_id : kf.frame_id)
+			{
+				frame_id = Native2LE(frame_id);
 				os.write(reinterpret_cast<char*>(&frame_id), sizeof(frame_id));
-				bind_real *= bind_scale;
-				bind_real.x() = Native2LE(bind_real.x());
-				bind_real.y() = Native2LE(bind_real.y());
-				bind_real.z() = Native2LE(bind_real.z());
-				bind_real.w() = Native2LE(bind_real.w());
-				os.write(reinterpret_cast<char*>(&bind_real), sizeof(bind_real));
-				bind_dual.x() = Native2LE(bind_dual.x());
-				bind_dual.y() = Native2LE(bind_dual.y());
-				bind_dual.z() = Native2LE(bind_dual.z());
-				bind_dual.w() = Native2LE(bind_dual.w());
-				os.write(reinterpret_cast<char*>(&bind_dual), sizeof(bind_dual));
+			}
+			for (auto rotation : kf.rotations)
+			{
+				rotation = Native2LE(rotation);
+				os.write(reinterpret_cast<char*>(&rotation), sizeof(rotation));
+			}
+			for (auto translation : kf.translations)
+			{
+				translation = Native2LE(translation);
+				os.write(reinterpret_cast<char*>(&translation), sizeof(translation));
+			}
+			for (auto scale : kf.scales)
+			{
+				scale = Native2LE(scale);
+				os.write(reinterpret_cast<char*>(&scale), sizeof(scale));
 			}
 		}
 	}
@@ -1883,7 +2109,7 @@ namespace KlayGE
 		std::vector<uint32_t> const & mesh_num_indices, std::vector<uint32_t> const & mesh_base_indices,
 		std::vector<SceneNode const *> const & nodes, std::vector<Renderable const *> const & renderables,
 		std::vector<Joint> const & joints, std::shared_ptr<std::vector<AnimationAction>> const & actions,
-		std::shared_ptr<std::vector<KeyFrameSet>> const & kfs, uint32_t num_frames, uint32_t frame_rate,
+		std::shared_ptr<std::vector<CompressedKeyFrameSet> const> const & kfs, uint32_t num_frames, uint32_t frame_rate,
 		std::vector<std::shared_ptr<AABBKeyFrameSet>> const & frame_pos_bbs)
 	{
 		std::ostringstream ss;
@@ -2103,7 +2329,7 @@ namespace KlayGE
 
 		std::vector<Joint> joints;
 		std::shared_ptr<std::vector<AnimationAction>> actions;
-		std::shared_ptr<std::vector<KeyFrameSet>> kfs;
+		std::shared_ptr<std::vector<CompressedKeyFrameSet> const> kfs;
 		uint32_t num_frame = 0;
 		uint32_t frame_rate = 0;
 		std::vector<std::shared_ptr<AABBKeyFrameSet>> frame_pos_bbs;
@@ -2154,7 +2380,7 @@ namespace KlayGE
 			num_frame = skinned_model.NumFrames();
 			frame_rate = skinned_model.FrameRate();
 
-			kfs = skinned_model.GetKeyFrameSets();
+			kfs = skinned_model.GetCompressedKeyFrameSets();
 
 			frame_pos_bbs.resize(mesh_names.size());
 			for (uint32_t mesh_index = 0; mesh_index < mesh_names.size(); ++ mesh_index)
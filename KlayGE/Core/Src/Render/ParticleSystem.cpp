@@ -40,6 +40,7 @@
 #include <KlayGE/ResLoader.hpp>
 #include <KFL/XMLDom.hpp>
 #include <KlayGE/DeferredRenderingLayer.hpp>
+#include <KlayGE/PerfProfiler.hpp>
 #include <KFL/Hash.hpp>
 
 #include <fstream>
@@ -741,6 +742,8 @@ namespace KlayGE
 
 	void ParticleSystem::UpdateParticlesNoLock(float elapsed_time)
 	{
+		KLAYGE_PERF_TRACE_SCOPE("Particle", "UpdateParticles");
+
 		auto emitter_iter = emitters_.begin();
 		uint32_t new_particle = (*emitter_iter)->Update(elapsed_time);
 
@@ -833,6 +836,8 @@ namespace KlayGE
 
 	void ParticleSystem::UpdateParticleBufferNoLock()
 	{
+		KLAYGE_PERF_TRACE_SCOPE("Particle", "UpdateParticleBuffer");
+
 		if (!actived_particles_.empty())
 		{
 			RenderLayout& rl = renderables_[0]->GetRenderLayout();
@@ -0,0 +1,167 @@
+/**
+ * @file RenderCommandList.cpp
+ * @author Minmin Gong
+ *
+ * @section DESCRIPTION
+ *
+ * This source file is part of KlayGE
+ * For the latest info, see http://www.klayge.org
+ *
+ * @section LICENSE
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * You may alternatively use this source under the terms of
+ * the KlayGE Proprietary License (KPL). You can obtained such a license
+ * from http://www.klayge.org/licensing/.
+ */
+
+#include <KlayGE/KlayGE.hpp>
+#include <KFL/Thread.hpp>
+#include <KlayGE/Context.hpp>
+#include <KlayGE/RenderEffect.hpp>
+
+#include <cstring>
+
+#include <boost/assert.hpp>
+
+#include <KlayGE/RenderCommandList.hpp>
+
+namespace
+{
+	using namespace KlayGE;
+
+	uint32_t const COMMAND_ALIGNMENT = sizeof(uint64_t);
+
+	uint32_t AlignCommandSize(uint32_t size)
+	{
+		return (size + COMMAND_ALIGNMENT - 1) & ~(COMMAND_ALIGNMENT - 1);
+	}
+}
+
+namespace KlayGE
+{
+	RenderCommandList::RenderCommandList()
+	{
+		this->Reset();
+	}
+
+	void RenderCommandList::Reset()
+	{
+		buff_.clear();
+		frame_buffers_.clear();
+		num_commands_ = 0;
+		type_counts_.fill(0);
+	}
+
+	void RenderCommandList::Draw(RenderEffect const & effect, RenderTechnique const & tech, RenderLayout const & rl)
+	{
+		auto* cmd = static_cast<DrawCommand*>(this->Allocate(CT_Draw, sizeof(DrawCommand)));
+		cmd->effect = &effect;
+		cmd->tech = &tech;
+		cmd->rl = &rl;
+	}
+
+	void RenderCommandList::Dispatch(RenderEffect const & effect, RenderTechnique const & tech,
+		uint32_t tgx, uint32_t tgy, uint32_t tgz)
+	{
+		auto* cmd = static_cast<DispatchCommand*>(this->Allocate(CT_Dispatch, sizeof(DispatchCommand)));
+		cmd->effect = &effect;
+		cmd->tech = &tech;
+		cmd->tgx = tgx;
+		cmd->tgy = tgy;
+		cmd->tgz = tgz;
+	}
+
+	void RenderCommandList::BindFrameBuffer(FrameBufferPtr const & fb)
+	{
+		auto* cmd = static_cast<BindFrameBufferCommand*>(this->Allocate(CT_BindFrameBuffer, sizeof(BindFrameBufferCommand)));
+		cmd->fb_index = static_cast<uint32_t>(frame_buffers_.size());
+		frame_buffers_.push_back(fb);
+	}
+
+	void RenderCommandList::UpdateConstantBuffer(RenderEffectConstantBuffer& cbuff, uint32_t offset, void const * data, uint32_t size)
+	{
+		auto* cmd = static_cast<UpdateConstantBufferCommand*>(this->Allocate(CT_UpdateConstantBuffer,
+			sizeof(UpdateConstantBufferCommand) + size));
+		cmd->cbuff = &cbuff;
+		cmd->offset = offset;
+		cmd->size = size;
+		std::memcpy(cmd + 1, data, size);
+	}
+
+	void RenderCommandList::SetParameter(RenderEffectParameter const & param, float4x4 const & value)
+	{
+		// Matrices are stored transposed, as RenderVariableFloat4x4 does
+		float4x4 const value_t = MathLib::transpose(value);
+		this->SetParameter(param, &value_t, sizeof(value_t));
+	}
+
+	void RenderCommandList::SetParameter(RenderEffectParameter const & param, void const * data, uint32_t size)
+	{
+		BOOST_ASSERT(param.InCBuffer());
+
+		this->UpdateConstantBuffer(param.CBuffer(), param.CBufferOffset(), data, size);
+	}
+
+	RenderCommandList::CommandHeader const * RenderCommandList::FirstCommand() const
+	{
+		return buff_.empty() ? nullptr : reinterpret_cast<CommandHeader const *>(buff_.data());
+	}
+
+	RenderCommandList::CommandHeader const * RenderCommandList::NextCommand(CommandHeader const * cmd) const
+	{
+		uint8_t const * next = reinterpret_cast<uint8_t const *>(cmd) + cmd->size;
+		uint8_t const * end = reinterpret_cast<uint8_t const *>(buff_.data() + buff_.size());
+		return (next < end) ? reinterpret_cast<CommandHeader const *>(next) : nullptr;
+	}
+
+	void* RenderCommandList::Allocate(CommandType type, uint32_t size)
+	{
+		size = AlignCommandSize(size);
+
+		size_t const offset = buff_.size();
+		buff_.resize(offset + size / COMMAND_ALIGNMENT);
+
+		auto* header = reinterpret_cast<CommandHeader*>(&buff_[offset]);
+		header->type = type;
+		header->size = size;
+
+		++ num_commands_;
+		++ type_counts_[type];
+
+		return header;
+	}
+
+
+	void RecordInParallel(ArrayRef<RenderCommandList*> lists,
+		std::function<void(RenderCommandList& cmds, uint32_t index)> const & record)
+	{
+		uint32_t const num_lists = static_cast<uint32_t>(lists.size());
+		for (auto* cmds : lists)
+		{
+			cmds->Reset();
+		}
+
+		parallel_for(Context::Instance().ThreadPool(), num_lists, num_lists,
+			[&lists, &record](uint32_t begin, uint32_t end)
+			{
+				for (uint32_t i = begin; i < end; ++ i)
+				{
+					record(*lists[i], i);
+				}
+			});
+	}
+}
@@ -51,10 +51,12 @@
 #include <KlayGE/ResLoader.hpp>
 #include <KlayGE/Context.hpp>
 #include <KFL/Math.hpp>
+#include <KlayGE/PerfProfiler.hpp>
 #include <KlayGE/RenderFactory.hpp>
 #include <KlayGE/RenderStateObject.hpp>
 #include <KlayGE/RenderView.hpp>
 #include <KlayGE/ShaderObject.hpp>
+#include <KlayGE/StartupManifest.hpp>
 #include <KlayGE/Texture.hpp>
 #include <KFL/XMLDom.hpp>
 #include <KFL/Hash.hpp>
@@ -2513,6 +2515,24 @@ namespace
 		}
 	}
 #endif
+
+	void RecordEffectLoad(ArrayRef<std::string> effect_names)
+	{
+		auto& manifest = Context::Instance().StartupManifestInstance();
+		if (manifest.Recording())
+		{
+			std::string name;
+			for (size_t i = 0; i < effect_names.size(); ++ i)
+			{
+				name += effect_names[i];
+				if (i != effect_names.size() - 1)
+				{
+					name += '|';
+				}
+			}
+			manifest.Record(StartupManifest::AK_Effect, name);
+		}
+	}
 }
 
 namespace KlayGE
@@ -3963,6 +3983,8 @@ namespace KlayGE
 			{
 				annotations_ = parent_tech->annotations_;
 			}
+
+			this->UpdateAutoInstancing();
 		}
 
 		{
@@ -4084,6 +4106,19 @@ namespace KlayGE
 	}
 #endif
 
+	void RenderTechnique::UpdateAutoInstancing()
+	{
+		auto_instancing_ = false;
+		for (uint32_t i = 0; i < this->NumAnnotations(); ++ i)
+		{
+			RenderEffectAnnotation const & annotation = this->Annotation(i);
+			if ((REDT_bool == annotation.Type()) && ("auto_instancing" == annotation.Name()))
+			{
+				annotation.Value(auto_instancing_);
+			}
+		}
+	}
+
 	bool RenderTechnique::StreamIn(RenderEffect& effect, ResIdentifierPtr const & res, uint32_t tech_index)
 	{
 		name_ = ReadShortString(res);
@@ -4103,6 +4138,7 @@ namespace KlayGE
 				annotation->StreamIn(res);
 			}
 		}
+		this->UpdateAutoInstancing();
 
 		uint8_t num_macro;
 		res->read(&num_macro, sizeof(num_macro));
@@ -4974,6 +5010,8 @@ namespace KlayGE
 
 	void RenderPass::Bind(RenderEffect const & effect) const
 	{
+		KLAYGE_PERF_TRACE_SCOPE("Render", "BindPass");
+
 		RenderEngine& render_eng = Context::Instance().RenderFactoryInstance().RenderEngineInstance();
 		render_eng.SetStateObject(render_state_obj_);
 
@@ -6321,22 +6359,26 @@ namespace KlayGE
 
 	RenderEffectPtr SyncLoadRenderEffect(std::string_view effect_name)
 	{
+		Context::Instance().StartupManifestInstance().Record(StartupManifest::AK_Effect, effect_name);
 		return ResLoader::Instance().SyncQueryT<RenderEffect>(MakeSharedPtr<EffectLoadingDesc>(std::string(effect_name)));
 	}
 
 	RenderEffectPtr SyncLoadRenderEffects(ArrayRef<std::string> effect_names)
 	{
+		RecordEffectLoad(effect_names);
 		return ResLoader::Instance().SyncQueryT<RenderEffect>(MakeSharedPtr<EffectLoadingDesc>(effect_names));
 	}
 
 	RenderEffectPtr ASyncLoadRenderEffect(std::string_view effect_name)
 	{
+		Context::Instance().StartupManifestInstance().Record(StartupManifest::AK_Effect, effect_name);
 		// TODO: Make it really async
 		return ResLoader::Instance().SyncQueryT<RenderEffect>(MakeSharedPtr<EffectLoadingDesc>(std::string(effect_name)));
 	}
 
 	RenderEffectPtr ASyncLoadRenderEffects(ArrayRef<std::string> effect_names)
 	{
+		RecordEffectLoad(effect_names);
 		// TODO: Make it really async
 		return ResLoader::Instance().SyncQueryT<RenderEffect>(MakeSharedPtr<EffectLoadingDesc>(effect_names));
 	}
@@ -49,6 +49,7 @@
 #include <KlayGE/ResLoader.hpp>
 #include <KlayGE/RenderFactory.hpp>
 #include <KlayGE/RenderEffect.hpp>
+#include <KlayGE/RenderCommandList.hpp>
 #include <KlayGE/RenderView.hpp>
 #include <KlayGE/PostProcess.hpp>
 #include <KlayGE/HDRPostProcess.hpp>
@@ -57,6 +58,7 @@
 #include <KlayGE/Window.hpp>
 #include <KlayGE/PerfProfiler.hpp>
 
+#include <cstring>
 #include <string>
 
 #include <KlayGE/RenderEngine.hpp>
@@ -68,6 +70,7 @@ namespace KlayGE
 	RenderEngine::RenderEngine()
 		: num_primitives_just_rendered_(0), num_vertices_just_rendered_(0),
 			num_draws_just_called_(0), num_dispatches_just_called_(0),
+			num_draws_queried_(0), num_dispatches_queried_(0), num_draws_traced_(0), num_dispatches_traced_(0),
 			default_fov_(PI / 4), default_render_width_scale_(1), default_render_height_scale_(1),
 			stereo_method_(STM_None), stereo_separation_(0),
 			fb_stage_(0), force_line_mode_(false)
@@ -577,6 +580,53 @@ namespace KlayGE
 		this->DoDispatchIndirect(effect, tech, buff_args, offset);
 	}
 
+	void RenderEngine::Execute(RenderCommandList const & cmds)
+	{
+		this->DoExecute(cmds);
+	}
+
+	void RenderEngine::DoExecute(RenderCommandList const & cmds)
+	{
+		for (auto const * header = cmds.FirstCommand(); header; header = cmds.NextCommand(header))
+		{
+			switch (header->type)
+			{
+			case RenderCommandList::CT_Draw:
+				{
+					auto const * cmd = reinterpret_cast<RenderCommandList::DrawCommand const *>(header);
+					this->Render(*cmd->effect, *cmd->tech, *cmd->rl);
+				}
+				break;
+
+			case RenderCommandList::CT_Dispatch:
+				{
+					auto const * cmd = reinterpret_cast<RenderCommandList::DispatchCommand const *>(header);
+					this->Dispatch(*cmd->effect, *cmd->tech, cmd->tgx, cmd->tgy, cmd->tgz);
+				}
+				break;
+
+			case RenderCommandList::CT_BindFrameBuffer:
+				{
+					auto const * cmd = reinterpret_cast<RenderCommandList::BindFrameBufferCommand const *>(header);
+					this->BindFrameBuffer(cmds.FrameBuffer(cmd->fb_index));
+				}
+				break;
+
+			case RenderCommandList::CT_UpdateConstantBuffer:
+				{
+					// The constant buffer is uploaded when the next draw binds it
+					auto const * cmd = reinterpret_cast<RenderCommandList::UpdateConstantBufferCommand const *>(header);
+					std::memcpy(cmd->cbuff->VariableInBuff<uint8_t>(cmd->offset), cmd + 1, cmd->size);
+					cmd->cbuff->Dirty(true);
+				}
+				break;
+
+			default:
+				KFL_UNREACHABLE("Invalid command type");
+			}
+		}
+	}
+
 	// ϴRender()ȾͼԪ
 	/////////////////////////////////////////////////////////////////////////////////
 	uint32_t RenderEngine::NumPrimitivesJustRendered()
@@ -599,6 +649,7 @@ namespace KlayGE
 	{
 		uint32_t const ret = num_draws_just_called_;
 		num_draws_just_called_ = 0;
+		num_draws_queried_ += ret;
 		return ret;
 	}
 
@@ -606,6 +657,7 @@ namespace KlayGE
 	{
 		uint32_t const ret = num_dispatches_just_called_;
 		num_dispatches_just_called_ = 0;
+		num_dispatches_queried_ += ret;
 		return ret;
 	}
 
@@ -988,6 +1040,13 @@ namespace KlayGE
 			Context::Instance().SceneManagerInstance().Update();
 
 #ifndef KLAYGE_SHIP
+			uint64_t const num_draws = num_draws_queried_ + num_draws_just_called_;
+			uint64_t const num_dispatches = num_dispatches_queried_ + num_dispatches_just_called_;
+			KLAYGE_PERF_TRACE_COUNTER("Render", "Draw calls", num_draws - num_draws_traced_);
+			KLAYGE_PERF_TRACE_COUNTER("Render", "Dispatch calls", num_dispatches - num_dispatches_traced_);
+			num_draws_traced_ = num_draws;
+			num_dispatches_traced_ = num_dispatches;
+
 			PerfProfiler::Instance().CollectData();
 #endif
 		}
@@ -30,9 +30,39 @@
 #include <KlayGE/Camera.hpp>
 #include <KlayGE/RenderMaterial.hpp>
 #include <KlayGE/DeferredRenderingLayer.hpp>
+#include <KlayGE/ElementFormat.hpp>
+#include <KlayGE/GraphicsBuffer.hpp>
+
+#include <algorithm>
+#include <cstring>
 
 #include <KlayGE/Renderable.hpp>
 
+namespace
+{
+	using namespace KlayGE;
+
+	// Copies a range of a buffer to memory, through a CPU readable copy if needed
+	void ReadBackBuffer(GraphicsBuffer& buffer, bool index_buffer, uint32_t offset, uint32_t size, std::vector<uint8_t>& data)
+	{
+		data.resize(size);
+
+		GraphicsBufferPtr buffer_cpu;
+		uint32_t cpu_offset = offset;
+		if (!(buffer.AccessHint() & EAH_CPU_Read))
+		{
+			auto& rf = Context::Instance().RenderFactoryInstance();
+			buffer_cpu = index_buffer ? rf.MakeIndexBuffer(BU_Static, EAH_CPU_Read, size, nullptr)
+				: rf.MakeVertexBuffer(BU_Static, EAH_CPU_Read, size, nullptr);
+			buffer.CopyToSubBuffer(*buffer_cpu, 0, offset, size);
+			cpu_offset = 0;
+		}
+
+		GraphicsBuffer::Mapper mapper(buffer_cpu ? *buffer_cpu : buffer, BA_Read_Only);
+		std::memcpy(data.data(), mapper.Pointer<uint8_t>() + cpu_offset, size);
+	}
+}
+
 namespace KlayGE
 {
 	Renderable::Renderable()
@@ -262,6 +292,10 @@ namespace KlayGE
 				this->OnRenderEnd();
 			}
 		}
+		else if (tech.AutoInstancing())
+		{
+			this->RenderAutoInstanced(effect, tech);
+		}
 		else
 		{
 			if (instances_.empty())
@@ -341,6 +375,282 @@ namespace KlayGE
 		}
 	}
 
+	std::vector<VertexElement> const & Renderable::AutoInstanceFormat()
+	{
+		static std::vector<VertexElement> const format =
+		{
+			VertexElement(VEU_TextureCoord, 5, EF_ABGR32F),
+			VertexElement(VEU_TextureCoord, 6, EF_ABGR32F),
+			VertexElement(VEU_TextureCoord, 7, EF_ABGR32F)
+		};
+		return format;
+	}
+
+	void Renderable::RenderAutoInstanced(RenderEffect const & effect, RenderTechnique const & tech)
+	{
+		RenderEngine& re = Context::Instance().RenderFactoryInstance().RenderEngineInstance();
+
+		// Without scene nodes, the renderable is drawn once with its own model matrix
+		uint32_t const num_instances = std::max(static_cast<uint32_t>(instances_.size()), 1U);
+		uint32_t const num_lods = this->NumLods();
+
+		auto_inst_lods_.resize(num_instances);
+		if (active_lod_ < 0)
+		{
+			auto const & camera = *re.CurFrameBuffer()->GetViewport()->camera;
+			float3 const & eye_pos = camera.EyePos();
+			float const fov_scale = camera.ProjMatrix()(0, 0);
+			for (uint32_t i = 0; i < num_instances; ++ i)
+			{
+				float4x4 const & model = instances_.empty() ? model_mat_ : instances_[i]->TransformToWorld();
+				auto_inst_lods_[i] = MathLib::clamp(static_cast<int32_t>(this->CalcLod(model, eye_pos, fov_scale) + 0.5f),
+					0, static_cast<int32_t>(num_lods - 1));
+			}
+		}
+		else
+		{
+			std::fill(auto_inst_lods_.begin(), auto_inst_lods_.end(), static_cast<uint32_t>(active_lod_));
+		}
+
+		// Groups the instances by LOD, so each LOD is one contiguous range of the instance stream
+		std::vector<uint32_t> lod_starts(num_lods + 1, 0);
+		for (uint32_t i = 0; i < num_instances; ++ i)
+		{
+			++ lod_starts[auto_inst_lods_[i] + 1];
+		}
+		for (uint32_t lod = 0; lod < num_lods; ++ lod)
+		{
+			lod_starts[lod + 1] += lod_starts[lod];
+		}
+
+		std::vector<uint32_t> lod_firsts(lod_starts.begin(), lod_starts.end() - 1);
+		std::vector<SceneNode const *> lod_nodes(num_lods, nullptr);
+		auto_inst_data_.resize(num_instances * 3);
+		for (uint32_t i = 0; i < num_instances; ++ i)
+		{
+			uint32_t const lod = auto_inst_lods_[i];
+			float4x4 const model_t = MathLib::transpose(instances_.empty() ? model_mat_ : instances_[i]->TransformToWorld());
+			float4* dst = &auto_inst_data_[lod_firsts[lod] * 3];
+			dst[0] = model_t.Row(0);
+			dst[1] = model_t.Row(1);
+			dst[2] = model_t.Row(2);
+			++ lod_firsts[lod];
+
+			if (!instances_.empty() && !lod_nodes[lod])
+			{
+				lod_nodes[lod] = instances_[i];
+			}
+		}
+
+		uint32_t const inst_size = static_cast<uint32_t>(auto_inst_data_.size() * sizeof(auto_inst_data_[0]));
+		if (!auto_inst_stream_ || (auto_inst_stream_->Size() < inst_size))
+		{
+			RenderFactory& rf = Context::Instance().RenderFactoryInstance();
+			auto_inst_stream_ = rf.MakeVertexBuffer(BU_Dynamic, EAH_CPU_Write | EAH_GPU_Read, inst_size, nullptr);
+		}
+		{
+			GraphicsBuffer::Mapper mapper(*auto_inst_stream_, BA_Write_Only);
+			std::copy(auto_inst_data_.begin(), auto_inst_data_.end(), mapper.Pointer<float4>());
+		}
+
+		float4x4 const model_mat = model_mat_;
+		SceneNode const * curr_node = curr_node_;
+		model_mat_ = float4x4::Identity();
+		for (uint32_t lod = 0; lod < num_lods; ++ lod)
+		{
+			uint32_t const count = lod_starts[lod + 1] - lod_starts[lod];
+			if (count > 0)
+			{
+				if (lod_nodes[lod])
+				{
+					curr_node_ = lod_nodes[lod];
+				}
+
+				RenderLayout& rl = this->AutoInstanceLayout(lod);
+				rl.NumInstances(count);
+				rl.StartInstanceLocation(lod_starts[lod]);
+
+				this->OnRenderBegin();
+				re.Render(effect, tech, rl);
+				this->OnRenderEnd();
+			}
+		}
+		model_mat_ = model_mat;
+		curr_node_ = curr_node;
+	}
+
+	// A copy of the geometry of a LOD, plus the shared instance stream. Rebuilt when the geometry buffers change, the draw range
+	// follows the source on every call.
+	RenderLayout& Renderable::AutoInstanceLayout(uint32_t lod)
+	{
+		if (auto_inst_rls_.size() < rls_.size())
+		{
+			auto_inst_rls_.resize(rls_.size());
+		}
+
+		RenderLayout const & src = this->GetRenderLayout(lod);
+		RenderLayoutPtr& rl = auto_inst_rls_[lod];
+
+		bool dirty = !rl || (rl->NumVertexStreams() != src.NumVertexStreams())
+			|| (rl->GetIndexStream() != src.GetIndexStream());
+		for (uint32_t i = 0; !dirty && (i < src.NumVertexStreams()); ++ i)
+		{
+			dirty = (rl->GetVertexStream(i) != src.GetVertexStream(i));
+		}
+
+		if (dirty)
+		{
+			RenderFactory& rf = Context::Instance().RenderFactoryInstance();
+			rl = rf.MakeRenderLayout();
+			for (uint32_t i = 0; i < src.NumVertexStreams(); ++ i)
+			{
+				rl->BindVertexStream(src.GetVertexStream(i), src.VertexStreamFormat(i));
+			}
+			if (src.UseIndices())
+			{
+				rl->BindIndexStream(src.GetIndexStream(), src.IndexStreamFormat());
+			}
+		}
+
+		// The setters dirty the layout, only call them on a change
+		if (rl->TopologyType() != src.TopologyType())
+		{
+			rl->TopologyType(src.TopologyType());
+		}
+		if (src.UseIndices())
+		{
+			if (rl->NumIndices() != src.NumIndices())
+			{
+				rl->NumIndices(src.NumIndices());
+			}
+			if (rl->StartIndexLocation() != src.StartIndexLocation())
+			{
+				rl->StartIndexLocation(src.StartIndexLocation());
+			}
+		}
+		if (rl->NumVertices() != src.NumVertices())
+		{
+			rl->NumVertices(src.NumVertices());
+		}
+		if (rl->StartVertexLocation() != src.StartVertexLocation())
+		{
+			rl->StartVertexLocation(src.StartVertexLocation());
+		}
+
+		if (rl->InstanceStream() != auto_inst_stream_)
+		{
+			rl->BindVertexStream(auto_inst_stream_, AutoInstanceFormat(), RenderLayout::ST_Instance, 1);
+			rl->InstanceStream(auto_inst_stream_);
+		}
+
+		return *rl;
+	}
+
+	ArrayRef<float3> Renderable::OccluderPositions()
+	{
+		this->UpdateOccluderGeometry();
+		return occluder_positions_;
+	}
+
+	ArrayRef<uint32_t> Renderable::OccluderIndices()
+	{
+		this->UpdateOccluderGeometry();
+		return occluder_indices_;
+	}
+
+	void Renderable::UpdateOccluderGeometry()
+	{
+		if (occluder_geometry_ready_ || !this->HWResourceReady())
+		{
+			return;
+		}
+		occluder_geometry_ready_ = true;
+
+		RenderLayout const & rl = this->GetRenderLayout(this->NumLods() - 1);
+		if ((rl.TopologyType() != RenderLayout::TT_TriangleList) || !rl.UseIndices() || (0 == rl.NumVertices())
+			|| (0 == rl.NumIndices()))
+		{
+			return;
+		}
+
+		uint32_t pos_stream = rl.NumVertexStreams();
+		uint32_t pos_offset = 0;
+		ElementFormat pos_fmt = EF_Unknown;
+		for (uint32_t i = 0; i < rl.NumVertexStreams(); ++ i)
+		{
+			if (rl.VertexStreamFrequency(i) != 1)
+			{
+				continue;
+			}
+
+			uint32_t offset = 0;
+			for (auto const & ve : rl.VertexStreamFormat(i))
+			{
+				if (VEU_BlendIndex == ve.usage)
+				{
+					// The bind pose isn't where an animated mesh is
+					return;
+				}
+				if ((VEU_Position == ve.usage) && (0 == ve.usage_index))
+				{
+					pos_stream = i;
+					pos_offset = offset;
+					pos_fmt = ve.format;
+				}
+				offset += ve.element_size();
+			}
+		}
+		if (pos_stream == rl.NumVertexStreams())
+		{
+			return;
+		}
+
+		uint32_t const num_vertices = rl.NumVertices();
+		uint32_t const vertex_size = rl.VertexSize(pos_stream);
+		std::vector<uint8_t> vertices;
+		ReadBackBuffer(*rl.GetVertexStream(pos_stream), false, rl.StartVertexLocation() * vertex_size, num_vertices * vertex_size,
+			vertices);
+
+		// Normalized integer positions are relative to the bounding box, as in the vertex shaders
+		bool const normalized = !IsFloatFormat(pos_fmt);
+		float3 const center = this->PosBound().Center();
+		float3 const extent = this->PosBound().HalfSize();
+		occluder_positions_.resize(num_vertices);
+		for (uint32_t i = 0; i < num_vertices; ++ i)
+		{
+			Color clr;
+			ConvertToABGR32F(pos_fmt, &vertices[i * vertex_size + pos_offset], 1, &clr);
+			float3 const pos(clr.r(), clr.g(), clr.b());
+			occluder_positions_[i] = normalized ? center + pos * extent : pos;
+		}
+
+		uint32_t const num_indices = rl.NumIndices();
+		uint32_t const index_size = NumFormatBytes(rl.IndexStreamFormat());
+		std::vector<uint8_t> indices;
+		ReadBackBuffer(*rl.GetIndexStream(), true, rl.StartIndexLocation() * index_size, num_indices * index_size, indices);
+
+		occluder_indices_.resize(num_indices);
+		for (uint32_t i = 0; i < num_indices; ++ i)
+		{
+			if (EF_R16UI == rl.IndexStreamFormat())
+			{
+				uint16_t index;
+				std::memcpy(&index, &indices[i * sizeof(index)], sizeof(index));
+				occluder_indices_[i] = index;
+			}
+			else
+			{
+				std::memcpy(&occluder_indices_[i], &indices[i * sizeof(uint32_t)], sizeof(uint32_t));
+			}
+		}
+		if (*std::max_element(occluder_indices_.begin(), occluder_indices_.end()) >= num_vertices)
+		{
+			// Indices that aren't relative to the start vertex
+			occluder_positions_.clear();
+			occluder_indices_.clear();
+		}
+	}
+
 	void Renderable::ModelMatrix(float4x4 const & mat)
 	{
 		model_mat_ = mat;
@@ -358,7 +668,12 @@ namespace KlayGE
 
 	float Renderable::CalcLod(float3 const & eye_pos, float fov_scale) const
 	{
-		auto const aabb_ws = MathLib::transform_aabb(this->PosBound(), model_mat_);
+		return this->CalcLod(model_mat_, eye_pos, fov_scale);
+	}
+
+	float Renderable::CalcLod(float4x4 const & model, float3 const & eye_pos, float fov_scale) const
+	{
+		auto const aabb_ws = MathLib::transform_aabb(this->PosBound(), model);
 		float3 view_dir = aabb_ws.Center() - eye_pos;
 		float const dist_sq = MathLib::length_sq(view_dir);
 		view_dir *= MathLib::recip_sqrt(dist_sq);
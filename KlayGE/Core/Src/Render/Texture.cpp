@@ -27,15 +27,18 @@
 //////////////////////////////////////////////////////////////////////////////////
 
 #include <KlayGE/KlayGE.hpp>
+#include <KFL/CpuInfo.hpp>
 #include <KFL/CXX17/filesystem.hpp>
 #include <KFL/CXX17/iterator.hpp>
 #include <KFL/ErrorHandling.hpp>
 #include <KFL/Math.hpp>
+#include <KFL/Thread.hpp>
 #include <KlayGE/Context.hpp>
 #include <KlayGE/RenderFactory.hpp>
 #include <KlayGE/RenderEngine.hpp>
 #include <KlayGE/RenderView.hpp>
 #include <KlayGE/ResLoader.hpp>
+#include <KlayGE/StartupManifest.hpp>
 #include <KFL/Util.hpp>
 #include <KlayGE/TexCompressionBC.hpp>
 #include <KlayGE/TexCompressionETC.hpp>
@@ -1633,6 +1636,281 @@ namespace
 		TexDesc tex_desc_;
 		std::mutex main_thread_stage_mutex_;
 	};
+
+
+	// Resizes producing fewer pixels than this run on the calling thread
+	uint32_t const MIN_PARALLEL_RESIZE_PIXELS = 128 * 128;
+
+	float const KAISER_RADIUS = 3;
+	float const KAISER_ALPHA = 4;
+	float const LANCZOS_RADIUS = 3;
+
+	float Sinc(float x)
+	{
+		if (std::abs(x) < 1e-4f)
+		{
+			return 1;
+		}
+		else
+		{
+			float const pi_x = PI * x;
+			return std::sin(pi_x) / pi_x;
+		}
+	}
+
+	// Zeroth order modified Bessel function of the first kind
+	float BesselI0(float x)
+	{
+		float const quarter_x_sq = x * x / 4;
+		float sum = 1;
+		float term = 1;
+		for (int k = 1; k < 32; ++ k)
+		{
+			term *= quarter_x_sq / (k * k);
+			sum += term;
+			if (term < sum * 1e-7f)
+			{
+				break;
+			}
+		}
+		return sum;
+	}
+
+	float FilterRadius(ResizeFilter filter)
+	{
+		switch (filter)
+		{
+		case RF_Box:
+			return 0.5f;
+
+		case RF_Kaiser:
+			return KAISER_RADIUS;
+
+		case RF_Lanczos:
+			return LANCZOS_RADIUS;
+
+		default:
+			KFL_UNREACHABLE("Invalid resize filter");
+		}
+	}
+
+	float FilterWeight(ResizeFilter filter, float x)
+	{
+		switch (filter)
+		{
+		case RF_Box:
+			return ((x >= -0.5f) && (x < 0.5f)) ? 1.0f : 0.0f;
+
+		case RF_Kaiser:
+			if (std::abs(x) < KAISER_RADIUS)
+			{
+				float const t = x / KAISER_RADIUS;
+				return Sinc(x) * BesselI0(KAISER_ALPHA * std::sqrt(1 - t * t)) / BesselI0(KAISER_ALPHA);
+			}
+			else
+			{
+				return 0;
+			}
+
+		case RF_Lanczos:
+			if (std::abs(x) < LANCZOS_RADIUS)
+			{
+				return Sinc(x) * Sinc(x / LANCZOS_RADIUS);
+			}
+			else
+			{
+				return 0;
+			}
+
+		default:
+			KFL_UNREACHABLE("Invalid resize filter");
+		}
+	}
+
+	// Source pixels and weights contributing to each destination pixel along one axis. All destination pixels have the same
+	// number of taps, the unused ones have zero weights.
+	struct ResampleAxis
+	{
+		uint32_t num_taps;
+		std::vector<uint32_t> indices;
+		std::vector<float> weights;
+
+		void Init(ResizeFilter filter, uint32_t src_size, uint32_t dst_size)
+		{
+			switch (filter)
+			{
+			case RF_Point:
+				num_taps = 1;
+				indices.resize(dst_size);
+				weights.assign(dst_size, 1.0f);
+				for (uint32_t x = 0; x < dst_size; ++ x)
+				{
+					float const fx = static_cast<float>(x + 0.5f) / dst_size * src_size;
+					indices[x] = std::min(static_cast<uint32_t>(fx), src_size - 1);
+				}
+				break;
+
+			case RF_Linear:
+				// Same taps as the original 2-tap bilinear resize
+				num_taps = 2;
+				indices.resize(dst_size * num_taps);
+				weights.resize(dst_size * num_taps);
+				for (uint32_t x = 0; x < dst_size; ++ x)
+				{
+					float const fx = static_cast<float>(x + 0.5f) / dst_size * src_size;
+					uint32_t const sx0 = static_cast<uint32_t>(std::max(fx - 0.5f, 0.0f));
+					float const weight = fx - sx0 - 0.5f;
+					indices[x * 2 + 0] = sx0;
+					indices[x * 2 + 1] = std::min(sx0 + 1, src_size - 1);
+					weights[x * 2 + 0] = 1 - weight;
+					weights[x * 2 + 1] = weight;
+				}
+				break;
+
+			default:
+				{
+					float const scale = static_cast<float>(src_size) / dst_size;
+					float const filter_scale = std::max(scale, 1.0f);
+					float const support = FilterRadius(filter) * filter_scale;
+					int32_t const last = static_cast<int32_t>(src_size - 1);
+
+					num_taps = static_cast<uint32_t>(support * 2) + 1;
+					indices.resize(dst_size * num_taps);
+					weights.resize(dst_size * num_taps);
+					for (uint32_t x = 0; x < dst_size; ++ x)
+					{
+						uint32_t* tap_indices = &indices[x * num_taps];
+						float* tap_weights = &weights[x * num_taps];
+
+						float const center = (x + 0.5f) * scale;
+						int32_t const first = static_cast<int32_t>(std::ceil(center - support - 0.5f));
+						float sum = 0;
+						for (uint32_t t = 0; t < num_taps; ++ t)
+						{
+							int32_t const sx = first + static_cast<int32_t>(t);
+							tap_indices[t] = MathLib::clamp(sx, 0, last);
+							tap_weights[t] = FilterWeight(filter, (sx + 0.5f - center) / filter_scale);
+							sum += tap_weights[t];
+						}
+
+						if (std::abs(sum) > 1e-6f)
+						{
+							for (uint32_t t = 0; t < num_taps; ++ t)
+							{
+								tap_weights[t] /= sum;
+							}
+						}
+						else
+						{
+							std::fill(tap_weights, tap_weights + num_taps, 0.0f);
+							tap_indices[0] = MathLib::clamp(static_cast<int32_t>(center), 0, last);
+							tap_weights[0] = 1;
+						}
+					}
+				}
+				break;
+			}
+		}
+	};
+
+	// Separable resampling between two uncompressed images. Destination rows are split into bands over the thread pool. A band
+	// only keeps a ring of horizontally filtered source rows in float, never a whole image. Filtering happens on the values
+	// returned by ConvertToABGR32F, which are linear for sRGB formats.
+	void ResampleImage(uint8_t* dst_data, uint32_t dst_row_pitch, uint32_t dst_slice_pitch, ElementFormat dst_format,
+		uint32_t dst_width, uint32_t dst_height, uint32_t dst_depth,
+		uint8_t const * src_data, uint32_t src_row_pitch, uint32_t src_slice_pitch, ElementFormat src_format,
+		uint32_t src_width, uint32_t src_height, uint32_t src_depth,
+		ResizeFilter filter)
+	{
+		KLAYGE_STATIC_ASSERT(sizeof(Color) == sizeof(float4));
+
+		ResampleAxis axis_x;
+		ResampleAxis axis_y;
+		ResampleAxis axis_z;
+		axis_x.Init(filter, src_width, dst_width);
+		axis_y.Init(filter, src_height, dst_height);
+		axis_z.Init(filter, src_depth, dst_depth);
+
+		uint32_t const num_cached_rows = axis_y.num_taps * axis_z.num_taps * 2;
+
+		uint32_t num_jobs = 1;
+		if (dst_width * dst_height * dst_depth >= MIN_PARALLEL_RESIZE_PIXELS)
+		{
+			CPUInfo cpu;
+			num_jobs = static_cast<uint32_t>(cpu.NumHWThreads());
+		}
+
+		parallel_for(Context::Instance().ThreadPool(), dst_height * dst_depth, num_jobs, [&](uint32_t begin, uint32_t end)
+			{
+				std::vector<float4> src_row(src_width);
+				std::vector<float4> cached_rows(num_cached_rows * dst_width);
+				std::vector<uint32_t> cached_row_ids(num_cached_rows, 0xFFFFFFFFU);
+				std::vector<float4> dst_row(dst_width);
+
+				auto filtered_row = [&](uint32_t sz, uint32_t sy)
+				{
+					uint32_t const row_id = sz * src_height + sy;
+					uint32_t const slot = row_id % num_cached_rows;
+					float4* row = &cached_rows[slot * dst_width];
+					if (cached_row_ids[slot] != row_id)
+					{
+						ConvertToABGR32F(src_format, src_data + sz * src_slice_pitch + sy * src_row_pitch, src_width,
+							reinterpret_cast<Color*>(src_row.data()));
+
+						for (uint32_t x = 0; x < dst_width; ++ x)
+						{
+							uint32_t const * tap_indices = &axis_x.indices[x * axis_x.num_taps];
+							float const * tap_weights = &axis_x.weights[x * axis_x.num_taps];
+
+							float4 sum(0, 0, 0, 0);
+							for (uint32_t t = 0; t < axis_x.num_taps; ++ t)
+							{
+								sum += src_row[tap_indices[t]] * tap_weights[t];
+							}
+							row[x] = sum;
+						}
+
+						cached_row_ids[slot] = row_id;
+					}
+					return row;
+				};
+
+				for (uint32_t i = begin; i < end; ++ i)
+				{
+					uint32_t const z = i / dst_height;
+					uint32_t const y = i - z * dst_height;
+
+					std::fill(dst_row.begin(), dst_row.end(), float4(0, 0, 0, 0));
+					for (uint32_t tz = 0; tz < axis_z.num_taps; ++ tz)
+					{
+						float const weight_z = axis_z.weights[z * axis_z.num_taps + tz];
+						if (weight_z == 0)
+						{
+							continue;
+						}
+
+						uint32_t const sz = axis_z.indices[z * axis_z.num_taps + tz];
+						for (uint32_t ty = 0; ty < axis_y.num_taps; ++ ty)
+						{
+							float const weight = weight_z * axis_y.weights[y * axis_y.num_taps + ty];
+							if (weight == 0)
+							{
+								continue;
+							}
+
+							float4 const * row = filtered_row(sz, axis_y.indices[y * axis_y.num_taps + ty]);
+							for (uint32_t x = 0; x < dst_width; ++ x)
+							{
+								dst_row[x] += row[x] * weight;
+							}
+						}
+					}
+
+					ConvertFromABGR32F(dst_format, reinterpret_cast<Color const *>(dst_row.data()), dst_width,
+						dst_data + z * dst_slice_pitch + y * dst_row_pitch);
+				}
+			});
+	}
 }
 
 namespace KlayGE
@@ -2352,11 +2630,13 @@ namespace KlayGE
 
 	TexturePtr SyncLoadTexture(std::string_view tex_name, uint32_t access_hint)
 	{
+		Context::Instance().StartupManifestInstance().Record(StartupManifest::AK_Texture, tex_name, access_hint);
 		return ResLoader::Instance().SyncQueryT<Texture>(MakeSharedPtr<TextureLoadingDesc>(tex_name, access_hint));
 	}
 
 	TexturePtr ASyncLoadTexture(std::string_view tex_name, uint32_t access_hint)
 	{
+		Context::Instance().StartupManifestInstance().Record(StartupManifest::AK_Texture, tex_name, access_hint);
 		return ResLoader::Instance().ASyncQueryT<Texture>(MakeSharedPtr<TextureLoadingDesc>(tex_name, access_hint));
 	}
 
@@ -3491,6 +3771,19 @@ namespace KlayGE
 		void const * src_data, uint32_t src_row_pitch, uint32_t src_slice_pitch, ElementFormat src_format,
 		uint32_t src_width, uint32_t src_height, uint32_t src_depth,
 		bool linear)
+	{
+		ResizeTexture(dst_data, dst_row_pitch, dst_slice_pitch, dst_format,
+			dst_width, dst_height, dst_depth,
+			src_data, src_row_pitch, src_slice_pitch, src_format,
+			src_width, src_height, src_depth,
+			linear ? RF_Linear : RF_Point);
+	}
+
+	void ResizeTexture(void* dst_data, uint32_t dst_row_pitch, uint32_t dst_slice_pitch, ElementFormat dst_format,
+		uint32_t dst_width, uint32_t dst_height, uint32_t dst_depth,
+		void const * src_data, uint32_t src_row_pitch, uint32_t src_slice_pitch, ElementFormat src_format,
+		uint32_t src_width, uint32_t src_height, uint32_t src_depth,
+		ResizeFilter filter)
 	{
 		std::vector<uint8_t> src_cpu_data_block;
 		void* src_cpu_data;
@@ -3577,7 +3870,7 @@ namespace KlayGE
 				KFL_UNREACHABLE("Invalid destination format");
 			}
 
-			dst_cpu_row_pitch = dst_width * NumFormatBytes(src_cpu_format);
+			dst_cpu_row_pitch = dst_width * NumFormatBytes(dst_cpu_format);
 			dst_cpu_slice_pitch = dst_cpu_row_pitch * dst_height;
 			dst_cpu_data_block.resize(dst_depth * dst_cpu_slice_pitch);
 			dst_cpu_data = &dst_cpu_data_block[0];
@@ -3595,7 +3888,7 @@ namespace KlayGE
 		uint32_t const src_elem_size = NumFormatBytes(src_cpu_format);
 		uint32_t const dst_elem_size = NumFormatBytes(dst_cpu_format);
 
-		if ((!linear || ((src_width == dst_width) && (src_height == dst_height) && (src_depth == dst_depth)))
+		if (((RF_Point == filter) || ((src_width == dst_width) && (src_height == dst_height) && (src_depth == dst_depth)))
 			&& (src_cpu_format == dst_cpu_format))
 		{
 			for (uint32_t z = 0; z < dst_depth; ++ z)
@@ -3627,90 +3920,23 @@ namespace KlayGE
 				}
 			}
 		}
-		else
+		else if ((src_width == dst_width) && (src_height == dst_height) && (src_depth == dst_depth))
 		{
-			std::vector<Color> src_32f(src_width * src_height * src_depth);
-			{
-				for (uint32_t z = 0; z < src_depth; ++ z)
-				{
-					for (uint32_t y = 0; y < src_height; ++ y)
-					{
-						ConvertToABGR32F(src_cpu_format, src_ptr + z * src_cpu_slice_pitch + y * src_cpu_row_pitch,
-							src_width, &src_32f[(z * src_height + y) * src_width]);
-					}
-				}
-			}
-
-			std::vector<Color> dst_32f(dst_width * dst_height * dst_depth);
-			if (linear)
-			{
-				for (uint32_t z = 0; z < dst_depth; ++ z)
-				{
-					float fz = static_cast<float>(z + 0.5f) / dst_depth * src_depth;
-					uint32_t sz0 = static_cast<uint32_t>(fz - 0.5f);
-					uint32_t sz1 = MathLib::clamp<uint32_t>(sz0 + 1, 0, src_depth - 1);
-					float weight_z = fz - sz0 - 0.5f;
-							
-					for (uint32_t y = 0; y < dst_height; ++ y)
-					{
-						float fy = static_cast<float>(y + 0.5f) / dst_height * src_height;
-						uint32_t sy0 = static_cast<uint32_t>(fy - 0.5f);
-						uint32_t sy1 = MathLib::clamp<uint32_t>(sy0 + 1, 0, src_height - 1);
-						float weight_y = fy - sy0 - 0.5f;
-							
-						for (uint32_t x = 0; x < dst_width; ++ x)
-						{
-							float fx = static_cast<float>(x + 0.5f) / dst_width * src_width;
-							uint32_t sx0 = static_cast<uint32_t>(fx - 0.5f);
-							uint32_t sx1 = MathLib::clamp<uint32_t>(sx0 + 1, 0, src_width - 1);
-							float weight_x = fx - sx0 - 0.5f;
-							Color clr_x00 = MathLib::lerp(src_32f[(sz0 * src_height + sy0) * src_width + sx0],
-								src_32f[(sz0 * src_height + sy0) * src_width + sx1], weight_x);
-							Color clr_x01 = MathLib::lerp(src_32f[(sz0 * src_height + sy1) * src_width + sx0],
-								src_32f[(sz0 * src_height + sy1) * src_width + sx1], weight_x);
-							Color clr_y0 = MathLib::lerp(clr_x00, clr_x01, weight_y);
-							Color clr_x10 = MathLib::lerp(src_32f[(sz1 * src_height + sy0) * src_width + sx0],
-								src_32f[(sz1 * src_height + sy0) * src_width + sx1], weight_x);
-							Color clr_x11 = MathLib::lerp(src_32f[(sz1 * src_height + sy1) * src_width + sx0],
-								src_32f[(sz1 * src_height + sy1) * src_width + sx1], weight_x);
-							Color clr_y1 = MathLib::lerp(clr_x10, clr_x11, weight_y);
-							dst_32f[(z * dst_height + y) * dst_width + x] = MathLib::lerp(clr_y0, clr_y1, weight_z);
-						}
-					}
-				}
-			}
-			else
-			{
-				for (uint32_t z = 0; z < dst_depth; ++ z)
-				{
-					float fz = static_cast<float>(z + 0.5f) / dst_depth * src_depth;
-					uint32_t sz = std::min(static_cast<uint32_t>(fz), src_depth - 1);
-
-					for (uint32_t y = 0; y < dst_height; ++ y)
-					{
-						float fy = static_cast<float>(y + 0.5f) / dst_height * src_height;
-						uint32_t sy = std::min(static_cast<uint32_t>(fy), src_height - 1);
-
-						for (uint32_t x = 0; x < dst_width; ++ x)
-						{
-							float fx = static_cast<float>(x + 0.5f) / dst_width * src_width;
-							uint32_t sx = std::min(static_cast<uint32_t>(fx), src_width - 1);
-							dst_32f[(z * dst_height + y) * dst_width + x] = src_32f[(sz * src_height + sy) * src_width + sx];
-						}
-					}
-				}
-			}
-
+			for (uint32_t z = 0; z < dst_depth; ++ z)
 			{
-				for (uint32_t z = 0; z < dst_depth; ++ z)
+				for (uint32_t y = 0; y < dst_height; ++ y)
 				{
-					for (uint32_t y = 0; y < dst_height; ++ y)
-					{
-						ConvertFromABGR32F(dst_cpu_format, &dst_32f[(z * dst_height + y) * dst_width], dst_width, dst_ptr + z * dst_cpu_slice_pitch + y * dst_cpu_row_pitch);
-					}
+					ConvertFormat(dst_cpu_format, dst_ptr + z * dst_cpu_slice_pitch + y * dst_cpu_row_pitch,
+						src_cpu_format, src_ptr + z * src_cpu_slice_pitch + y * src_cpu_row_pitch, dst_width);
 				}
 			}
 		}
+		else
+		{
+			ResampleImage(dst_ptr, dst_cpu_row_pitch, dst_cpu_slice_pitch, dst_cpu_format, dst_width, dst_height, dst_depth,
+				src_ptr, src_cpu_row_pitch, src_cpu_slice_pitch, src_cpu_format, src_width, src_height, src_depth,
+				filter);
+		}
 
 		if (IsCompressedFormat(dst_format))
 		{
@@ -3720,6 +3946,63 @@ namespace KlayGE
 		}
 	}
 
+	void BuildMipChain(ArrayRef<ElementInitData> levels, ElementFormat format,
+		uint32_t width, uint32_t height, uint32_t depth, ResizeFilter filter)
+	{
+		uint32_t const num_levels = static_cast<uint32_t>(levels.size());
+		if (IsCompressedFormat(format))
+		{
+			// Decoding only the top level keeps the compression error from accumulating down the chain
+			std::vector<uint8_t> src_cpu_data_block;
+			uint32_t src_cpu_row_pitch;
+			uint32_t src_cpu_slice_pitch;
+			ElementFormat cpu_format;
+			DecodeTexture(src_cpu_data_block, src_cpu_row_pitch, src_cpu_slice_pitch, cpu_format,
+				levels[0].data, levels[0].row_pitch, levels[0].slice_pitch, format, width, height, depth);
+
+			std::vector<uint8_t> dst_cpu_data_block;
+			for (uint32_t level = 1; level < num_levels; ++ level)
+			{
+				uint32_t const src_width = std::max<uint32_t>(1U, width >> (level - 1));
+				uint32_t const src_height = std::max<uint32_t>(1U, height >> (level - 1));
+				uint32_t const src_depth = std::max<uint32_t>(1U, depth >> (level - 1));
+				uint32_t const dst_width = std::max<uint32_t>(1U, width >> level);
+				uint32_t const dst_height = std::max<uint32_t>(1U, height >> level);
+				uint32_t const dst_depth = std::max<uint32_t>(1U, depth >> level);
+
+				uint32_t const dst_cpu_row_pitch = dst_width * NumFormatBytes(cpu_format);
+				uint32_t const dst_cpu_slice_pitch = dst_cpu_row_pitch * dst_height;
+				dst_cpu_data_block.resize(dst_cpu_slice_pitch * dst_depth);
+
+				ResizeTexture(dst_cpu_data_block.data(), dst_cpu_row_pitch, dst_cpu_slice_pitch, cpu_format,
+					dst_width, dst_height, dst_depth,
+					src_cpu_data_block.data(), src_cpu_row_pitch, src_cpu_slice_pitch, cpu_format,
+					src_width, src_height, src_depth,
+					filter);
+				EncodeTexture(const_cast<void*>(levels[level].data), levels[level].row_pitch, levels[level].slice_pitch, format,
+					dst_cpu_data_block.data(), dst_cpu_row_pitch, dst_cpu_slice_pitch, cpu_format,
+					dst_width, dst_height, dst_depth);
+
+				src_cpu_data_block.swap(dst_cpu_data_block);
+				src_cpu_row_pitch = dst_cpu_row_pitch;
+				src_cpu_slice_pitch = dst_cpu_slice_pitch;
+			}
+		}
+		else
+		{
+			for (uint32_t level = 1; level < num_levels; ++ level)
+			{
+				ResizeTexture(const_cast<void*>(levels[level].data), levels[level].row_pitch, levels[level].slice_pitch, format,
+					std::max<uint32_t>(1U, width >> level), std::max<uint32_t>(1U, height >> level),
+					std::max<uint32_t>(1U, depth >> level),
+					levels[level - 1].data, levels[level - 1].row_pitch, levels[level - 1].slice_pitch, format,
+					std::max<uint32_t>(1U, width >> (level - 1)), std::max<uint32_t>(1U, height >> (level - 1)),
+					std::max<uint32_t>(1U, depth >> (level - 1)),
+					filter);
+			}
+		}
+	}
+
 
 	template KLAYGE_CORE_API std::pair<float3, float3> CubeMapViewVector(Texture::CubeFaces face);
 
@@ -4051,38 +4334,11 @@ namespace KlayGE
 
 	void SoftwareTexture::BuildMipSubLevels()
 	{
-		for (uint32_t index = 0; index < this->ArraySize(); ++ index)
+		uint32_t const num_faces = (type_ == TT_Cube) ? 6 : 1;
+		for (uint32_t index = 0; index < array_size_ * num_faces; ++ index)
 		{
-			for (uint32_t level = 1; level < this->NumMipMaps(); ++ level)
-			{
-				switch (type_)
-				{
-				case TT_1D:
-					this->CopyToSubTexture1D(*this, index, level, 0, this->Width(level),
-						index, level - 1, 0, this->Width(level - 1));
-					break;
-
-				case TT_2D:
-					this->CopyToSubTexture2D(*this, index, level, 0, 0, this->Width(level), this->Height(level),
-						index, level - 1, 0, 0, this->Width(level - 1), this->Height(level - 1));
-					break;
-
-				case TT_3D:
-					this->CopyToSubTexture3D(*this, index, level, 0, 0, 0, this->Width(level), this->Height(level), this->Depth(level),
-						index, level - 1, 0, 0, 0, this->Width(level - 1), this->Height(level - 1), this->Depth(level - 1));
-					break;
-
-				case TT_Cube:
-					for (uint32_t face = 0; face < 6; ++ face)
-					{
-						this->CopyToSubTextureCube(*this, index, static_cast<CubeFaces>(face), level, 0, 0,
-							this->Width(level), this->Height(level),
-							index, static_cast<CubeFaces>(face), level - 1, 0, 0,
-							this->Width(level - 1), this->Height(level - 1));
-					}
-					break;
-				}
-			}
+			BuildMipChain(MakeArrayRef(&subres_data_[index * num_mip_maps_], num_mip_maps_), format_,
+				this->Width(0), this->Height(0), this->Depth(0), RF_Box);
 		}
 	}
 
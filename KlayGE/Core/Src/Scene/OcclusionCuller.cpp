@@ -0,0 +1,437 @@
+/**
+ * @file OcclusionCuller.cpp
+ * @author Minmin Gong
+ *
+ * @section DESCRIPTION
+ *
+ * This source file is part of KlayGE
+ * For the latest info, see http://www.klayge.org
+ *
+ * @section LICENSE
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * You may alternatively use this source under the terms of
+ * the KlayGE Proprietary License (KPL). You can obtained such a license
+ * from http://www.klayge.org/licensing/.
+ */
+
+#include <KlayGE/KlayGE.hpp>
+#include <KFL/CpuInfo.hpp>
+#include <KFL/Thread.hpp>
+#include <KlayGE/Context.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+#include <boost/assert.hpp>
+
+#if defined(KLAYGE_SSE2_SUPPORT)
+#include <emmintrin.h>
+#endif
+
+#include <KlayGE/OcclusionCuller.hpp>
+
+namespace
+{
+	using namespace KlayGE;
+
+	uint32_t constexpr MIN_PARALLEL_TRIANGLES = 64;
+	uint32_t constexpr MIN_PARALLEL_BOXES = 256;
+	float constexpr MIN_W = 1e-6f;
+
+	float4 TransformPoint(float3 const & p, float4x4 const & mat)
+	{
+		return mat.Row(0) * p.x() + mat.Row(1) * p.y() + mat.Row(2) * p.z() + mat.Row(3);
+	}
+}
+
+namespace KlayGE
+{
+	OcclusionCuller::OcclusionCuller(uint32_t width, uint32_t height)
+		: view_proj_(float4x4::Identity()),
+			num_tested_(0), num_occluded_(0)
+	{
+		BOOST_ASSERT((width > 0) && (height > 0));
+
+		tiles_x_ = (width + TILE_SIZE - 1) / TILE_SIZE;
+		tiles_y_ = (height + TILE_SIZE - 1) / TILE_SIZE;
+		width_ = tiles_x_ * TILE_SIZE;
+		height_ = tiles_y_ * TILE_SIZE;
+
+		depth_.assign(width_ * height_, 1.0f);
+		tile_max_depth_.assign(tiles_x_ * tiles_y_, 1.0f);
+
+		CPUInfo cpu;
+		num_hw_threads_ = static_cast<uint32_t>(cpu.NumHWThreads());
+	}
+
+	void OcclusionCuller::BeginFrame(float4x4 const & view_proj)
+	{
+		view_proj_ = view_proj;
+		triangles_.clear();
+		num_tested_ = 0;
+		num_occluded_ = 0;
+		std::fill(depth_.begin(), depth_.end(), 1.0f);
+		std::fill(tile_max_depth_.begin(), tile_max_depth_.end(), 1.0f);
+	}
+
+	void OcclusionCuller::AddOccluder(ArrayRef<float3> positions, ArrayRef<uint32_t> indices, float4x4 const & model)
+	{
+		BOOST_ASSERT(indices.size() % 3 == 0);
+
+		float4x4 const mvp = model * view_proj_;
+		for (size_t i = 0; i < indices.size(); i += 3)
+		{
+			this->AddClipTriangle(TransformPoint(positions[indices[i + 0]], mvp),
+				TransformPoint(positions[indices[i + 1]], mvp),
+				TransformPoint(positions[indices[i + 2]], mvp));
+		}
+	}
+
+	void OcclusionCuller::AddOccluder(AABBox const & aabb, float4x4 const & model)
+	{
+		static uint32_t const box_indices[] =
+		{
+			0, 2, 3, 3, 1, 0,
+			5, 7, 6, 6, 4, 5,
+			4, 0, 1, 1, 5, 4,
+			4, 6, 2, 2, 0, 4,
+			2, 6, 7, 7, 3, 2,
+			1, 3, 7, 7, 5, 1
+		};
+
+		float3 corners[8];
+		for (uint32_t i = 0; i < 8; ++ i)
+		{
+			corners[i] = aabb.Corner(i);
+		}
+		this->AddOccluder(corners, box_indices, model);
+	}
+
+	// Clips against the near plane z >= 0, and keeps the triangles that touch the screen
+	void OcclusionCuller::AddClipTriangle(float4 const & c0, float4 const & c1, float4 const & c2)
+	{
+		float4 const in[] = { c0, c1, c2 };
+		float4 clipped[4];
+		uint32_t num_clipped = 0;
+		for (uint32_t i = 0; i < 3; ++ i)
+		{
+			float4 const & a = in[i];
+			float4 const & b = in[(i + 1) % 3];
+			bool const a_in = (a.z() >= 0) && (a.w() > MIN_W);
+			bool const b_in = (b.z() >= 0) && (b.w() > MIN_W);
+			if (a_in)
+			{
+				clipped[num_clipped] = a;
+				++ num_clipped;
+			}
+			if (a_in != b_in)
+			{
+				float const t = a.z() / (a.z() - b.z());
+				float4 p = MathLib::lerp(a, b, t);
+				p.w() = std::max(p.w(), MIN_W);
+				clipped[num_clipped] = p;
+				++ num_clipped;
+			}
+		}
+		if (num_clipped < 3)
+		{
+			return;
+		}
+
+		float3 screen[4];
+		for (uint32_t i = 0; i < num_clipped; ++ i)
+		{
+			screen[i] = this->ToScreen(clipped[i]);
+		}
+		for (uint32_t i = 1; i + 1 < num_clipped; ++ i)
+		{
+			float const min_x = std::min(std::min(screen[0].x(), screen[i].x()), screen[i + 1].x());
+			float const max_x = std::max(std::max(screen[0].x(), screen[i].x()), screen[i + 1].x());
+			float const min_y = std::min(std::min(screen[0].y(), screen[i].y()), screen[i + 1].y());
+			float const max_y = std::max(std::max(screen[0].y(), screen[i].y()), screen[i + 1].y());
+			if ((max_x >= 0) && (min_x <= width_) && (max_y >= 0) && (min_y <= height_))
+			{
+				Triangle tri;
+				tri.v[0] = screen[0];
+				tri.v[1] = screen[i];
+				tri.v[2] = screen[i + 1];
+				triangles_.push_back(tri);
+			}
+		}
+	}
+
+	float3 OcclusionCuller::ToScreen(float4 const & clip) const
+	{
+		float const inv_w = 1 / clip.w();
+		return float3((clip.x() * inv_w * 0.5f + 0.5f) * width_, (0.5f - clip.y() * inv_w * 0.5f) * height_, clip.z() * inv_w);
+	}
+
+	void OcclusionCuller::Rasterize()
+	{
+		// Each job owns whole rows of tiles, so the jobs write disjoint parts of the buffers
+		parallel_for(Context::Instance().ThreadPool(), tiles_y_,
+			(triangles_.size() >= MIN_PARALLEL_TRIANGLES) ? num_hw_threads_ : 1,
+			[this](uint32_t begin, uint32_t end)
+			{
+				this->RasterizeBand(begin, end);
+			});
+	}
+
+	void OcclusionCuller::RasterizeBand(uint32_t tile_row_begin, uint32_t tile_row_end)
+	{
+		uint32_t const row_begin = tile_row_begin * TILE_SIZE;
+		uint32_t const row_end = tile_row_end * TILE_SIZE;
+		for (auto const & tri : triangles_)
+		{
+			this->RasterizeTriangle(tri, row_begin, row_end);
+		}
+
+		for (uint32_t ty = tile_row_begin; ty < tile_row_end; ++ ty)
+		{
+			for (uint32_t tx = 0; tx < tiles_x_; ++ tx)
+			{
+				float max_depth = 0;
+				for (uint32_t y = 0; y < TILE_SIZE; ++ y)
+				{
+					float const * row = &depth_[(ty * TILE_SIZE + y) * width_ + tx * TILE_SIZE];
+					for (uint32_t x = 0; x < TILE_SIZE; ++ x)
+					{
+						max_depth = std::max(max_depth, row[x]);
+					}
+				}
+				tile_max_depth_[ty * tiles_x_ + tx] = max_depth;
+			}
+		}
+	}
+
+	// Pixels are covered if their centers are inside. The depth is interpolated linearly, as z/w is affine in screen space.
+	void OcclusionCuller::RasterizeTriangle(Triangle const & tri, uint32_t row_begin, uint32_t row_end)
+	{
+		float3 v0 = tri.v[0];
+		float3 v1 = tri.v[1];
+		float3 v2 = tri.v[2];
+
+		float area = (v1.x() - v0.x()) * (v2.y() - v0.y()) - (v1.y() - v0.y()) * (v2.x() - v0.x());
+		if (area < 0)
+		{
+			std::swap(v1, v2);
+			area = -area;
+		}
+		if (!(area > 1e-8f))
+		{
+			return;
+		}
+
+		float const min_x = std::min(std::min(v0.x(), v1.x()), v2.x());
+		float const max_x = std::max(std::max(v0.x(), v1.x()), v2.x());
+		float const min_y = std::min(std::min(v0.y(), v1.y()), v2.y());
+		float const max_y = std::max(std::max(v0.y(), v1.y()), v2.y());
+
+		int32_t const x_begin = std::max(static_cast<int32_t>(std::ceil(min_x - 0.5f)), 0);
+		int32_t const x_end = std::min(static_cast<int32_t>(std::floor(max_x - 0.5f)) + 1, static_cast<int32_t>(width_));
+		int32_t const y_begin = std::max(static_cast<int32_t>(std::ceil(min_y - 0.5f)), static_cast<int32_t>(row_begin));
+		int32_t const y_end = std::min(static_cast<int32_t>(std::floor(max_y - 0.5f)) + 1, static_cast<int32_t>(row_end));
+		if ((x_begin >= x_end) || (y_begin >= y_end))
+		{
+			return;
+		}
+
+		// Edge functions of v0->v1, v1->v2, v2->v0, positive inside
+		float3 const* verts[] = { &v0, &v1, &v2 };
+		float edge_dx[3];
+		float edge_dy[3];
+		float edge_origin[3];
+		float const px = x_begin + 0.5f;
+		for (uint32_t i = 0; i < 3; ++ i)
+		{
+			float3 const & a = *verts[i];
+			float3 const & b = *verts[(i + 1) % 3];
+			edge_dx[i] = a.y() - b.y();
+			edge_dy[i] = b.x() - a.x();
+			edge_origin[i] = (b.x() - a.x()) * (y_begin + 0.5f - a.y()) - (b.y() - a.y()) * (px - a.x());
+		}
+
+		float const inv_area = 1 / area;
+		float const dz1 = v1.z() - v0.z();
+		float const dz2 = v2.z() - v0.z();
+		float const z_dx = (dz1 * (v2.y() - v0.y()) - dz2 * (v1.y() - v0.y())) * inv_area;
+		float const z_dy = (dz2 * (v1.x() - v0.x()) - dz1 * (v2.x() - v0.x())) * inv_area;
+		float const z_origin = v0.z() + z_dx * (px - v0.x()) + z_dy * (y_begin + 0.5f - v0.y());
+
+#if defined(KLAYGE_SSE2_SUPPORT)
+		__m128 const ramp = _mm_set_ps(3, 2, 1, 0);
+		__m128 const zero = _mm_setzero_ps();
+		__m128 const e0_step = _mm_set1_ps(edge_dx[0] * 4);
+		__m128 const e1_step = _mm_set1_ps(edge_dx[1] * 4);
+		__m128 const e2_step = _mm_set1_ps(edge_dx[2] * 4);
+		__m128 const z_step = _mm_set1_ps(z_dx * 4);
+#endif
+
+		for (int32_t y = y_begin; y < y_end; ++ y)
+		{
+			float const dy = static_cast<float>(y - y_begin);
+			float const e0_row = edge_origin[0] + edge_dy[0] * dy;
+			float const e1_row = edge_origin[1] + edge_dy[1] * dy;
+			float const e2_row = edge_origin[2] + edge_dy[2] * dy;
+			float const z_row = z_origin + z_dy * dy;
+			float* row = &depth_[y * width_];
+
+			int32_t x = x_begin;
+#if defined(KLAYGE_SSE2_SUPPORT)
+			__m128 e0 = _mm_add_ps(_mm_set1_ps(e0_row), _mm_mul_ps(ramp, _mm_set1_ps(edge_dx[0])));
+			__m128 e1 = _mm_add_ps(_mm_set1_ps(e1_row), _mm_mul_ps(ramp, _mm_set1_ps(edge_dx[1])));
+			__m128 e2 = _mm_add_ps(_mm_set1_ps(e2_row), _mm_mul_ps(ramp, _mm_set1_ps(edge_dx[2])));
+			__m128 z = _mm_add_ps(_mm_set1_ps(z_row), _mm_mul_ps(ramp, _mm_set1_ps(z_dx)));
+			for (; x + 4 <= x_end; x += 4)
+			{
+				__m128 const inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(e0, zero), _mm_cmpge_ps(e1, zero)),
+					_mm_cmpge_ps(e2, zero));
+				__m128 const old_depth = _mm_loadu_ps(row + x);
+				__m128 const new_depth = _mm_min_ps(old_depth, z);
+				_mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, new_depth), _mm_andnot_ps(inside, old_depth)));
+
+				e0 = _mm_add_ps(e0, e0_step);
+				e1 = _mm_add_ps(e1, e1_step);
+				e2 = _mm_add_ps(e2, e2_step);
+				z = _mm_add_ps(z, z_step);
+			}
+#endif
+			for (; x < x_end; ++ x)
+			{
+				float const dx = static_cast<float>(x - x_begin);
+				if ((e0_row + edge_dx[0] * dx >= 0) && (e1_row + edge_dx[1] * dx >= 0) && (e2_row + edge_dx[2] * dx >= 0))
+				{
+					row[x] = std::min(row[x], z_row + z_dx * dx);
+				}
+			}
+		}
+	}
+
+	bool OcclusionCuller::AABBOccluded(AABBox const & aabb_ws) const
+	{
+		float min_x = +1e10f;
+		float max_x = -1e10f;
+		float min_y = +1e10f;
+		float max_y = -1e10f;
+		float min_z = +1e10f;
+		for (uint32_t i = 0; i < 8; ++ i)
+		{
+			float4 const clip = TransformPoint(aabb_ws.Corner(i), view_proj_);
+			if ((clip.z() < 0) || (clip.w() <= MIN_W))
+			{
+				return false;
+			}
+
+			float3 const screen = this->ToScreen(clip);
+			min_x = std::min(min_x, screen.x());
+			max_x = std::max(max_x, screen.x());
+			min_y = std::min(min_y, screen.y());
+			max_y = std::max(max_y, screen.y());
+			min_z = std::min(min_z, screen.z());
+		}
+
+		if ((min_x < 0) || (max_x >= width_) || (min_y < 0) || (max_y >= height_) || (min_z > 1))
+		{
+			// Partially off screen boxes are left to the frustum culling
+			return false;
+		}
+
+		uint32_t const x_begin = static_cast<uint32_t>(min_x);
+		uint32_t const x_end = static_cast<uint32_t>(max_x) + 1;
+		uint32_t const y_begin = static_cast<uint32_t>(min_y);
+		uint32_t const y_end = static_cast<uint32_t>(max_y) + 1;
+
+#if defined(KLAYGE_SSE2_SUPPORT)
+		__m128 const box_z = _mm_set1_ps(min_z);
+#endif
+
+		for (uint32_t ty = y_begin / TILE_SIZE; ty <= (y_end - 1) / TILE_SIZE; ++ ty)
+		{
+			for (uint32_t tx = x_begin / TILE_SIZE; tx <= (x_end - 1) / TILE_SIZE; ++ tx)
+			{
+				if (tile_max_depth_[ty * tiles_x_ + tx] < min_z)
+				{
+					continue;
+				}
+
+				uint32_t const tile_x_begin = std::max(tx * TILE_SIZE, x_begin);
+				uint32_t const tile_x_end = std::min((tx + 1) * TILE_SIZE, x_end);
+				uint32_t const tile_y_begin = std::max(ty * TILE_SIZE, y_begin);
+				uint32_t const tile_y_end = std::min((ty + 1) * TILE_SIZE, y_end);
+				for (uint32_t y = tile_y_begin; y < tile_y_end; ++ y)
+				{
+					float const * row = &depth_[y * width_];
+					uint32_t x = tile_x_begin;
+#if defined(KLAYGE_SSE2_SUPPORT)
+					for (; x + 4 <= tile_x_end; x += 4)
+					{
+						if (_mm_movemask_ps(_mm_cmpge_ps(_mm_loadu_ps(row + x), box_z)) != 0)
+						{
+							return false;
+						}
+					}
+#endif
+					for (; x < tile_x_end; ++ x)
+					{
+						if (row[x] >= min_z)
+						{
+							return false;
+						}
+					}
+				}
+			}
+		}
+
+		return true;
+	}
+
+	uint32_t OcclusionCuller::TestAABBs(ArrayRef<AABBox> aabbs_ws, uint8_t* occluded)
+	{
+		uint32_t const num_boxes = static_cast<uint32_t>(aabbs_ws.size());
+		parallel_for(Context::Instance().ThreadPool(), num_boxes, (num_boxes >= MIN_PARALLEL_BOXES) ? num_hw_threads_ : 1,
+			[this, &aabbs_ws, occluded](uint32_t begin, uint32_t end)
+			{
+				for (uint32_t i = begin; i < end; ++ i)
+				{
+					occluded[i] = this->AABBOccluded(aabbs_ws[i]) ? 1 : 0;
+				}
+			});
+
+		uint32_t num_occluded = 0;
+		for (uint32_t i = 0; i < num_boxes; ++ i)
+		{
+			num_occluded += occluded[i];
+		}
+
+		num_tested_ += num_boxes;
+		num_occluded_ += num_occluded;
+		return num_occluded;
+	}
+
+	void OcclusionCuller::DebugImage(std::vector<uint8_t>& image) const
+	{
+		// Stretched from the closest occluder to the far plane, perspective depths are all close to 1
+		float const min_depth = *std::min_element(depth_.begin(), depth_.end());
+		float const scale = (min_depth < 1) ? 255 / (1 - min_depth) : 0.0f;
+
+		image.resize(depth_.size());
+		for (size_t i = 0; i < depth_.size(); ++ i)
+		{
+			image[i] = static_cast<uint8_t>(MathLib::clamp(static_cast<int>((1 - depth_[i]) * scale + 0.5f), 0, 255));
+		}
+	}
+}
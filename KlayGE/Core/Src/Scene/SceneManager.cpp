@@ -52,10 +52,15 @@
 #include <KlayGE/InputFactory.hpp>
 #include <KlayGE/FrameBuffer.hpp>
 #include <KlayGE/DeferredRenderingLayer.hpp>
+#include <KlayGE/OcclusionCuller.hpp>
+#include <KlayGE/PerfProfiler.hpp>
 #include <KFL/Hash.hpp>
+#include <KFL/CpuInfo.hpp>
 
 #include <map>
 #include <algorithm>
+#include <chrono>
+#include <unordered_set>
 
 #include <KlayGE/SceneManager.hpp>
 
@@ -67,12 +72,13 @@ namespace KlayGE
 		: frustum_(nullptr),
 			scene_root_(L"SceenRoot", SceneNode::SOA_Cullable),
 			overlay_root_(L"OverlayRoot", SceneNode::SOA_Cullable | SceneNode::SOA_Overlay),
+			visibility_cache_threshold_(0), visibility_cache_frame_(0), num_visibility_cache_hits_(0),
 			small_obj_threshold_(0),
 			update_elapse_(1.0f / 60),
 			num_objects_rendered_(0), num_renderables_rendered_(0),
 			num_primitives_rendered_(0), num_vertices_rendered_(0),
 			num_draw_calls_(0), num_dispatch_calls_(0),
-			quit_(false), deferred_mode_(false)
+			quit_(false), num_sub_thread_update_jobs_(1), deferred_mode_(false)
 	{
 		scene_root_.VisibleMark(BO_Partial);
 		overlay_root_.VisibleMark(BO_Partial);
@@ -82,8 +88,15 @@ namespace KlayGE
 	/////////////////////////////////////////////////////////////////////////////////
 	SceneManager::~SceneManager()
 	{
-		quit_ = true;
-		(*update_thread_)();
+		{
+			std::lock_guard<std::mutex> lock(quit_mutex_);
+			quit_ = true;
+		}
+		quit_cond_.notify_one();
+		if (update_thread_)
+		{
+			(*update_thread_)();
+		}
 
 		this->ClearLight();
 		this->ClearCamera();
@@ -103,6 +116,28 @@ namespace KlayGE
 	void SceneManager::SmallObjectThreshold(float area)
 	{
 		small_obj_threshold_ = area;
+		this->ClearVisibilityCache();
+	}
+
+	void SceneManager::OcclusionCulling(bool enabled)
+	{
+		if (enabled)
+		{
+			if (!occlusion_culler_)
+			{
+				occlusion_culler_ = MakeUniquePtr<OcclusionCuller>(256, 128);
+			}
+		}
+		else
+		{
+			occlusion_culler_.reset();
+		}
+		this->ClearVisibilityCache();
+	}
+
+	bool SceneManager::OcclusionCulling() const
+	{
+		return occlusion_culler_ ? true : false;
 	}
 
 	void SceneManager::SceneUpdateElapse(float elapse)
@@ -110,6 +145,39 @@ namespace KlayGE
 		update_elapse_ = elapse;
 	}
 
+	void SceneManager::VisibilityCacheThreshold(float threshold)
+	{
+		visibility_cache_threshold_ = threshold;
+	}
+
+	void SceneManager::ClearVisibilityCache()
+	{
+		visibility_cache_.clear();
+	}
+
+	uint32_t SceneManager::NumVisibilityCacheHits() const
+	{
+		return num_visibility_cache_hits_;
+	}
+
+	void SceneManager::ParallelSubThreadUpdate(bool parallel)
+	{
+		if (parallel)
+		{
+			CPUInfo cpu;
+			num_sub_thread_update_jobs_ = std::max(static_cast<uint32_t>(cpu.NumHWThreads()), 1U);
+		}
+		else
+		{
+			num_sub_thread_update_jobs_ = 1;
+		}
+	}
+
+	bool SceneManager::ParallelSubThreadUpdate() const
+	{
+		return num_sub_thread_update_jobs_ > 1;
+	}
+
 	// ü
 	/////////////////////////////////////////////////////////////////////////////////
 	void SceneManager::ClipScene()
@@ -117,6 +185,15 @@ namespace KlayGE
 		App3DFramework& app = Context::Instance().AppInstance();
 		Camera& camera = app.ActiveCamera();
 
+		float4x4 const view_proj = this->ClipViewProj(camera);
+		for (auto* sn : all_scene_nodes_)
+		{
+			sn->VisibleMark(this->ClipNode(*sn, camera, view_proj));
+		}
+	}
+
+	float4x4 SceneManager::ClipViewProj(Camera const & camera) const
+	{
 		float4x4 view_proj = camera.ViewProjMatrix();
 		auto drl = Context::Instance().DeferredRenderingLayerInstance();
 		if (drl)
@@ -127,49 +204,77 @@ namespace KlayGE
 				view_proj *= drl->GetCascadedShadowLayer()->CascadeCropMatrix(cas_index);
 			}
 		}
+		return view_proj;
+	}
 
-		for (auto* sn : all_scene_nodes_)
+	BoundOverlap SceneManager::ClipNode(SceneNode const & node, Camera const & camera, float4x4 const & view_proj)
+	{
+		BoundOverlap visible;
+		if (node.Visible() && node.Updated())
 		{
-			auto& node = *sn;
-			BoundOverlap visible;
-			if (node.Visible() && node.Updated())
-			{
-				uint32_t const attr = node.Attrib();
+			uint32_t const attr = node.Attrib();
 
-				visible = this->VisibleTestFromParent(node, camera.ForwardVec(), camera.EyePos(), view_proj);
-				if (BO_Partial == visible)
+			visible = this->VisibleTestFromParent(node, camera.ForwardVec(), camera.EyePos(), view_proj);
+			if (BO_Partial == visible)
+			{
+				if (attr & SceneNode::SOA_Cullable)
 				{
-					if (attr & SceneNode::SOA_Cullable)
+					if (small_obj_threshold_ > 0)
 					{
-						if (small_obj_threshold_ > 0)
-						{
-							visible = ((MathLib::ortho_area(camera.ForwardVec(), node.PosBoundWS()) > small_obj_threshold_)
-								&& (MathLib::perspective_area(camera.EyePos(), view_proj, node.PosBoundWS()) > small_obj_threshold_))
-								? BO_Yes : BO_No;
-						}
-						else
-						{
-							visible = BO_Yes;
-						}
+						visible = ((MathLib::ortho_area(camera.ForwardVec(), node.PosBoundWS()) > small_obj_threshold_)
+							&& (MathLib::perspective_area(camera.EyePos(), view_proj, node.PosBoundWS()) > small_obj_threshold_))
+							? BO_Yes : BO_No;
 					}
 					else
 					{
 						visible = BO_Yes;
 					}
+				}
+				else
+				{
+					visible = BO_Yes;
+				}
 
-					if (!camera.OmniDirectionalMode() && (attr & SceneNode::SOA_Cullable)
-						&& (BO_Yes == visible))
-					{
-						visible = this->AABBVisible(node.PosBoundWS());
-					}
+				if (!camera.OmniDirectionalMode() && (attr & SceneNode::SOA_Cullable)
+					&& (BO_Yes == visible))
+				{
+					visible = this->AABBVisible(node.PosBoundWS());
 				}
 			}
-			else
+		}
+		else
+		{
+			visible = BO_No;
+		}
+
+		return visible;
+	}
+
+	void SceneManager::ReclipChangedNodes(std::vector<BoundOverlap>& marks, uint32_t since_stamp, Camera const & camera,
+		float4x4 const & view_proj)
+	{
+		// Parents come before their children. A node is clipped again if it moved, or if the mark of its parent changed.
+		std::unordered_set<SceneNode const *> changed_nodes;
+		for (size_t i = 0; i < all_scene_nodes_.size(); ++ i)
+		{
+			SceneNode& node = *all_scene_nodes_[i];
+			bool reclip = transform_hierarchy_.ChangeStamp(node) > since_stamp;
+			if (!reclip && !changed_nodes.empty() && (node.Parent() != nullptr))
 			{
-				visible = BO_No;
+				reclip = changed_nodes.find(node.Parent()) != changed_nodes.end();
 			}
 
-			node.VisibleMark(visible);
+			if (reclip)
+			{
+				BoundOverlap const visible = this->ClipNode(node, camera, view_proj);
+				if (visible != marks[i])
+				{
+					marks[i] = visible;
+					changed_nodes.insert(&node);
+				}
+			}
+
+			node.VisibleMark(marks[i]);
 		}
 	}
 
@@ -378,6 +483,8 @@ namespace KlayGE
 	/////////////////////////////////////////////////////////////////////////////////
 	void SceneManager::Update()
 	{
+		KLAYGE_PERF_TRACE_SCOPE("Scene", "Update");
+
 		deferred_mode_ = !!Context::Instance().DeferredRenderingLayerInstance();
 
 		App3DFramework& app = Context::Instance().AppInstance();
@@ -396,8 +503,12 @@ namespace KlayGE
 		{
 			std::lock_guard<std::mutex> lock(update_mutex_);
 
-			scene_root_.MainThreadUpdateSubtree(app_time, frame_time);
-			scene_root_.UpdatePosBoundSubtree();
+			scene_root_.Traverse([app_time, frame_time](SceneNode& node)
+				{
+					node.MainThreadUpdate(app_time, frame_time);
+					return true;
+				});
+			transform_hierarchy_.Update(scene_root_);
 
 			overlay_root_.ClearChildren();
 			for (auto iter = lights_.begin(); iter != lights_.end();)
@@ -443,7 +554,15 @@ namespace KlayGE
 	/////////////////////////////////////////////////////////////////////////////////
 	void SceneManager::Flush(uint32_t urt)
 	{
-		std::lock_guard<std::mutex> lock(update_mutex_);
+		KLAYGE_PERF_TRACE_SCOPE("Scene", "Flush");
+
+		// The sub thread update callbacks write the render state, e.g. particle buffers and transforms, so the scene pass
+		// can't overlap them. The overlay pass only touches the overlay tree.
+		std::unique_lock<std::mutex> lock(update_mutex_, std::defer_lock);
+		if (!(urt & App3DFramework::URV_Overlay))
+		{
+			lock.lock();
+		}
 
 		urt_ = urt;
 
@@ -490,6 +609,8 @@ namespace KlayGE
 		}
 		if (urt & App3DFramework::URV_NeedFlush)
 		{
+			KLAYGE_PERF_TRACE_SCOPE("Scene", "Cull");
+
 			frustum_ = &camera.ViewFrustum();
 
 			std::vector<uint32_t> visible_list((scene_nodes.size() + 31) / 32, 0);
@@ -500,36 +621,87 @@ namespace KlayGE
 					visible_list[i / 32] |= (1UL << (i & 31));
 				}
 			}
+			int32_t cas_index = -1;
+			if (deferred_mode_)
+			{
+				cas_index = Context::Instance().DeferredRenderingLayerInstance()->CurrCascadeIndex();
+			}
+
 			size_t seed = 0;
 			HashRange(seed, visible_list.begin(), visible_list.end());
 			HashCombine(seed, camera.OmniDirectionalMode());
 			HashCombine(seed, &camera);
+			HashCombine(seed, cas_index);
 
-			auto vmiter = visible_marks_map_.find(seed);
-			if (vmiter == visible_marks_map_.end())
+			if (urt & App3DFramework::URV_Overlay)
 			{
 				this->ClipScene();
+			}
+			else
+			{
+				float4x4 const view_proj = this->ClipViewProj(camera);
+				uint32_t const last_change = transform_hierarchy_.LastChangeStamp();
 
-				auto visible_marks = MakeUniquePtr<BoundOverlap[]>(scene_nodes.size());
-				for (size_t i = 0; i < scene_nodes.size(); ++ i)
+				auto vciter = visibility_cache_.find(seed);
+				bool hit = false;
+				if (vciter != visibility_cache_.end())
 				{
-					visible_marks[i] = scene_nodes[i]->VisibleMark();
+					auto const & entry = vciter->second;
+					hit = (entry.marks.size() == scene_nodes.size()) && !transform_hierarchy_.StructureDirty()
+						&& (entry.build_version == transform_hierarchy_.BuildVersion())
+						&& (!occlusion_culler_ || (last_change <= entry.change_stamp));
+					for (size_t i = 0; hit && (i < entry.view_proj.size()); ++ i)
+					{
+						hit = std::abs(entry.view_proj[i] - view_proj[i]) <= visibility_cache_threshold_;
+					}
 				}
 
-				visible_marks_map_.emplace(seed, std::move(visible_marks));
-			}
-			else
-			{
-				for (size_t i = 0; i < scene_nodes.size(); ++ i)
+				if (hit)
+				{
+					auto& entry = vciter->second;
+					if (last_change > entry.change_stamp)
+					{
+						this->ReclipChangedNodes(entry.marks, entry.change_stamp, camera, view_proj);
+						entry.change_stamp = transform_hierarchy_.UpdateStamp();
+					}
+					else
+					{
+						for (size_t i = 0; i < scene_nodes.size(); ++ i)
+						{
+							scene_nodes[i]->VisibleMark(entry.marks[i]);
+						}
+					}
+					entry.last_used_frame = visibility_cache_frame_;
+
+					++ num_visibility_cache_hits_;
+				}
+				else
 				{
-					scene_nodes[i]->VisibleMark(vmiter->second[i]);
+					this->ClipScene();
+					if (occlusion_culler_)
+					{
+						this->OcclusionCullScene();
+					}
+
+					auto& entry = visibility_cache_[seed];
+					entry.marks.resize(scene_nodes.size());
+					for (size_t i = 0; i < scene_nodes.size(); ++ i)
+					{
+						entry.marks[i] = scene_nodes[i]->VisibleMark();
+					}
+					entry.view_proj = view_proj;
+					entry.build_version = transform_hierarchy_.BuildVersion();
+					entry.change_stamp = transform_hierarchy_.UpdateStamp();
+					entry.last_used_frame = visibility_cache_frame_;
 				}
 			}
 		}
 		if (urt & App3DFramework::URV_Overlay)
 		{
+			// The overlay tree is rebuilt by the main thread every frame, so it's updated here instead of by the sub thread
 			for (auto const & scene_node : scene_nodes)
 			{
+				scene_node->SubThreadUpdate(app_time, frame_time);
 				scene_node->MainThreadUpdate(app_time, frame_time);
 				scene_node->VisibleMark(scene_node->Visible() ? BO_Yes : BO_No);
 			}
@@ -671,9 +843,23 @@ namespace KlayGE
 
 	void SceneManager::FlushScene()
 	{
+		KLAYGE_PERF_TRACE_SCOPE("Scene", "FlushScene");
+
 		RenderEngine& re = Context::Instance().RenderFactoryInstance().RenderEngineInstance();
 
-		visible_marks_map_.clear();
+		++ visibility_cache_frame_;
+		num_visibility_cache_hits_ = 0;
+		for (auto iter = visibility_cache_.begin(); iter != visibility_cache_.end();)
+		{
+			if (visibility_cache_frame_ - iter->second.last_used_frame > VISIBILITY_CACHE_MAX_AGE)
+			{
+				iter = visibility_cache_.erase(iter);
+			}
+			else
+			{
+				++ iter;
+			}
+		}
 
 		uint32_t urt;
 		App3DFramework& app = Context::Instance().AppInstance();
@@ -715,6 +901,7 @@ namespace KlayGE
 	{
 		Timer timer;
 		float app_time = 0;
+		auto next_tick = std::chrono::steady_clock::now();
 		while (!quit_)
 		{
 			float const frame_time = static_cast<float>(timer.elapsed());
@@ -727,16 +914,46 @@ namespace KlayGE
 				if (win && win->Active())
 				{
 					std::lock_guard<std::mutex> lock(update_mutex_);
-
-					scene_root_.SubThreadUpdateSubtree(app_time, frame_time);
-					overlay_root_.SubThreadUpdateSubtree(app_time, frame_time);
+					this->SubThreadUpdateScene(app_time, frame_time);
 				}
+			}
 
-				if (frame_time < update_elapse_)
-				{
-					Sleep(static_cast<uint32_t>((update_elapse_ - frame_time) * 1000));
-				}
+			// Ticks at a fixed rate. An update that takes longer than the interval moves the schedule instead of being caught up.
+			next_tick += std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+				std::chrono::duration<float>(update_elapse_));
+			auto const now = std::chrono::steady_clock::now();
+			if (next_tick < now)
+			{
+				next_tick = now;
 			}
+
+			std::unique_lock<std::mutex> lock(quit_mutex_);
+			quit_cond_.wait_until(lock, next_tick, [this] { return quit_.load(); });
+		}
+	}
+
+	void SceneManager::SubThreadUpdateScene(float app_time, float frame_time)
+	{
+		KLAYGE_PERF_TRACE_SCOPE("Scene", "SubThreadUpdate");
+
+		auto const & children = scene_root_.Children();
+		uint32_t const num_children = static_cast<uint32_t>(children.size());
+		if (std::min(num_sub_thread_update_jobs_, num_children) > 1)
+		{
+			scene_root_.SubThreadUpdate(app_time, frame_time);
+
+			parallel_for(Context::Instance().ThreadPool(), num_children, num_sub_thread_update_jobs_,
+				[&children, app_time, frame_time](uint32_t begin, uint32_t end)
+				{
+					for (uint32_t i = begin; i < end; ++ i)
+					{
+						children[i]->SubThreadUpdateSubtree(app_time, frame_time);
+					}
+				});
+		}
+		else
+		{
+			scene_root_.SubThreadUpdateSubtree(app_time, frame_time);
 		}
 	}
 
@@ -780,4 +997,63 @@ namespace KlayGE
 
 		return visible;
 	}
+
+	void SceneManager::OcclusionCullScene()
+	{
+		KLAYGE_PERF_TRACE_SCOPE("Scene", "OcclusionCull");
+
+		App3DFramework& app = Context::Instance().AppInstance();
+		Camera& camera = app.ActiveCamera();
+		if (camera.OmniDirectionalMode())
+		{
+			return;
+		}
+
+		occlusion_culler_->BeginFrame(this->ClipViewProj(camera));
+
+		occludee_nodes_.clear();
+		occludee_aabbs_.clear();
+		for (auto* sn : all_scene_nodes_)
+		{
+			auto& node = *sn;
+			if (node.VisibleMark() != BO_No)
+			{
+				uint32_t const attr = node.Attrib();
+				if (attr & SceneNode::SOA_Occluder)
+				{
+					float4x4 const & model = node.TransformToWorld();
+					node.ForEachRenderable([this, &model](Renderable& renderable)
+						{
+							// The real triangles, since the bounding box of a mesh is bigger than what it hides. Surfaces with
+							// holes or see-through ones hide nothing.
+							if (!renderable.AlphaTest() && !renderable.TransparencyBackFace() && !renderable.TransparencyFrontFace())
+							{
+								auto const indices = renderable.OccluderIndices();
+								if (!indices.empty())
+								{
+									occlusion_culler_->AddOccluder(renderable.OccluderPositions(), indices, model);
+								}
+							}
+						});
+				}
+				else if (attr & SceneNode::SOA_Cullable)
+				{
+					occludee_nodes_.push_back(sn);
+					occludee_aabbs_.push_back(node.PosBoundWS());
+				}
+			}
+		}
+
+		occlusion_culler_->Rasterize();
+
+		occluded_.resize(occludee_aabbs_.size());
+		occlusion_culler_->TestAABBs(occludee_aabbs_, occluded_.data());
+		for (size_t i = 0; i < occludee_nodes_.size(); ++ i)
+		{
+			if (occluded_[i])
+			{
+				occludee_nodes_[i]->VisibleMark(BO_No);
+			}
+		}
+	}
 }
@@ -34,6 +34,7 @@
 #include <KlayGE/Context.hpp>
 #include <KFL/Math.hpp>
 #include <KlayGE/Renderable.hpp>
+#include <KlayGE/TransformHierarchy.hpp>
 
 #include <boost/assert.hpp>
 
@@ -71,6 +72,10 @@ namespace KlayGE
 
 	SceneNode::~SceneNode()
 	{
+		if (hierarchy_ != nullptr)
+		{
+			hierarchy_->NodeDestroyed(hierarchy_index_);
+		}
 	}
 
 	std::wstring_view SceneNode::Name() const
@@ -147,7 +152,7 @@ namespace KlayGE
 	{
 		parent_ = so;
 
-		pos_aabb_dirty_ = true;
+		this->MarkDirty();
 		updated_ = false;
 	}
 
@@ -161,7 +166,7 @@ namespace KlayGE
 		auto iter = std::find(children_.begin(), children_.end(), node);
 		if (iter == children_.end())
 		{
-			pos_aabb_dirty_ = true;
+			this->MarkStructureDirty();
 			node->Parent(this);
 			children_.push_back(node);
 		}
@@ -172,7 +177,7 @@ namespace KlayGE
 		auto iter = std::find(children_.begin(), children_.end(), node);
 		if (iter != children_.end())
 		{
-			pos_aabb_dirty_ = true;
+			this->MarkStructureDirty();
 			node->Parent(nullptr);
 			children_.erase(iter);
 
@@ -187,7 +192,7 @@ namespace KlayGE
 			child->Parent(nullptr);
 		}
 
-		pos_aabb_dirty_ = true;
+		this->MarkStructureDirty();
 		children_.clear();
 
 		this->EmitSceneChanged();
@@ -243,7 +248,7 @@ namespace KlayGE
 	void SceneNode::AddRenderable(RenderablePtr const & renderable)
 	{
 		renderables_.push_back(renderable);
-		pos_aabb_dirty_ = true;
+		this->MarkDirty();
 	}
 
 	void SceneNode::DelRenderable(RenderablePtr const & renderable)
@@ -252,14 +257,14 @@ namespace KlayGE
 		if (iter != renderables_.end())
 		{
 			renderables_.erase(iter);
-			pos_aabb_dirty_ = true;
+			this->MarkDirty();
 		}
 	}
 
 	void SceneNode::ClearRenderables()
 	{
 		renderables_.clear();
-		pos_aabb_dirty_ = true;
+		this->MarkDirty();
 	}
 
 	void SceneNode::ForEachRenderable(std::function<void(Renderable&)> const & callback) const
@@ -276,7 +281,7 @@ namespace KlayGE
 	void SceneNode::TransformToParent(float4x4 const & mat)
 	{
 		xform_to_parent_ = mat;
-		pos_aabb_dirty_ = true;
+		this->MarkDirty();
 	}
 
 	void SceneNode::TransformToWorld(float4x4 const & mat)
@@ -289,7 +294,7 @@ namespace KlayGE
 		{
 			xform_to_parent_ = mat;
 		}
-		pos_aabb_dirty_ = true;
+		this->MarkDirty();
 	}
 
 	float4x4 const & SceneNode::TransformToParent() const
@@ -551,6 +556,24 @@ namespace KlayGE
 		}
 	}
 
+	void SceneNode::MarkDirty()
+	{
+		pos_aabb_dirty_ = true;
+		if (hierarchy_ != nullptr)
+		{
+			hierarchy_->MarkDirty(hierarchy_index_);
+		}
+	}
+
+	void SceneNode::MarkStructureDirty()
+	{
+		this->MarkDirty();
+		if (hierarchy_ != nullptr)
+		{
+			hierarchy_->Invalidate();
+		}
+	}
+
 	void SceneNode::EmitSceneChanged()
 	{
 		auto& context = Context::Instance();
@@ -0,0 +1,367 @@
+/**
+ * @file TransformHierarchy.cpp
+ * @author Minmin Gong
+ *
+ * @section DESCRIPTION
+ *
+ * This source file is part of KlayGE
+ * For the latest info, see http://www.klayge.org
+ *
+ * @section LICENSE
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * You may alternatively use this source under the terms of
+ * the KlayGE Proprietary License (KPL). You can obtained such a license
+ * from http://www.klayge.org/licensing/.
+ */
+
+#include <KlayGE/KlayGE.hpp>
+#include <KFL/CpuInfo.hpp>
+#include <KFL/SIMDMath.hpp>
+#include <KFL/SIMDVector.hpp>
+#include <KFL/Thread.hpp>
+#include <KlayGE/Context.hpp>
+#include <KlayGE/Renderable.hpp>
+#include <KlayGE/SceneNode.hpp>
+
+#include <algorithm>
+#include <atomic>
+
+#include <boost/assert.hpp>
+
+#include <KlayGE/TransformHierarchy.hpp>
+
+namespace
+{
+	using namespace KlayGE;
+
+	uint32_t constexpr NO_PARENT = ~0U;
+	uint32_t constexpr MIN_PARALLEL_NODES = 1024;
+
+	// lhs * rhs, one row of the result at a time
+	void MultiplyMatrix(float4x4& out, float4x4 const & lhs, float4x4 const & rhs)
+	{
+		float const * l = lhs.data();
+		float const * r = rhs.data();
+		SIMDVectorF4 const r0 = SIMDMathLib::LoadVector4(r + 0);
+		SIMDVectorF4 const r1 = SIMDMathLib::LoadVector4(r + 4);
+		SIMDVectorF4 const r2 = SIMDMathLib::LoadVector4(r + 8);
+		SIMDVectorF4 const r3 = SIMDMathLib::LoadVector4(r + 12);
+		for (size_t i = 0; i < 4; ++ i)
+		{
+			SIMDVectorF4 row = SIMDMathLib::Multiply(SIMDMathLib::SetVector(l[i * 4 + 0]), r0);
+			row = SIMDMathLib::Add(row, SIMDMathLib::Multiply(SIMDMathLib::SetVector(l[i * 4 + 1]), r1));
+			row = SIMDMathLib::Add(row, SIMDMathLib::Multiply(SIMDMathLib::SetVector(l[i * 4 + 2]), r2));
+			row = SIMDMathLib::Add(row, SIMDMathLib::Multiply(SIMDMathLib::SetVector(l[i * 4 + 3]), r3));
+
+			float4 v;
+			SIMDMathLib::StoreVector4(v, row);
+			out.Row(i, v);
+		}
+	}
+
+	// An affine matrix maps the center and the half size of a box independently, which takes 2 transforms instead of 8
+	AABBox TransformAABB(AABBox const & aabb, float4x4 const & mat)
+	{
+		if ((mat(0, 3) != 0) || (mat(1, 3) != 0) || (mat(2, 3) != 0) || (mat(3, 3) != 1))
+		{
+			return MathLib::transform_aabb(aabb, mat);
+		}
+
+		float const * m = mat.data();
+		SIMDVectorF4 const r0 = SIMDMathLib::LoadVector4(m + 0);
+		SIMDVectorF4 const r1 = SIMDMathLib::LoadVector4(m + 4);
+		SIMDVectorF4 const r2 = SIMDMathLib::LoadVector4(m + 8);
+		SIMDVectorF4 const r3 = SIMDMathLib::LoadVector4(m + 12);
+
+		float3 const center = aabb.Center();
+		float3 const half_size = aabb.HalfSize();
+
+		SIMDVectorF4 c = SIMDMathLib::Multiply(SIMDMathLib::SetVector(center.x()), r0);
+		c = SIMDMathLib::Add(c, SIMDMathLib::Multiply(SIMDMathLib::SetVector(center.y()), r1));
+		c = SIMDMathLib::Add(c, SIMDMathLib::Multiply(SIMDMathLib::SetVector(center.z()), r2));
+		c = SIMDMathLib::Add(c, r3);
+
+		SIMDVectorF4 e = SIMDMathLib::Multiply(SIMDMathLib::SetVector(half_size.x()), SIMDMathLib::Abs(r0));
+		e = SIMDMathLib::Add(e, SIMDMathLib::Multiply(SIMDMathLib::SetVector(half_size.y()), SIMDMathLib::Abs(r1)));
+		e = SIMDMathLib::Add(e, SIMDMathLib::Multiply(SIMDMathLib::SetVector(half_size.z()), SIMDMathLib::Abs(r2)));
+
+		float3 min, max;
+		SIMDMathLib::StoreVector3(min, SIMDMathLib::Substract(c, e));
+		SIMDMathLib::StoreVector3(max, SIMDMathLib::Add(c, e));
+		return AABBox(min, max);
+	}
+
+	bool ValidBound(AABBox const & aabb)
+	{
+		return (aabb.Min().x() < aabb.Max().x()) && (aabb.Min().y() < aabb.Max().y()) && (aabb.Min().z() < aabb.Max().z());
+	}
+}
+
+namespace KlayGE
+{
+	TransformHierarchy::TransformHierarchy()
+		: structure_dirty_(true), num_nodes_updated_(0), build_version_(0), update_stamp_(0), last_change_stamp_(0)
+	{
+	}
+
+	TransformHierarchy::~TransformHierarchy()
+	{
+		this->Clear();
+	}
+
+	void TransformHierarchy::Clear()
+	{
+		for (auto* node : nodes_)
+		{
+			if (node != nullptr)
+			{
+				node->hierarchy_ = nullptr;
+			}
+		}
+
+		nodes_.clear();
+		parents_.clear();
+		first_children_.clear();
+		num_children_.clear();
+		level_begins_.clear();
+		flags_.clear();
+		local_xforms_.clear();
+		world_xforms_.clear();
+		own_bounds_.clear();
+		local_bounds_.clear();
+		world_bounds_.clear();
+		change_stamps_.clear();
+
+		structure_dirty_ = true;
+		num_nodes_updated_ = 0;
+	}
+
+	void TransformHierarchy::NodeDestroyed(uint32_t index)
+	{
+		nodes_[index] = nullptr;
+		structure_dirty_ = true;
+	}
+
+	uint32_t TransformHierarchy::ChangeStamp(SceneNode const & node) const
+	{
+		return (node.hierarchy_ == this) ? change_stamps_[node.hierarchy_index_] : ~0U;
+	}
+
+	void TransformHierarchy::Build(SceneNode& root)
+	{
+		this->Clear();
+
+		// Breadth first, so the levels are contiguous, and so are the children of each node
+		nodes_.push_back(&root);
+		parents_.push_back(NO_PARENT);
+		level_begins_.push_back(0);
+		uint32_t level_end = 1;
+		for (uint32_t i = 0; i < static_cast<uint32_t>(nodes_.size()); ++ i)
+		{
+			if (i == level_end)
+			{
+				level_begins_.push_back(i);
+				level_end = static_cast<uint32_t>(nodes_.size());
+			}
+
+			SceneNode* node = nodes_[i];
+			first_children_.push_back(static_cast<uint32_t>(nodes_.size()));
+			num_children_.push_back(static_cast<uint32_t>(node->children_.size()));
+			for (auto const & child : node->children_)
+			{
+				nodes_.push_back(child.get());
+				parents_.push_back(i);
+			}
+		}
+		level_begins_.push_back(static_cast<uint32_t>(nodes_.size()));
+
+		size_t const num_nodes = nodes_.size();
+		flags_.resize(num_nodes);
+		local_xforms_.resize(num_nodes);
+		world_xforms_.resize(num_nodes);
+		own_bounds_.resize(num_nodes);
+		local_bounds_.resize(num_nodes);
+		world_bounds_.resize(num_nodes);
+		change_stamps_.resize(num_nodes);
+		for (uint32_t i = 0; i < num_nodes; ++ i)
+		{
+			SceneNode* node = nodes_[i];
+			node->hierarchy_ = this;
+			node->hierarchy_index_ = i;
+
+			flags_[i] = NF_Dirty | (node->pos_aabb_os_ ? NF_HasBound : 0);
+		}
+
+		structure_dirty_ = false;
+		++ build_version_;
+	}
+
+	void TransformHierarchy::Update(SceneNode& root)
+	{
+		if (structure_dirty_ || nodes_.empty() || (nodes_[0] != &root))
+		{
+			this->Build(root);
+		}
+
+		++ update_stamp_;
+
+		CPUInfo cpu;
+		uint32_t const num_hw_threads = static_cast<uint32_t>(cpu.NumHWThreads());
+		auto& tp = Context::Instance().ThreadPool();
+
+		uint32_t const num_levels = this->NumLevels();
+		for (uint32_t level = 0; level < num_levels; ++ level)
+		{
+			uint32_t const begin = level_begins_[level];
+			uint32_t const count = level_begins_[level + 1] - begin;
+			parallel_for(tp, count, (count >= MIN_PARALLEL_NODES) ? num_hw_threads : 1, [this, begin](uint32_t b, uint32_t e)
+				{
+					this->UpdateWorldTransforms(begin + b, begin + e);
+				});
+		}
+		for (uint32_t level = num_levels; level > 0; -- level)
+		{
+			uint32_t const begin = level_begins_[level - 1];
+			uint32_t const count = level_begins_[level] - begin;
+			parallel_for(tp, count, (count >= MIN_PARALLEL_NODES) ? num_hw_threads : 1, [this, begin](uint32_t b, uint32_t e)
+				{
+					this->UpdateLocalBounds(begin + b, begin + e);
+				});
+		}
+
+		uint32_t const num_nodes = this->NumNodes();
+		std::atomic<uint32_t> num_updated(0);
+		parallel_for(tp, num_nodes, (num_nodes >= MIN_PARALLEL_NODES) ? num_hw_threads : 1,
+			[this, &num_updated](uint32_t b, uint32_t e)
+			{
+				num_updated += this->WriteBack(b, e);
+			});
+		num_nodes_updated_ = num_updated;
+		if (num_nodes_updated_ > 0)
+		{
+			last_change_stamp_ = update_stamp_;
+		}
+	}
+
+	void TransformHierarchy::UpdateWorldTransforms(uint32_t begin, uint32_t end)
+	{
+		for (uint32_t i = begin; i < end; ++ i)
+		{
+			uint8_t flags = flags_[i] & ~(NF_WorldChanged | NF_BoundChanged);
+			if (flags & NF_Dirty)
+			{
+				SceneNode const & node = *nodes_[i];
+				local_xforms_[i] = node.xform_to_parent_;
+
+				if (flags & NF_HasBound)
+				{
+					AABBox& bound = own_bounds_[i];
+					bound.Min() = float3(+1e10f, +1e10f, +1e10f);
+					bound.Max() = float3(-1e10f, -1e10f, -1e10f);
+					if (!node.renderables_.empty())
+					{
+						bound = node.renderables_[0]->PosBound();
+						for (size_t j = 1; j < node.renderables_.size(); ++ j)
+						{
+							bound |= node.renderables_[j]->PosBound();
+						}
+					}
+				}
+			}
+
+			uint32_t const parent = parents_[i];
+			if (parent == NO_PARENT)
+			{
+				if (flags & NF_Dirty)
+				{
+					world_xforms_[i] = local_xforms_[i];
+					flags |= NF_WorldChanged;
+				}
+			}
+			else if ((flags & NF_Dirty) || (flags_[parent] & NF_WorldChanged))
+			{
+				MultiplyMatrix(world_xforms_[i], local_xforms_[i], world_xforms_[parent]);
+				flags |= NF_WorldChanged;
+			}
+
+			flags_[i] = flags;
+		}
+	}
+
+	void TransformHierarchy::UpdateLocalBounds(uint32_t begin, uint32_t end)
+	{
+		for (uint32_t i = begin; i < end; ++ i)
+		{
+			uint8_t flags = flags_[i];
+			uint32_t const first_child = first_children_[i];
+			uint32_t const last_child = first_child + num_children_[i];
+
+			bool changed = (flags & NF_Dirty) ? true : false;
+			for (uint32_t c = first_child; (c < last_child) && !changed; ++ c)
+			{
+				// A moved child changes the bound of its parent too
+				changed = (flags_[c] & (NF_Dirty | NF_BoundChanged)) ? true : false;
+			}
+
+			if (changed)
+			{
+				if (flags & NF_HasBound)
+				{
+					AABBox bound = own_bounds_[i];
+					for (uint32_t c = first_child; c < last_child; ++ c)
+					{
+						if ((flags_[c] & NF_HasBound) && ValidBound(local_bounds_[c]))
+						{
+							bound |= TransformAABB(local_bounds_[c], local_xforms_[c]);
+						}
+					}
+					local_bounds_[i] = bound;
+				}
+
+				flags_[i] = flags | NF_BoundChanged;
+			}
+		}
+	}
+
+	uint32_t TransformHierarchy::WriteBack(uint32_t begin, uint32_t end)
+	{
+		uint32_t num_updated = 0;
+		for (uint32_t i = begin; i < end; ++ i)
+		{
+			uint8_t const flags = flags_[i];
+			if (flags & (NF_WorldChanged | NF_BoundChanged))
+			{
+				SceneNode& node = *nodes_[i];
+				node.xform_to_world_ = world_xforms_[i];
+				if (flags & NF_HasBound)
+				{
+					world_bounds_[i] = TransformAABB(local_bounds_[i], world_xforms_[i]);
+					*node.pos_aabb_os_ = local_bounds_[i];
+					*node.pos_aabb_ws_ = world_bounds_[i];
+				}
+				node.pos_aabb_dirty_ = false;
+				change_stamps_[i] = update_stamp_;
+
+				++ num_updated;
+			}
+
+			flags_[i] = flags & ~NF_Dirty;
+		}
+
+		return num_updated;
+	}
+}
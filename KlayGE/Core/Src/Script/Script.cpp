@@ -34,6 +34,15 @@
 
 namespace KlayGE
 {
+	ScriptFunction::ScriptFunction()
+	{
+	}
+
+	ScriptFunction::~ScriptFunction()
+	{
+	}
+
+
 	ScriptModule::ScriptModule()
 	{
 	}
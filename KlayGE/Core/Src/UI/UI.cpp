@@ -87,6 +87,7 @@ namespace KlayGE
 	std::unique_ptr<UIManager> UIManager::ui_mgr_instance_;
 
 
+	// All the quads of a texture, uploaded and drawn once per frame
 	class UIRectRenderable : public Renderable
 	{
 	public:
@@ -130,11 +131,14 @@ namespace KlayGE
 			ui_tex_ep_ = effect->ParameterByName("ui_tex");
 			half_width_height_ep_ = effect->ParameterByName("half_width_height");
 			dpi_scale_ep_ = effect->ParameterByName("dpi_scale");
+
+			indices_base_vertex_ = 0;
+			indices_num_quads_ = 0;
 		}
 
 		bool Empty() const
 		{
-			return tb_ib_sub_allocs_.empty();
+			return vertices_.empty();
 		}
 
 		void OnRenderBegin()
@@ -161,75 +165,79 @@ namespace KlayGE
 		{
 			tb_vb_->OnPresent();
 			tb_ib_->OnPresent();
-
-			tb_vb_sub_allocs_.clear();
-			tb_ib_sub_allocs_.clear();
 		}
 
 		void Render()
 		{
 			RenderEngine& re = Context::Instance().RenderFactoryInstance().RenderEngineInstance();
 
-			this->OnRenderBegin();
+			// One sub alloc for all the vertices, and one for all the indices
+			SubAlloc const vb_sub_alloc = tb_vb_->Alloc(static_cast<uint32_t>(vertices_.size() * sizeof(vertices_[0])),
+				vertices_.data());
+			uint32_t const base_vertex = vb_sub_alloc.offset_ / sizeof(UIManager::VertexFormat);
+			BOOST_ASSERT(base_vertex + vertices_.size() <= 0xFFFF);
+			this->UpdateIndices(static_cast<uint16_t>(base_vertex), static_cast<uint32_t>(vertices_.size() / 4));
+			SubAlloc const ib_sub_alloc = tb_ib_->Alloc(static_cast<uint32_t>(indices_.size() * sizeof(indices_[0])),
+				indices_.data());
 
-			BOOST_ASSERT(tb_vb_sub_allocs_.size() == tb_ib_sub_allocs_.size());
+			this->OnRenderBegin();
 
-			for (size_t i = 0; i < tb_vb_sub_allocs_.size(); ++ i)
-			{
-				uint32_t vert_length = tb_vb_sub_allocs_[i].length_;
-				uint32_t const ind_offset = tb_ib_sub_allocs_[i].offset_;
-				uint32_t ind_length = tb_ib_sub_allocs_[i].length_;
+			rls_[0]->NumVertices(static_cast<uint32_t>(vertices_.size()));
+			rls_[0]->StartIndexLocation(ib_sub_alloc.offset_ / sizeof(uint16_t));
+			rls_[0]->NumIndices(static_cast<uint32_t>(indices_.size()));
 
-				while ((i + 1 < tb_vb_sub_allocs_.size())
-					&& (tb_vb_sub_allocs_[i].offset_ + tb_vb_sub_allocs_[i].length_ == tb_vb_sub_allocs_[i + 1].offset_)
-					&& (tb_ib_sub_allocs_[i].offset_ + tb_ib_sub_allocs_[i].length_ == tb_ib_sub_allocs_[i + 1].offset_))
-				{
-					vert_length += tb_vb_sub_allocs_[i + 1].length_;
-					ind_length += tb_ib_sub_allocs_[i + 1].length_;
-					++ i;
-				}
+			re.Render(*this->GetRenderEffect(), *this->GetRenderTechnique(), *rls_[0]);
 
-				rls_[0]->NumVertices(vert_length / sizeof(UIManager::VertexFormat));
-				rls_[0]->StartIndexLocation(ind_offset / sizeof(uint16_t));
-				rls_[0]->NumIndices(ind_length / sizeof(uint16_t));
+			tb_vb_->Dealloc(vb_sub_alloc);
+			tb_ib_->Dealloc(ib_sub_alloc);
 
-				re.Render(*this->GetRenderEffect(), *this->GetRenderTechnique(), *rls_[0]);
-			}
+			this->OnRenderEnd();
+		}
 
-			for (size_t i = 0; i < tb_vb_sub_allocs_.size(); ++ i)
-			{
-				tb_vb_->Dealloc(tb_vb_sub_allocs_[i]);
-				tb_ib_->Dealloc(tb_ib_sub_allocs_[i]);
-			}
+		void AddQuads(UIManager::VertexFormat const * vertices, uint32_t num_quads)
+		{
+			vertices_.insert(vertices_.end(), vertices, vertices + num_quads * 4);
+		}
 
-			this->OnRenderEnd();
+		void ClearQuads()
+		{
+			vertices_.clear();
 		}
 
-		void AddQuad(std::vector<UIManager::VertexFormat> const & vertices)
+	private:
+		// The indices only change with the position of the vertices in the transient buffer, or the number of quads
+		void UpdateIndices(uint16_t base_vertex, uint32_t num_quads)
 		{
-			tb_vb_sub_allocs_.push_back(tb_vb_->Alloc(static_cast<uint32_t>(vertices.size() * sizeof(vertices[0])), &vertices[0]));
-			
-			uint16_t const last_index = static_cast<uint16_t>(tb_vb_sub_allocs_.back().offset_ / sizeof(UIManager::VertexFormat));
-			std::vector<uint16_t> indices;
-			indices.resize(restart_ ? 5 : 6);
-			indices[0] = last_index + 0;
-			indices[1] = last_index + 1;
-			if (restart_)
+			if ((base_vertex == indices_base_vertex_) && (num_quads == indices_num_quads_))
 			{
-				indices[2] = last_index + 3;
-				indices[3] = last_index + 2;
-				indices[4] = 0xFFFF;
+				return;
 			}
-			else
+
+			uint32_t const index_per_quad = restart_ ? 5 : 6;
+			indices_.resize(num_quads * index_per_quad);
+			for (uint32_t i = 0; i < num_quads; ++ i)
 			{
-				indices[2] = last_index + 2;
-				indices[3] = last_index + 2;
-				indices[4] = last_index + 3;
-				indices[5] = last_index + 0;
+				uint16_t const first = static_cast<uint16_t>(base_vertex + i * 4);
+				uint16_t* indices = &indices_[i * index_per_quad];
+				indices[0] = first + 0;
+				indices[1] = first + 1;
+				if (restart_)
+				{
+					indices[2] = first + 3;
+					indices[3] = first + 2;
+					indices[4] = 0xFFFF;
+				}
+				else
+				{
+					indices[2] = first + 2;
+					indices[3] = first + 2;
+					indices[4] = first + 3;
+					indices[5] = first + 0;
+				}
 			}
-			BOOST_ASSERT(last_index + 3 <= 0xFFFF);
 
-			tb_ib_sub_allocs_.push_back(tb_ib_->Alloc(static_cast<uint32_t>(indices.size() * sizeof(indices[0])), &indices[0]));
+			indices_base_vertex_ = base_vertex;
+			indices_num_quads_ = num_quads;
 		}
 
 	private:
@@ -243,11 +251,38 @@ namespace KlayGE
 
 		std::unique_ptr<TransientBuffer> tb_vb_;
 		std::unique_ptr<TransientBuffer> tb_ib_;
-		std::vector<SubAlloc> tb_vb_sub_allocs_;
-		std::vector<SubAlloc> tb_ib_sub_allocs_;
+
+		std::vector<UIManager::VertexFormat> vertices_;
+		std::vector<uint16_t> indices_;
+		uint16_t indices_base_vertex_;
+		uint32_t indices_num_quads_;
 	};
 
 
+	void UIManager::GeometryCache::Clear()
+	{
+		for (auto& quad : quads)
+		{
+			quad.second.clear();
+		}
+		for (auto& str : strings)
+		{
+			str.second.clear();
+		}
+		num_quads = 0;
+	}
+
+
+	void UIControl::Invalidate()
+	{
+		auto dialog = dialog_.lock();
+		if (dialog)
+		{
+			dialog->Invalidate();
+		}
+	}
+
+
 	void UIStatesColor::Init(Color const & default_color,
 			Color const & disabled_color,
 			Color const & hidden_color)
@@ -300,7 +335,9 @@ namespace KlayGE
 
 
 	UIManager::UIManager()
-		: mouse_on_ui_(false),
+		: curr_geometry_(&immediate_geometry_),
+			num_quads_(0), num_quads_rebuilt_(0),
+			mouse_on_ui_(false),
 			inited_(false)
 	{
 	}
@@ -920,25 +957,67 @@ namespace KlayGE
 
 	void UIManager::Render()
 	{
-		for (auto& str : strings_)
+		num_quads_ = 0;
+		num_quads_rebuilt_ = 0;
+
+		for (auto const & rect : rects_)
 		{
-			str.second.clear();
+			checked_pointer_cast<UIRectRenderable>(rect.second->GetRenderable())->ClearQuads();
 		}
 
+		// Only the dialogs that changed since the last frame run their controls' Render
 		for (auto const & dialog : dialogs_)
 		{
-			dialog->Render();
+			if (dialog->NeedsRebuild())
+			{
+				dialog->geometry_.Clear();
+
+				curr_geometry_ = &dialog->geometry_;
+				dialog->Render();
+				curr_geometry_ = &immediate_geometry_;
+
+				dialog->dirty_ = false;
+				num_quads_rebuilt_ += dialog->geometry_.num_quads;
+			}
+		}
+
+		for (auto const & dialog : dialogs_)
+		{
+			this->RenderGeometry(dialog->geometry_);
 		}
+		this->RenderGeometry(immediate_geometry_);
+		num_quads_rebuilt_ += immediate_geometry_.num_quads;
+		immediate_geometry_.Clear();
 
 		for (auto const & rect : rects_)
 		{
-			if (!checked_pointer_cast<UIRectRenderable>(rect.second)->Empty())
+			if (!checked_pointer_cast<UIRectRenderable>(rect.second->GetRenderable())->Empty())
 			{
-				auto ui_rect_obj = MakeSharedPtr<SceneNode>(rect.second, SceneNode::SOA_Overlay);
-				Context::Instance().SceneManagerInstance().OverlayRootNode().AddChild(ui_rect_obj);
+				Context::Instance().SceneManagerInstance().OverlayRootNode().AddChild(rect.second);
 			}
 		}
-		for (auto const & str : strings_)
+	}
+
+	void UIManager::RenderGeometry(GeometryCache const & geometry)
+	{
+		for (auto const & quad : geometry.quads)
+		{
+			if (!quad.second.empty())
+			{
+				auto iter = rects_.find(quad.first);
+				if (iter == rects_.end())
+				{
+					auto renderable = MakeSharedPtr<UIRectRenderable>(quad.first, effect_);
+					iter = rects_.emplace(quad.first, MakeSharedPtr<SceneNode>(renderable, SceneNode::SOA_Overlay)).first;
+				}
+
+				uint32_t const num_quads = static_cast<uint32_t>(quad.second.size() / 4);
+				checked_pointer_cast<UIRectRenderable>(iter->second->GetRenderable())->AddQuads(quad.second.data(), num_quads);
+				num_quads_ += num_quads;
+			}
+		}
+
+		for (auto const & str : geometry.strings)
 		{
 			auto const & font = font_cache_[str.first];
 			for (auto const & s : str.second)
@@ -948,6 +1027,13 @@ namespace KlayGE
 		}
 	}
 
+	void UIManager::AddQuads(TexturePtr const & texture, VertexFormat const * vertices, uint32_t num_quads)
+	{
+		auto& quads = curr_geometry_->quads[texture];
+		quads.insert(quads.end(), vertices, vertices + num_quads * 4);
+		curr_geometry_->num_quads += num_quads;
+	}
+
 	void UIManager::DrawRect(float3 const & pos, float width, float height, Color const * clrs,
 				IRect const & rcTexture, TexturePtr const & texture)
 	{
@@ -964,63 +1050,44 @@ namespace KlayGE
 			texcoord = Rect(0, 0, 0, 0);
 		}
 
-		std::shared_ptr<UIRectRenderable> renderable;
-		if (rects_.find(texture) == rects_.end())
+		VertexFormat const vertices[] =
 		{
-			renderable = MakeSharedPtr<UIRectRenderable>(texture, effect_);
-			rects_[texture] = renderable;
-		}
-		else
-		{
-			renderable = checked_pointer_cast<UIRectRenderable>(rects_[texture]);
-		}
-		BOOST_ASSERT(renderable);
-
-		std::vector<VertexFormat> vertices(4);
-		vertices[0] = VertexFormat(pos + float3(0, 0, 0),
-			clrs[0], float2(texcoord.left(), texcoord.top()));
-		vertices[1] = VertexFormat(pos + float3(width, 0, 0),
-			clrs[1], float2(texcoord.right(), texcoord.top()));
-		vertices[2] = VertexFormat(pos + float3(width, height, 0),
-			clrs[2], float2(texcoord.right(), texcoord.bottom()));
-		vertices[3] = VertexFormat(pos + float3(0, height, 0),
-			clrs[3], float2(texcoord.left(), texcoord.bottom()));
+			VertexFormat(pos + float3(0, 0, 0),
+				clrs[0], float2(texcoord.left(), texcoord.top())),
+			VertexFormat(pos + float3(width, 0, 0),
+				clrs[1], float2(texcoord.right(), texcoord.top())),
+			VertexFormat(pos + float3(width, height, 0),
+				clrs[2], float2(texcoord.right(), texcoord.bottom())),
+			VertexFormat(pos + float3(0, height, 0),
+				clrs[3], float2(texcoord.left(), texcoord.bottom()))
+		};
 
-		renderable->AddQuad(vertices);
+		this->AddQuads(texture, vertices, 1);
 	}
 
 	void UIManager::DrawQuad(float3 const & offset, VertexFormat const * vertices, TexturePtr const & texture)
 	{
-		std::shared_ptr<UIRectRenderable> renderable;
-		if (rects_.find(texture) == rects_.end())
+		VertexFormat const verts[] =
 		{
-			renderable = MakeSharedPtr<UIRectRenderable>(texture, effect_);
-			rects_[texture] = renderable;
-		}
-		else
-		{
-			renderable = checked_pointer_cast<UIRectRenderable>(rects_[texture]);
-		}
-		BOOST_ASSERT(renderable);
-
-		std::vector<VertexFormat> verts(4);
-		verts[0] = VertexFormat(offset + vertices[0].pos,
-			vertices[0].clr, vertices[0].tex);
-		verts[1] = VertexFormat(offset + vertices[1].pos,
-			vertices[1].clr, vertices[1].tex);
-		verts[2] = VertexFormat(offset + vertices[2].pos,
-			vertices[2].clr, vertices[2].tex);
-		verts[3] = VertexFormat(offset + vertices[3].pos,
-			vertices[3].clr, vertices[3].tex);
+			VertexFormat(offset + vertices[0].pos,
+				vertices[0].clr, vertices[0].tex),
+			VertexFormat(offset + vertices[1].pos,
+				vertices[1].clr, vertices[1].tex),
+			VertexFormat(offset + vertices[2].pos,
+				vertices[2].clr, vertices[2].tex),
+			VertexFormat(offset + vertices[3].pos,
+				vertices[3].clr, vertices[3].tex)
+		};
 
-		renderable->AddQuad(verts);
+		this->AddQuads(texture, verts, 1);
 	}
 
 	void UIManager::DrawString(std::wstring const & strText, uint32_t font_index,
 		IRect const & rc, float depth, Color const & clr, uint32_t align)
 	{
-		strings_[font_index].push_back(string_cache());
-		string_cache& sc = strings_[font_index].back();
+		auto& strings = curr_geometry_->strings[font_index];
+		strings.push_back(string_cache());
+		string_cache& sc = strings.back();
 		sc.rc = rc;
 		sc.depth = depth;
 		sc.clr = clr;
@@ -1232,7 +1299,8 @@ namespace KlayGE
 					caption_height_(18),
 					top_left_clr_(0, 0, 0, 0), top_right_clr_(0, 0, 0, 0),
 					bottom_left_clr_(0, 0, 0, 0), bottom_right_clr_(0, 0, 0, 0),
-					opacity_(0.5f)
+					opacity_(0.5f),
+					dirty_(true)
 	{
 		TexturePtr ct;
 		if (control_tex)
@@ -1270,6 +1338,7 @@ namespace KlayGE
 
 		// Add to the list
 		controls_.push_back(control);
+		dirty_ = true;
 	}
 
 	void UIDialog::InitControl(UIControl& control)
@@ -1497,6 +1566,15 @@ namespace KlayGE
 		}
 	}
 
+	bool UIDialog::NeedsRebuild() const
+	{
+		return dirty_ || std::any_of(controls_.begin(), controls_.end(),
+			[](UIControlPtr const & control)
+			{
+				return control->GetVisible() && control->IsAnimated();
+			});
+	}
+
 	void UIDialog::RequestFocus(UIControl& control)
 	{
 		if ((control_focus_.lock().get() != &control) && control.CanHaveFocus())
@@ -1523,6 +1601,7 @@ namespace KlayGE
 		top_right_clr_ = colorTopRight;
 		bottom_left_clr_ = colorBottomLeft;
 		bottom_right_clr_ = colorBottomRight;
+		dirty_ = true;
 	}
 
 	bool UIDialog::ContainsPoint(int2 const & pt) const
@@ -1632,6 +1711,7 @@ namespace KlayGE
 				}
 
 				controls_.erase(controls_.begin() + i);
+				dirty_ = true;
 
 				return;
 			}
@@ -1647,6 +1727,7 @@ namespace KlayGE
 		control_mouse_over_.reset();
 
 		controls_.clear();
+		dirty_ = true;
 	}
 
 	// Device state notification
@@ -1671,6 +1752,8 @@ namespace KlayGE
 		{
 			this->FocusDefaultControl();
 		}
+
+		dirty_ = true;
 	}
 
 	// Shared resource access. Indexed fonts and textures are shared among
@@ -1683,6 +1766,7 @@ namespace KlayGE
 			fonts_.resize(index + 1, -1);
 		}
 		fonts_[index] = static_cast<int>(UIManager::Instance().AddFont(font, font_size));
+		dirty_ = true;
 	}
 
 	FontPtr const & UIDialog::GetFont(size_t index) const
@@ -1954,6 +2038,8 @@ namespace KlayGE
 
 	void UIDialog::KeyDownHandler(uint32_t key)
 	{
+		dirty_ = true;
+
 		if (control_focus_.lock() && control_focus_.lock()->GetEnabled())
 		{
 			control_focus_.lock()->KeyDownHandler(*this, key);
@@ -2016,6 +2102,8 @@ namespace KlayGE
 
 	void UIDialog::KeyUpHandler(uint32_t key)
 	{
+		dirty_ = true;
+
 		if (control_focus_.lock() && control_focus_.lock()->GetEnabled())
 		{
 			control_focus_.lock()->KeyUpHandler(*this, key);
@@ -2033,6 +2121,8 @@ namespace KlayGE
 
 	void UIDialog::MouseDownHandler(uint32_t buttons, int2 const & pt)
 	{
+		dirty_ = true;
+
 		int2 const local_pt = this->ToLocal(pt);
 
 		UIControlPtr control;
@@ -2072,6 +2162,8 @@ namespace KlayGE
 
 	void UIDialog::MouseUpHandler(uint32_t buttons, int2 const & pt)
 	{
+		dirty_ = true;
+
 		int2 const local_pt = this->ToLocal(pt);
 
 		UIControlPtr control;
@@ -2111,6 +2203,8 @@ namespace KlayGE
 
 	void UIDialog::MouseWheelHandler(uint32_t buttons, int2 const & pt, int32_t z_delta)
 	{
+		dirty_ = true;
+
 		int2 const local_pt = this->ToLocal(pt);
 
 		UIControlPtr control;
@@ -2150,6 +2244,8 @@ namespace KlayGE
 
 	void UIDialog::MouseOverHandler(uint32_t buttons, int2 const & pt)
 	{
+		dirty_ = true;
+
 		int2 const local_pt = this->ToLocal(pt);
 
 		UIControlPtr control;
@@ -180,6 +180,7 @@ namespace KlayGE
 	void UIButton::SetText(std::wstring const & strText)
 	{
 		text_ = strText;
+		this->Invalidate();
 	}
 
 	void UIButton::OnHotkey()
@@ -117,6 +117,8 @@ namespace KlayGE
 	{
 		checked_ = bChecked;
 
+		this->Invalidate();
+
 		this->OnChangedEvent()(*this);
 	}
 
@@ -127,6 +129,7 @@ namespace KlayGE
 		text_rc_.left() += static_cast<int32_t>(1.25f * button_rc_.Width());
 
 		bounding_box_ = button_rc_ | text_rc_;
+		this->Invalidate();
 	}
 
 	void UICheckBox::Render()
@@ -187,6 +190,7 @@ namespace KlayGE
 	void UICheckBox::SetText(std::wstring const & strText)
 	{
 		text_ = strText;
+		this->Invalidate();
 	}
 
 	void UICheckBox::OnHotkey()
@@ -107,6 +107,7 @@ namespace KlayGE
 		{
 			dropdown_element->FontColor().States[UICS_Normal] = color;
 		}
+		this->Invalidate();
 	}
 
 	void UIComboBox::OnFocusOut()
@@ -612,6 +613,7 @@ namespace KlayGE
 		{
 			selected_ = static_cast<int>(items_.size() - 1);
 		}
+		this->Invalidate();
 	}
 
 	void UIComboBox::RemoveAllItems()
@@ -619,6 +621,7 @@ namespace KlayGE
 		items_.clear();
 		scroll_bar_.SetTrackRange(0, 1);
 		focused_ = selected_ = -1;
+		this->Invalidate();
 	}
 
 	bool UIComboBox::ContainsItem(std::wstring const & strText, uint32_t iStart) const
@@ -698,6 +701,8 @@ namespace KlayGE
 		BOOST_ASSERT(index < this->GetNumItems());
 
 		focused_ = selected_ = index;
+		this->Invalidate();
+
 		this->OnSelectionChangedEvent()(*this);
 	}
 
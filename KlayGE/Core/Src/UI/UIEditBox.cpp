@@ -352,6 +352,7 @@ namespace KlayGE
 		first_visible_ = 0;
 		this->PlaceCaret(0);
 		sel_start_ = 0;
+		this->Invalidate();
 	}
 
 	void UIEditBox::SetText(std::wstring const & wszText, bool bSelected)
@@ -361,6 +362,7 @@ namespace KlayGE
 		// Move the caret to the end of the text
 		this->PlaceCaret(buffer_.GetTextSize());
 		sel_start_ = bSelected ? 0 : caret_pos_;
+		this->Invalidate();
 	}
 
 	void UIEditBox::DeleteSelectionText()
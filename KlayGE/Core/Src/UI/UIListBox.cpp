@@ -146,6 +146,7 @@ namespace KlayGE
 
 		items_.insert(items_.begin() + nIndex, pNewItem);
 		scroll_bar_.SetTrackRange(0, items_.size());
+		this->Invalidate();
 	}
 
 	void UIListBox::RemoveItem(int nIndex)
@@ -159,6 +160,8 @@ namespace KlayGE
 			selected_ = static_cast<int>(items_.size() - 1);
 		}
 
+		this->Invalidate();
+
 		this->OnSelectionEvent()(*this);
 	}
 
@@ -166,6 +169,7 @@ namespace KlayGE
 	{
 		items_.clear();
 		scroll_bar_.SetTrackRange(0, 1);
+		this->Invalidate();
 	}
 
 	std::shared_ptr<UIListBoxItem> UIListBox::GetItem(int nIndex) const
@@ -245,6 +249,8 @@ namespace KlayGE
 			scroll_bar_.ShowItem(selected_);
 		}
 
+		this->Invalidate();
+
 		this->OnSelectionEvent()(*this);
 	}
 
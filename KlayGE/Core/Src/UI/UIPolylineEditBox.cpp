@@ -91,6 +91,7 @@ namespace KlayGE
 		active_pt_ = -1;
 		ctrl_points_.clear();
 		move_point_ = false;
+		this->Invalidate();
 	}
 
 	int UIPolylineEditBox::AddCtrlPoint(float pos, float value)
@@ -143,16 +144,19 @@ namespace KlayGE
 	void UIPolylineEditBox::SetCtrlPoint(int index, float pos, float value)
 	{
 		ctrl_points_[index] = float2(pos, value);
+		this->Invalidate();
 	}
 
 	void UIPolylineEditBox::SetCtrlPoints(std::vector<float2> const & ctrl_points)
 	{
 		ctrl_points_ = ctrl_points;
+		this->Invalidate();
 	}
 
 	void UIPolylineEditBox::SetColor(Color const & clr)
 	{
 		elements_[POLYLINE_INDEX]->TextureColor().States[UICS_Normal] = clr;
+		this->Invalidate();
 	}
 
 	size_t UIPolylineEditBox::NumCtrlPoints() const
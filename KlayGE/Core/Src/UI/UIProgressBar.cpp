@@ -63,6 +63,7 @@ namespace KlayGE
 	void UIProgressBar::SetValue(int value)
 	{
 		progress_ = value;
+		this->Invalidate();
 	}
 	
 	int UIProgressBar::GetValue() const
@@ -129,6 +129,8 @@ namespace KlayGE
 		}
 
 		checked_ = bChecked;
+		this->Invalidate();
+
 		this->OnChangedEvent()(*this);
 	}
 
@@ -203,6 +205,7 @@ namespace KlayGE
 	void UIRadioButton::SetText(std::wstring const & strText)
 	{
 		text_ = strText;
+		this->Invalidate();
 	}
 
 	void UIRadioButton::OnHotkey()
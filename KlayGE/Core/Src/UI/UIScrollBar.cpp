@@ -139,6 +139,7 @@ namespace KlayGE
 			thumb_rc_.bottom() = thumb_rc_.top();
 			show_thumb_ = false;
 		}
+		this->Invalidate();
 	}
 
 	// Scroll() scrolls by nDelta items.  A positive value scrolls down, while a negative
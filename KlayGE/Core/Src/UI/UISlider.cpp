@@ -209,6 +209,7 @@ namespace KlayGE
 
 		value_ = nValue;
 		this->UpdateRects();
+		this->Invalidate();
 
 		this->OnValueChangedEvent()(*this);
 	}
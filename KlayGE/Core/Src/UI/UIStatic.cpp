@@ -70,6 +70,11 @@ namespace KlayGE
 
 	void UIStatic::SetText(std::wstring const & strText)
 	{
-		text_ = strText;
+		// Often set every frame with the same text
+		if (text_ != strText)
+		{
+			text_ = strText;
+			this->Invalidate();
+		}
 	}
 }
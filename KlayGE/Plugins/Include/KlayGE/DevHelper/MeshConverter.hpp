@@ -34,6 +34,7 @@
 #pragma once
 
 #include <KlayGE/PreDeclare.hpp>
+#include <KFL/ArrayRef.hpp>
 #include <KFL/CXX17/string_view.hpp>
 #include <KlayGE/Mesh.hpp>
 
@@ -50,9 +51,20 @@ namespace KlayGE
 {
 	class KLAYGE_DEV_HELPER_API MeshConverter
 	{
+	public:
+		// Post-transform vertex cache efficiency. ACMR is the average cache miss ratio per triangle,
+		// ATVR is the average transform to vertex ratio.
+		struct VertexCacheStats
+		{
+			float acmr;
+			float atvr;
+		};
+
 	public:
 		RenderModelPtr Load(std::string_view input_name, MeshMetadata const & metadata);
 		void Save(RenderModel& model, std::string_view output_name);
+
+		static VertexCacheStats AnalyzeVertexCache(ArrayRef<uint32_t> indices, uint32_t num_vertices);
 	};
 }
 
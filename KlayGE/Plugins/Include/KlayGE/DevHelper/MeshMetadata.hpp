@@ -112,6 +112,15 @@ namespace KlayGE
 			flip_winding_order_ = flip_winding_order;
 		}
 
+		bool OptimizeMesh() const
+		{
+			return optimize_mesh_;
+		}
+		void OptimizeMesh(bool optimize_mesh)
+		{
+			optimize_mesh_ = optimize_mesh;
+		}
+
 		uint32_t NumLods() const;
 		void NumLods(uint32_t lods);
 		std::string_view LodFileName(uint32_t lod) const;
@@ -137,6 +146,7 @@ namespace KlayGE
 		float3 scale_ = float3(1, 1, 1);
 		uint8_t axis_mapping_[3] = { 0, 1, 2 };
 		bool flip_winding_order_ = false;
+		bool optimize_mesh_ = true;
 		std::vector<std::string> lod_file_names_;
 
 		float4x4 transform_ = float4x4::Identity();
@@ -137,6 +137,16 @@ namespace KlayGE
 		void LinearMipmap(bool linear)
 		{
 			mipmap_.linear = linear;
+			mipmap_.filter = linear ? RF_Linear : RF_Point;
+		}
+		ResizeFilter MipmapFilter() const
+		{
+			return mipmap_.filter;
+		}
+		void MipmapFilter(ResizeFilter filter)
+		{
+			mipmap_.filter = filter;
+			mipmap_.linear = (filter != RF_Point);
 		}
 
 		bool BumpToNormal() const
@@ -194,6 +204,7 @@ namespace KlayGE
 			bool auto_gen = true;
 			uint32_t num_levels = 0;
 			bool linear = true;
+			ResizeFilter filter = RF_Linear;
 		};
 		Mipmap mipmap_;
 
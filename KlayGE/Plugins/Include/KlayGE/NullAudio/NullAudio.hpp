@@ -34,6 +34,10 @@
 #pragma once
 
 #include <KlayGE/PreDeclare.hpp>
+#include <KFL/Timer.hpp>
+
+#include <atomic>
+#include <vector>
 
 #include <KlayGE/Audio.hpp>
 
@@ -89,11 +93,18 @@ namespace KlayGE
 		void DoReset() override;
 		void DoPlay(bool loop) override;
 		void DoStop() override;
+		void DoUpdateBuffer() override;
 
 	private:
 		float3 pos_;
 		float3 vel_;
 		float3 dir_;
+
+		// Playback is simulated by consuming the stream in real time
+		std::atomic<bool> playing_;
+		Timer play_timer_;
+		uint64_t played_bytes_;
+		std::vector<uint8_t> data_;
 	};
 
 	class NullAudioEngine : public AudioEngine
@@ -49,6 +49,8 @@ namespace KlayGE
 		std::any Value(std::string const & name) override;
 		std::any Call(std::string const & func_name, ArrayRef<std::any> args) override;
 		std::any RunString(std::string const & script) override;
+
+		ScriptFunctionPtr Function(std::string const & name) override;
 	};
 
 	class NullScriptEngine : public ScriptEngine
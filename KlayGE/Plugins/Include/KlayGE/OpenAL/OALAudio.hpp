@@ -34,7 +34,6 @@
 #pragma once
 
 #include <KlayGE/PreDeclare.hpp>
-#include <KFL/Thread.hpp>
 
 #if (defined KLAYGE_PLATFORM_DARWIN) || (defined KLAYGE_PLATFORM_IOS)
 #include <OpenAL/al.h>
@@ -104,24 +103,19 @@ namespace KlayGE
 		float3 Direction() const override;
 		void Direction(float3 const & v) override;
 
-		void LoopUpdateBuffer();
-
 	private:
 		void DoReset() override;
 		void DoPlay(bool loop) override;
 		void DoStop() override;
+		void DoUpdateBuffer() override;
+
+		void QueueFreeBuffers();
 
 	private:
 		ALuint source_;
 		std::vector<ALuint> buffer_queue_;
-
-		bool loop_;
-
-		bool played_;
-		bool stopped_;
-		std::condition_variable play_cond_;
-		std::mutex play_mutex_;
-		joiner<void> play_thread_;
+		std::vector<ALuint> free_buffers_;
+		std::vector<uint8_t> data_;
 	};
 
 	class OALAudioEngine : public AudioEngine
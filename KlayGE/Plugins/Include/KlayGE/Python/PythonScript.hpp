@@ -54,6 +54,7 @@
 #endif
 #include <vector>
 #include <string>
+#include <unordered_map>
 
 #include <KlayGE/PreDeclare.hpp>
 #include <KlayGE/Script.hpp>
@@ -85,6 +86,23 @@ namespace KlayGE
 	PyObjectPtr CppType2PyObjectPtr(PyObjectPtr const & t);
 	PyObjectPtr CppType2PyObjectPtr(std::any const & t);
 
+	// Py Script function
+	/////////////////////////////////////////////////////////////////////////////////
+	class PythonScriptFunction : public ScriptFunction
+	{
+	public:
+		explicit PythonScriptFunction(PyObjectPtr const & func);
+
+		std::any Call(ArrayRef<std::any> args) override;
+		std::any CallArgs(ArrayRef<ScriptArg> args) override;
+		using ScriptFunction::Call;
+
+		void CallBatch(ArrayRef<ScriptArg> args, uint32_t num_args_per_call, std::vector<std::any>* results) override;
+
+	private:
+		PyObjectPtr func_;
+	};
+
 	// Py Script module
 	/////////////////////////////////////////////////////////////////////////////////
 	class PythonScriptModule : public ScriptModule
@@ -97,9 +115,13 @@ namespace KlayGE
 		std::any Call(std::string const & func_name, ArrayRef<std::any> args) override;
 		std::any RunString(std::string const & script) override;
 
+		ScriptFunctionPtr Function(std::string const & name) override;
+
 	private:
 		PyObjectPtr module_;
 		PyObjectPtr dict_;
+
+		std::unordered_map<std::string, PyObjectPtr> code_cache_;
 	};
 
 	class PythonEngine : public ScriptEngine
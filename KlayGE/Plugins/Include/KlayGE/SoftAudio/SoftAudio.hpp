@@ -0,0 +1,277 @@
+/**
+ * @file SoftAudio.hpp
+ * @author Minmin Gong
+ *
+ * @section DESCRIPTION
+ *
+ * This source file is part of KlayGE
+ * For the latest info, see http://www.klayge.org
+ *
+ * @section LICENSE
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * You may alternatively use this source under the terms of
+ * the KlayGE Proprietary License (KPL). You can obtained such a license
+ * from http://www.klayge.org/licensing/.
+ */
+
+#ifndef KLAYGE_PLUGINS_SOFT_AUDIO_HPP
+#define KLAYGE_PLUGINS_SOFT_AUDIO_HPP
+
+#pragma once
+
+#include <KlayGE/PreDeclare.hpp>
+#include <KFL/Thread.hpp>
+
+#if (defined KLAYGE_PLATFORM_DARWIN) || (defined KLAYGE_PLATFORM_IOS)
+#include <OpenAL/al.h>
+#include <OpenAL/alc.h>
+#else
+#include <AL/al.h>
+#include <AL/alc.h>
+#endif
+
+#include <vector>
+
+#include <KlayGE/Audio.hpp>
+#include <KlayGE/AudioMixer.hpp>
+
+namespace KlayGE
+{
+	class SoftAudioEngine;
+
+	uint32_t NumChannels(AudioFormat format);
+	uint32_t NumBytesPerSample(AudioFormat format);
+	// 8-bit samples are unsigned, 16-bit ones signed little-endian
+	void PCMToFloat(AudioFormat format, void const * pcm, uint32_t num_samples, float* samples);
+
+	// Voice parameters are only touched with the engine's mixing mutex locked
+	class SoftAudioVoice : public AudioVoice
+	{
+	public:
+		SoftAudioVoice(uint32_t num_channels, uint32_t freq, float volume, float3 const & pos, float3 const & vel);
+
+		void Volume(float vol);
+		void Position(float3 const & v);
+		void Velocity(float3 const & v);
+
+		// Mono voices are spatialized, stereo ones only take the volume
+		void UpdateGains(float3 const & listener_pos, float3 const & listener_vel,
+			float3 const & listener_face, float3 const & listener_up);
+
+	private:
+		float volume_;
+		float3 pos_;
+		float3 vel_;
+	};
+	typedef std::shared_ptr<SoftAudioVoice> SoftAudioVoicePtr;
+
+	// Plays from the PCM shared by all voices of a sound, converting it to floats while mixing
+	class SoftClipVoice : public SoftAudioVoice
+	{
+	public:
+		SoftClipVoice(std::shared_ptr<std::vector<uint8_t> const> const & pcm, AudioFormat format, uint32_t freq, bool loop,
+			float volume, float3 const & pos, float3 const & vel);
+
+	private:
+		uint32_t Fetch(float* samples, uint32_t num_frames) override;
+
+	private:
+		std::shared_ptr<std::vector<uint8_t> const> pcm_;
+		AudioFormat format_;
+		uint32_t block_align_;
+		uint32_t num_frames_;
+		uint32_t frame_;
+		bool loop_;
+	};
+
+	// Plays from the ring buffer of a music stream
+	class SoftStreamVoice : public SoftAudioVoice
+	{
+	public:
+		SoftStreamVoice(AudioStreamPtr const & stream, AudioFormat format, uint32_t freq,
+			float volume, float3 const & pos, float3 const & vel);
+
+	private:
+		uint32_t Fetch(float* samples, uint32_t num_frames) override;
+
+	private:
+		AudioStreamPtr stream_;
+		AudioFormat format_;
+		std::vector<uint8_t> pcm_;
+	};
+
+	class SoftSoundBuffer : public SoundBuffer
+	{
+	public:
+		SoftSoundBuffer(AudioDataSourcePtr const & data_source, uint32_t num_sources, float volume);
+		~SoftSoundBuffer() override;
+
+		void Play(bool loop = false) override;
+		void Stop() override;
+
+		void Volume(float vol) override;
+
+		bool IsPlaying() const override;
+
+		float3 Position() const override;
+		void Position(float3 const & v) override;
+		float3 Velocity() const override;
+		void Velocity(float3 const & v) override;
+		float3 Direction() const override;
+		void Direction(float3 const & v) override;
+
+	private:
+		void DoReset() override;
+
+	private:
+		SoftAudioEngine& engine_;
+
+		std::vector<SoftAudioVoicePtr> voices_;
+		uint32_t next_voice_;
+
+		float volume_;
+		float3 pos_;
+		float3 vel_;
+		float3 dir_;
+	};
+
+	class SoftMusicBuffer : public MusicBuffer
+	{
+	public:
+		SoftMusicBuffer(AudioDataSourcePtr const & data_source, uint32_t buffer_seconds, float volume);
+		~SoftMusicBuffer() override;
+
+		void Volume(float vol) override;
+
+		bool IsPlaying() const override;
+
+		float3 Position() const override;
+		void Position(float3 const & v) override;
+		float3 Velocity() const override;
+		void Velocity(float3 const & v) override;
+		float3 Direction() const override;
+		void Direction(float3 const & v) override;
+
+	private:
+		void DoReset() override;
+		void DoPlay(bool loop) override;
+		void DoStop() override;
+		void DoUpdateBuffer() override;
+
+	private:
+		SoftAudioEngine& engine_;
+
+		SoftAudioVoicePtr voice_;
+
+		float volume_;
+		float3 pos_;
+		float3 vel_;
+		float3 dir_;
+	};
+
+	// Plays the mixed frames on the default OpenAL device, through a small queue of buffers
+	class SoftDeviceSink : public AudioSink
+	{
+	public:
+		explicit SoftDeviceSink(uint32_t freq);
+		~SoftDeviceSink() override;
+
+		// False if no device could be opened
+		bool Valid() const
+		{
+			return context_ != nullptr;
+		}
+
+		void Write(float const * frames, uint32_t num_frames) override;
+
+	private:
+		uint32_t freq_;
+		ALCdevice* device_;
+		ALCcontext* context_;
+		ALuint source_;
+		std::vector<ALuint> buffers_;
+		std::vector<ALuint> free_buffers_;
+		std::vector<int16_t> pcm_;
+	};
+
+	// Mixes all buffers on the CPU. By default a thread mixes in real time into an SoftDeviceSink, or a NullAudioSink if there
+	// is no device. An offline sink, such as a WavAudioSink, is fed by Render instead, which makes the output deterministic.
+	class SoftAudioEngine : public AudioEngine
+	{
+	public:
+		SoftAudioEngine();
+		~SoftAudioEngine() override;
+
+		std::wstring const & Name() const override;
+
+		float3 GetListenerPos() const override;
+		void SetListenerPos(float3 const & v) override;
+		float3 GetListenerVel() const override;
+		void SetListenerVel(float3 const & v) override;
+		void GetListenerOri(float3& face, float3& up) const override;
+		void SetListenerOri(float3 const & face, float3 const & up) override;
+
+		uint32_t Freq() const
+		{
+			return mixer_.Freq();
+		}
+
+		void Output(AudioSinkPtr const & sink, bool real_time);
+		// Offline output only. Decodes the music, mixes num_frames frames and writes them to the sink.
+		void Render(uint32_t num_frames);
+
+		uint32_t NumActiveVoices() const;
+
+		// Used by the buffers
+		void StartVoice(SoftAudioVoicePtr const & voice);
+		void StopVoice(SoftAudioVoice const * voice);
+		bool IsVoicePlaying(SoftAudioVoice const * voice) const;
+		std::mutex& MixMutex() const
+		{
+			return mix_mutex_;
+		}
+
+	private:
+		void DoSuspend() override;
+		void DoResume() override;
+
+		void StartMixThread();
+		void StopMixThread();
+		void MixThreadFunc();
+		void MixBlock(uint32_t num_frames);
+
+	private:
+		float3 pos_;
+		float3 vel_;
+		float3 face_;
+		float3 up_;
+
+		AudioMixer mixer_;
+		std::vector<SoftAudioVoicePtr> voices_;
+		std::vector<float> mix_buff_;
+		mutable std::mutex mix_mutex_;
+
+		AudioSinkPtr sink_;
+		bool real_time_;
+
+		bool quit_;
+		std::condition_variable quit_cond_;
+		std::unique_ptr<joiner<void>> mix_thread_;
+	};
+}
+
+#endif		// KLAYGE_PLUGINS_SOFT_AUDIO_HPP
@@ -35,10 +35,9 @@
 namespace KlayGE
 {
 	NullMusicBuffer::NullMusicBuffer(AudioDataSourcePtr const & data_source, uint32_t buffer_seconds, float volume)
-					: MusicBuffer(data_source)
+					: MusicBuffer(data_source, buffer_seconds),
+						playing_(false), played_bytes_(0)
 	{
-		KFL_UNUSED(buffer_seconds);
-
 		this->Position(float3::Zero());
 		this->Velocity(float3::Zero());
 		this->Direction(float3::Zero());
@@ -61,15 +60,48 @@ namespace KlayGE
 	void NullMusicBuffer::DoPlay(bool loop)
 	{
 		KFL_UNUSED(loop);
+
+		play_timer_.restart();
+		played_bytes_ = 0;
+		playing_ = true;
 	}
 
 	void NullMusicBuffer::DoStop()
 	{
+		playing_ = false;
+	}
+
+	void NullMusicBuffer::DoUpdateBuffer()
+	{
+		if (!playing_)
+		{
+			return;
+		}
+
+		uint32_t const block_align = stream_->BlockAlign();
+		uint64_t const due_bytes = static_cast<uint64_t>(play_timer_.elapsed() * stream_->BytesPerSecond()) / block_align * block_align;
+		data_.resize(static_cast<size_t>(due_bytes - played_bytes_));
+		size_t const read_size = stream_->Read(data_.data(), data_.size());
+		if (read_size < data_.size())
+		{
+			// Like a starved device, playback resumes from here once data arrives
+			play_timer_.restart();
+			played_bytes_ = 0;
+		}
+		else
+		{
+			played_bytes_ += read_size;
+		}
+
+		if (stream_->EndOfStream())
+		{
+			playing_ = false;
+		}
 	}
 
 	bool NullMusicBuffer::IsPlaying() const
 	{
-		return false;
+		return playing_;
 	}
 
 	void NullMusicBuffer::Volume(float vol)
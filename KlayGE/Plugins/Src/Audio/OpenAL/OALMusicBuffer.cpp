@@ -34,15 +34,15 @@
 
 #include <KlayGE/OpenAL/OALAudio.hpp>
 
-size_t constexpr READ_SIZE = 88200;
-
 namespace KlayGE
 {
 	OALMusicBuffer::OALMusicBuffer(AudioDataSourcePtr const & data_source, uint32_t buffer_seconds, float volume)
-							: MusicBuffer(data_source),
-								buffer_queue_(buffer_seconds * BUFFERS_PER_SECOND),
-								played_(false), stopped_(true)
+							: MusicBuffer(data_source, buffer_seconds),
+								buffer_queue_(buffer_seconds * BUFFERS_PER_SECOND)
 	{
+		uint32_t const buffer_size = stream_->BytesPerSecond() / BUFFERS_PER_SECOND;
+		data_.resize(buffer_size - buffer_size % stream_->BlockAlign());
+
 		alGenBuffers(static_cast<ALsizei>(buffer_queue_.size()), buffer_queue_.data());
 
 		alGenSources(1, &source_);
@@ -65,107 +65,71 @@ namespace KlayGE
 		alDeleteSources(1, &source_);
 	}
 
-	void OALMusicBuffer::LoopUpdateBuffer()
+	void OALMusicBuffer::DoUpdateBuffer()
 	{
-		std::unique_lock<std::mutex> lock(play_mutex_);
-		while (!played_)
+		ALint processed;
+		alGetSourcei(source_, AL_BUFFERS_PROCESSED, &processed);
+		while (processed > 0)
 		{
-			play_cond_.wait(lock);
+			-- processed;
+
+			ALuint buf;
+			alSourceUnqueueBuffers(source_, 1, &buf);
+			free_buffers_.push_back(buf);
 		}
-		played_ = false;
 
-		while (!stopped_)
+		this->QueueFreeBuffers();
+
+		// A source that ran out of buffers stops by itself. Restart it once the stream catches up.
+		ALint state;
+		alGetSourcei(source_, AL_SOURCE_STATE, &state);
+		if ((AL_STOPPED == state) && (free_buffers_.size() < buffer_queue_.size()))
 		{
-			ALint processed;
-			alGetSourcei(source_, AL_BUFFERS_PROCESSED, &processed);
-			if (processed > 0)
-			{
-				while (processed > 0)
-				{
-					-- processed;
-
-					ALuint buf;
-					alSourceUnqueueBuffers(source_, 1, &buf);
-
-					std::vector<uint8_t> data(READ_SIZE);
-					data.resize(data_source_->Read(data.data(), data.size()));
-					if (data.empty())
-					{
-						if (loop_)
-						{
-							stopped_ = false;
-							alSourceStopv(1, &source_);
-							this->DoReset();
-							alSourcePlay(source_);
-						}
-						else
-						{
-							stopped_ = true;
-						}
-					}
-					else
-					{
-						alBufferData(buf, Convert(format_), data.data(), static_cast<ALsizei>(data.size()), freq_);
-						alSourceQueueBuffers(source_, 1, &buf);
-					}
-				}
-			}
-			else
-			{
-				Sleep(1000 / BUFFERS_PER_SECOND);
-			}
+			alSourcePlay(source_);
 		}
 	}
 
-	void OALMusicBuffer::DoReset()
+	void OALMusicBuffer::QueueFreeBuffers()
 	{
-		ALint queued_;
-		alGetSourcei(source_, AL_BUFFERS_QUEUED, &queued_);
-		if (queued_ > 0)
+		ALenum const format = Convert(format_);
+		while (!free_buffers_.empty())
 		{
-			std::vector<ALuint> cur_queue(queued_);
-			alSourceUnqueueBuffers(source_, queued_, &cur_queue[0]);
-		}
-
-		ALenum const format(Convert(format_));
-		std::vector<uint8_t> data(READ_SIZE);
-
-		data_source_->Reset();
-
-		ALsizei non_empty_buf = 0;
-		// Load 1 / BUFFERS_PER_SECOND second data to each buffer
-		for (auto const & buf : buffer_queue_)
-		{
-			data.resize(data_source_->Read(data.data(), data.size()));
-			if (data.empty())
+			size_t const size = stream_->Read(data_.data(), data_.size());
+			if (0 == size)
 			{
 				break;
 			}
-			else
-			{
-				++ non_empty_buf;
-				alBufferData(buf, format, data.data(),
-					static_cast<ALuint>(data.size()), static_cast<ALuint>(freq_));
-			}
+
+			ALuint const buf = free_buffers_.back();
+			free_buffers_.pop_back();
+			alBufferData(buf, format, data_.data(), static_cast<ALsizei>(size), static_cast<ALsizei>(freq_));
+			alSourceQueueBuffers(source_, 1, &buf);
 		}
+	}
 
-		alSourceQueueBuffers(source_, non_empty_buf, buffer_queue_.data());
+	void OALMusicBuffer::DoReset()
+	{
+		alSourceStopv(1, &source_);
+
+		ALint queued;
+		alGetSourcei(source_, AL_BUFFERS_QUEUED, &queued);
+		if (queued > 0)
+		{
+			std::vector<ALuint> cur_queue(queued);
+			alSourceUnqueueBuffers(source_, queued, cur_queue.data());
+		}
+		free_buffers_ = buffer_queue_;
 
 		alSourceRewindv(1, &source_);
 	}
 
 	void OALMusicBuffer::DoPlay(bool loop)
 	{
-		play_thread_ = Context::Instance().ThreadPool()([this] { this->LoopUpdateBuffer(); });
-
-		loop_ = loop;
+		// Looping is done by the stream, the source only sees a continuous queue
+		KFL_UNUSED(loop);
 
-		stopped_ = false;
-		{
-			std::lock_guard<std::mutex> lock(play_mutex_);
-			played_ = true;
-		}
-		play_cond_.notify_one();
+		this->DoReset();
+		this->QueueFreeBuffers();
 
 		alSourcei(source_, AL_LOOPING, false);
 		alSourcePlay(source_);
@@ -173,12 +137,6 @@ namespace KlayGE
 
 	void OALMusicBuffer::DoStop()
 	{
-		if (!stopped_)
-		{
-			stopped_ = true;
-			play_thread_();
-		}
-
 		alSourceStopv(1, &source_);
 	}
 
@@ -55,11 +55,7 @@ namespace KlayGE
 							sources_(num_sources)
 	{
 		alGenBuffers(1, &buffer_);
-
-		std::vector<uint8_t> data(data_source_->Size());
-		data_source_->Read(data.data(), data.size());
-
-		alBufferData(buffer_, Convert(format_), data.data(), static_cast<ALsizei>(data.size()), freq_);
+		alBufferData(buffer_, Convert(format_), pcm_->data(), static_cast<ALsizei>(pcm_->size()), freq_);
 
 		alGenSources(static_cast<ALsizei>(sources_.size()), sources_.data());
 
@@ -0,0 +1,272 @@
+/**
+ * @file SoftAudioEngine.cpp
+ * @author Minmin Gong
+ *
+ * @section DESCRIPTION
+ *
+ * This source file is part of KlayGE
+ * For the latest info, see http://www.klayge.org
+ *
+ * @section LICENSE
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * You may alternatively use this source under the terms of
+ * the KlayGE Proprietary License (KPL). You can obtained such a license
+ * from http://www.klayge.org/licensing/.
+ */
+
+#include <KlayGE/KlayGE.hpp>
+#include <KFL/Log.hpp>
+#include <KlayGE/Context.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <ostream>
+
+#include <boost/assert.hpp>
+
+#include <KlayGE/SoftAudio/SoftAudio.hpp>
+
+namespace
+{
+	uint32_t constexpr MIX_FREQ = 48000;
+	// About 5ms a block
+	uint32_t constexpr BLOCK_FRAMES = 256;
+	// The real time thread keeps this many blocks mixed ahead of the clock
+	uint32_t constexpr LEAD_BLOCKS = 2;
+	uint32_t constexpr MIX_THREAD_PERIOD_MS = 5;
+}
+
+namespace KlayGE
+{
+	SoftAudioEngine::SoftAudioEngine()
+		: mixer_(MIX_FREQ), mix_buff_(BLOCK_FRAMES * 2),
+			real_time_(true), quit_(false)
+	{
+		auto device_sink = MakeSharedPtr<SoftDeviceSink>(MIX_FREQ);
+		if (device_sink->Valid())
+		{
+			sink_ = device_sink;
+		}
+		else
+		{
+			LogWarn() << "SoftAudio can't open an audio device, the output is discarded." << std::endl;
+			sink_ = MakeSharedPtr<NullAudioSink>();
+		}
+
+		this->SetListenerPos(float3(0, 0, 0));
+		this->SetListenerVel(float3(0, 0, 0));
+		this->SetListenerOri(float3(0, 0, 1), float3(0, 1, 0));
+
+		this->StartMixThread();
+	}
+
+	SoftAudioEngine::~SoftAudioEngine()
+	{
+		audio_buffs_.clear();
+
+		this->StopMixThread();
+	}
+
+	void SoftAudioEngine::DoSuspend()
+	{
+		this->StopMixThread();
+	}
+
+	void SoftAudioEngine::DoResume()
+	{
+		if (real_time_)
+		{
+			this->StartMixThread();
+		}
+	}
+
+	std::wstring const & SoftAudioEngine::Name() const
+	{
+		static std::wstring const name(L"Soft Audio Engine");
+		return name;
+	}
+
+	float3 SoftAudioEngine::GetListenerPos() const
+	{
+		std::lock_guard<std::mutex> lock(mix_mutex_);
+		return pos_;
+	}
+
+	void SoftAudioEngine::SetListenerPos(float3 const & v)
+	{
+		std::lock_guard<std::mutex> lock(mix_mutex_);
+		pos_ = v;
+	}
+
+	float3 SoftAudioEngine::GetListenerVel() const
+	{
+		std::lock_guard<std::mutex> lock(mix_mutex_);
+		return vel_;
+	}
+
+	void SoftAudioEngine::SetListenerVel(float3 const & v)
+	{
+		std::lock_guard<std::mutex> lock(mix_mutex_);
+		vel_ = v;
+	}
+
+	void SoftAudioEngine::GetListenerOri(float3& face, float3& up) const
+	{
+		std::lock_guard<std::mutex> lock(mix_mutex_);
+		face = face_;
+		up = up_;
+	}
+
+	void SoftAudioEngine::SetListenerOri(float3 const & face, float3 const & up)
+	{
+		std::lock_guard<std::mutex> lock(mix_mutex_);
+		face_ = face;
+		up_ = up;
+	}
+
+	void SoftAudioEngine::Output(AudioSinkPtr const & sink, bool real_time)
+	{
+		BOOST_ASSERT(sink);
+
+		this->StopMixThread();
+
+		sink_ = sink;
+		real_time_ = real_time;
+
+		if (real_time_)
+		{
+			this->StartMixThread();
+		}
+	}
+
+	void SoftAudioEngine::Render(uint32_t num_frames)
+	{
+		BOOST_ASSERT(!real_time_);
+
+		while (num_frames > 0)
+		{
+			// Fills the music streams first, an offline render never underruns
+			streamer_->Update();
+
+			uint32_t const n = std::min(num_frames, BLOCK_FRAMES);
+			this->MixBlock(n);
+			num_frames -= n;
+		}
+	}
+
+	uint32_t SoftAudioEngine::NumActiveVoices() const
+	{
+		std::lock_guard<std::mutex> lock(mix_mutex_);
+		return mixer_.NumVoices();
+	}
+
+	void SoftAudioEngine::StartVoice(SoftAudioVoicePtr const & voice)
+	{
+		std::lock_guard<std::mutex> lock(mix_mutex_);
+		voice->UpdateGains(pos_, vel_, face_, up_);
+		mixer_.AddVoice(voice);
+		voices_.push_back(voice);
+	}
+
+	void SoftAudioEngine::StopVoice(SoftAudioVoice const * voice)
+	{
+		std::lock_guard<std::mutex> lock(mix_mutex_);
+		mixer_.RemoveVoice(voice);
+		auto iter = std::find_if(voices_.begin(), voices_.end(),
+			[voice](SoftAudioVoicePtr const & v) { return v.get() == voice; });
+		if (iter != voices_.end())
+		{
+			voices_.erase(iter);
+		}
+	}
+
+	bool SoftAudioEngine::IsVoicePlaying(SoftAudioVoice const * voice) const
+	{
+		std::lock_guard<std::mutex> lock(mix_mutex_);
+		return std::find_if(voices_.begin(), voices_.end(),
+			[voice](SoftAudioVoicePtr const & v) { return v.get() == voice; }) != voices_.end();
+	}
+
+	void SoftAudioEngine::StartMixThread()
+	{
+		BOOST_ASSERT(!mix_thread_);
+
+		quit_ = false;
+		mix_thread_ = MakeUniquePtr<joiner<void>>(Context::Instance().ThreadPool()([this] { this->MixThreadFunc(); }));
+	}
+
+	void SoftAudioEngine::StopMixThread()
+	{
+		if (mix_thread_)
+		{
+			{
+				std::lock_guard<std::mutex> lock(mix_mutex_);
+				quit_ = true;
+			}
+			quit_cond_.notify_one();
+			(*mix_thread_)();
+			mix_thread_.reset();
+		}
+	}
+
+	void SoftAudioEngine::MixThreadFunc()
+	{
+		auto const start = std::chrono::steady_clock::now();
+		uint64_t mixed_frames = 0;
+		for (;;)
+		{
+			{
+				std::unique_lock<std::mutex> lock(mix_mutex_);
+				if (quit_)
+				{
+					break;
+				}
+			}
+
+			double const elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+			uint64_t const due_frames = static_cast<uint64_t>(elapsed * MIX_FREQ) + LEAD_BLOCKS * BLOCK_FRAMES;
+			while (mixed_frames + BLOCK_FRAMES <= due_frames)
+			{
+				this->MixBlock(BLOCK_FRAMES);
+				mixed_frames += BLOCK_FRAMES;
+			}
+
+			std::unique_lock<std::mutex> lock(mix_mutex_);
+			quit_cond_.wait_for(lock, std::chrono::milliseconds(MIX_THREAD_PERIOD_MS), [this] { return quit_; });
+		}
+	}
+
+	void SoftAudioEngine::MixBlock(uint32_t num_frames)
+	{
+		{
+			std::lock_guard<std::mutex> lock(mix_mutex_);
+
+			for (auto const & voice : voices_)
+			{
+				voice->UpdateGains(pos_, vel_, face_, up_);
+			}
+
+			mixer_.Mix(mix_buff_.data(), num_frames);
+
+			voices_.erase(std::remove_if(voices_.begin(), voices_.end(),
+				[](SoftAudioVoicePtr const & voice) { return voice->Finished(); }), voices_.end());
+		}
+
+		// Only the mixing thread, or the caller of Render, touches the sink
+		sink_->Write(mix_buff_.data(), num_frames);
+	}
+}
@@ -0,0 +1,203 @@
+/**
+ * @file SoftAudioVoice.cpp
+ * @author Minmin Gong
+ *
+ * @section DESCRIPTION
+ *
+ * This source file is part of KlayGE
+ * For the latest info, see http://www.klayge.org
+ *
+ * @section LICENSE
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * You may alternatively use this source under the terms of
+ * the KlayGE Proprietary License (KPL). You can obtained such a license
+ * from http://www.klayge.org/licensing/.
+ */
+
+#include <KlayGE/KlayGE.hpp>
+#include <KFL/ErrorHandling.hpp>
+#include <KFL/Util.hpp>
+#include <KlayGE/AudioDataSource.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+#include <boost/assert.hpp>
+
+#include <KlayGE/SoftAudio/SoftAudio.hpp>
+
+namespace KlayGE
+{
+	uint32_t NumChannels(AudioFormat format)
+	{
+		switch (format)
+		{
+		case AF_Mono8:
+		case AF_Mono16:
+			return 1;
+
+		case AF_Stereo8:
+		case AF_Stereo16:
+			return 2;
+
+		default:
+			KFL_UNREACHABLE("Invalid audio format");
+		}
+	}
+
+	uint32_t NumBytesPerSample(AudioFormat format)
+	{
+		switch (format)
+		{
+		case AF_Mono8:
+		case AF_Stereo8:
+			return 1;
+
+		case AF_Mono16:
+		case AF_Stereo16:
+			return 2;
+
+		default:
+			KFL_UNREACHABLE("Invalid audio format");
+		}
+	}
+
+	void PCMToFloat(AudioFormat format, void const * pcm, uint32_t num_samples, float* samples)
+	{
+		if (1 == NumBytesPerSample(format))
+		{
+			uint8_t const * src = static_cast<uint8_t const *>(pcm);
+			for (uint32_t i = 0; i < num_samples; ++ i)
+			{
+				samples[i] = (static_cast<int>(src[i]) - 128) * (1.0f / 128);
+			}
+		}
+		else
+		{
+			uint8_t const * src = static_cast<uint8_t const *>(pcm);
+			for (uint32_t i = 0; i < num_samples; ++ i)
+			{
+				int16_t s;
+				memcpy(&s, &src[i * sizeof(s)], sizeof(s));
+				samples[i] = LE2Native(s) * (1.0f / 32768);
+			}
+		}
+	}
+
+
+	SoftAudioVoice::SoftAudioVoice(uint32_t num_channels, uint32_t freq, float volume, float3 const & pos, float3 const & vel)
+		: AudioVoice(num_channels, freq),
+			volume_(volume), pos_(pos), vel_(vel)
+	{
+	}
+
+	void SoftAudioVoice::Volume(float vol)
+	{
+		volume_ = vol;
+	}
+
+	void SoftAudioVoice::Position(float3 const & v)
+	{
+		pos_ = v;
+	}
+
+	void SoftAudioVoice::Velocity(float3 const & v)
+	{
+		vel_ = v;
+	}
+
+	void SoftAudioVoice::UpdateGains(float3 const & listener_pos, float3 const & listener_vel,
+		float3 const & listener_face, float3 const & listener_up)
+	{
+		if (1 == this->NumChannels())
+		{
+			float gain_left;
+			float gain_right;
+			float pitch;
+			AudioMixer::Spatialize(listener_pos, listener_vel, listener_face, listener_up, pos_, vel_,
+				gain_left, gain_right, pitch);
+			this->Gains(gain_left * volume_, gain_right * volume_);
+			this->Pitch(pitch);
+		}
+		else
+		{
+			this->Gains(volume_, volume_);
+		}
+	}
+
+
+	SoftClipVoice::SoftClipVoice(std::shared_ptr<std::vector<uint8_t> const> const & pcm, AudioFormat format, uint32_t freq,
+			bool loop, float volume, float3 const & pos, float3 const & vel)
+		: SoftAudioVoice(KlayGE::NumChannels(format), freq, volume, pos, vel),
+			pcm_(pcm), format_(format), block_align_(KlayGE::NumChannels(format) * NumBytesPerSample(format)),
+			num_frames_(static_cast<uint32_t>(pcm->size() / block_align_)), frame_(0), loop_(loop)
+	{
+	}
+
+	uint32_t SoftClipVoice::Fetch(float* samples, uint32_t num_frames)
+	{
+		uint32_t const num_channels = this->NumChannels();
+
+		uint32_t fetched = 0;
+		while ((fetched < num_frames) && (num_frames_ > 0))
+		{
+			if (frame_ == num_frames_)
+			{
+				if (!loop_)
+				{
+					break;
+				}
+				frame_ = 0;
+			}
+
+			uint32_t const n = std::min(num_frames - fetched, num_frames_ - frame_);
+			PCMToFloat(format_, &(*pcm_)[frame_ * block_align_], n * num_channels, &samples[fetched * num_channels]);
+			fetched += n;
+			frame_ += n;
+		}
+
+		return fetched;
+	}
+
+
+	SoftStreamVoice::SoftStreamVoice(AudioStreamPtr const & stream, AudioFormat format, uint32_t freq,
+			float volume, float3 const & pos, float3 const & vel)
+		: SoftAudioVoice(KlayGE::NumChannels(format), freq, volume, pos, vel),
+			stream_(stream), format_(format)
+	{
+	}
+
+	uint32_t SoftStreamVoice::Fetch(float* samples, uint32_t num_frames)
+	{
+		uint32_t const block_align = stream_->BlockAlign();
+		size_t const size = num_frames * block_align;
+		pcm_.resize(size);
+
+		size_t read_size = stream_->Read(pcm_.data(), size);
+		if ((read_size < size) && !stream_->EndOfStream())
+		{
+			// An underrun, counted by the stream. Plays silence instead of ending the voice.
+			uint8_t const silence = (1 == NumBytesPerSample(format_)) ? 128 : 0;
+			memset(&pcm_[read_size], silence, size - read_size);
+			read_size = size;
+		}
+
+		uint32_t const fetched = static_cast<uint32_t>(read_size / block_align);
+		PCMToFloat(format_, pcm_.data(), fetched * this->NumChannels(), samples);
+		return fetched;
+	}
+}
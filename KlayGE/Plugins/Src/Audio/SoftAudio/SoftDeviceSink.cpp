@@ -0,0 +1,122 @@
+/**
+ * @file SoftDeviceSink.cpp
+ * @author Minmin Gong
+ *
+ * @section DESCRIPTION
+ *
+ * This source file is part of KlayGE
+ * For the latest info, see http://www.klayge.org
+ *
+ * @section LICENSE
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * You may alternatively use this source under the terms of
+ * the KlayGE Proprietary License (KPL). You can obtained such a license
+ * from http://www.klayge.org/licensing/.
+ */
+
+#include <KlayGE/KlayGE.hpp>
+
+#include <KlayGE/SoftAudio/SoftAudio.hpp>
+
+namespace
+{
+	// Enough to ride out a late wake up of the mixing thread
+	uint32_t constexpr NUM_BUFFERS = 8;
+}
+
+namespace KlayGE
+{
+	SoftDeviceSink::SoftDeviceSink(uint32_t freq)
+		: freq_(freq), device_(alcOpenDevice(nullptr)), context_(nullptr), source_(0)
+	{
+		if (device_)
+		{
+			context_ = alcCreateContext(device_, nullptr);
+			if (!context_)
+			{
+				alcCloseDevice(device_);
+				device_ = nullptr;
+				return;
+			}
+
+			alcMakeContextCurrent(context_);
+
+			alGenSources(1, &source_);
+			// The frames are already spatialized
+			alSourcei(source_, AL_SOURCE_RELATIVE, AL_TRUE);
+
+			buffers_.resize(NUM_BUFFERS);
+			alGenBuffers(static_cast<ALsizei>(buffers_.size()), buffers_.data());
+			free_buffers_ = buffers_;
+		}
+	}
+
+	SoftDeviceSink::~SoftDeviceSink()
+	{
+		if (context_)
+		{
+			alSourceStop(source_);
+			alSourcei(source_, AL_BUFFER, 0);
+			alDeleteSources(1, &source_);
+			alDeleteBuffers(static_cast<ALsizei>(buffers_.size()), buffers_.data());
+
+			alcMakeContextCurrent(nullptr);
+			alcDestroyContext(context_);
+			alcCloseDevice(device_);
+		}
+	}
+
+	void SoftDeviceSink::Write(float const * frames, uint32_t num_frames)
+	{
+		if (!context_)
+		{
+			return;
+		}
+
+		ALint processed = 0;
+		alGetSourcei(source_, AL_BUFFERS_PROCESSED, &processed);
+		if (processed > 0)
+		{
+			size_t const num_free = free_buffers_.size();
+			free_buffers_.resize(num_free + processed);
+			alSourceUnqueueBuffers(source_, processed, &free_buffers_[num_free]);
+		}
+
+		if (free_buffers_.empty())
+		{
+			// The device is behind the mixing clock, drops the block instead of blocking the mixing thread
+			return;
+		}
+
+		pcm_.resize(num_frames * 2);
+		FloatToPCM16(frames, pcm_.data(), num_frames * 2);
+
+		ALuint const buffer = free_buffers_.back();
+		free_buffers_.pop_back();
+		alBufferData(buffer, AL_FORMAT_STEREO16, pcm_.data(), static_cast<ALsizei>(pcm_.size() * sizeof(pcm_[0])),
+			static_cast<ALsizei>(freq_));
+		alSourceQueueBuffers(source_, 1, &buffer);
+
+		// Starts the source, or restarts it after an underrun
+		ALint state;
+		alGetSourcei(source_, AL_SOURCE_STATE, &state);
+		if (state != AL_PLAYING)
+		{
+			alSourcePlay(source_);
+		}
+	}
+}
@@ -0,0 +1,136 @@
+/**
+ * @file SoftMusicBuffer.cpp
+ * @author Minmin Gong
+ *
+ * @section DESCRIPTION
+ *
+ * This source file is part of KlayGE
+ * For the latest info, see http://www.klayge.org
+ *
+ * @section LICENSE
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * You may alternatively use this source under the terms of
+ * the KlayGE Proprietary License (KPL). You can obtained such a license
+ * from http://www.klayge.org/licensing/.
+ */
+
+#include <KlayGE/KlayGE.hpp>
+#include <KFL/Util.hpp>
+#include <KlayGE/AudioFactory.hpp>
+#include <KlayGE/Context.hpp>
+
+#include <KlayGE/SoftAudio/SoftAudio.hpp>
+
+namespace KlayGE
+{
+	SoftMusicBuffer::SoftMusicBuffer(AudioDataSourcePtr const & data_source, uint32_t buffer_seconds, float volume)
+					: MusicBuffer(data_source, buffer_seconds),
+						engine_(*checked_cast<SoftAudioEngine*>(&Context::Instance().AudioFactoryInstance().AudioEngineInstance())),
+						volume_(volume)
+	{
+		this->Position(float3(0, 0, 0.1f));
+		this->Velocity(float3(0, 0, 0));
+		this->Direction(float3(0, 0, 0));
+	}
+
+	SoftMusicBuffer::~SoftMusicBuffer()
+	{
+		this->Stop();
+	}
+
+	void SoftMusicBuffer::DoReset()
+	{
+	}
+
+	void SoftMusicBuffer::DoPlay(bool loop)
+	{
+		// Looping is done by the stream
+		KFL_UNUSED(loop);
+
+		voice_ = MakeSharedPtr<SoftStreamVoice>(stream_, format_, freq_, volume_, pos_, vel_);
+		engine_.StartVoice(voice_);
+	}
+
+	void SoftMusicBuffer::DoStop()
+	{
+		if (voice_)
+		{
+			engine_.StopVoice(voice_.get());
+			voice_.reset();
+		}
+	}
+
+	void SoftMusicBuffer::DoUpdateBuffer()
+	{
+		// The mixer reads the stream directly
+	}
+
+	bool SoftMusicBuffer::IsPlaying() const
+	{
+		return voice_ && engine_.IsVoicePlaying(voice_.get());
+	}
+
+	void SoftMusicBuffer::Volume(float vol)
+	{
+		std::lock_guard<std::mutex> lock(engine_.MixMutex());
+		volume_ = vol;
+		if (voice_)
+		{
+			voice_->Volume(vol);
+		}
+	}
+
+	float3 SoftMusicBuffer::Position() const
+	{
+		return pos_;
+	}
+
+	void SoftMusicBuffer::Position(float3 const & v)
+	{
+		std::lock_guard<std::mutex> lock(engine_.MixMutex());
+		pos_ = v;
+		if (voice_)
+		{
+			voice_->Position(v);
+		}
+	}
+
+	float3 SoftMusicBuffer::Velocity() const
+	{
+		return vel_;
+	}
+
+	void SoftMusicBuffer::Velocity(float3 const & v)
+	{
+		std::lock_guard<std::mutex> lock(engine_.MixMutex());
+		vel_ = v;
+		if (voice_)
+		{
+			voice_->Velocity(v);
+		}
+	}
+
+	float3 SoftMusicBuffer::Direction() const
+	{
+		return dir_;
+	}
+
+	void SoftMusicBuffer::Direction(float3 const & v)
+	{
+		dir_ = v;
+	}
+}
@@ -0,0 +1,173 @@
+/**
+ * @file SoftSoundBuffer.cpp
+ * @author Minmin Gong
+ *
+ * @section DESCRIPTION
+ *
+ * This source file is part of KlayGE
+ * For the latest info, see http://www.klayge.org
+ *
+ * @section LICENSE
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * You may alternatively use this source under the terms of
+ * the KlayGE Proprietary License (KPL). You can obtained such a license
+ * from http://www.klayge.org/licensing/.
+ */
+
+#include <KlayGE/KlayGE.hpp>
+#include <KFL/Util.hpp>
+#include <KlayGE/AudioDataSource.hpp>
+#include <KlayGE/AudioFactory.hpp>
+#include <KlayGE/Context.hpp>
+
+#include <boost/assert.hpp>
+
+#include <KlayGE/SoftAudio/SoftAudio.hpp>
+
+namespace KlayGE
+{
+	SoftSoundBuffer::SoftSoundBuffer(AudioDataSourcePtr const & data_source, uint32_t num_sources, float volume)
+					: SoundBuffer(data_source),
+						engine_(*checked_cast<SoftAudioEngine*>(&Context::Instance().AudioFactoryInstance().AudioEngineInstance())),
+						voices_(num_sources), next_voice_(0),
+						volume_(volume)
+	{
+		BOOST_ASSERT(num_sources > 0);
+
+		this->Position(float3(0, 0, 0.1f));
+		this->Velocity(float3(0, 0, 0));
+		this->Direction(float3(0, 0, 0));
+
+		this->Reset();
+	}
+
+	SoftSoundBuffer::~SoftSoundBuffer()
+	{
+		this->Stop();
+	}
+
+	void SoftSoundBuffer::Play(bool loop)
+	{
+		// Takes a free voice, or restarts the oldest one
+		uint32_t index = next_voice_;
+		for (uint32_t i = 0; i < voices_.size(); ++ i)
+		{
+			uint32_t const v = (next_voice_ + i) % voices_.size();
+			if (!voices_[v] || !engine_.IsVoicePlaying(voices_[v].get()))
+			{
+				index = v;
+				break;
+			}
+		}
+		next_voice_ = static_cast<uint32_t>((index + 1) % voices_.size());
+
+		if (voices_[index])
+		{
+			engine_.StopVoice(voices_[index].get());
+		}
+		voices_[index] = MakeSharedPtr<SoftClipVoice>(pcm_, format_, freq_, loop, volume_, pos_, vel_);
+		engine_.StartVoice(voices_[index]);
+	}
+
+	void SoftSoundBuffer::Stop()
+	{
+		for (auto& voice : voices_)
+		{
+			if (voice)
+			{
+				engine_.StopVoice(voice.get());
+				voice.reset();
+			}
+		}
+	}
+
+	void SoftSoundBuffer::DoReset()
+	{
+	}
+
+	bool SoftSoundBuffer::IsPlaying() const
+	{
+		for (auto const & voice : voices_)
+		{
+			if (voice && engine_.IsVoicePlaying(voice.get()))
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void SoftSoundBuffer::Volume(float vol)
+	{
+		std::lock_guard<std::mutex> lock(engine_.MixMutex());
+		volume_ = vol;
+		for (auto const & voice : voices_)
+		{
+			if (voice)
+			{
+				voice->Volume(vol);
+			}
+		}
+	}
+
+	float3 SoftSoundBuffer::Position() const
+	{
+		return pos_;
+	}
+
+	void SoftSoundBuffer::Position(float3 const & v)
+	{
+		std::lock_guard<std::mutex> lock(engine_.MixMutex());
+		pos_ = v;
+		for (auto const & voice : voices_)
+		{
+			if (voice)
+			{
+				voice->Position(v);
+			}
+		}
+	}
+
+	float3 SoftSoundBuffer::Velocity() const
+	{
+		return vel_;
+	}
+
+	void SoftSoundBuffer::Velocity(float3 const & v)
+	{
+		std::lock_guard<std::mutex> lock(engine_.MixMutex());
+		vel_ = v;
+		for (auto const & voice : voices_)
+		{
+			if (voice)
+			{
+				voice->Velocity(v);
+			}
+		}
+	}
+
+	float3 SoftSoundBuffer::Direction() const
+	{
+		return dir_;
+	}
+
+	void SoftSoundBuffer::Direction(float3 const & v)
+	{
+		// Sources are omnidirectional, like the default cone of the other backends
+		dir_ = v;
+	}
+}
@@ -44,67 +44,22 @@
 
 namespace KlayGE
 {
-	class MusicVoiceContext : public IXAudio2VoiceCallback
-	{
-	public:
-		MusicVoiceContext()
-			: buffer_end_event_(::CreateEventEx(nullptr, nullptr, 0, EVENT_ALL_ACCESS))
-		{
-		}
-		virtual ~MusicVoiceContext()
-		{
-			::CloseHandle(buffer_end_event_);
-		}
-
-		HANDLE GetBufferEndEvent() const
-		{
-			return buffer_end_event_;
-		}
-
-		STDMETHOD_(void, OnVoiceProcessingPassStart)(UINT32)
-		{
-		}
-		STDMETHOD_(void, OnVoiceProcessingPassEnd)()
-		{
-		}
-		STDMETHOD_(void, OnStreamEnd)()
-		{
-		}
-		STDMETHOD_(void, OnBufferStart)(void*)
-		{
-		}
-		STDMETHOD_(void, OnBufferEnd)(void*)
-		{
-			::SetEvent(buffer_end_event_);
-		}
-		STDMETHOD_(void, OnLoopEnd)(void*)
-		{
-		}
-		STDMETHOD_(void, OnVoiceError)(void*, HRESULT)
-		{
-		}
-
-	private:
-		HANDLE buffer_end_event_;
-	};
-
 	XAMusicBuffer::XAMusicBuffer(AudioDataSourcePtr const & data_source, uint32_t buffer_seconds, float volume)
-					: MusicBuffer(data_source),
-						voice_call_back_(MakeUniquePtr<MusicVoiceContext>()),
+					: MusicBuffer(data_source, buffer_seconds),
 						buffer_count_(buffer_seconds * BUFFERS_PER_SECOND), curr_buffer_index_(0),
-						played_(false), stopped_(true),
 						emitter_{}, dsp_settings_{}
 	{
 		WAVEFORMATEX wfx = WaveFormatEx(data_source);
-		audio_data_.resize(wfx.nAvgBytesPerSec * buffer_seconds);
 		buffer_size_ = wfx.nAvgBytesPerSec / BUFFERS_PER_SECOND;
+		buffer_size_ -= buffer_size_ % wfx.nBlockAlign;
+		audio_data_.resize(buffer_size_ * buffer_count_);
 
 		auto const & ae = *checked_cast<XAAudioEngine const *>(&Context::Instance().AudioFactoryInstance().AudioEngineInstance());
 
 		auto xaudio = ae.XAudio();
 
 		IXAudio2SourceVoice* source_voice;
-		TIFHR(xaudio->CreateSourceVoice(&source_voice, &wfx, 0, XAUDIO2_DEFAULT_FREQ_RATIO, voice_call_back_.get(), nullptr, nullptr));
+		TIFHR(xaudio->CreateSourceVoice(&source_voice, &wfx, 0, XAUDIO2_DEFAULT_FREQ_RATIO, nullptr, nullptr, nullptr));
 		source_voice_ = std::shared_ptr<IXAudio2SourceVoice>(source_voice, std::mem_fn(&IXAudio2SourceVoice::DestroyVoice));
 
 		emitter_.ChannelCount = 1;
@@ -130,54 +85,24 @@ namespace KlayGE
 		this->Stop();
 	}
 
-	void XAMusicBuffer::LoopUpdateBuffer()
+	void XAMusicBuffer::DoUpdateBuffer()
 	{
-		std::unique_lock<std::mutex> lock(play_mutex_);
-		while (!played_)
-		{
-			play_cond_.wait(lock);
-		}
-		played_ = false;
+		XAUDIO2_VOICE_STATE state;
+		source_voice_->GetState(&state);
 
-		while (!stopped_)
+		// The voice may still read from the last submitted buffer, so one stays unused
+		for (uint32_t queued = state.BuffersQueued; queued < buffer_count_ - 1; ++ queued)
 		{
-			XAUDIO2_VOICE_STATE state;
-			for (;;)
+			if (!this->FillData())
 			{
-				source_voice_->GetState(&state);
-				if (state.BuffersQueued < buffer_count_ - 1)
-				{
-					break;
-				}
-
-				::WaitForSingleObjectEx(checked_cast<MusicVoiceContext*>(voice_call_back_.get())->GetBufferEndEvent(),
-					INFINITE, FALSE);
-			}
-
-			if (this->FillData(buffer_size_))
-			{
-				if (loop_)
-				{
-					stopped_ = false;
-					this->DoReset();
-				}
-				else
-				{
-					stopped_ = true;
-
-					HRESULT hr = source_voice_->Stop();
-					if (SUCCEEDED(hr))
-					{
-						source_voice_->FlushSourceBuffers();
-					}
-				}
+				break;
 			}
 		}
 	}
 
 	void XAMusicBuffer::DoReset()
 	{
-		data_source_->Reset();
+		curr_buffer_index_ = 0;
 	}
 
 	void XAMusicBuffer::DoPlay(bool loop)
@@ -189,30 +114,17 @@ namespace KlayGE
 		source_voice_->SetOutputMatrix(ae.MasteringVoice(), 1, ae.MasteringVoiceChannels(), dsp_settings_.pMatrixCoefficients);
 		source_voice_->SetFrequencyRatio(dsp_settings_.DopplerFactor);
 
-		curr_buffer_index_ = 0;
-		loop_ = loop;
-
-		play_thread_ = Context::Instance().ThreadPool()([this] { this->LoopUpdateBuffer(); });
+		// Looping is done by the stream, the voice only sees a continuous queue
+		KFL_UNUSED(loop);
 
-		stopped_ = false;
-		{
-			std::lock_guard<std::mutex> lock(play_mutex_);
-			played_ = true;
-		}
-		play_cond_.notify_one();
+		curr_buffer_index_ = 0;
+		this->DoUpdateBuffer();
 
 		source_voice_->Start(0, 0);
 	}
 
 	void XAMusicBuffer::DoStop()
 	{
-		if (!stopped_)
-		{
-			stopped_ = true;
-			::SetEvent(checked_cast<MusicVoiceContext*>(voice_call_back_.get())->GetBufferEndEvent());
-			play_thread_();
-		}
-
 		HRESULT hr = source_voice_->Stop();
 		if (SUCCEEDED(hr))
 		{
@@ -220,24 +132,27 @@ namespace KlayGE
 		}
 	}
 
-	bool XAMusicBuffer::FillData(uint32_t size)
+	bool XAMusicBuffer::FillData()
 	{
-		bool ret = false;
+		uint8_t* data = &audio_data_[curr_buffer_index_ * buffer_size_];
+		size_t const read_size = stream_->Read(data, buffer_size_);
+		if (0 == read_size)
+		{
+			return false;
+		}
 
-		size_t read_size = data_source_->Read(&audio_data_[curr_buffer_index_ * buffer_size_], size);
 		XAUDIO2_BUFFER buf{};
 		buf.AudioBytes = static_cast<uint32_t>(read_size);
-		buf.pAudioData = &audio_data_[curr_buffer_index_ * buffer_size_];
-		if (curr_buffer_index_ * buffer_size_ + read_size >= data_source_->Size())
+		buf.pAudioData = data;
+		if (stream_->EndOfStream())
 		{
 			buf.Flags = XAUDIO2_END_OF_STREAM;
-			ret = true;
 		}
 
 		source_voice_->SubmitSourceBuffer(&buf);
 		curr_buffer_index_ = (curr_buffer_index_ + 1) % buffer_count_;
 
-		return ret;
+		return true;
 	}
 
 	bool XAMusicBuffer::IsPlaying() const
@@ -95,11 +95,6 @@ namespace KlayGE
 	{
 		WAVEFORMATEX wfx = WaveFormatEx(data_source);
 
-		data_source_->Reset();
-
-		audio_data_.resize(data_source_->Size());
-		data_source_->Read(audio_data_.data(), audio_data_.size());
-
 		auto const & ae = *checked_cast<XAAudioEngine const *>(&Context::Instance().AudioFactoryInstance().AudioEngineInstance());
 
 		auto xaudio = ae.XAudio();
@@ -185,8 +180,8 @@ namespace KlayGE
 		}
 
 		XAUDIO2_BUFFER play_buffer{};
-		play_buffer.AudioBytes = static_cast<uint32_t>(audio_data_.size());
-		play_buffer.pAudioData = audio_data_.data();
+		play_buffer.AudioBytes = static_cast<uint32_t>(pcm_->size());
+		play_buffer.pAudioData = pcm_->data();
 		play_buffer.Flags = XAUDIO2_END_OF_STREAM;
 
 		hr = source.voice->SubmitSourceBuffer(&play_buffer);
@@ -711,15 +711,14 @@ namespace KlayGE
 		CPUInfo cpu;
 		uint32_t const num_threads = cpu.NumHWThreads();
 		thread_pool tp(1, num_threads);
-		std::vector<joiner<void>> joiners(num_threads);
 
 		uint32_t const tex_region_height = ((tex_height + num_threads - 1) / num_threads + block_height - 1) & ~(block_height - 1);
 		std::vector<TexturePtr> new_tex_regions(num_threads);
-		for (uint32_t i = 0; i < num_threads; ++ i)
-		{
-			joiners[i] = tp(
-				[block_height, tex_width, tex_height, tex_region_height, i, format, row_pitch,
-					&new_tex_data, &new_tex_regions, this]
+		parallel_for(tp, num_threads, num_threads,
+			[block_height, tex_width, tex_height, tex_region_height, format, row_pitch, &new_tex_data, &new_tex_regions, this](
+				uint32_t region_begin, uint32_t region_end)
+			{
+				for (uint32_t i = region_begin; i < region_end; ++ i)
 				{
 					uint32_t const this_tex_region_height = MathLib::clamp(static_cast<int>(tex_height - i * tex_region_height),
 						0, static_cast<int>(tex_region_height));
@@ -738,8 +737,8 @@ namespace KlayGE
 						uncompressed_tex_->CopyToSubTexture2D(*new_tex_regions[i], 0, 0, 0, 0, tex_width, this_tex_region_height,
 							0, 0, 0, i * tex_region_height, tex_width, this_tex_region_height);
 					}
-				});
-		}
+				}
+			});
 
 		TexturePtr new_tex = MakeSharedPtr<SoftwareTexture>(Texture::TT_2D, uncompressed_tex_->Width(0), uncompressed_tex_->Height(0),
 			1, 1, 1, format, false);
@@ -748,11 +747,6 @@ namespace KlayGE
 		init_data.row_pitch = row_pitch;
 		init_data.slice_pitch = slice_pitch;
 
-		for (uint32_t i = 0; i < num_threads; ++ i)
-		{
-			joiners[i]();
-		}
-
 		new_tex->CreateHWResource(init_data, nullptr);
 
 		if (IsCompressedFormat(format))
@@ -799,6 +793,55 @@ namespace KlayGE
 		return target;
 	}
 
+	std::vector<ImagePlane> ImagePlane::BuildMipChain(uint32_t num_mipmaps, ResizeFilter filter)
+	{
+		BOOST_ASSERT(uncompressed_tex_);
+		BOOST_ASSERT(num_mipmaps > 0);
+
+		compressed_tex_.reset();
+
+		auto const format = uncompressed_tex_->Format();
+		uint32_t const width = uncompressed_tex_->Width(0);
+		uint32_t const height = uncompressed_tex_->Height(0);
+
+		std::vector<ElementInitData> init_data(num_mipmaps);
+		uint32_t chain_size = 0;
+		for (uint32_t m = 1; m < num_mipmaps; ++ m)
+		{
+			init_data[m].row_pitch = std::max<uint32_t>(1U, width >> m) * NumFormatBytes(format);
+			init_data[m].slice_pitch = init_data[m].row_pitch * std::max<uint32_t>(1U, height >> m);
+			chain_size += init_data[m].slice_pitch;
+		}
+
+		std::vector<uint8_t> chain_data(chain_size);
+		{
+			uint8_t* p = chain_data.data();
+			for (uint32_t m = 1; m < num_mipmaps; ++ m)
+			{
+				init_data[m].data = p;
+				p += init_data[m].slice_pitch;
+			}
+
+			Texture::Mapper mapper(*uncompressed_tex_, 0, 0, TMA_Read_Only, 0, 0, width, height);
+			init_data[0].data = mapper.Pointer<void>();
+			init_data[0].row_pitch = mapper.RowPitch();
+			init_data[0].slice_pitch = mapper.SlicePitch();
+
+			KlayGE::BuildMipChain(init_data, format, width, height, 1, filter);
+		}
+
+		std::vector<ImagePlane> mips(num_mipmaps - 1);
+		for (uint32_t m = 1; m < num_mipmaps; ++ m)
+		{
+			auto& mip = mips[m - 1];
+			mip.uncompressed_tex_ = MakeSharedPtr<SoftwareTexture>(Texture::TT_2D,
+				std::max<uint32_t>(1U, width >> m), std::max<uint32_t>(1U, height >> m), 1, 1, 1, format, false);
+			mip.uncompressed_tex_->CreateHWResource(init_data[m], nullptr);
+		}
+
+		return mips;
+	}
+
 	float ImagePlane::RgbToLum(Color const & clr)
 	{
 		float3 constexpr RGB_TO_LUM(0.2126f, 0.7152f, 0.0722f);
@@ -188,6 +188,350 @@ namespace
 		}
 	}
 
+	// Size of the FIFO post-transform cache used for analysis and overdraw clustering
+	uint32_t constexpr VERTEX_CACHE_SIZE = 16;
+
+	// Parameters of Tom Forsyth's "Linear-Speed Vertex Cache Optimisation"
+	uint32_t constexpr FORSYTH_MAX_CACHE_SIZE = 32;
+	float constexpr FORSYTH_CACHE_DECAY_POWER = 1.5f;
+	float constexpr FORSYTH_LAST_TRI_SCORE = 0.75f;
+	float constexpr FORSYTH_VALENCE_BOOST_SCALE = 2.0f;
+	float constexpr FORSYTH_VALENCE_BOOST_POWER = 0.5f;
+
+	float ForsythVertexScore(int32_t cache_pos, uint32_t remaining_valence)
+	{
+		if (remaining_valence == 0)
+		{
+			return -1;
+		}
+
+		float score = 0;
+		if (cache_pos >= 0)
+		{
+			if (cache_pos < 3)
+			{
+				score = FORSYTH_LAST_TRI_SCORE;
+			}
+			else
+			{
+				float const scaler = 1.0f / (FORSYTH_MAX_CACHE_SIZE - 3);
+				score = MathLib::pow(1 - (cache_pos - 3) * scaler, FORSYTH_CACHE_DECAY_POWER);
+			}
+		}
+
+		score += FORSYTH_VALENCE_BOOST_SCALE * MathLib::pow(static_cast<float>(remaining_valence), -FORSYTH_VALENCE_BOOST_POWER);
+		return score;
+	}
+
+	// Reorders triangles for the post-transform vertex cache
+	std::vector<uint32_t> OptimizeVertexCache(std::vector<uint32_t> const & indices, uint32_t num_vertices)
+	{
+		uint32_t const num_tris = static_cast<uint32_t>(indices.size() / 3);
+
+		std::vector<uint32_t> valences(num_vertices, 0);
+		for (auto const index : indices)
+		{
+			++ valences[index];
+		}
+
+		std::vector<uint32_t> adj_offsets(num_vertices + 1, 0);
+		for (uint32_t i = 0; i < num_vertices; ++ i)
+		{
+			adj_offsets[i + 1] = adj_offsets[i] + valences[i];
+		}
+		std::vector<uint32_t> adj_tris(indices.size());
+		{
+			std::vector<uint32_t> fill_pos(adj_offsets.begin(), adj_offsets.end() - 1);
+			for (uint32_t i = 0; i < indices.size(); ++ i)
+			{
+				adj_tris[fill_pos[indices[i]]] = i / 3;
+				++ fill_pos[indices[i]];
+			}
+		}
+
+		std::vector<int32_t> cache_positions(num_vertices, -1);
+		std::vector<float> vertex_scores(num_vertices);
+		for (uint32_t i = 0; i < num_vertices; ++ i)
+		{
+			vertex_scores[i] = ForsythVertexScore(-1, valences[i]);
+		}
+
+		std::vector<float> tri_scores(num_tris);
+		std::vector<bool> emitted(num_tris, false);
+		uint32_t best_tri = 0;
+		for (uint32_t i = 0; i < num_tris; ++ i)
+		{
+			tri_scores[i] = vertex_scores[indices[i * 3 + 0]] + vertex_scores[indices[i * 3 + 1]] + vertex_scores[indices[i * 3 + 2]];
+			if (tri_scores[i] > tri_scores[best_tri])
+			{
+				best_tri = i;
+			}
+		}
+
+		std::vector<uint32_t> cache;
+		std::vector<uint32_t> new_cache;
+		cache.reserve(FORSYTH_MAX_CACHE_SIZE + 3);
+		new_cache.reserve(FORSYTH_MAX_CACHE_SIZE + 3);
+
+		std::vector<uint32_t> ret;
+		ret.reserve(indices.size());
+
+		uint32_t scan_pos = 0;
+		for (uint32_t i = 0; i < num_tris; ++ i)
+		{
+			if (best_tri == ~0U)
+			{
+				while (emitted[scan_pos])
+				{
+					++ scan_pos;
+				}
+				best_tri = scan_pos;
+			}
+
+			emitted[best_tri] = true;
+
+			new_cache.clear();
+			for (uint32_t j = 0; j < 3; ++ j)
+			{
+				uint32_t const v = indices[best_tri * 3 + j];
+				ret.push_back(v);
+				new_cache.push_back(v);
+
+				// Remove the triangle from the vertex's remaining adjacency
+				uint32_t const begin = adj_offsets[v];
+				uint32_t const end = begin + valences[v];
+				for (uint32_t k = begin; k < end; ++ k)
+				{
+					if (adj_tris[k] == best_tri)
+					{
+						std::swap(adj_tris[k], adj_tris[end - 1]);
+						break;
+					}
+				}
+				-- valences[v];
+			}
+			for (auto const v : cache)
+			{
+				if ((v != new_cache[0]) && (v != new_cache[1]) && (v != new_cache[2]))
+				{
+					new_cache.push_back(v);
+				}
+			}
+
+			for (uint32_t j = 0; j < new_cache.size(); ++ j)
+			{
+				uint32_t const v = new_cache[j];
+				cache_positions[v] = (j < FORSYTH_MAX_CACHE_SIZE) ? static_cast<int32_t>(j) : -1;
+
+				float const new_score = ForsythVertexScore(cache_positions[v], valences[v]);
+				float const diff = new_score - vertex_scores[v];
+				vertex_scores[v] = new_score;
+
+				for (uint32_t k = adj_offsets[v]; k < adj_offsets[v] + valences[v]; ++ k)
+				{
+					tri_scores[adj_tris[k]] += diff;
+				}
+			}
+
+			best_tri = ~0U;
+			float best_score = -1;
+			new_cache.resize(std::min<size_t>(new_cache.size(), FORSYTH_MAX_CACHE_SIZE));
+			for (auto const v : new_cache)
+			{
+				for (uint32_t k = adj_offsets[v]; k < adj_offsets[v] + valences[v]; ++ k)
+				{
+					uint32_t const tri = adj_tris[k];
+					if (tri_scores[tri] > best_score)
+					{
+						best_score = tri_scores[tri];
+						best_tri = tri;
+					}
+				}
+			}
+
+			cache.swap(new_cache);
+		}
+
+		return ret;
+	}
+
+	// Splits the cache optimized triangle list into clusters at the points where the vertex cache is flushed, and sorts
+	// the clusters from outside to inside to reduce overdraw. A cluster is split further when its local ACMR stays
+	// within threshold times the ACMR of the whole cluster.
+	void OptimizeOverdraw(std::vector<uint32_t>& indices, std::vector<float3> const & positions, float threshold)
+	{
+		uint32_t const num_tris = static_cast<uint32_t>(indices.size() / 3);
+		if (num_tris == 0)
+		{
+			return;
+		}
+
+		std::vector<uint32_t> cache_timestamps(positions.size(), 0);
+		uint32_t timestamp = VERTEX_CACHE_SIZE + 1;
+		auto count_misses = [&indices, &cache_timestamps, &timestamp](uint32_t tri)
+		{
+			uint32_t misses = 0;
+			for (uint32_t j = 0; j < 3; ++ j)
+			{
+				uint32_t const v = indices[tri * 3 + j];
+				if (timestamp - cache_timestamps[v] > VERTEX_CACHE_SIZE)
+				{
+					cache_timestamps[v] = timestamp;
+					++ timestamp;
+					++ misses;
+				}
+			}
+			return misses;
+		};
+		auto flush_cache = [&timestamp]()
+		{
+			timestamp += VERTEX_CACHE_SIZE + 1;
+		};
+
+		std::vector<uint32_t> hard_clusters;
+		for (uint32_t i = 0; i < num_tris; ++ i)
+		{
+			if ((count_misses(i) == 3) || (i == 0))
+			{
+				hard_clusters.push_back(i);
+			}
+		}
+		hard_clusters.push_back(num_tris);
+
+		std::vector<uint32_t> clusters;
+		for (size_t c = 0; c < hard_clusters.size() - 1; ++ c)
+		{
+			uint32_t const start = hard_clusters[c];
+			uint32_t const end = hard_clusters[c + 1];
+
+			flush_cache();
+			uint32_t cluster_misses = 0;
+			for (uint32_t i = start; i < end; ++ i)
+			{
+				cluster_misses += count_misses(i);
+			}
+			float const cluster_threshold = threshold * cluster_misses / (end - start);
+
+			flush_cache();
+			clusters.push_back(start);
+			uint32_t sub_start = start;
+			uint32_t misses = 0;
+			for (uint32_t i = start; i < end - 1; ++ i)
+			{
+				misses += count_misses(i);
+				if (static_cast<float>(misses) / (i + 1 - sub_start) <= cluster_threshold)
+				{
+					flush_cache();
+					sub_start = i + 1;
+					misses = 0;
+					clusters.push_back(sub_start);
+				}
+			}
+		}
+		clusters.push_back(num_tris);
+
+		float3 mesh_centroid(0, 0, 0);
+		float mesh_area = 0;
+		std::vector<float3> cluster_centroids(clusters.size() - 1, float3(0, 0, 0));
+		std::vector<float3> cluster_normals(clusters.size() - 1, float3(0, 0, 0));
+		for (size_t c = 0; c < clusters.size() - 1; ++ c)
+		{
+			float cluster_area = 0;
+			for (uint32_t i = clusters[c]; i < clusters[c + 1]; ++ i)
+			{
+				float3 const & p0 = positions[indices[i * 3 + 0]];
+				float3 const & p1 = positions[indices[i * 3 + 1]];
+				float3 const & p2 = positions[indices[i * 3 + 2]];
+
+				float3 const n = MathLib::cross(p1 - p0, p2 - p0);
+				float const area = MathLib::length(n);
+				float3 const centroid = (p0 + p1 + p2) / 3.0f;
+
+				cluster_centroids[c] += centroid * area;
+				cluster_normals[c] += n;
+				cluster_area += area;
+			}
+
+			mesh_centroid += cluster_centroids[c];
+			mesh_area += cluster_area;
+
+			if (cluster_area > 0)
+			{
+				cluster_centroids[c] /= cluster_area;
+			}
+		}
+		if (mesh_area > 0)
+		{
+			mesh_centroid /= mesh_area;
+		}
+
+		std::vector<std::pair<float, uint32_t>> sort_keys(clusters.size() - 1);
+		for (uint32_t c = 0; c < sort_keys.size(); ++ c)
+		{
+			float const len = MathLib::length(cluster_normals[c]);
+			float const dp = (len > 0) ? MathLib::dot(cluster_centroids[c] - mesh_centroid, cluster_normals[c] / len) : 0.0f;
+			sort_keys[c] = { dp, c };
+		}
+		std::stable_sort(sort_keys.begin(), sort_keys.end(),
+			[](std::pair<float, uint32_t> const & lhs, std::pair<float, uint32_t> const & rhs)
+			{
+				return lhs.first > rhs.first;
+			});
+
+		std::vector<uint32_t> ret;
+		ret.reserve(indices.size());
+		for (auto const & key : sort_keys)
+		{
+			ret.insert(ret.end(), indices.begin() + clusters[key.second] * 3, indices.begin() + clusters[key.second + 1] * 3);
+		}
+		indices.swap(ret);
+	}
+
+	// Generates a vertex remapping that places vertices in the order they are first referenced. Unreferenced vertices are
+	// moved to the end.
+	std::vector<uint32_t> OptimizeVertexFetch(std::vector<uint32_t>& indices, uint32_t num_vertices)
+	{
+		std::vector<uint32_t> remap(num_vertices, ~0U);
+		uint32_t next_vertex = 0;
+		for (auto& index : indices)
+		{
+			if (remap[index] == ~0U)
+			{
+				remap[index] = next_vertex;
+				++ next_vertex;
+			}
+			index = remap[index];
+		}
+		for (auto& r : remap)
+		{
+			if (r == ~0U)
+			{
+				r = next_vertex;
+				++ next_vertex;
+			}
+		}
+
+		return remap;
+	}
+
+	template <typename T>
+	void RemapVertices(std::vector<T>& attrib, std::vector<uint32_t> const & remap)
+	{
+		if (attrib.empty())
+		{
+			return;
+		}
+
+		BOOST_ASSERT(attrib.size() == remap.size());
+
+		std::vector<T> new_attrib(attrib.size());
+		for (size_t i = 0; i < attrib.size(); ++ i)
+		{
+			new_attrib[remap[i]] = std::move(attrib[i]);
+		}
+		attrib.swap(new_attrib);
+	}
+
 	class MeshLoader
 	{
 	public:
@@ -196,7 +540,10 @@ namespace
 	private:
 		void RemoveUnusedJoints();
 		void RemoveUnusedMaterials();
-		void CompressKeyFrameSet(KeyFrameSet& kf);
+		void OptimizeMeshes();
+		std::vector<float> ComputeJointReaches() const;
+		void CompressKeyFrameSets(std::vector<KeyFrameSet>& kfs) const;
+		void CompressKeyFrameSet(KeyFrameSet& kf, float reach, float parent_scale) const;
 
 		// From assimp
 		void BuildNodeData(uint32_t num_lods, uint32_t lod, int16_t parent_id, aiNode const * node);
@@ -901,13 +1248,13 @@ namespace
 					kf.bind_dual.push_back(frame.second.bind_dual[f]);
 					kf.bind_scale.push_back(frame.second.bind_scale[f]);
 				}
-
-				this->CompressKeyFrameSet(kf);
 			}
 
 			action_frame_offset = action_frame_offset + anim.frame_num;
 		}
 
+		this->CompressKeyFrameSets(*kfs);
+
 		skinned_model.AttachKeyFrameSets(kfs);
 		skinned_model.AttachActions(actions);
 
@@ -2784,10 +3131,9 @@ namespace
 				kfs.bind_dual.push_back(bind_dual);
 				kfs.bind_scale.push_back(bind_scale);
 			}
-
-			this->CompressKeyFrameSet(kfs);
 		}
 
+		this->CompressKeyFrameSets(*kfss);
 		skinned_model.AttachKeyFrameSets(kfss);
 	}
 
@@ -2945,7 +3291,8 @@ namespace
 			this->CompileKeyFramesChunk(key_frames_chunk);
 
 			auto& skinned_model = *checked_pointer_cast<SkinnedModel>(render_model_);
-			auto& kfs = *skinned_model.GetKeyFrameSets();
+			auto new_kfs = MakeSharedPtr<std::vector<KeyFrameSet>>(*skinned_model.GetKeyFrameSets());
+			auto& kfs = *new_kfs;
 
 			for (size_t i = 0; i < kfs.size(); ++ i)
 			{
@@ -2976,6 +3323,9 @@ namespace
 				}
 			}
 
+			// Re-attaching drops the compressed sets cached from the old ones
+			skinned_model.AttachKeyFrameSets(new_kfs);
+
 			XMLNodePtr bb_kfs_chunk = root->FirstNode("bb_key_frames_chunk");
 			for (uint32_t mesh_index = 0; mesh_index < skinned_model.NumMeshes(); ++ mesh_index)
 			{
@@ -3033,7 +3383,8 @@ namespace
 		}
 
 		auto& skinned_model = *checked_pointer_cast<SkinnedModel>(render_model_);
-		auto& kfs = *skinned_model.GetKeyFrameSets();
+		auto new_kfs = MakeSharedPtr<std::vector<KeyFrameSet>>(*skinned_model.GetKeyFrameSets());
+		auto& kfs = *new_kfs;
 
 		for (uint32_t ji = 0; ji < joints_.size(); ++ ji)
 		{
@@ -3046,6 +3397,7 @@ namespace
 		}
 		joints_.resize(new_joint_id);
 		kfs.resize(joints_.size());
+		skinned_model.AttachKeyFrameSets(new_kfs);
 
 		for (auto& mesh : meshes_)
 		{
@@ -3095,59 +3447,219 @@ namespace
 		}
 	}
 
-	void MeshLoader::CompressKeyFrameSet(KeyFrameSet& kf)
+	void MeshLoader::OptimizeMeshes()
 	{
-		float const THRESHOLD = 1e-3f;
+		float const OVERDRAW_THRESHOLD = 1.05f;
+
+		for (auto& mesh : meshes_)
+		{
+			for (uint32_t lod = 0; lod < mesh.lods.size(); ++ lod)
+			{
+				auto& mesh_lod = mesh.lods[lod];
+				uint32_t const num_vertices = static_cast<uint32_t>(mesh_lod.positions.size());
+				if (mesh_lod.indices.empty())
+				{
+					continue;
+				}
+
+				auto const before = MeshConverter::AnalyzeVertexCache(mesh_lod.indices, num_vertices);
+
+				mesh_lod.indices = OptimizeVertexCache(mesh_lod.indices, num_vertices);
+				OptimizeOverdraw(mesh_lod.indices, mesh_lod.positions, OVERDRAW_THRESHOLD);
+
+				auto const remap = OptimizeVertexFetch(mesh_lod.indices, num_vertices);
+				RemapVertices(mesh_lod.positions, remap);
+				RemapVertices(mesh_lod.tangents, remap);
+				RemapVertices(mesh_lod.binormals, remap);
+				RemapVertices(mesh_lod.normals, remap);
+				RemapVertices(mesh_lod.diffuses, remap);
+				RemapVertices(mesh_lod.speculars, remap);
+				for (auto& texcoords : mesh_lod.texcoords)
+				{
+					RemapVertices(texcoords, remap);
+				}
+				RemapVertices(mesh_lod.joint_bindings, remap);
+
+				auto const after = MeshConverter::AnalyzeVertexCache(mesh_lod.indices, num_vertices);
+
+				LogInfo() << "Mesh " << mesh.name << " LOD " << lod << ": ACMR " << before.acmr << " -> " << after.acmr
+					<< ", ATVR " << before.atvr << " -> " << after.atvr << std::endl;
+			}
+		}
+	}
+
+	std::vector<float> MeshLoader::ComputeJointReaches() const
+	{
+		std::vector<float3> positions(joints_.size());
+		for (size_t i = 0; i < joints_.size(); ++ i)
+		{
+			positions[i] = MathLib::udq_to_trans(joints_[i].bind_real, joints_[i].bind_dual);
+		}
+
+		std::vector<float> reaches(joints_.size(), 0.0f);
+		for (size_t i = 0; i < joints_.size(); ++ i)
+		{
+			for (int16_t parent = joints_[i].parent; parent != -1; parent = joints_[parent].parent)
+			{
+				reaches[parent] = std::max(reaches[parent], MathLib::length(positions[i] - positions[parent]));
+			}
+		}
+		for (size_t i = 0; i < joints_.size(); ++ i)
+		{
+			// Leaf joints still move skin around them. Use the bone length as an estimation.
+			if ((reaches[i] == 0) && (joints_[i].parent != -1))
+			{
+				reaches[i] = MathLib::length(positions[i] - positions[joints_[i].parent]);
+			}
+		}
+
+		return reaches;
+	}
+
+	void MeshLoader::CompressKeyFrameSets(std::vector<KeyFrameSet>& kfs) const
+	{
+		BOOST_ASSERT(kfs.size() == joints_.size());
+
+		auto const joint_reaches = this->ComputeJointReaches();
+
+		// Largest scale of each joint's local transform during the animation
+		std::vector<float> local_scales(joints_.size());
+		for (size_t i = 0; i < joints_.size(); ++ i)
+		{
+			auto const & kf = kfs[i];
+			if (kf.bind_scale.empty())
+			{
+				// Not animated, stays in bind pose
+				int16_t const parent = joints_[i].parent;
+				local_scales[i] = MathLib::abs(joints_[i].bind_scale / ((parent == -1) ? 1.0f : joints_[parent].bind_scale));
+			}
+			else
+			{
+				local_scales[i] = 0;
+				for (float scale : kf.bind_scale)
+				{
+					local_scales[i] = std::max(local_scales[i], MathLib::abs(scale));
+				}
+			}
+		}
+
+		for (size_t i = 0; i < joints_.size(); ++ i)
+		{
+			// Every ancestor scales the error on its way to world space
+			float parent_scale = 1;
+			for (int16_t parent = joints_[i].parent; parent != -1; parent = joints_[parent].parent)
+			{
+				parent_scale *= local_scales[parent];
+			}
+
+			this->CompressKeyFrameSet(kfs[i], joint_reaches[i], parent_scale);
+		}
+	}
+
+	void MeshLoader::CompressKeyFrameSet(KeyFrameSet& kf, float reach, float parent_scale) const
+	{
+		// In world space units
+		float const TOLERANCE = 1e-3f;
 
 		BOOST_ASSERT((kf.bind_real.size() == kf.bind_dual.size())
 			&& (kf.frame_id.size() == kf.bind_scale.size())
 			&& (kf.frame_id.size() == kf.bind_real.size()));
 
-		int base = 0;
-		while (base < static_cast<int>(kf.frame_id.size() - 2))
+		size_t const num_kf = kf.frame_id.size();
+		if (num_kf <= 2)
 		{
-			int const frame0 = kf.frame_id[base + 0];
-			int const frame1 = kf.frame_id[base + 1];
-			int const frame2 = kf.frame_id[base + 2];
-			float const factor = static_cast<float>(frame1 - frame0) / (frame2 - frame0);
+			return;
+		}
+
+		// An error of the local transform moves the descendants in world space. Rotation and scale errors are amplified by
+		// the distance to the farthest descendant, all of them are scaled by the ancestors.
+		auto key_error = [&kf, reach, parent_scale](Quaternion const & real, Quaternion const & dual, float scale, size_t key)
+		{
+			float3 const trans_diff = MathLib::udq_to_trans(real, dual) - MathLib::udq_to_trans(kf.bind_real[key], kf.bind_dual[key]);
+			float const angle = 2 * MathLib::acos(std::min(MathLib::abs(MathLib::dot(real, kf.bind_real[key])), 1.0f));
+			float const scale_diff = MathLib::abs(scale - kf.bind_scale[key]);
+
+			return parent_scale * (MathLib::length(trans_diff) + reach * (angle * MathLib::abs(kf.bind_scale[key]) + scale_diff));
+		};
+		auto interpolation_error = [&kf, &key_error](size_t from, size_t to, size_t key)
+		{
+			float const factor = static_cast<float>(kf.frame_id[key] - kf.frame_id[from]) / (kf.frame_id[to] - kf.frame_id[from]);
 			Quaternion interpolate_real;
 			Quaternion interpolate_dual;
-			std::tie(interpolate_real, interpolate_dual) = MathLib::sclerp(kf.bind_real[base + 0], kf.bind_dual[base + 0],
-				kf.bind_real[base + 2], kf.bind_dual[base + 2], factor);
-			float const scale = MathLib::lerp(kf.bind_scale[base + 0], kf.bind_scale[base + 2], factor);
+			std::tie(interpolate_real, interpolate_dual) = MathLib::sclerp(kf.bind_real[from], kf.bind_dual[from],
+				kf.bind_real[to], kf.bind_dual[to], factor);
+			float const interpolate_scale = MathLib::lerp(kf.bind_scale[from], kf.bind_scale[to], factor);
+
+			return key_error(interpolate_real, interpolate_dual, interpolate_scale, key);
+		};
 
-			if (MathLib::dot(kf.bind_real[base + 1], interpolate_real) < 0)
+		// Static tracks, such as the joints an action doesn't move, keep one key
+		bool is_static = true;
+		for (size_t i = 1; (i < num_kf) && is_static; ++ i)
+		{
+			is_static = (key_error(kf.bind_real[0], kf.bind_dual[0], kf.bind_scale[0], i) < TOLERANCE);
+		}
+		// Linear tracks keep the two end keys, without going through the greedy search
+		bool is_linear = !is_static;
+		for (size_t i = 1; (i < num_kf - 1) && is_linear; ++ i)
+		{
+			is_linear = (interpolation_error(0, num_kf - 1, i) < TOLERANCE);
+		}
+		if (is_static || is_linear)
+		{
+			size_t const num_kept = is_static ? 1 : 2;
+			if (is_linear)
+			{
+				kf.frame_id[1] = kf.frame_id[num_kf - 1];
+				kf.bind_real[1] = kf.bind_real[num_kf - 1];
+				kf.bind_dual[1] = kf.bind_dual[num_kf - 1];
+				kf.bind_scale[1] = kf.bind_scale[num_kf - 1];
+			}
+			kf.frame_id.resize(num_kept);
+			kf.bind_real.resize(num_kept);
+			kf.bind_dual.resize(num_kept);
+			kf.bind_scale.resize(num_kept);
+			return;
+		}
+
+		// Greedily drop keys, as long as every dropped key since the last kept one can be reconstructed within the tolerance
+		std::vector<bool> keep(num_kf, false);
+		keep[0] = true;
+		keep[num_kf - 1] = true;
+		size_t last_kept = 0;
+		for (size_t i = 1; i < num_kf - 1; ++ i)
+		{
+			bool removable = true;
+			for (size_t j = last_kept + 1; (j <= i) && removable; ++ j)
 			{
-				interpolate_real = -interpolate_real;
-				interpolate_dual = -interpolate_dual;
+				removable = (interpolation_error(last_kept, i + 1, j) < TOLERANCE);
 			}
 
-			Quaternion diff_real;
-			Quaternion diff_dual;
-			std::tie(diff_real, diff_dual) = MathLib::inverse(kf.bind_real[base + 1], kf.bind_dual[base + 1]);
-			diff_dual = MathLib::mul_dual(diff_real, diff_dual * scale, interpolate_real, interpolate_dual);
-			diff_real = MathLib::mul_real(diff_real, interpolate_real);
-			float diff_scale = scale * kf.bind_scale[base + 1];
-
-			if ((MathLib::abs(diff_real.x()) < THRESHOLD) && (MathLib::abs(diff_real.y()) < THRESHOLD)
-				&& (MathLib::abs(diff_real.z()) < THRESHOLD) && (MathLib::abs(diff_real.w() - 1) < THRESHOLD)
-				&& (MathLib::abs(diff_dual.x()) < THRESHOLD) && (MathLib::abs(diff_dual.y()) < THRESHOLD)
-				&& (MathLib::abs(diff_dual.z()) < THRESHOLD) && (MathLib::abs(diff_dual.w()) < THRESHOLD)
-				&& (MathLib::abs(diff_scale - 1) < THRESHOLD))
+			if (!removable)
 			{
-				kf.frame_id.erase(kf.frame_id.begin() + base + 1);
-				kf.bind_real.erase(kf.bind_real.begin() + base + 1);
-				kf.bind_dual.erase(kf.bind_dual.begin() + base + 1);
-				kf.bind_scale.erase(kf.bind_scale.begin() + base + 1);
+				keep[i] = true;
+				last_kept = i;
 			}
-			else
+		}
+
+		size_t num_kept = 0;
+		for (size_t i = 0; i < num_kf; ++ i)
+		{
+			if (keep[i])
 			{
-				++ base;
+				kf.frame_id[num_kept] = kf.frame_id[i];
+				kf.bind_real[num_kept] = kf.bind_real[i];
+				kf.bind_dual[num_kept] = kf.bind_dual[i];
+				kf.bind_scale[num_kept] = kf.bind_scale[i];
+				++ num_kept;
 			}
 		}
+		kf.frame_id.resize(num_kept);
+		kf.bind_real.resize(num_kept);
+		kf.bind_dual.resize(num_kept);
+		kf.bind_scale.resize(num_kept);
 	}
 
-
 	RenderModelPtr MeshLoader::Load(std::string_view input_name, MeshMetadata const & metadata)
 	{
 		std::string const input_name_str = ResLoader::Instance().Locate(input_name);
@@ -3202,6 +3714,10 @@ namespace
 			this->RemoveUnusedJoints();
 		}
 		this->RemoveUnusedMaterials();
+		if (metadata.OptimizeMesh())
+		{
+			this->OptimizeMeshes();
+		}
 
 		auto global_transform = metadata.Transform();
 		if (metadata.AutoCenter())
@@ -3605,5 +4121,40 @@ namespace KlayGE
 		MeshSaver ms;
 		ms.Save(model, output_name);
 	}
+
+	MeshConverter::VertexCacheStats MeshConverter::AnalyzeVertexCache(ArrayRef<uint32_t> indices, uint32_t num_vertices)
+	{
+		VertexCacheStats stats{ 0, 0 };
+		if (indices.empty())
+		{
+			return stats;
+		}
+
+		std::vector<uint32_t> cache_timestamps(num_vertices, 0);
+		std::vector<bool> referenced(num_vertices, false);
+		uint32_t timestamp = VERTEX_CACHE_SIZE + 1;
+		uint32_t num_misses = 0;
+		uint32_t num_referenced = 0;
+		for (auto const index : indices)
+		{
+			BOOST_ASSERT(index < num_vertices);
+
+			if (timestamp - cache_timestamps[index] > VERTEX_CACHE_SIZE)
+			{
+				cache_timestamps[index] = timestamp;
+				++ timestamp;
+				++ num_misses;
+			}
+			if (!referenced[index])
+			{
+				referenced[index] = true;
+				++ num_referenced;
+			}
+		}
+
+		stats.acmr = static_cast<float>(num_misses) / (indices.size() / 3);
+		stats.atvr = static_cast<float>(num_misses) / num_referenced;
+		return stats;
+	}
 }
 
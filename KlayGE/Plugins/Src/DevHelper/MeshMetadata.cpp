@@ -211,6 +211,13 @@ namespace KlayGE
 				new_metadata.flip_winding_order_ = flip_winding_order_val.GetBool();
 			}
 
+			if (document.HasMember("optimize_mesh"))
+			{
+				auto const & optimize_mesh_val = document["optimize_mesh"];
+				BOOST_ASSERT(optimize_mesh_val.IsBool());
+				new_metadata.optimize_mesh_ = optimize_mesh_val.GetBool();
+			}
+
 			if (document.HasMember("lod"))
 			{
 				auto const & lod_val = document["lod"];
@@ -318,6 +325,11 @@ namespace KlayGE
 			document.AddMember("flip_winding_order", flip_winding_order_, allocator);
 		}
 
+		if (!optimize_mesh_)
+		{
+			document.AddMember("optimize_mesh", optimize_mesh_, allocator);
+		}
+
 		if ((lod_file_names_.size() > 1) || ((lod_file_names_.size() == 1) && (lod_file_names_[0].size() > 1)))
 		{
 			rapidjson::Value array_names_val;
@@ -332,14 +332,10 @@ namespace
 		{
 			for (uint32_t arr = 0; arr < array_size_; ++ arr)
 			{
-				uint32_t w = width_;
-				uint32_t h = height_;
-				for (uint32_t m = 0; m < num_mipmaps_ - 1; ++ m)
+				auto mips = planes_[arr][0]->BuildMipChain(num_mipmaps_, metadata_.MipmapFilter());
+				for (uint32_t m = 1; m < num_mipmaps_; ++ m)
 				{
-					w = std::max<uint32_t>(1U, w / 2);
-					h = std::max<uint32_t>(1U, h / 2);
-
-					*planes_[arr][m + 1] = planes_[arr][m]->ResizeTo(w, h, metadata_.LinearMipmap());
+					*planes_[arr][m] = std::move(mips[m - 1]);
 				}
 			}
 
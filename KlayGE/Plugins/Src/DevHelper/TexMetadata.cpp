@@ -326,6 +326,40 @@ namespace KlayGE
 					auto const & linear_val = mipmap_val["linear"];
 					BOOST_ASSERT(linear_val.IsBool());
 					new_metadata.mipmap_.linear = linear_val.GetBool();
+					new_metadata.mipmap_.filter = new_metadata.mipmap_.linear ? RF_Linear : RF_Point;
+				}
+
+				if (mipmap_val.HasMember("filter"))
+				{
+					auto const & filter_val = mipmap_val["filter"];
+					BOOST_ASSERT(filter_val.IsString());
+					size_t const filter_hash = RT_HASH(filter_val.GetString());
+					switch (filter_hash)
+					{
+					case CT_HASH("point"):
+						new_metadata.mipmap_.filter = RF_Point;
+						break;
+
+					case CT_HASH("linear"):
+						new_metadata.mipmap_.filter = RF_Linear;
+						break;
+
+					case CT_HASH("box"):
+						new_metadata.mipmap_.filter = RF_Box;
+						break;
+
+					case CT_HASH("kaiser"):
+						new_metadata.mipmap_.filter = RF_Kaiser;
+						break;
+
+					case CT_HASH("lanczos"):
+						new_metadata.mipmap_.filter = RF_Lanczos;
+						break;
+
+					default:
+						KFL_UNREACHABLE("Invalid mipmap filter.");
+					}
+					new_metadata.mipmap_.linear = (new_metadata.mipmap_.filter != RF_Point);
 				}
 			}
 			else if (assign_default_values)
@@ -550,6 +584,34 @@ namespace KlayGE
 			mipmap_val.AddMember("num_levels", mipmap_.num_levels, allocator);
 			mipmap_val.AddMember("linear", mipmap_.linear, allocator);
 
+			char const * filter_str;
+			switch (mipmap_.filter)
+			{
+			case RF_Point:
+				filter_str = "point";
+				break;
+
+			case RF_Linear:
+				filter_str = "linear";
+				break;
+
+			case RF_Box:
+				filter_str = "box";
+				break;
+
+			case RF_Kaiser:
+				filter_str = "kaiser";
+				break;
+
+			case RF_Lanczos:
+				filter_str = "lanczos";
+				break;
+
+			default:
+				KFL_UNREACHABLE("Invalid mipmap filter.");
+			}
+			mipmap_val.AddMember("filter", rapidjson::StringRef(filter_str), allocator);
+
 			document.AddMember("mipmap", mipmap_val, allocator);
 		}
 
@@ -31,6 +31,7 @@
 #include <KlayGE/KlayGE.hpp>
 #include <KFL/ErrorHandling.hpp>
 #include <KFL/Hash.hpp>
+#include <KlayGE/RenderEffect.hpp>
 
 #include <KlayGE/NullRender/NullRenderEngine.hpp>
 
@@ -165,26 +166,30 @@ namespace KlayGE
 	void NullRenderEngine::DoRender(RenderEffect const & effect, RenderTechnique const & tech, RenderLayout const & rl)
 	{
 		KFL_UNUSED(effect);
-		KFL_UNUSED(tech);
 		KFL_UNUSED(rl);
+
+		// Counted like the other engines, so the draw call statistics can be checked without a device
+		num_draws_just_called_ += tech.NumPasses();
 	}
 
 	void NullRenderEngine::DoDispatch(RenderEffect const & effect, RenderTechnique const & tech, uint32_t tgx, uint32_t tgy, uint32_t tgz)
 	{
 		KFL_UNUSED(effect);
-		KFL_UNUSED(tech);
 		KFL_UNUSED(tgx);
 		KFL_UNUSED(tgy);
 		KFL_UNUSED(tgz);
+
+		num_dispatches_just_called_ += tech.NumPasses();
 	}
 
 	void NullRenderEngine::DoDispatchIndirect(RenderEffect const & effect, RenderTechnique const & tech,
 		GraphicsBufferPtr const & buff_args, uint32_t offset)
 	{
 		KFL_UNUSED(effect);
-		KFL_UNUSED(tech);
 		KFL_UNUSED(buff_args);
 		KFL_UNUSED(offset);
+
+		num_dispatches_just_called_ += tech.NumPasses();
 	}
 
 	void NullRenderEngine::DoResize(uint32_t width, uint32_t height)
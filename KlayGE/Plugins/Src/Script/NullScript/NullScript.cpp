@@ -61,6 +61,12 @@ namespace KlayGE
 		return std::any();
 	}
 
+	ScriptFunctionPtr NullScriptModule::Function(std::string const & name)
+	{
+		KFL_UNUSED(name);
+		return ScriptFunctionPtr();
+	}
+
 
 	NullScriptEngine::NullScriptEngine()
 	{
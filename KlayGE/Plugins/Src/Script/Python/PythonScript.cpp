@@ -364,10 +364,49 @@ namespace KlayGE
 		}
 	}
 
+	// Returns a new reference
+	PyObject* ScriptArg2PyObject(ScriptArg const & arg)
+	{
+		switch (arg.Type())
+		{
+		case ScriptArg::SAT_Bool:
+			return PyBool_FromLong(arg.Bool());
+
+		case ScriptArg::SAT_Int:
+			return PyLong_FromLongLong(arg.Int());
+
+		case ScriptArg::SAT_UInt:
+			return PyLong_FromUnsignedLongLong(arg.UInt());
+
+		case ScriptArg::SAT_Float:
+			return PyFloat_FromDouble(arg.Float());
+
+		case ScriptArg::SAT_String:
+			{
+				auto const str = arg.String();
+				return PyUnicode_FromStringAndSize(str.data(), str.size());
+			}
+
+		case ScriptArg::SAT_WString:
+			{
+				auto const str = arg.WString();
+				return PyUnicode_FromWideChar(str.data(), str.size());
+			}
+
+		default:
+			KFL_UNREACHABLE("Invalid script argument type");
+		}
+	}
+
 	std::any PyObjectPtr2CppType(PyObjectPtr const & t)
 	{
 		std::any ret;
-		if (PyObject_TypeCheck(t.get(), &PyUnicode_Type))
+		if (!t)
+		{
+			// The call raised
+			PyErr_Print();
+		}
+		else if (PyObject_TypeCheck(t.get(), &PyUnicode_Type))
 		{
 			ret = std::any(std::string(PyBytes_AsString(PyUnicode_AsASCIIString(t.get()))));
 		}
@@ -406,6 +445,73 @@ namespace KlayGE
 		return ret;
 	}
 
+	PyObjectPtr AnyArgs2PyTuple(ArrayRef<std::any> args)
+	{
+		PyObjectPtr py_args = MakePyObjectPtr(PyTuple_New(args.size()));
+		for (size_t i = 0; i < args.size(); ++ i)
+		{
+			PyObjectPtr value = CppType2PyObjectPtr(args[i]);
+			Py_IncRef(value.get());
+			PyTuple_SetItem(py_args.get(), i, value.get());
+		}
+		return py_args;
+	}
+
+
+	PythonScriptFunction::PythonScriptFunction(PyObjectPtr const & func)
+		: func_(func)
+	{
+	}
+
+	std::any PythonScriptFunction::Call(ArrayRef<std::any> args)
+	{
+		PyObjectPtr py_args = AnyArgs2PyTuple(args);
+		return PyObjectPtr2CppType(MakePyObjectPtr(PyObject_CallObject(func_.get(), py_args.get())));
+	}
+
+	std::any PythonScriptFunction::CallArgs(ArrayRef<ScriptArg> args)
+	{
+		PyObjectPtr py_args = MakePyObjectPtr(PyTuple_New(args.size()));
+		for (size_t i = 0; i < args.size(); ++ i)
+		{
+			PyTuple_SetItem(py_args.get(), i, ScriptArg2PyObject(args[i]));
+		}
+		return PyObjectPtr2CppType(MakePyObjectPtr(PyObject_CallObject(func_.get(), py_args.get())));
+	}
+
+	void PythonScriptFunction::CallBatch(ArrayRef<ScriptArg> args, uint32_t num_args_per_call, std::vector<std::any>* results)
+	{
+		BOOST_ASSERT(num_args_per_call > 0);
+		BOOST_ASSERT(args.size() % num_args_per_call == 0);
+
+		size_t const num_calls = args.size() / num_args_per_call;
+		if (results != nullptr)
+		{
+			results->assign(num_calls, std::any());
+		}
+
+		PyObjectPtr py_args;
+		for (size_t call = 0; call < num_calls; ++ call)
+		{
+			// The tuple is refilled in place, unless the function kept a reference to it
+			if (!py_args || (Py_REFCNT(py_args.get()) != 1))
+			{
+				py_args = MakePyObjectPtr(PyTuple_New(num_args_per_call));
+			}
+			for (uint32_t i = 0; i < num_args_per_call; ++ i)
+			{
+				PyTuple_SetItem(py_args.get(), i, ScriptArg2PyObject(args[call * num_args_per_call + i]));
+			}
+
+			std::any ret = PyObjectPtr2CppType(MakePyObjectPtr(PyObject_CallObject(func_.get(), py_args.get())));
+			if (results != nullptr)
+			{
+				(*results)[call] = std::move(ret);
+			}
+		}
+	}
+
+
 	PythonScriptModule::PythonScriptModule(std::string const & name)
 	{
 		if (name.empty())
@@ -436,13 +542,7 @@ namespace KlayGE
 
 	std::any PythonScriptModule::Call(std::string const & func_name, ArrayRef<std::any> args)
 	{
-		PyObjectPtr py_args = MakePyObjectPtr(PyTuple_New(args.size()));
-		for (size_t i = 0; i < args.size(); ++ i)
-		{
-			PyObjectPtr value = CppType2PyObjectPtr(args[i]);
-			Py_IncRef(value.get());
-			PyTuple_SetItem(py_args.get(), i, value.get());
-		}
+		PyObjectPtr py_args = AnyArgs2PyTuple(args);
 
 		PyObjectPtr func = std::any_cast<PyObjectPtr>(this->Value(func_name));
 		return PyObjectPtr2CppType(MakePyObjectPtr(PyObject_CallObject(func.get(), py_args.get())));
@@ -450,7 +550,38 @@ namespace KlayGE
 
 	std::any PythonScriptModule::RunString(std::string const & script)
 	{
-		return MakePyObjectPtr(PyRun_String(script.c_str(), Py_file_input, dict_.get(), dict_.get()));
+		// Scripts run every frame are usually a handful of fixed strings. The cache is dropped when it grows past that.
+		size_t constexpr MAX_CACHED_SCRIPTS = 256;
+
+		auto iter = code_cache_.find(script);
+		if (iter == code_cache_.end())
+		{
+			PyObjectPtr code = MakePyObjectPtr(Py_CompileString(script.c_str(), "<string>", Py_file_input));
+			if (!code)
+			{
+				return code;
+			}
+
+			if (code_cache_.size() >= MAX_CACHED_SCRIPTS)
+			{
+				code_cache_.clear();
+			}
+			iter = code_cache_.emplace(script, code).first;
+		}
+
+		return MakePyObjectPtr(PyEval_EvalCode(iter->second.get(), dict_.get(), dict_.get()));
+	}
+
+	ScriptFunctionPtr PythonScriptModule::Function(std::string const & name)
+	{
+		PyObject* p = PyDict_GetItemString(dict_.get(), name.c_str());
+		if ((p == nullptr) || !PyCallable_Check(p))
+		{
+			return ScriptFunctionPtr();
+		}
+
+		Py_IncRef(p);
+		return MakeSharedPtr<PythonScriptFunction>(MakePyObjectPtr(p));
 	}
 
 	PythonEngine::PythonEngine()
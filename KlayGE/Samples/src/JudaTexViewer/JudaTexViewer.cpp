@@ -404,6 +404,12 @@ void JudaTexViewer::DoUpdateOverlay()
 	font_->RenderText(0, 0, Color(1, 1, 0, 1), L"Juda Texture Viewer", 16);
 	font_->RenderText(0, 18, Color(1, 1, 0, 1), stream.str(), 16);
 
+	JudaTexture::CacheStats const cache_stats = juda_tex_->Stats();
+	stream.str(L"");
+	stream << "Tile cache hit rate: " << (cache_stats.requests > 0 ? 100.0 * cache_stats.hits / cache_stats.requests : 100.0)
+		<< "%, " << cache_stats.pending << " pending";
+	font_->RenderText(0, 36, Color(1, 1, 0, 1), stream.str(), 16);
+
 	if (tile_size_ * scale_ > 64)
 	{
 		for (uint32_t y = sy_; y < ey_; ++ y)
@@ -472,7 +478,7 @@ uint32_t JudaTexViewer::DoUpdate(uint32_t /*pass*/)
 		rl_border.VertexStreamFrequencyDivider(i, RenderLayout::ST_Geometry, nx * ny);
 	}
 
-	juda_tex_->UpdateCache(tile_ids);
+	juda_tex_->UpdateCacheAsync(tile_ids, 16);
 
 	Color clear_clr(0.2f, 0.4f, 0.6f, 1);
 	if (Context::Instance().Config().graphics_cfg.gamma)
@@ -690,6 +690,8 @@ void MotionBlurDoFApp::OnCreate()
 
 	ScriptEngine& scriptEngine = Context::Instance().ScriptFactoryInstance().ScriptEngineInstance();
 	script_module_ = scriptEngine.CreateModule("MotionBlurDoF_init");
+	get_pos_func_ = script_module_->Function("get_pos");
+	get_clr_func_ = script_module_->Function("get_clr");
 
 	this->LookAt(float3(-1.8f, 1.9f, -1.8f), float3(0, 0, 0));
 	this->Proj(0.1f, 100);
@@ -1105,30 +1107,55 @@ uint32_t MotionBlurDoFApp::DoUpdate(uint32_t pass)
 			else if (loading_percentage_ < 80)
 			{
 				int32_t i = loading_percentage_ - (80 - NUM_LINE);
+
+				std::vector<ScriptArg> script_args;
+				script_args.reserve(NUM_INSTANCE / NUM_LINE * 4);
+				for (int32_t j = 0; j < NUM_INSTANCE / NUM_LINE; ++ j)
+				{
+					script_args.emplace_back(i);
+					script_args.emplace_back(j);
+					script_args.emplace_back(NUM_INSTANCE);
+					script_args.emplace_back(NUM_LINE);
+				}
+				std::vector<std::any> scr_poses;
+				std::vector<std::any> scr_clrs;
+				if (get_pos_func_ && get_clr_func_)
+				{
+					get_pos_func_->CallBatch(script_args, 4, &scr_poses);
+					get_clr_func_->CallBatch(script_args, 4, &scr_clrs);
+				}
+				else
+				{
+					LogWarn() << "get_pos or get_clr is missing in the script" << std::endl;
+				}
+				scr_poses.resize(NUM_INSTANCE / NUM_LINE);
+				scr_clrs.resize(NUM_INSTANCE / NUM_LINE);
+
 				for (int32_t j = 0; j < NUM_INSTANCE / NUM_LINE; ++ j)
 				{
 					float3 pos(0, 0, 0);
 					Color clr(0, 0, 0, 1);
-					try
+					if (scr_poses[j].has_value() && scr_clrs[j].has_value())
 					{
-						std::vector<std::any> scr_pos = std::any_cast<std::vector<std::any>>(script_module_->Call("get_pos",
-							{ i, j, NUM_INSTANCE, NUM_LINE }));
+						try
+						{
+							std::vector<std::any> scr_pos = std::any_cast<std::vector<std::any>>(scr_poses[j]);
 
-						pos.x() = std::any_cast<float>(scr_pos[0]);
-						pos.y() = std::any_cast<float>(scr_pos[1]);
-						pos.z() = std::any_cast<float>(scr_pos[2]);
+							pos.x() = std::any_cast<float>(scr_pos[0]);
+							pos.y() = std::any_cast<float>(scr_pos[1]);
+							pos.z() = std::any_cast<float>(scr_pos[2]);
 
-						std::vector<std::any> scr_clr = std::any_cast<std::vector<std::any>>(script_module_->Call("get_clr",
-							{i, j, NUM_INSTANCE, NUM_LINE }));
+							std::vector<std::any> scr_clr = std::any_cast<std::vector<std::any>>(scr_clrs[j]);
 
-						clr.r() = std::any_cast<float>(scr_clr[0]);
-						clr.g() = std::any_cast<float>(scr_clr[1]);
-						clr.b() = std::any_cast<float>(scr_clr[2]);
-						clr.a() = std::any_cast<float>(scr_clr[3]);
-					}
-					catch (...)
-					{
-						LogWarn() << "Wrong callings to script engine" << std::endl;
+							clr.r() = std::any_cast<float>(scr_clr[0]);
+							clr.g() = std::any_cast<float>(scr_clr[1]);
+							clr.b() = std::any_cast<float>(scr_clr[2]);
+							clr.a() = std::any_cast<float>(scr_clr[3]);
+						}
+						catch (...)
+						{
+							LogWarn() << "Wrong callings to script engine" << std::endl;
+						}
 					}
 
 					auto so = MakeSharedPtr<Teapot>();
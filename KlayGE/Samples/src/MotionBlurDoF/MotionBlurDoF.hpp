@@ -62,6 +62,8 @@ private:
 	KlayGE::PostProcessPtr motion_blur_copy_pp_;
 
 	KlayGE::ScriptModulePtr script_module_;
+	KlayGE::ScriptFunctionPtr get_pos_func_;
+	KlayGE::ScriptFunctionPtr get_clr_func_;
 	KlayGE::RenderModelPtr model_instance_;
 	KlayGE::RenderModelPtr model_mesh_;
 	KlayGE::uint32_t loading_percentage_;
@@ -0,0 +1,303 @@
+#include <KlayGE/KlayGE.hpp>
+#include <KFL/Math.hpp>
+#include <KFL/Timer.hpp>
+#include <KlayGE/AudioMixer.hpp>
+
+#include "KlayGETests.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <vector>
+
+using namespace std;
+using namespace KlayGE;
+
+namespace
+{
+	class BufferVoice : public AudioVoice
+	{
+	public:
+		BufferVoice(vector<float> const & samples, uint32_t num_channels, uint32_t freq)
+			: AudioVoice(num_channels, freq), samples_(samples), frame_(0)
+		{
+		}
+
+	private:
+		uint32_t Fetch(float* samples, uint32_t num_frames) override
+		{
+			uint32_t const num_channels = this->NumChannels();
+			uint32_t const n = std::min(num_frames, static_cast<uint32_t>(samples_.size() / num_channels) - frame_);
+			memcpy(samples, &samples_[frame_ * num_channels], n * num_channels * sizeof(float));
+			frame_ += n;
+			return n;
+		}
+
+	private:
+		vector<float> samples_;
+		uint32_t frame_;
+	};
+
+	vector<float> RandomSamples(uint32_t num_samples, uint32_t seed)
+	{
+		mt19937 gen(seed);
+		uniform_real_distribution<float> dis(-1, 1);
+		vector<float> samples(num_samples);
+		for (auto& s : samples)
+		{
+			s = dis(gen);
+		}
+		return samples;
+	}
+
+	vector<float> MixAll(AudioMixer& mixer, uint32_t block_frames)
+	{
+		vector<float> output;
+		vector<float> block(block_frames * 2);
+		while (mixer.NumVoices() > 0)
+		{
+			mixer.Mix(block.data(), block_frames);
+			output.insert(output.end(), block.begin(), block.end());
+		}
+		return output;
+	}
+}
+
+TEST(AudioMixerTest, SameRate)
+{
+	uint32_t const NUM_FRAMES = 1001;
+	vector<float> const mono = RandomSamples(NUM_FRAMES, 1);
+	vector<float> const stereo = RandomSamples(NUM_FRAMES * 2, 2);
+
+	AudioMixer mixer(48000);
+	auto mono_voice = MakeSharedPtr<BufferVoice>(mono, 1, 48000);
+	mono_voice->Gains(0.5f, 0.25f);
+	mixer.AddVoice(mono_voice);
+	auto stereo_voice = MakeSharedPtr<BufferVoice>(stereo, 2, 48000);
+	stereo_voice->Gains(0.25f, 0.5f);
+	mixer.AddVoice(stereo_voice);
+
+	vector<float> const output = MixAll(mixer, 256);
+	EXPECT_TRUE(mono_voice->Finished());
+	EXPECT_TRUE(stereo_voice->Finished());
+	ASSERT_GE(output.size(), NUM_FRAMES * 2U);
+	for (uint32_t i = 0; i < NUM_FRAMES; ++ i)
+	{
+		EXPECT_FLOAT_EQ(mono[i] * 0.5f + stereo[i * 2 + 0] * 0.25f, output[i * 2 + 0]) << "Frame " << i;
+		EXPECT_FLOAT_EQ(mono[i] * 0.25f + stereo[i * 2 + 1] * 0.5f, output[i * 2 + 1]) << "Frame " << i;
+	}
+	for (size_t i = NUM_FRAMES * 2; i < output.size(); ++ i)
+	{
+		EXPECT_EQ(0, output[i]);
+	}
+}
+
+TEST(AudioMixerTest, Resample)
+{
+	uint32_t const NUM_FRAMES = 1000;
+	vector<float> const samples = RandomSamples(NUM_FRAMES * 2, 3);
+
+	for (float const pitch : { 0.5f, 0.75f, 1.3f, 2.0f })
+	{
+		AudioMixer mixer(48000);
+		auto voice = MakeSharedPtr<BufferVoice>(samples, 2, 32000);
+		voice->Gains(1, 1);
+		voice->Pitch(pitch);
+		mixer.AddVoice(voice);
+
+		vector<float> const output = MixAll(mixer, 100);
+
+		double const step = pitch * 32000.0 / 48000.0;
+		uint32_t const num_output_frames = static_cast<uint32_t>(ceil(NUM_FRAMES / step));
+		ASSERT_GE(output.size(), num_output_frames * 2U);
+		for (uint32_t i = 0; i < num_output_frames; ++ i)
+		{
+			double const pos = i * step;
+			uint32_t const index = static_cast<uint32_t>(pos);
+			double const frac = pos - index;
+			for (uint32_t c = 0; c < 2; ++ c)
+			{
+				float const s0 = samples[index * 2 + c];
+				float const s1 = (index + 1 < NUM_FRAMES) ? samples[index * 2 + 2 + c] : 0.0f;
+				float const expected = static_cast<float>(s0 + (s1 - s0) * frac);
+				ASSERT_NEAR(expected, output[i * 2 + c], 1e-4f) << "Pitch " << pitch << ", frame " << i;
+			}
+		}
+		// The 32.32 fixed point step may reach one more frame, which interpolates to silence
+		for (size_t i = num_output_frames * 2; i < output.size(); ++ i)
+		{
+			ASSERT_NEAR(0, output[i], 1e-4f);
+		}
+	}
+}
+
+TEST(AudioMixerTest, GainRamp)
+{
+	vector<float> const samples(512, 1.0f);
+
+	AudioMixer mixer(48000);
+	auto voice = MakeSharedPtr<BufferVoice>(samples, 1, 48000);
+	voice->Gains(0, 0);
+	mixer.AddVoice(voice);
+
+	vector<float> output(256 * 2);
+	voice->Gains(1, 0.5f);
+	mixer.Mix(output.data(), 256);
+	for (uint32_t i = 0; i < 256; ++ i)
+	{
+		EXPECT_NEAR(i / 256.0f, output[i * 2 + 0], 1e-6f);
+		EXPECT_NEAR(i / 512.0f, output[i * 2 + 1], 1e-6f);
+	}
+
+	mixer.Mix(output.data(), 256);
+	EXPECT_FLOAT_EQ(1, output[0]);
+	EXPECT_FLOAT_EQ(0.5f, output[1]);
+}
+
+TEST(AudioMixerTest, RemoveVoice)
+{
+	AudioMixer mixer(48000);
+	auto voice = MakeSharedPtr<BufferVoice>(vector<float>(48000, 1.0f), 1, 48000);
+	voice->Gains(1, 1);
+	mixer.AddVoice(voice);
+	EXPECT_EQ(1U, mixer.NumVoices());
+
+	vector<float> output(256 * 2);
+	mixer.Mix(output.data(), 256);
+	mixer.RemoveVoice(voice.get());
+	EXPECT_EQ(0U, mixer.NumVoices());
+	EXPECT_FALSE(voice->Finished());
+
+	mixer.Mix(output.data(), 256);
+	EXPECT_TRUE(all_of(output.begin(), output.end(), [](float v) { return 0 == v; }));
+}
+
+TEST(AudioMixerTest, Spatialize)
+{
+	float3 const listener_pos(1, 2, 3);
+	float3 const face(0, 0, 1);
+	float3 const up(0, 1, 0);
+
+	float gain_left;
+	float gain_right;
+	float pitch;
+
+	AudioMixer::Spatialize(listener_pos, float3::Zero(), face, up, listener_pos + float3(0, 0, 0.5f), float3::Zero(),
+		gain_left, gain_right, pitch);
+	EXPECT_FLOAT_EQ(sqrt(0.5f), gain_left);
+	EXPECT_FLOAT_EQ(sqrt(0.5f), gain_right);
+	EXPECT_FLOAT_EQ(1, pitch);
+
+	AudioMixer::Spatialize(listener_pos, float3::Zero(), face, up, listener_pos + float3(4, 0, 0), float3::Zero(),
+		gain_left, gain_right, pitch);
+	EXPECT_NEAR(0, gain_left, 1e-5f);
+	EXPECT_FLOAT_EQ(0.25f, gain_right);
+
+	AudioMixer::Spatialize(listener_pos, float3::Zero(), face, up, listener_pos + float3(-2, 0, 0), float3::Zero(),
+		gain_left, gain_right, pitch);
+	EXPECT_FLOAT_EQ(0.5f, gain_left);
+	EXPECT_NEAR(0, gain_right, 1e-5f);
+
+	// Approaching, then receding
+	AudioMixer::Spatialize(listener_pos, float3::Zero(), face, up, listener_pos + float3(0, 0, 10), float3(0, 0, -34.3f),
+		gain_left, gain_right, pitch);
+	EXPECT_FLOAT_EQ(343 / (343 - 34.3f), pitch);
+	AudioMixer::Spatialize(listener_pos, float3::Zero(), face, up, listener_pos + float3(0, 0, 10), float3(0, 0, 34.3f),
+		gain_left, gain_right, pitch);
+	EXPECT_FLOAT_EQ(343 / (343 + 34.3f), pitch);
+}
+
+TEST(AudioMixerTest, WavSink)
+{
+	auto render = [](shared_ptr<ostream> const & os)
+	{
+		AudioMixer mixer(48000);
+		for (uint32_t i = 0; i < 64; ++ i)
+		{
+			auto voice = MakeSharedPtr<BufferVoice>(RandomSamples(4800 + i * 37, i), 1 + (i & 1), 22050 + i * 1000);
+			voice->Gains(0.05f, 0.03f);
+			voice->Pitch(0.9f + i * 0.01f);
+			mixer.AddVoice(voice);
+		}
+
+		WavAudioSink sink(os, mixer.Freq());
+		vector<float> block(256 * 2);
+		while (mixer.NumVoices() > 0)
+		{
+			mixer.Mix(block.data(), 256);
+			sink.Write(block.data(), 256);
+		}
+		return sink.NumFrames();
+	};
+
+	auto os0 = MakeSharedPtr<stringstream>();
+	auto os1 = MakeSharedPtr<stringstream>();
+	uint64_t const num_frames = render(os0);
+	EXPECT_EQ(num_frames, render(os1));
+
+	string const wav = os0->str();
+	EXPECT_EQ(wav, os1->str());
+	ASSERT_EQ(44 + num_frames * 4, wav.size());
+
+	EXPECT_EQ(0, memcmp(wav.data(), "RIFF", 4));
+	EXPECT_EQ(0, memcmp(wav.data() + 8, "WAVEfmt ", 8));
+	EXPECT_EQ(0, memcmp(wav.data() + 36, "data", 4));
+	uint32_t riff_size;
+	memcpy(&riff_size, wav.data() + 4, sizeof(riff_size));
+	EXPECT_EQ(wav.size() - 8, LE2Native(riff_size));
+	uint32_t data_size;
+	memcpy(&data_size, wav.data() + 40, sizeof(data_size));
+	EXPECT_EQ(num_frames * 4, LE2Native(data_size));
+}
+
+TEST(AudioMixerTest, WavSinkClamps)
+{
+	auto os = MakeSharedPtr<stringstream>();
+	{
+		WavAudioSink sink(os, 48000);
+		float const frames[] = { 2, -2, 0.5f, -0.5f, 1, -1, 0, 1.0f / 65534, 0.25f, 0.75f };
+		sink.Write(frames, 5);
+	}
+
+	string const wav = os->str();
+	ASSERT_EQ(44 + 5 * 4U, wav.size());
+	int16_t const expected[] = { 32767, -32767, 16384, -16384, 32767, -32767, 0, 0, 8192, 24575 };
+	for (uint32_t i = 0; i < 10; ++ i)
+	{
+		int16_t s;
+		memcpy(&s, wav.data() + 44 + i * 2, sizeof(s));
+		EXPECT_EQ(expected[i], LE2Native(s)) << "Sample " << i;
+	}
+}
+
+// Mixing speed relative to real time. Pass --gtest_also_run_disabled_tests to run it.
+TEST(AudioMixerTest, DISABLED_Performance)
+{
+	uint32_t const NUM_VOICES = 256;
+	uint32_t const FREQ = 48000;
+
+	for (float const pitch : { 1.0f, 1.1f })
+	{
+		AudioMixer mixer(FREQ);
+		for (uint32_t i = 0; i < NUM_VOICES; ++ i)
+		{
+			auto voice = MakeSharedPtr<BufferVoice>(RandomSamples(FREQ * 2 * (1 + (i & 1)), i), 1 + (i & 1), FREQ);
+			voice->Gains(1.0f / NUM_VOICES, 1.0f / NUM_VOICES);
+			voice->Pitch(pitch);
+			mixer.AddVoice(voice);
+		}
+
+		vector<float> block(256 * 2);
+		Timer timer;
+		for (uint32_t i = 0; i < FREQ / 256; ++ i)
+		{
+			mixer.Mix(block.data(), 256);
+		}
+		double const time = timer.elapsed();
+
+		cout << NUM_VOICES << " voices, pitch " << pitch << ": " << FREQ / 256 * 256 / time / FREQ
+			<< "x real time" << endl;
+	}
+}
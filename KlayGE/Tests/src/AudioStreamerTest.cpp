@@ -0,0 +1,183 @@
+#include <KlayGE/KlayGE.hpp>
+#include <KlayGE/AudioDataSource.hpp>
+#include <KlayGE/Audio.hpp>
+
+#include "KlayGETests.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+using namespace std;
+using namespace KlayGE;
+
+namespace
+{
+	class MemoryAudioDataSource : public AudioDataSource
+	{
+	public:
+		MemoryAudioDataSource(AudioFormat format, uint32_t freq, size_t size)
+			: data_(size), pos_(0), read_log_(nullptr), id_(0)
+		{
+			format_ = format;
+			freq_ = freq;
+
+			for (size_t i = 0; i < size; ++ i)
+			{
+				data_[i] = static_cast<uint8_t>(i * 7 + i / 251);
+			}
+		}
+
+		void Open(ResIdentifierPtr const & file) override
+		{
+			KFL_UNUSED(file);
+		}
+
+		void Close() override
+		{
+		}
+
+		size_t Size() override
+		{
+			return data_.size();
+		}
+
+		size_t Read(void* data, size_t size) override
+		{
+			size_t const read_size = std::min(size, data_.size() - pos_);
+			memcpy(data, &data_[pos_], read_size);
+			pos_ += read_size;
+			if (read_log_ && (read_size > 0))
+			{
+				read_log_->push_back(id_);
+			}
+			return read_size;
+		}
+
+		void Reset() override
+		{
+			pos_ = 0;
+		}
+
+		vector<uint8_t> const & Data() const
+		{
+			return data_;
+		}
+
+		// Records the id on every read, to see in which order sources are decoded
+		void ReadLog(vector<uint32_t>* log, uint32_t id)
+		{
+			read_log_ = log;
+			id_ = id;
+		}
+
+	private:
+		vector<uint8_t> data_;
+		size_t pos_;
+
+		vector<uint32_t>* read_log_;
+		uint32_t id_;
+	};
+}
+
+TEST(AudioStreamerTest, WholeStream)
+{
+	auto source = MakeSharedPtr<MemoryAudioDataSource>(AF_Stereo16, 8000, 32000 * 3 + 100);
+	auto stream = MakeSharedPtr<AudioStream>(source, 1);
+	AudioStreamer streamer(false);
+
+	vector<uint8_t> played;
+	vector<uint8_t> block(3200);
+	streamer.Register(stream, [&]
+		{
+			size_t const read_size = stream->Read(block.data(), block.size());
+			played.insert(played.end(), block.begin(), block.begin() + read_size);
+		});
+
+	stream->Fill();
+	for (uint32_t i = 0; (i < 1000) && !stream->EndOfStream(); ++ i)
+	{
+		streamer.Update();
+	}
+	streamer.Unregister(stream);
+
+	EXPECT_TRUE(stream->EndOfStream());
+	EXPECT_TRUE(played == source->Data());
+	EXPECT_EQ(streamer.NumUnderruns(), 0U);
+}
+
+TEST(AudioStreamerTest, Loop)
+{
+	auto source = MakeSharedPtr<MemoryAudioDataSource>(AF_Mono8, 8000, 3000);
+	auto stream = MakeSharedPtr<AudioStream>(source, 1);
+	stream->Loop(true);
+	stream->Fill();
+
+	EXPECT_FALSE(stream->EndOfStream());
+	EXPECT_FLOAT_EQ(stream->BufferedSeconds(), 1.0f);
+
+	vector<uint8_t> played(8000);
+	EXPECT_EQ(stream->Read(played.data(), played.size()), played.size());
+	for (size_t i = 0; i < played.size(); ++ i)
+	{
+		EXPECT_EQ(played[i], source->Data()[i % source->Data().size()]);
+	}
+	EXPECT_EQ(stream->NumUnderruns(), 0U);
+}
+
+TEST(AudioStreamerTest, Underrun)
+{
+	auto source = MakeSharedPtr<MemoryAudioDataSource>(AF_Mono16, 8000, 16000 * 4);
+	auto stream = MakeSharedPtr<AudioStream>(source, 1);
+	AudioStreamer streamer(false);
+
+	stream->Fill();
+	vector<uint8_t> block(20000);
+	EXPECT_EQ(stream->Read(block.data(), 8000), 8000U);
+	EXPECT_EQ(stream->NumUnderruns(), 0U);
+
+	// Asks for more than the ring holds between two updates
+	streamer.Register(stream, [&]
+		{
+			stream->Read(block.data(), block.size());
+		});
+	streamer.Update();
+	EXPECT_GT(streamer.NumUnderruns(), 0U);
+
+	uint32_t const num_underruns = streamer.NumUnderruns();
+	streamer.Unregister(stream);
+	EXPECT_EQ(streamer.NumUnderruns(), num_underruns);
+}
+
+TEST(AudioStreamerTest, Deadline)
+{
+	auto source0 = MakeSharedPtr<MemoryAudioDataSource>(AF_Mono8, 8000, 80000);
+	auto source1 = MakeSharedPtr<MemoryAudioDataSource>(AF_Mono8, 8000, 80000);
+	auto stream0 = MakeSharedPtr<AudioStream>(source0, 2);
+	auto stream1 = MakeSharedPtr<AudioStream>(source1, 2);
+	AudioStreamer streamer(false);
+	streamer.Register(stream0, nullptr);
+	streamer.Register(stream1, nullptr);
+
+	stream0->Fill();
+	stream1->Fill();
+
+	vector<uint8_t> block(12000);
+	stream0->Read(block.data(), 12000);
+	stream1->Read(block.data(), 4000);
+	EXPECT_LT(stream0->BufferedSeconds(), stream1->BufferedSeconds());
+
+	vector<uint32_t> read_log;
+	source0->ReadLog(&read_log, 0);
+	source1->ReadLog(&read_log, 1);
+	streamer.Update();
+
+	// Stream 0 is 1 second behind. It gets all the 1/8 second decoding steps until it catches up.
+	ASSERT_GE(read_log.size(), 8U);
+	EXPECT_EQ(vector<uint32_t>(8, 0), vector<uint32_t>(read_log.begin(), read_log.begin() + 8));
+	EXPECT_FLOAT_EQ(stream0->BufferedSeconds(), 2.0f);
+	EXPECT_FLOAT_EQ(stream1->BufferedSeconds(), 2.0f);
+
+	streamer.Unregister(stream0);
+	streamer.Unregister(stream1);
+}
@@ -0,0 +1,164 @@
+/**
+ * @file AutoInstancingTest.cpp
+ * @author Minmin Gong
+ *
+ * @section DESCRIPTION
+ *
+ * This source file is part of KlayGE
+ * For the latest info, see http://www.klayge.org
+ *
+ * @section LICENSE
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * You may alternatively use this source under the terms of
+ * the KlayGE Proprietary License (KPL). You can obtained such a license
+ * from http://www.klayge.org/licensing/.
+ */
+
+#include <KlayGE/KlayGE.hpp>
+#include <KFL/Math.hpp>
+#include <KlayGE/Camera.hpp>
+#include <KlayGE/FrameBuffer.hpp>
+#include <KlayGE/GraphicsBuffer.hpp>
+#include <KlayGE/RenderEffect.hpp>
+#include <KlayGE/RenderEngine.hpp>
+#include <KlayGE/RenderFactory.hpp>
+#include <KlayGE/Renderable.hpp>
+#include <KlayGE/SceneNode.hpp>
+#include <KlayGE/Viewport.hpp>
+
+#include <vector>
+
+#include "KlayGETests.hpp"
+
+using namespace std;
+using namespace KlayGE;
+
+namespace
+{
+	class AutoInstancingTriangle : public Renderable
+	{
+	public:
+		AutoInstancingTriangle(RenderEffectPtr const & effect, std::string_view tech_name, uint32_t num_lods)
+			: Renderable(L"AutoInstancingTriangle")
+		{
+			float3 const pos[] =
+			{
+				float3(-1, -1, 0),
+				float3(+1, -1, 0),
+				float3(0, +1, 0)
+			};
+
+			auto& rf = Context::Instance().RenderFactoryInstance();
+			auto vb = rf.MakeVertexBuffer(BU_Static, EAH_GPU_Read | EAH_Immutable, sizeof(pos), pos);
+
+			this->NumLods(num_lods);
+			for (uint32_t lod = 0; lod < num_lods; ++ lod)
+			{
+				rls_[lod] = rf.MakeRenderLayout();
+				rls_[lod]->TopologyType(RenderLayout::TT_TriangleList);
+				rls_[lod]->BindVertexStream(vb, VertexElement(VEU_Position, 0, EF_BGR32F));
+			}
+
+			pos_aabb_ = AABBox(float3(-1, -1, 0), float3(+1, +1, 0));
+
+			effect_ = effect;
+			technique_ = effect_->TechniqueByName(tech_name);
+		}
+
+		void OnRenderBegin() override
+		{
+			auto const & camera = *Context::Instance().RenderFactoryInstance().RenderEngineInstance().CurFrameBuffer()
+				->GetViewport()->camera;
+			*(effect_->ParameterByName("mvp")) = model_mat_ * camera.ViewProjMatrix();
+		}
+	};
+
+	uint32_t RenderAndCountDraws(Renderable& renderable)
+	{
+		auto& re = Context::Instance().RenderFactoryInstance().RenderEngineInstance();
+		re.NumDrawsJustCalled();
+		renderable.Render();
+		return re.NumDrawsJustCalled();
+	}
+}
+
+TEST(AutoInstancingTest, TechniqueAnnotation)
+{
+	auto effect = SyncLoadRenderEffect("AutoInstancing/AutoInstancingTest.fxml");
+	EXPECT_FALSE(effect->TechniqueByName("NonInstanced")->AutoInstancing());
+	EXPECT_TRUE(effect->TechniqueByName("AutoInstanced")->AutoInstancing());
+}
+
+TEST(AutoInstancingTest, OneDrawForAllNodes)
+{
+	auto effect = SyncLoadRenderEffect("AutoInstancing/AutoInstancingTest.fxml");
+
+	AutoInstancingTriangle non_instanced(effect, "NonInstanced", 1);
+	AutoInstancingTriangle auto_instanced(effect, "AutoInstanced", 1);
+
+	uint32_t const num_nodes = 16;
+	vector<SceneNodePtr> nodes;
+	for (uint32_t i = 0; i < num_nodes; ++ i)
+	{
+		auto node = MakeSharedPtr<SceneNode>(SceneNode::SOA_Cullable);
+		node->TransformToParent(MathLib::translation(static_cast<float>(i) * 3, 0.0f, 10.0f));
+		node->UpdateTransforms();
+		nodes.push_back(node);
+
+		non_instanced.AddInstance(node.get());
+		auto_instanced.AddInstance(node.get());
+	}
+
+	EXPECT_EQ(num_nodes, RenderAndCountDraws(non_instanced));
+	EXPECT_EQ(1U, RenderAndCountDraws(auto_instanced));
+}
+
+TEST(AutoInstancingTest, OneDrawPerLod)
+{
+	auto effect = SyncLoadRenderEffect("AutoInstancing/AutoInstancingTest.fxml");
+
+	auto& camera = *Context::Instance().RenderFactoryInstance().RenderEngineInstance().CurFrameBuffer()->GetViewport()->camera;
+	camera.ViewParams(float3(0, 0, 0), float3(0, 0, 1));
+	camera.ProjParams(PI / 4, 1, 0.1f, 5000);
+
+	AutoInstancingTriangle auto_instanced(effect, "AutoInstanced", 2);
+	auto_instanced.ActiveLod(-1);
+
+	vector<SceneNodePtr> nodes;
+	for (uint32_t i = 0; i < 8; ++ i)
+	{
+		// Alternates between large close instances and small distant ones
+		auto node = MakeSharedPtr<SceneNode>(SceneNode::SOA_Cullable);
+		if (i & 1)
+		{
+			node->TransformToParent(MathLib::translation(0.0f, 0.0f, 1000.0f));
+		}
+		else
+		{
+			node->TransformToParent(MathLib::scaling(10.0f, 10.0f, 10.0f) * MathLib::translation(0.0f, 0.0f, 5.0f));
+		}
+		node->UpdateTransforms();
+		nodes.push_back(node);
+
+		auto_instanced.AddInstance(node.get());
+	}
+
+	EXPECT_EQ(2U, RenderAndCountDraws(auto_instanced));
+
+	auto_instanced.ActiveLod(1);
+	EXPECT_EQ(1U, RenderAndCountDraws(auto_instanced));
+}
@@ -0,0 +1,109 @@
+/**
+ * @file DeferredRenderingLayerTest.cpp
+ * @author Minmin Gong
+ *
+ * @section DESCRIPTION
+ *
+ * This source file is part of KlayGE
+ * For the latest info, see http://www.klayge.org
+ *
+ * @section LICENSE
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * You may alternatively use this source under the terms of
+ * the KlayGE Proprietary License (KPL). You can obtained such a license
+ * from http://www.klayge.org/licensing/.
+ */
+
+#include <KlayGE/KlayGE.hpp>
+#include <KlayGE/App3D.hpp>
+#include <KlayGE/Camera.hpp>
+#include <KlayGE/Context.hpp>
+#include <KlayGE/DeferredRenderingLayer.hpp>
+#include <KlayGE/FrameBuffer.hpp>
+#include <KlayGE/Light.hpp>
+#include <KlayGE/RenderEngine.hpp>
+#include <KlayGE/RenderFactory.hpp>
+#include <KlayGE/Viewport.hpp>
+
+#include "KlayGETests.hpp"
+
+using namespace std;
+using namespace KlayGE;
+
+namespace
+{
+	// Runs the jobs of one frame. Nothing is in the scene, so the flushes can be skipped.
+	void RenderFrame(DeferredRenderingLayer& layer)
+	{
+		for (uint32_t pass = 0;; ++ pass)
+		{
+			if (layer.Update(pass) & App3DFramework::URV_Finished)
+			{
+				break;
+			}
+		}
+	}
+}
+
+TEST(DeferredRenderingLayerTest, JobGraphRebuilds)
+{
+	auto& re = Context::Instance().RenderFactoryInstance().RenderEngineInstance();
+	auto const & screen_fb = re.CurFrameBuffer();
+	Camera& camera = *screen_fb->GetViewport()->camera;
+	camera.ViewParams(float3(0, 0, -5), float3(0, 0, 0));
+
+	DeferredRenderingLayer layer;
+	layer.SetupViewport(0, screen_fb, 0);
+
+	RenderFrame(layer);
+	EXPECT_EQ(layer.NumJobGraphRebuilds(), 1U);
+
+	// Camera motion only changes what the jobs see
+	camera.ViewParams(float3(1, 2, -5), float3(0, 0, 0));
+	RenderFrame(layer);
+	RenderFrame(layer);
+	EXPECT_EQ(layer.NumJobGraphRebuilds(), 1U);
+
+	auto light = MakeSharedPtr<PointLightSource>();
+	light->Attrib(LightSource::LSA_NoShadow);
+	light->Color(float3(1, 1, 1));
+	light->Falloff(float3(1, 0, 1));
+	light->AddToSceneManager();
+
+	RenderFrame(layer);
+	EXPECT_EQ(layer.NumJobGraphRebuilds(), 2U);
+	RenderFrame(layer);
+	EXPECT_EQ(layer.NumJobGraphRebuilds(), 2U);
+
+	// Shadowing adds the shadow map jobs
+	light->Attrib(0);
+	RenderFrame(layer);
+	EXPECT_EQ(layer.NumJobGraphRebuilds(), 3U);
+
+	layer.Display(DeferredRenderingLayer::DT_Normal);
+	RenderFrame(layer);
+	EXPECT_EQ(layer.NumJobGraphRebuilds(), 4U);
+	layer.Display(DeferredRenderingLayer::DT_Final);
+	RenderFrame(layer);
+	EXPECT_EQ(layer.NumJobGraphRebuilds(), 5U);
+
+	light->DelFromSceneManager();
+	RenderFrame(layer);
+	EXPECT_EQ(layer.NumJobGraphRebuilds(), 6U);
+	RenderFrame(layer);
+	EXPECT_EQ(layer.NumJobGraphRebuilds(), 6U);
+}
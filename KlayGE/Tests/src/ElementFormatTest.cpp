@@ -0,0 +1,170 @@
+#include <KlayGE/KlayGE.hpp>
+#include <KFL/Math.hpp>
+#include <KFL/Half.hpp>
+#include <KFL/Timer.hpp>
+#include <KlayGE/ElementFormat.hpp>
+
+#include "KlayGETests.hpp"
+
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace std;
+using namespace KlayGE;
+
+namespace
+{
+	vector<uint8_t> RandomBytes(uint32_t size, uint32_t seed)
+	{
+		mt19937 gen(seed);
+		uniform_int_distribution<int> dis(0, 255);
+		vector<uint8_t> bytes(size);
+		for (auto& b : bytes)
+		{
+			b = static_cast<uint8_t>(dis(gen));
+		}
+		return bytes;
+	}
+}
+
+TEST(ElementFormatTest, UNorm8RoundTrip)
+{
+	ElementFormat const formats[] = { EF_A8, EF_R8, EF_GR8, EF_BGR8, EF_ARGB8, EF_ABGR8, EF_ARGB8_SRGB, EF_ABGR8_SRGB };
+	uint32_t const NUM_ELEMS = 1027;
+
+	for (auto fmt : formats)
+	{
+		uint32_t const elem_size = NumFormatBytes(fmt);
+		vector<uint8_t> const src = RandomBytes(NUM_ELEMS * elem_size, fmt & 0xFFFF);
+		vector<Color> clrs(NUM_ELEMS);
+		vector<uint8_t> dst(src.size());
+		ConvertToABGR32F(fmt, src.data(), NUM_ELEMS, clrs.data());
+		ConvertFromABGR32F(fmt, clrs.data(), NUM_ELEMS, dst.data());
+		EXPECT_EQ(src, dst) << "Format " << fmt;
+	}
+}
+
+TEST(ElementFormatTest, SRGBEncodeMatchesFormula)
+{
+	vector<Color> clrs;
+	for (uint32_t i = 0; i <= 0x10000; ++ i)
+	{
+		float const v = i / 65536.0f * 1.25f - 0.125f;
+		clrs.push_back(Color(v, v, v, v));
+	}
+
+	vector<uint32_t> encoded(clrs.size());
+	ConvertFromABGR32F(EF_ABGR8_SRGB, clrs.data(), static_cast<uint32_t>(clrs.size()), encoded.data());
+	for (size_t i = 0; i < clrs.size(); ++ i)
+	{
+		uint32_t const expected = MathLib::clamp(static_cast<int>(MathLib::linear_to_srgb(clrs[i].r()) * 255.0f + 0.5f), 0, 255);
+		ASSERT_EQ(expected * 0x01010101U, encoded[i]) << "Value " << clrs[i].r();
+	}
+}
+
+TEST(ElementFormatTest, HalfRoundTrip)
+{
+	vector<uint16_t> src;
+	for (uint32_t i = 0; i < 0x10000; ++ i)
+	{
+		// Skips NaNs, they don't compare equal, and -0, which half encodes as 0
+		if ((((i & 0x7C00) != 0x7C00) || ((i & 0x03FF) == 0)) && (i != 0x8000))
+		{
+			src.push_back(static_cast<uint16_t>(i));
+		}
+	}
+	uint32_t const num_elems = static_cast<uint32_t>(src.size() / 4);
+
+	vector<Color> clrs(num_elems);
+	ConvertToABGR32F(EF_ABGR16F, src.data(), num_elems, clrs.data());
+	EXPECT_EQ(0.0f, clrs[0].r());
+	EXPECT_EQ(numeric_limits<float>::infinity(), clrs[0x7C00 / 4].r());
+	EXPECT_EQ(1.0f, clrs[0x3C00 / 4].r());
+
+	vector<uint16_t> dst(num_elems * 4);
+	ConvertFromABGR32F(EF_ABGR16F, clrs.data(), num_elems, dst.data());
+	src.resize(dst.size());
+	EXPECT_EQ(src, dst);
+
+	for (uint32_t i = 0; i < num_elems; ++ i)
+	{
+		for (uint32_t c = 0; c < 4; ++ c)
+		{
+			uint16_t bits;
+			half const h(clrs[i][c]);
+			memcpy(&bits, &h, sizeof(bits));
+			ASSERT_EQ(bits, dst[i * 4 + c]);
+		}
+	}
+}
+
+TEST(ElementFormatTest, ConvertFormatMatchesFloatPath)
+{
+	ElementFormat const formats[] = { EF_A8, EF_R8, EF_GR8, EF_BGR8, EF_ARGB8, EF_ABGR8, EF_ARGB8_SRGB, EF_ABGR8_SRGB,
+		EF_A2BGR10, EF_R16F, EF_ABGR16F, EF_ABGR32F };
+	uint32_t const NUM_ELEMS = 333;
+
+	for (auto src_fmt : formats)
+	{
+		vector<uint8_t> const src = RandomBytes(NUM_ELEMS * NumFormatBytes(src_fmt), src_fmt & 0xFFFF);
+		vector<Color> clrs(NUM_ELEMS);
+		ConvertToABGR32F(src_fmt, src.data(), NUM_ELEMS, clrs.data());
+
+		for (auto dst_fmt : formats)
+		{
+			if (IsFloatFormat(src_fmt) && !IsFloatFormat(dst_fmt))
+			{
+				// Random float bits include NaN, which has no defined integer conversion
+				continue;
+			}
+
+			uint32_t const dst_size = NUM_ELEMS * NumFormatBytes(dst_fmt);
+			vector<uint8_t> expected(dst_size);
+			vector<uint8_t> converted(dst_size);
+			ConvertFromABGR32F(dst_fmt, clrs.data(), NUM_ELEMS, expected.data());
+			ConvertFormat(dst_fmt, converted.data(), src_fmt, src.data(), NUM_ELEMS);
+			EXPECT_EQ(expected, converted) << "From " << src_fmt << " to " << dst_fmt;
+		}
+	}
+}
+
+// Throughput of every vectorized format. Only runs with --gtest_also_run_disabled_tests.
+TEST(ElementFormatTest, DISABLED_Performance)
+{
+	ElementFormat const formats[] = { EF_R8, EF_GR8, EF_BGR8, EF_ARGB8, EF_ABGR8, EF_A2BGR10, EF_R16F, EF_GR16F, EF_BGR16F,
+		EF_ABGR16F, EF_B10G11R11F, EF_ARGB8_SRGB, EF_ABGR8_SRGB };
+	uint32_t const NUM_ELEMS = 1024 * 1024;
+
+	vector<Color> clrs(NUM_ELEMS);
+	mt19937 gen(0);
+	uniform_real_distribution<float> dis(0, 1);
+	for (auto& clr : clrs)
+	{
+		clr = Color(dis(gen), dis(gen), dis(gen), dis(gen));
+	}
+
+	vector<uint8_t> data(NUM_ELEMS * sizeof(Color));
+	vector<Color> decoded(NUM_ELEMS);
+	vector<uint8_t> argb8(NUM_ELEMS * 4);
+	for (auto fmt : formats)
+	{
+		Timer timer;
+		ConvertFromABGR32F(fmt, clrs.data(), NUM_ELEMS, data.data());
+		double const from_time = timer.elapsed();
+
+		timer.restart();
+		ConvertToABGR32F(fmt, data.data(), NUM_ELEMS, decoded.data());
+		double const to_time = timer.elapsed();
+
+		timer.restart();
+		ConvertFormat(EF_ARGB8, argb8.data(), fmt, data.data(), NUM_ELEMS);
+		double const convert_time = timer.elapsed();
+
+		cout << "Format 0x" << hex << fmt << dec << ": "
+			<< NUM_ELEMS / from_time / 1e6 << " Mpix/s encode, "
+			<< NUM_ELEMS / to_time / 1e6 << " Mpix/s decode, "
+			<< NUM_ELEMS / convert_time / 1e6 << " Mpix/s to ARGB8" << endl;
+	}
+}
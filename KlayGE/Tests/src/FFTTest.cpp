@@ -0,0 +1,202 @@
+#include <KlayGE/KlayGE.hpp>
+#include <KFL/Math.hpp>
+#include <KFL/Timer.hpp>
+#include <KlayGE/Texture.hpp>
+#include <KlayGE/FFT.hpp>
+
+#include "KlayGETests.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace std;
+using namespace KlayGE;
+
+namespace
+{
+	void RandomPlanes(vector<float4>& real, vector<float4>& imag, uint32_t size, uint32_t seed)
+	{
+		mt19937 gen(seed);
+		uniform_real_distribution<float> dis(-1, 1);
+
+		real.resize(size);
+		imag.resize(size);
+		for (uint32_t i = 0; i < size; ++ i)
+		{
+			real[i] = float4(dis(gen), dis(gen), dis(gen), dis(gen));
+			imag[i] = float4(dis(gen), dis(gen), dis(gen), dis(gen));
+		}
+	}
+
+	// Direct evaluation of the 2D DFT, one channel at a time
+	void NaiveDft(vector<float4>& out_real, vector<float4>& out_imag,
+		vector<float4> const & in_real, vector<float4> const & in_imag, uint32_t width, uint32_t height, bool forward)
+	{
+		double const pi = 3.14159265358979323846;
+		double const sign = forward ? -1 : 1;
+		double const scale = forward ? 1 : 1.0 / (width * height);
+
+		out_real.resize(width * height);
+		out_imag.resize(width * height);
+		for (uint32_t v = 0; v < height; ++ v)
+		{
+			for (uint32_t u = 0; u < width; ++ u)
+			{
+				for (uint32_t ch = 0; ch < 4; ++ ch)
+				{
+					complex<double> sum(0, 0);
+					for (uint32_t y = 0; y < height; ++ y)
+					{
+						for (uint32_t x = 0; x < width; ++ x)
+						{
+							double const phase = sign * 2 * pi * (static_cast<double>(u * x) / width + static_cast<double>(v * y) / height);
+							sum += complex<double>(in_real[y * width + x][ch], in_imag[y * width + x][ch])
+								* complex<double>(cos(phase), sin(phase));
+						}
+					}
+					out_real[v * width + u][ch] = static_cast<float>(sum.real() * scale);
+					out_imag[v * width + u][ch] = static_cast<float>(sum.imag() * scale);
+				}
+			}
+		}
+	}
+
+	float MaxDiff(vector<float4> const & lhs, vector<float4> const & rhs)
+	{
+		float ret = 0;
+		for (size_t i = 0; i < lhs.size(); ++ i)
+		{
+			for (uint32_t ch = 0; ch < 4; ++ ch)
+			{
+				ret = max(ret, abs(lhs[i][ch] - rhs[i][ch]));
+			}
+		}
+		return ret;
+	}
+}
+
+TEST(FFTTest, CpuAgainstNaiveDft)
+{
+	// Odd and even powers of 4, and non square sizes, to cover both the radix-4 and the radix-2 stages on both axes
+	uint32_t const sizes[][2] = { { 1, 1 }, { 2, 8 }, { 8, 4 }, { 16, 32 }, { 64, 16 }, { 4, 128 } };
+	for (auto const & size : sizes)
+	{
+		uint32_t const width = size[0];
+		uint32_t const height = size[1];
+
+		vector<float4> in_real, in_imag;
+		RandomPlanes(in_real, in_imag, width * height, width * 1000 + height);
+
+		for (bool forward : { true, false })
+		{
+			vector<float4> ref_real, ref_imag;
+			NaiveDft(ref_real, ref_imag, in_real, in_imag, width, height, forward);
+
+			vector<float4> real = in_real;
+			vector<float4> imag = in_imag;
+			CpuFft fft(width, height, forward);
+			fft.Transform(real.data(), imag.data());
+
+			// Errors grow with the log of the size, relative to the magnitude of the outputs
+			float const tolerance = (forward ? sqrt(static_cast<float>(width * height)) : 1.0f / sqrt(static_cast<float>(width * height)))
+				* 1e-5f * (1 + log2(static_cast<float>(width * height)));
+			EXPECT_LE(MaxDiff(real, ref_real), tolerance) << width << "x" << height << (forward ? " forward" : " inverse");
+			EXPECT_LE(MaxDiff(imag, ref_imag), tolerance) << width << "x" << height << (forward ? " forward" : " inverse");
+		}
+	}
+}
+
+TEST(FFTTest, CpuRoundTrip)
+{
+	uint32_t const WIDTH = 256;
+	uint32_t const HEIGHT = 512;
+
+	vector<float4> in_real, in_imag;
+	RandomPlanes(in_real, in_imag, WIDTH * HEIGHT, 1);
+
+	vector<float4> real = in_real;
+	vector<float4> imag = in_imag;
+	CpuFft(WIDTH, HEIGHT, true).Transform(real.data(), imag.data());
+	CpuFft(WIDTH, HEIGHT, false).Transform(real.data(), imag.data());
+
+	EXPECT_LE(MaxDiff(real, in_real), 1e-5f);
+	EXPECT_LE(MaxDiff(imag, in_imag), 1e-5f);
+}
+
+TEST(FFTTest, CpuOnSoftwareTextures)
+{
+	uint32_t const WIDTH = 32;
+	uint32_t const HEIGHT = 16;
+
+	vector<float4> in_real, in_imag;
+	RandomPlanes(in_real, in_imag, WIDTH * HEIGHT, 2);
+
+	ElementInitData init_data;
+	init_data.data = in_real.data();
+	init_data.row_pitch = WIDTH * sizeof(float4);
+	init_data.slice_pitch = init_data.row_pitch * HEIGHT;
+	TexturePtr in_real_tex = MakeSharedPtr<SoftwareTexture>(Texture::TT_2D, WIDTH, HEIGHT, 1, 1, 1, EF_ABGR32F, false);
+	in_real_tex->CreateHWResource(init_data, nullptr);
+
+	TexturePtr out_real_tex = MakeSharedPtr<SoftwareTexture>(Texture::TT_2D, WIDTH, HEIGHT, 1, 1, 1, EF_ABGR32F, false);
+	out_real_tex->CreateHWResource({}, nullptr);
+	TexturePtr out_imag_tex = MakeSharedPtr<SoftwareTexture>(Texture::TT_2D, WIDTH, HEIGHT, 1, 1, 1, EF_ABGR32F, false);
+	out_imag_tex->CreateHWResource({}, nullptr);
+
+	CpuFft fft(WIDTH, HEIGHT, true);
+	fft.Execute(out_real_tex, out_imag_tex, in_real_tex, TexturePtr());
+
+	vector<float4> real = in_real;
+	vector<float4> imag(WIDTH * HEIGHT, float4(0, 0, 0, 0));
+	fft.Transform(real.data(), imag.data());
+
+	vector<float4> tex_real(WIDTH * HEIGHT);
+	vector<float4> tex_imag(WIDTH * HEIGHT);
+	{
+		Texture::Mapper mapper(*out_real_tex, 0, 0, TMA_Read_Only, 0, 0, WIDTH, HEIGHT);
+		for (uint32_t y = 0; y < HEIGHT; ++ y)
+		{
+			float4 const * src = reinterpret_cast<float4 const *>(mapper.Pointer<uint8_t>() + y * mapper.RowPitch());
+			std::copy(src, src + WIDTH, tex_real.begin() + y * WIDTH);
+		}
+	}
+	{
+		Texture::Mapper mapper(*out_imag_tex, 0, 0, TMA_Read_Only, 0, 0, WIDTH, HEIGHT);
+		for (uint32_t y = 0; y < HEIGHT; ++ y)
+		{
+			float4 const * src = reinterpret_cast<float4 const *>(mapper.Pointer<uint8_t>() + y * mapper.RowPitch());
+			std::copy(src, src + WIDTH, tex_imag.begin() + y * WIDTH);
+		}
+	}
+
+	EXPECT_EQ(MaxDiff(tex_real, real), 0);
+	EXPECT_EQ(MaxDiff(tex_imag, imag), 0);
+}
+
+// Benchmark, enabled by --gtest_also_run_disabled_tests
+TEST(FFTTest, DISABLED_CpuPerformance)
+{
+	for (uint32_t size = 256; size <= 2048; size *= 2)
+	{
+		vector<float4> real, imag;
+		RandomPlanes(real, imag, size * size, size);
+
+		CpuFft fft(size, size, true);
+		fft.Transform(real.data(), imag.data());
+
+		uint32_t const NUM_RUNS = 4;
+		Timer timer;
+		for (uint32_t i = 0; i < NUM_RUNS; ++ i)
+		{
+			fft.Transform(real.data(), imag.data());
+		}
+		double const time = timer.elapsed() / NUM_RUNS;
+
+		cout << "CpuFft " << size << "x" << size << ": " << time * 1000 << " ms, "
+			<< 5.0 * size * size * log2(static_cast<double>(size * size)) * 4 / time / 1e9 << " GFLOPS" << endl;
+	}
+}
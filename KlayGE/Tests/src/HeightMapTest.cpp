@@ -0,0 +1,132 @@
+#include <KlayGE/KlayGE.hpp>
+#include <KFL/Math.hpp>
+#include <KFL/Thread.hpp>
+#include <KlayGE/Context.hpp>
+#include <KlayGE/HeightMap.hpp>
+
+#include "KlayGETests.hpp"
+
+#include <cmath>
+#include <vector>
+
+using namespace std;
+using namespace KlayGE;
+
+namespace
+{
+	float Wave(float x, float y)
+	{
+		return sin(x * 0.3f) * cos(y * 0.2f) * 4;
+	}
+
+	void WaveRow(ArrayRef<float> xs, float y, float* heights)
+	{
+		for (size_t i = 0; i < xs.size(); ++ i)
+		{
+			heights[i] = Wave(xs[i], y);
+		}
+	}
+}
+
+TEST(HeightMapTest, PerVertexCallback)
+{
+	vector<float3> vertices;
+	vector<uint16_t> indices;
+	HeightMap hm;
+	hm.BuildTerrain(0, 0, 10, 5, 1, 1, vertices, indices, Wave);
+
+	uint32_t const num_x = 10;
+	uint32_t const num_y = 5;
+	ASSERT_EQ(num_x * num_y, vertices.size());
+	float pos_y = 0;
+	for (uint32_t y = 0; y < num_y; ++ y)
+	{
+		float pos_x = 0;
+		for (uint32_t x = 0; x < num_x; ++ x)
+		{
+			pos_x += 1;
+			EXPECT_EQ(float3(pos_x, Wave(pos_x, pos_y), pos_y), vertices[y * num_x + x]);
+		}
+		pos_y += 1;
+	}
+
+	ASSERT_EQ((num_x - 1) * (num_y - 1) * 6, indices.size());
+	for (uint32_t y = 0; y < num_y - 1; ++ y)
+	{
+		for (uint32_t x = 0; x < num_x - 1; ++ x)
+		{
+			uint16_t const* cell = &indices[(y * (num_x - 1) + x) * 6];
+			EXPECT_EQ((y + 0) * num_x + (x + 0), cell[0]);
+			EXPECT_EQ((y + 1) * num_x + (x + 0), cell[1]);
+			EXPECT_EQ((y + 1) * num_x + (x + 1), cell[2]);
+			EXPECT_EQ((y + 1) * num_x + (x + 1), cell[3]);
+			EXPECT_EQ((y + 0) * num_x + (x + 1), cell[4]);
+			EXPECT_EQ((y + 0) * num_x + (x + 0), cell[5]);
+		}
+	}
+}
+
+TEST(HeightMapTest, BatchedMatchesPerVertex)
+{
+	HeightMap hm;
+
+	vector<float3> ref_vertices;
+	vector<uint16_t> ref_indices;
+	hm.BuildTerrain(-20, 30, 40, -10, 0.5f, 0.5f, ref_vertices, ref_indices, Wave);
+
+	vector<float3> vertices;
+	vector<float3> normals;
+	vector<uint16_t> indices;
+	hm.BuildTerrain(-20, 30, 40, -10, 0.5f, 0.5f, vertices, normals, indices, WaveRow, &Context::Instance().ThreadPool());
+
+	EXPECT_EQ(ref_vertices, vertices);
+	EXPECT_EQ(ref_indices, indices);
+	ASSERT_EQ(vertices.size(), normals.size());
+	for (auto const & n : normals)
+	{
+		EXPECT_NEAR(1, MathLib::length(n), 1e-5f);
+		EXPECT_GT(n.y(), 0);
+	}
+}
+
+TEST(HeightMapTest, Normals)
+{
+	HeightMap hm;
+	vector<float3> vertices;
+	vector<float3> normals;
+	vector<uint16_t> indices;
+
+	// A plane rising along x by 0.5 per unit and falling along z by 0.25 per unit
+	hm.BuildTerrain(0, 0, 23, 7, 1, 1, vertices, normals, indices,
+		[](ArrayRef<float> xs, float y, float* heights)
+		{
+			for (size_t i = 0; i < xs.size(); ++ i)
+			{
+				heights[i] = xs[i] * 0.5f - y * 0.25f;
+			}
+		});
+
+	float3 const expected = MathLib::normalize(float3(-0.5f, 1, 0.25f));
+	for (auto const & n : normals)
+	{
+		EXPECT_NEAR(expected.x(), n.x(), 1e-5f);
+		EXPECT_NEAR(expected.y(), n.y(), 1e-5f);
+		EXPECT_NEAR(expected.z(), n.z(), 1e-5f);
+	}
+}
+
+TEST(HeightMapTest, Async)
+{
+	auto tile = HeightMap::BuildTerrainAsync(0, 0, 200, 200, 1, 1, WaveRow);
+
+	HeightMap hm;
+	vector<float3> vertices;
+	vector<float3> normals;
+	vector<uint16_t> indices;
+	hm.BuildTerrain(0, 0, 200, 200, 1, 1, vertices, normals, indices, WaveRow);
+
+	auto const & mesh = tile();
+	EXPECT_EQ(vertices, mesh.vertices);
+	EXPECT_EQ(normals, mesh.normals);
+	EXPECT_EQ(indices, mesh.indices);
+}
@@ -0,0 +1,133 @@
+/**
+ * @file JudaTextureTest.cpp
+ * @author Minmin Gong
+ *
+ * @section DESCRIPTION
+ *
+ * This source file is part of KlayGE
+ * For the latest info, see http://www.klayge.org
+ *
+ * @section LICENSE
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * You may alternatively use this source under the terms of
+ * the KlayGE Proprietary License (KPL). You can obtained such a license
+ * from http://www.klayge.org/licensing/.
+ */
+#include <KlayGE/KlayGE.hpp>
+#include <KlayGE/JudaTexture.hpp>
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "KlayGETests.hpp"
+
+using namespace std;
+using namespace KlayGE;
+
+class JudaTextureTest : public testing::Test
+{
+public:
+	static uint32_t constexpr NUM_TILES = 32;
+	static uint32_t constexpr TILE_SIZE = 16;
+
+	void SetUp() override
+	{
+		juda_tex_ = MakeSharedPtr<JudaTexture>(NUM_TILES, TILE_SIZE, EF_ARGB8);
+
+		uint32_t const level = juda_tex_->TreeLevels() - 1;
+		for (uint32_t y = 0; y < NUM_TILES; ++ y)
+		{
+			vector<vector<uint8_t>> tiles;
+			vector<uint32_t> tile_ids;
+			vector<uint32_t> tile_attrs;
+			for (uint32_t x = 0; x < NUM_TILES; ++ x)
+			{
+				tiles.emplace_back(TILE_SIZE * TILE_SIZE * 4, static_cast<uint8_t>(y * NUM_TILES + x));
+				tile_ids.push_back(juda_tex_->EncodeTileID(level, x, y));
+				tile_attrs.push_back(0);
+			}
+			juda_tex_->CommitTiles(tiles, tile_ids, tile_attrs);
+		}
+
+		juda_tex_->CacheProperty(NUM_TILES * NUM_TILES, EF_ARGB8, 2);
+	}
+
+	vector<uint32_t> TileIDs(uint32_t x_begin, uint32_t x_end) const
+	{
+		uint32_t const level = juda_tex_->TreeLevels() - 1;
+		vector<uint32_t> ret;
+		for (uint32_t y = 0; y < NUM_TILES; ++ y)
+		{
+			for (uint32_t x = x_begin; x < x_end; ++ x)
+			{
+				ret.push_back(juda_tex_->EncodeTileID(level, x, y));
+			}
+		}
+		return ret;
+	}
+
+	// Keeps requesting the tiles, as a renderer would every frame, until everything in flight is uploaded
+	bool Drain(vector<uint32_t> const & tile_ids)
+	{
+		for (uint32_t frame = 0; frame < 1000; ++ frame)
+		{
+			juda_tex_->UpdateCacheAsync(tile_ids, 4);
+			if (0 == juda_tex_->Stats().pending)
+			{
+				return true;
+			}
+			this_thread::sleep_for(chrono::milliseconds(1));
+		}
+		return false;
+	}
+
+protected:
+	JudaTexturePtr juda_tex_;
+};
+
+TEST_F(JudaTextureTest, RequestToCommit)
+{
+	auto const tile_ids = this->TileIDs(0, NUM_TILES);
+
+	ASSERT_TRUE(this->Drain(tile_ids));
+	auto stats = juda_tex_->Stats();
+	EXPECT_EQ(tile_ids.size(), stats.uploads);
+	EXPECT_EQ(0U, stats.queued);
+
+	// Everything is in the cache now
+	juda_tex_->UpdateCacheAsync(tile_ids, 4);
+	auto const cached_stats = juda_tex_->Stats();
+	EXPECT_EQ(stats.uploads, cached_stats.uploads);
+	EXPECT_EQ(stats.hits + tile_ids.size(), cached_stats.hits);
+	EXPECT_EQ(0U, cached_stats.pending);
+}
+
+TEST_F(JudaTextureTest, StaleRequestsArePruned)
+{
+	auto old_ids = this->TileIDs(0, NUM_TILES);
+	vector<uint32_t> const new_ids(1, old_ids.back());
+	old_ids.pop_back();
+
+	// Far more old tiles than can be decoded between two calls. Once the view moves away, only the new one is left queued.
+	juda_tex_->UpdateCacheAsync(old_ids, 0);
+	juda_tex_->UpdateCacheAsync(new_ids, 0);
+	EXPECT_LE(juda_tex_->Stats().queued, new_ids.size());
+
+	ASSERT_TRUE(this->Drain(new_ids));
+	EXPECT_EQ(0U, juda_tex_->Stats().queued);
+}
@@ -0,0 +1,83 @@
+#include <KlayGE/KlayGE.hpp>
+#include <KFL/Math.hpp>
+#include <KlayGE/LightCuller.hpp>
+
+#include "KlayGETests.hpp"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+using namespace std;
+using namespace KlayGE;
+
+class LightCullerTest : public testing::Test
+{
+public:
+	void SetUp() override
+	{
+		view_ = MathLib::look_at_lh(float3(0, 2, -10), float3(0, 0, 0));
+		proj_ = MathLib::perspective_fov_lh(PI / 3, 1280.0f / 720, 0.1f, 100.0f);
+	}
+
+protected:
+	float4x4 view_;
+	float4x4 proj_;
+	vector<Sphere> lights_;
+};
+
+TEST_F(LightCullerTest, Culling)
+{
+	lights_.clear();
+	lights_.emplace_back(float3(0, 0, 0), 1.0f);
+	lights_.emplace_back(float3(0, 0, -20), 1.0f);
+	lights_.emplace_back(float3(0, 0, 0), -1.0f);
+
+	LightCuller culler;
+	culler.Cull(view_ * proj_, MakeArrayRef(lights_));
+
+	EXPECT_TRUE(culler.LightVisible(0));
+	EXPECT_FALSE(culler.LightVisible(1));
+	EXPECT_FALSE(culler.LightVisible(2));
+	EXPECT_EQ(1U, culler.VisibleLights().size());
+}
+
+TEST_F(LightCullerTest, MatchesScalarCulling)
+{
+	// Not a multiple of 4, so the last batch is partial
+	mt19937 gen(1);
+	uniform_real_distribution<float> pos_dist(-60, 60);
+	uniform_real_distribution<float> radius_dist(0.1f, 5);
+	for (uint32_t i = 0; i < 1001; ++ i)
+	{
+		lights_.emplace_back(float3(pos_dist(gen), pos_dist(gen) * 0.3f, pos_dist(gen) + 20), radius_dist(gen));
+	}
+
+	float4x4 const view_proj = view_ * proj_;
+	LightCuller culler;
+	culler.Cull(view_proj, MakeArrayRef(lights_));
+
+	Frustum frustum;
+	frustum.ClipMatrix(view_proj, MathLib::inverse(view_proj));
+
+	vector<uint32_t> expected;
+	for (uint32_t i = 0; i < lights_.size(); ++ i)
+	{
+		bool visible = true;
+		for (uint32_t p = 0; p < 6; ++ p)
+		{
+			if (MathLib::dot_coord(frustum.FrustumPlane(p), lights_[i].Center()) + lights_[i].Radius() < 0)
+			{
+				visible = false;
+			}
+		}
+
+		EXPECT_EQ(visible, culler.LightVisible(i));
+		if (visible)
+		{
+			expected.push_back(i);
+		}
+	}
+	EXPECT_FALSE(expected.empty());
+	EXPECT_TRUE(expected == culler.VisibleLights());
+}
@@ -784,3 +784,91 @@ TEST_F(MeshConverterTest, AnimationMeshML)
 {
 	RunTest("anim.meshml", "", "anim.meshml");
 }
+
+TEST_F(MeshConverterTest, VertexCacheOptimization)
+{
+	MeshMetadata metadata("tree2a.lod.kmeta");
+
+	MeshConverter mc;
+	metadata.OptimizeMesh(false);
+	auto unoptimized = mc.Load("tree2a_lod0.obj", metadata);
+	EXPECT_TRUE(unoptimized);
+	metadata.OptimizeMesh(true);
+	auto optimized = mc.Load("tree2a_lod0.obj", metadata);
+	EXPECT_TRUE(optimized);
+
+	auto extract_indices = [](StaticMesh const & mesh, uint32_t lod)
+	{
+		auto const & rl = mesh.GetRenderLayout(lod);
+
+		std::vector<uint32_t> indices(mesh.NumIndices(lod));
+		GraphicsBuffer::Mapper indices_mapper(*rl.GetIndexStream(), BA_Read_Only);
+		for (uint32_t i = 0; i < mesh.NumIndices(lod); ++ i)
+		{
+			uint32_t const index = i + mesh.StartIndexLocation(lod);
+			if (rl.IndexStreamFormat() == EF_R16UI)
+			{
+				indices[i] = indices_mapper.Pointer<uint16_t>()[index];
+			}
+			else
+			{
+				indices[i] = indices_mapper.Pointer<uint32_t>()[index];
+			}
+		}
+		return indices;
+	};
+
+	EXPECT_EQ(optimized->NumMeshes(), unoptimized->NumMeshes());
+	for (uint32_t i = 0; i < optimized->NumMeshes(); ++ i)
+	{
+		auto const & mesh = *checked_cast<StaticMesh*>(optimized->Mesh(i).get());
+		auto const & unoptimized_mesh = *checked_cast<StaticMesh*>(unoptimized->Mesh(i).get());
+
+		EXPECT_EQ(mesh.NumLods(), unoptimized_mesh.NumLods());
+		for (uint32_t lod = 0; lod < mesh.NumLods(); ++ lod)
+		{
+			EXPECT_EQ(mesh.NumVertices(lod), unoptimized_mesh.NumVertices(lod));
+			EXPECT_EQ(mesh.NumIndices(lod), unoptimized_mesh.NumIndices(lod));
+
+			auto const before = MeshConverter::AnalyzeVertexCache(extract_indices(unoptimized_mesh, lod),
+				unoptimized_mesh.NumVertices(lod));
+			auto const after = MeshConverter::AnalyzeVertexCache(extract_indices(mesh, lod), mesh.NumVertices(lod));
+
+			EXPECT_LE(after.acmr, before.acmr);
+			EXPECT_LE(after.atvr, before.atvr);
+			EXPECT_GE(after.atvr, 1.0f);
+		}
+	}
+}
+
+TEST_F(MeshConverterTest, KeyFrameCompression)
+{
+	MeshConverter mc;
+	auto target = mc.Load("anim.fbx", MeshMetadata());
+	EXPECT_TRUE(target);
+	EXPECT_TRUE(target->IsSkinned());
+
+	auto const & skinned_model = *checked_cast<SkinnedModel*>(target.get());
+	auto const & kfs = *skinned_model.GetKeyFrameSets();
+	for (auto const & kf : kfs)
+	{
+		CompressedKeyFrameSet ckf;
+		ckf.Compress(kf);
+		EXPECT_EQ(ckf.frame_id, kf.frame_id);
+
+		for (uint32_t j = 0; j < kf.frame_id.size(); ++ j)
+		{
+			Quaternion bind_real;
+			Quaternion bind_dual;
+			float bind_scale;
+			std::tie(bind_real, bind_dual, bind_scale) = ckf.Frame(static_cast<float>(kf.frame_id[j]));
+
+			float3 const trans = MathLib::udq_to_trans(bind_real, bind_dual);
+			float3 const sanity_trans = MathLib::udq_to_trans(kf.bind_real[j], kf.bind_dual[j]);
+
+			EXPECT_GT(std::abs(MathLib::dot(bind_real, kf.bind_real[j])) / MathLib::length(kf.bind_real[j]), 1 - 1e-6f);
+			EXPECT_LT(MathLib::length(trans - sanity_trans), 1e-3f);
+			EXPECT_LT(std::abs(bind_scale - kf.bind_scale[j]), 1e-4f);
+		}
+	}
+}
@@ -0,0 +1,143 @@
+#include <KlayGE/KlayGE.hpp>
+#include <KFL/Math.hpp>
+#include <KFL/Noise.hpp>
+#include <KFL/Thread.hpp>
+#include <KlayGE/Context.hpp>
+
+#include "KlayGETests.hpp"
+
+#include <random>
+#include <vector>
+
+using namespace std;
+using namespace KlayGE;
+
+namespace
+{
+	// Odd sizes also cover the padded tail of a block
+	uint32_t const NUM_SAMPLES = 64 * 3 + 7;
+
+	template <int N>
+	vector<Vector_T<float, N>> RandomPositions(uint32_t num, float range, uint32_t seed)
+	{
+		mt19937 gen(seed);
+		uniform_real_distribution<float> dis(-range, range);
+
+		vector<Vector_T<float, N>> ret(num);
+		for (auto& pos : ret)
+		{
+			for (int i = 0; i < N; ++ i)
+			{
+				pos[i] = dis(gen);
+			}
+		}
+		return ret;
+	}
+}
+
+TEST(NoiseTest, BatchNoise)
+{
+	auto& noiser = MathLib::SimplexNoise<float>::Instance();
+
+	auto const pos2 = RandomPositions<2>(NUM_SAMPLES, 64, 1);
+	vector<float> out(pos2.size());
+	noiser.noise(pos2, out.data(), out.size());
+	for (size_t i = 0; i < pos2.size(); ++ i)
+	{
+		EXPECT_FLOAT_EQ(noiser.noise(pos2[i].x(), pos2[i].y()), out[i]);
+	}
+
+	auto const pos3 = RandomPositions<3>(NUM_SAMPLES, 64, 2);
+	out.resize(pos3.size());
+	noiser.noise(pos3, out.data(), out.size());
+	for (size_t i = 0; i < pos3.size(); ++ i)
+	{
+		EXPECT_FLOAT_EQ(noiser.noise(pos3[i].x(), pos3[i].y(), pos3[i].z()), out[i]);
+	}
+}
+
+TEST(NoiseTest, BatchFractal)
+{
+	auto& noiser = MathLib::SimplexNoise<float>::Instance();
+
+	auto const pos2 = RandomPositions<2>(NUM_SAMPLES, 8, 3);
+	vector<float> out(pos2.size());
+	noiser.fBm(pos2, out.data(), out.size(), 6, 2.1f, 0.45f);
+	for (size_t i = 0; i < pos2.size(); ++ i)
+	{
+		EXPECT_FLOAT_EQ(noiser.fBm(pos2[i].x(), pos2[i].y(), 6, 2.1f, 0.45f), out[i]);
+	}
+	noiser.turbulence(pos2, out.data(), out.size(), 5);
+	for (size_t i = 0; i < pos2.size(); ++ i)
+	{
+		EXPECT_FLOAT_EQ(noiser.turbulence(pos2[i].x(), pos2[i].y(), 5), out[i]);
+	}
+
+	auto const pos3 = RandomPositions<3>(NUM_SAMPLES, 8, 4);
+	out.resize(pos3.size());
+	noiser.fBm(pos3, out.data(), out.size(), 6, 2.1f, 0.45f);
+	for (size_t i = 0; i < pos3.size(); ++ i)
+	{
+		EXPECT_FLOAT_EQ(noiser.fBm(pos3[i].x(), pos3[i].y(), pos3[i].z(), 6, 2.1f, 0.45f), out[i]);
+	}
+	noiser.turbulence(pos3, out.data(), out.size(), 5);
+	for (size_t i = 0; i < pos3.size(); ++ i)
+	{
+		EXPECT_FLOAT_EQ(noiser.turbulence(pos3[i].x(), pos3[i].y(), pos3[i].z(), 5), out[i]);
+	}
+}
+
+TEST(NoiseTest, BatchTileableFractal)
+{
+	auto& noiser = MathLib::SimplexNoise<float>::Instance();
+
+	vector<float2> pos2(NUM_SAMPLES);
+	for (size_t i = 0; i < pos2.size(); ++ i)
+	{
+		pos2[i] = float2(static_cast<float>(i % 16), static_cast<float>(i / 16)) * 0.5f;
+	}
+	vector<float> out(pos2.size());
+	noiser.tileable_fBm(pos2, out.data(), out.size(), 8.0f, 8.0f, 4);
+	for (size_t i = 0; i < pos2.size(); ++ i)
+	{
+		EXPECT_FLOAT_EQ(noiser.tileable_fBm(pos2[i].x(), pos2[i].y(), 8.0f, 8.0f, 4), out[i]);
+	}
+	noiser.tileable_turbulence(pos2, out.data(), out.size(), 8.0f, 8.0f, 4);
+	for (size_t i = 0; i < pos2.size(); ++ i)
+	{
+		EXPECT_FLOAT_EQ(noiser.tileable_turbulence(pos2[i].x(), pos2[i].y(), 8.0f, 8.0f, 4), out[i]);
+	}
+
+	vector<float3> pos3(NUM_SAMPLES);
+	for (size_t i = 0; i < pos3.size(); ++ i)
+	{
+		pos3[i] = float3(static_cast<float>(i % 8), static_cast<float>(i / 8 % 8), static_cast<float>(i / 64)) * 0.5f;
+	}
+	out.resize(pos3.size());
+	noiser.tileable_fBm(pos3, out.data(), out.size(), 4.0f, 4.0f, 4.0f, 3);
+	for (size_t i = 0; i < pos3.size(); ++ i)
+	{
+		EXPECT_FLOAT_EQ(noiser.tileable_fBm(pos3[i].x(), pos3[i].y(), pos3[i].z(), 4.0f, 4.0f, 4.0f, 3), out[i]);
+	}
+	noiser.tileable_turbulence(pos3, out.data(), out.size(), 4.0f, 4.0f, 4.0f, 3);
+	for (size_t i = 0; i < pos3.size(); ++ i)
+	{
+		EXPECT_FLOAT_EQ(noiser.tileable_turbulence(pos3[i].x(), pos3[i].y(), pos3[i].z(), 4.0f, 4.0f, 4.0f, 3), out[i]);
+	}
+}
+
+TEST(NoiseTest, BatchOnThreadPool)
+{
+	auto& noiser = MathLib::SimplexNoise<float>::Instance();
+	auto& pool = Context::Instance().ThreadPool();
+
+	auto const pos = RandomPositions<3>(256 * 256, 16, 5);
+	vector<float> serial(pos.size());
+	vector<float> parallel(pos.size());
+	noiser.fBm(pos, serial.data(), serial.size(), 4);
+	noiser.fBm(pos, parallel.data(), parallel.size(), 4, 2.0f, 0.5f, &pool);
+	for (size_t i = 0; i < pos.size(); ++ i)
+	{
+		EXPECT_EQ(serial[i], parallel[i]);
+	}
+}
@@ -0,0 +1,220 @@
+/**
+ * @file OcclusionCullerTest.cpp
+ * @author Minmin Gong
+ *
+ * @section DESCRIPTION
+ *
+ * This source file is part of KlayGE
+ * For the latest info, see http://www.klayge.org
+ *
+ * @section LICENSE
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * You may alternatively use this source under the terms of
+ * the KlayGE Proprietary License (KPL). You can obtained such a license
+ * from http://www.klayge.org/licensing/.
+ */
+
+#include <KlayGE/KlayGE.hpp>
+#include <KFL/Math.hpp>
+#include <KlayGE/GraphicsBuffer.hpp>
+#include <KlayGE/OcclusionCuller.hpp>
+#include <KlayGE/RenderFactory.hpp>
+#include <KlayGE/RenderLayout.hpp>
+#include <KlayGE/Renderable.hpp>
+
+#include <vector>
+
+#include "KlayGETests.hpp"
+
+using namespace std;
+using namespace KlayGE;
+
+namespace
+{
+	float4x4 TestViewProj()
+	{
+		return MathLib::look_at_lh(float3(0, 0, 0), float3(0, 0, 1))
+			* MathLib::perspective_fov_lh(PI / 2, 2.0f, 0.1f, 100.0f);
+	}
+
+	// An L shaped wall at z = 10, its top right quarter is open
+	class OccluderL : public Renderable
+	{
+	public:
+		OccluderL()
+			: Renderable(L"OccluderL")
+		{
+			float3 const pos[] =
+			{
+				float3(-5, -5, 10),
+				float3(+5, -5, 10),
+				float3(-5, 0, 10),
+				float3(+5, 0, 10),
+				float3(-5, 0, 10),
+				float3(0, 0, 10),
+				float3(-5, +5, 10),
+				float3(0, +5, 10)
+			};
+			uint16_t const indices[] =
+			{
+				0, 2, 1, 1, 2, 3,
+				4, 6, 5, 5, 6, 7
+			};
+
+			auto& rf = Context::Instance().RenderFactoryInstance();
+			rls_[0] = rf.MakeRenderLayout();
+			rls_[0]->TopologyType(RenderLayout::TT_TriangleList);
+			rls_[0]->BindVertexStream(rf.MakeVertexBuffer(BU_Static, EAH_GPU_Read | EAH_Immutable, sizeof(pos), pos),
+				VertexElement(VEU_Position, 0, EF_BGR32F));
+			rls_[0]->BindIndexStream(rf.MakeIndexBuffer(BU_Static, EAH_GPU_Read | EAH_Immutable, sizeof(indices), indices),
+				EF_R16UI);
+
+			pos_aabb_ = AABBox(float3(-5, -5, 10), float3(+5, +5, 10));
+		}
+	};
+}
+
+TEST(OcclusionCullerTest, BoxOccluder)
+{
+	OcclusionCuller culler(64, 32);
+	culler.BeginFrame(TestViewProj());
+	culler.AddOccluder(AABBox(float3(-5, -5, 10), float3(5, 5, 11)), float4x4::Identity());
+	culler.Rasterize();
+
+	EXPECT_EQ(12U, culler.NumOccluderTriangles());
+
+	// Fully behind the wall
+	EXPECT_TRUE(culler.AABBOccluded(AABBox(float3(-1, -1, 20), float3(1, 1, 22))));
+	// In front of the wall
+	EXPECT_FALSE(culler.AABBOccluded(AABBox(float3(-1, -1, 5), float3(1, 1, 6))));
+	// Behind, but wider than the wall
+	EXPECT_FALSE(culler.AABBOccluded(AABBox(float3(-30, -1, 20), float3(30, 1, 22))));
+	// Beside the wall
+	EXPECT_FALSE(culler.AABBOccluded(AABBox(float3(6, -1, 11.5f), float3(8, 1, 12))));
+	// Crossing the near plane
+	EXPECT_FALSE(culler.AABBOccluded(AABBox(float3(-1, -1, -1), float3(1, 1, 22))));
+	// Sticking out in front of the wall
+	EXPECT_FALSE(culler.AABBOccluded(AABBox(float3(-1, -1, 9), float3(1, 1, 22))));
+}
+
+TEST(OcclusionCullerTest, MeshOccluder)
+{
+	// A quad at z = 10, transformed by the model matrix
+	float3 const positions[] =
+	{
+		float3(-1, -1, 0),
+		float3(+1, -1, 0),
+		float3(-1, +1, 0),
+		float3(+1, +1, 0)
+	};
+	uint32_t const indices[] =
+	{
+		0, 2, 1, 1, 2, 3
+	};
+
+	OcclusionCuller culler(64, 32);
+	culler.BeginFrame(TestViewProj());
+	culler.AddOccluder(positions, indices, MathLib::scaling(5.0f, 5.0f, 1.0f) * MathLib::translation(0.0f, 0.0f, 10.0f));
+	culler.Rasterize();
+
+	EXPECT_EQ(2U, culler.NumOccluderTriangles());
+	EXPECT_TRUE(culler.AABBOccluded(AABBox(float3(-1, -1, 20), float3(1, 1, 22))));
+	EXPECT_FALSE(culler.AABBOccluded(AABBox(float3(-1, -1, 5), float3(1, 1, 6))));
+
+	// A new frame clears the occluders
+	culler.BeginFrame(TestViewProj());
+	culler.Rasterize();
+	EXPECT_EQ(0U, culler.NumOccluderTriangles());
+	EXPECT_FALSE(culler.AABBOccluded(AABBox(float3(-1, -1, 20), float3(1, 1, 22))));
+}
+
+TEST(OcclusionCullerTest, RenderableOccluder)
+{
+	OccluderL renderable;
+	auto const positions = renderable.OccluderPositions();
+	auto const indices = renderable.OccluderIndices();
+	ASSERT_EQ(8U, positions.size());
+	ASSERT_EQ(12U, indices.size());
+	EXPECT_EQ(float3(0, +5, 10), positions[7]);
+	EXPECT_EQ(6U, indices[10]);
+
+	OcclusionCuller culler(64, 32);
+	culler.BeginFrame(TestViewProj());
+	culler.AddOccluder(positions, indices, float4x4::Identity());
+	culler.Rasterize();
+
+	EXPECT_EQ(4U, culler.NumOccluderTriangles());
+	// Behind the wall
+	EXPECT_TRUE(culler.AABBOccluded(AABBox(float3(-8, -8, 20), float3(-3, -3, 22))));
+	// Behind the open quarter, the bounding box would hide it
+	EXPECT_FALSE(culler.AABBOccluded(AABBox(float3(3, 3, 20), float3(8, 8, 22))));
+}
+
+TEST(OcclusionCullerTest, TestAABBs)
+{
+	OcclusionCuller culler(256, 128);
+	culler.BeginFrame(TestViewProj());
+	culler.AddOccluder(AABBox(float3(-5, -5, 10), float3(5, 5, 11)), float4x4::Identity());
+	culler.Rasterize();
+
+	// Enough boxes to be tested in parallel
+	vector<AABBox> boxes;
+	for (int32_t z = 0; z < 8; ++ z)
+	{
+		for (int32_t x = -16; x < 16; ++ x)
+		{
+			float3 const center(x * 0.5f, 0, 12.0f + z * 4);
+			boxes.emplace_back(center - float3(0.2f, 0.2f, 0.2f), center + float3(0.2f, 0.2f, 0.2f));
+		}
+	}
+
+	vector<uint8_t> occluded(boxes.size());
+	uint32_t const num_occluded = culler.TestAABBs(boxes, occluded.data());
+
+	uint32_t expected_num_occluded = 0;
+	for (size_t i = 0; i < boxes.size(); ++ i)
+	{
+		bool const expected = culler.AABBOccluded(boxes[i]);
+		EXPECT_EQ(expected ? 1 : 0, occluded[i]);
+		expected_num_occluded += expected;
+	}
+	EXPECT_EQ(expected_num_occluded, num_occluded);
+	EXPECT_GT(num_occluded, 0U);
+	EXPECT_LT(num_occluded, boxes.size());
+
+	EXPECT_EQ(boxes.size(), culler.NumTested());
+	EXPECT_EQ(num_occluded, culler.NumOccluded());
+}
+
+TEST(OcclusionCullerTest, DebugImage)
+{
+	OcclusionCuller culler(60, 30);
+	EXPECT_EQ(64U, culler.Width());
+	EXPECT_EQ(32U, culler.Height());
+
+	culler.BeginFrame(TestViewProj());
+	culler.AddOccluder(AABBox(float3(-5, -5, 10), float3(5, 5, 11)), float4x4::Identity());
+	culler.Rasterize();
+
+	vector<uint8_t> image;
+	culler.DebugImage(image);
+	ASSERT_EQ(culler.Width() * culler.Height(), image.size());
+
+	// Center covered by the wall, corner empty
+	EXPECT_EQ(255, image[(culler.Height() / 2) * culler.Width() + culler.Width() / 2]);
+	EXPECT_EQ(0, image[0]);
+}
@@ -0,0 +1,149 @@
+/**
+ * @file PerfProfilerTest.cpp
+ * @author Minmin Gong
+ *
+ * @section DESCRIPTION
+ *
+ * This source file is part of KlayGE
+ * For the latest info, see http://www.klayge.org
+ *
+ * @section LICENSE
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * You may alternatively use this source under the terms of
+ * the KlayGE Proprietary License (KPL). You can obtained such a license
+ * from http://www.klayge.org/licensing/.
+ */
+
+#include <KlayGE/KlayGE.hpp>
+#include <KlayGE/PerfProfiler.hpp>
+
+#include <fstream>
+#include <iterator>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "KlayGETests.hpp"
+
+using namespace std;
+using namespace KlayGE;
+
+TEST(PerfProfilerTest, TraceOnlyWhileTracing)
+{
+	PerfProfiler& profiler = PerfProfiler::Instance();
+
+	{
+		KLAYGE_PERF_TRACE_SCOPE("Test", "Before");
+	}
+	profiler.StartTracing();
+	{
+		KLAYGE_PERF_TRACE_SCOPE("Test", "During");
+		KLAYGE_PERF_TRACE_COUNTER("Test", "Counter", 42);
+	}
+	profiler.StopTracing();
+	{
+		KLAYGE_PERF_TRACE_SCOPE("Test", "After");
+	}
+
+	auto const events = profiler.TraceEvents();
+	ASSERT_EQ(events.size(), 2U);
+	EXPECT_EQ(events[0].type, PerfTraceEvent::ET_Counter);
+	EXPECT_EQ(events[0].value, 42);
+	EXPECT_EQ(events[1].type, PerfTraceEvent::ET_Complete);
+	EXPECT_EQ(string(events[1].name), "During");
+	EXPECT_LE(events[1].timestamp, events[0].timestamp);
+
+	PerfProfiler::Destroy();
+}
+
+TEST(PerfProfilerTest, TraceFromThreads)
+{
+	PerfProfiler& profiler = PerfProfiler::Instance();
+	profiler.StartTracing();
+
+	uint32_t const num_threads = 4;
+	uint32_t const num_scopes = 1000;
+	vector<thread> threads;
+	for (uint32_t i = 0; i < num_threads; ++ i)
+	{
+		threads.emplace_back([]
+			{
+				for (uint32_t j = 0; j < num_scopes; ++ j)
+				{
+					KLAYGE_PERF_TRACE_SCOPE("Test", "Thread");
+				}
+			});
+	}
+	for (auto& t : threads)
+	{
+		t.join();
+	}
+	profiler.StopTracing();
+
+	auto const events = profiler.TraceEvents();
+	EXPECT_EQ(events.size(), num_threads * num_scopes);
+	set<uint32_t> thread_ids;
+	for (auto const & event : events)
+	{
+		thread_ids.insert(event.thread_id);
+	}
+	EXPECT_EQ(thread_ids.size(), num_threads);
+	EXPECT_EQ(profiler.NumDroppedTraceEvents(), 0U);
+
+	PerfProfiler::Destroy();
+}
+
+TEST(PerfProfilerTest, DropWhenFull)
+{
+	PerfProfiler& profiler = PerfProfiler::Instance();
+	profiler.StartTracing();
+
+	uint32_t const num_counters = (1UL << 14) + 10;
+	for (uint32_t i = 0; i < num_counters; ++ i)
+	{
+		KLAYGE_PERF_TRACE_COUNTER("Test", "Counter", i);
+	}
+	profiler.StopTracing();
+
+	EXPECT_EQ(profiler.NumDroppedTraceEvents(), 10U);
+	EXPECT_EQ(profiler.TraceEvents().size(), num_counters - 10);
+
+	PerfProfiler::Destroy();
+}
+
+TEST(PerfProfilerTest, ExportToChromeTrace)
+{
+	PerfProfiler& profiler = PerfProfiler::Instance();
+	profiler.StartTracing();
+	{
+		KLAYGE_PERF_TRACE_SCOPE("Test", "Scope \"quoted\"");
+	}
+	KLAYGE_PERF_TRACE_COUNTER("Test", "Counter", 7);
+	profiler.StopTracing();
+
+	profiler.ExportToChromeTrace("PerfProfilerTest.json");
+	PerfProfiler::Destroy();
+
+	ifstream ifs("PerfProfilerTest.json");
+	string const json((istreambuf_iterator<char>(ifs)), istreambuf_iterator<char>());
+	EXPECT_EQ(json.find("{\"traceEvents\":["), 0U);
+	EXPECT_NE(json.find("\"name\":\"Scope \\\"quoted\\\"\",\"cat\":\"Test\""), string::npos);
+	EXPECT_NE(json.find("\"ph\":\"X\",\"dur\":"), string::npos);
+	EXPECT_NE(json.find("\"ph\":\"C\",\"args\":{\"value\":7}}"), string::npos);
+	EXPECT_NE(json.find("\"displayTimeUnit\":\"ns\"}"), string::npos);
+}
@@ -0,0 +1,198 @@
+/**
+ * @file RenderCommandListTest.cpp
+ * @author Minmin Gong
+ *
+ * @section DESCRIPTION
+ *
+ * This source file is part of KlayGE
+ * For the latest info, see http://www.klayge.org
+ *
+ * @section LICENSE
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * You may alternatively use this source under the terms of
+ * the KlayGE Proprietary License (KPL). You can obtained such a license
+ * from http://www.klayge.org/licensing/.
+ */
+
+#include <KlayGE/KlayGE.hpp>
+#include <KFL/Math.hpp>
+#include <KlayGE/GraphicsBuffer.hpp>
+#include <KlayGE/RenderCommandList.hpp>
+#include <KlayGE/RenderEffect.hpp>
+#include <KlayGE/RenderEngine.hpp>
+#include <KlayGE/RenderFactory.hpp>
+#include <KlayGE/RenderLayout.hpp>
+
+#include <memory>
+#include <vector>
+
+#include "KlayGETests.hpp"
+
+using namespace std;
+using namespace KlayGE;
+
+class RenderCommandListTest : public testing::Test
+{
+public:
+	void SetUp() override
+	{
+		effect_ = SyncLoadRenderEffect("RenderCommandList/RenderCommandListTest.fxml");
+		tech_ = effect_->TechniqueByName("Draw");
+
+		float3 const pos[] =
+		{
+			float3(-1, -1, 0),
+			float3(+1, -1, 0),
+			float3(0, +1, 0)
+		};
+
+		auto& rf = Context::Instance().RenderFactoryInstance();
+		auto vb = rf.MakeVertexBuffer(BU_Static, EAH_GPU_Read | EAH_Immutable, sizeof(pos), pos);
+		rl_ = rf.MakeRenderLayout();
+		rl_->TopologyType(RenderLayout::TT_TriangleList);
+		rl_->BindVertexStream(vb, VertexElement(VEU_Position, 0, EF_BGR32F));
+	}
+
+protected:
+	RenderEffectPtr effect_;
+	RenderTechnique* tech_;
+	RenderLayoutPtr rl_;
+};
+
+TEST_F(RenderCommandListTest, Record)
+{
+	auto const & color = *effect_->ParameterByName("color");
+
+	RenderCommandList cmds;
+	EXPECT_EQ(nullptr, cmds.FirstCommand());
+
+	cmds.SetParameter(color, float4(1, 0, 0, 1));
+	cmds.Draw(*effect_, *tech_, *rl_);
+	cmds.Dispatch(*effect_, *tech_, 1, 2, 3);
+	cmds.Draw(*effect_, *tech_, *rl_);
+
+	EXPECT_EQ(4U, cmds.NumCommands());
+	EXPECT_EQ(2U, cmds.NumCommands(RenderCommandList::CT_Draw));
+	EXPECT_EQ(1U, cmds.NumCommands(RenderCommandList::CT_Dispatch));
+	EXPECT_EQ(1U, cmds.NumCommands(RenderCommandList::CT_UpdateConstantBuffer));
+	EXPECT_EQ(0U, cmds.NumCommands(RenderCommandList::CT_BindFrameBuffer));
+
+	RenderCommandList::CommandType const expected_types[] =
+	{
+		RenderCommandList::CT_UpdateConstantBuffer,
+		RenderCommandList::CT_Draw,
+		RenderCommandList::CT_Dispatch,
+		RenderCommandList::CT_Draw
+	};
+	uint32_t index = 0;
+	for (auto const * header = cmds.FirstCommand(); header; header = cmds.NextCommand(header))
+	{
+		ASSERT_LT(index, std::size(expected_types));
+		EXPECT_EQ(expected_types[index], header->type);
+		EXPECT_EQ(0U, header->size % sizeof(uint64_t));
+		++ index;
+	}
+	EXPECT_EQ(std::size(expected_types), index);
+
+	auto const * dispatch = reinterpret_cast<RenderCommandList::DispatchCommand const *>(
+		cmds.NextCommand(cmds.NextCommand(cmds.FirstCommand())));
+	EXPECT_EQ(tech_, dispatch->tech);
+	EXPECT_EQ(1U, dispatch->tgx);
+	EXPECT_EQ(2U, dispatch->tgy);
+	EXPECT_EQ(3U, dispatch->tgz);
+
+	cmds.Reset();
+	EXPECT_EQ(0U, cmds.NumCommands());
+	EXPECT_EQ(0U, cmds.NumCommands(RenderCommandList::CT_Draw));
+	EXPECT_EQ(nullptr, cmds.FirstCommand());
+}
+
+TEST_F(RenderCommandListTest, ExecuteUpdatesParameters)
+{
+	auto& color = *effect_->ParameterByName("color");
+	auto& mvp = *effect_->ParameterByName("mvp");
+
+	color = float4(0, 0, 0, 0);
+	mvp = float4x4::Identity();
+
+	float4 const new_color(0.25f, 0.5f, 0.75f, 1);
+	float4x4 const new_mvp = MathLib::translation(1.0f, 2.0f, 3.0f) * MathLib::scaling(4.0f, 5.0f, 6.0f);
+
+	RenderCommandList cmds;
+	cmds.SetParameter(color, new_color);
+	cmds.SetParameter(mvp, new_mvp);
+	cmds.Draw(*effect_, *tech_, *rl_);
+
+	// Nothing changes until the list is executed
+	float4 color_value;
+	color.Value(color_value);
+	EXPECT_EQ(float4(0, 0, 0, 0), color_value);
+
+	auto& re = Context::Instance().RenderFactoryInstance().RenderEngineInstance();
+	re.NumDrawsJustCalled();
+	re.Execute(cmds);
+	EXPECT_EQ(tech_->NumPasses(), re.NumDrawsJustCalled());
+
+	color.Value(color_value);
+	EXPECT_EQ(new_color, color_value);
+	float4x4 mvp_value;
+	mvp.Value(mvp_value);
+	EXPECT_EQ(new_mvp, mvp_value);
+}
+
+TEST_F(RenderCommandListTest, ParallelRecording)
+{
+	auto const & color = *effect_->ParameterByName("color");
+
+	uint32_t const num_lists = 4;
+	vector<unique_ptr<RenderCommandList>> list_holders;
+	vector<RenderCommandList*> lists;
+	for (uint32_t i = 0; i < num_lists; ++ i)
+	{
+		list_holders.push_back(MakeUniquePtr<RenderCommandList>());
+		lists.push_back(list_holders.back().get());
+	}
+
+	RecordInParallel(lists, [this, &color](RenderCommandList& cmds, uint32_t index)
+		{
+			for (uint32_t i = 0; i <= index; ++ i)
+			{
+				cmds.SetParameter(color, float4(static_cast<float>(index), static_cast<float>(i), 0, 1));
+				cmds.Draw(*effect_, *tech_, *rl_);
+			}
+		});
+
+	uint32_t num_draws = 0;
+	for (uint32_t i = 0; i < num_lists; ++ i)
+	{
+		EXPECT_EQ(i + 1, lists[i]->NumCommands(RenderCommandList::CT_Draw));
+		num_draws += lists[i]->NumCommands(RenderCommandList::CT_Draw);
+	}
+
+	auto& re = Context::Instance().RenderFactoryInstance().RenderEngineInstance();
+	re.NumDrawsJustCalled();
+	for (auto const * cmds : lists)
+	{
+		re.Execute(*cmds);
+	}
+	EXPECT_EQ(num_draws * tech_->NumPasses(), re.NumDrawsJustCalled());
+
+	// The last recorded value wins, as if everything was recorded into one list
+	float4 color_value;
+	color.Value(color_value);
+	EXPECT_EQ(float4(num_lists - 1.0f, num_lists - 1.0f, 0, 1), color_value);
+}
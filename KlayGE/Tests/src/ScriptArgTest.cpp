@@ -0,0 +1,73 @@
+#include <KlayGE/KlayGE.hpp>
+#include <KlayGE/Script.hpp>
+
+#include "KlayGETests.hpp"
+
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace KlayGE;
+
+namespace
+{
+	// Keeps the arguments of the last typed call
+	class RecordingScriptFunction : public ScriptFunction
+	{
+	public:
+		std::any Call(ArrayRef<std::any> args) override
+		{
+			return std::any(static_cast<uint32_t>(args.size()));
+		}
+
+		std::any CallArgs(ArrayRef<ScriptArg> args) override
+		{
+			args_.assign(args.begin(), args.end());
+			return std::any(static_cast<uint32_t>(args.size()));
+		}
+		using ScriptFunction::Call;
+
+		void CallBatch(ArrayRef<ScriptArg> args, uint32_t num_args_per_call, std::vector<std::any>* results) override
+		{
+			KFL_UNUSED(args);
+			KFL_UNUSED(num_args_per_call);
+			KFL_UNUSED(results);
+		}
+
+		std::vector<ScriptArg> args_;
+	};
+}
+
+TEST(ScriptArgTest, Types)
+{
+	EXPECT_EQ(ScriptArg(true).Type(), ScriptArg::SAT_Bool);
+	EXPECT_EQ(ScriptArg(static_cast<int8_t>(-3)).Int(), -3);
+	EXPECT_EQ(ScriptArg(-5LL).Int(), -5);
+	EXPECT_EQ(ScriptArg(static_cast<uint16_t>(7)).UInt(), 7U);
+	EXPECT_EQ(ScriptArg(0xFFFFFFFFFFFFFFFFULL).UInt(), 0xFFFFFFFFFFFFFFFFULL);
+	EXPECT_EQ(ScriptArg(1.5f).Float(), 1.5);
+	EXPECT_EQ(ScriptArg("abc").String(), "abc");
+	EXPECT_EQ(ScriptArg(std::string("de")).String(), "de");
+	EXPECT_EQ(ScriptArg(L"wide").WString(), L"wide");
+}
+
+TEST(ScriptArgTest, TypedCall)
+{
+	RecordingScriptFunction func;
+	std::string const name = "teapot";
+
+	EXPECT_EQ(std::any_cast<uint32_t>(func.Call(1, 2U, 0.5, name, false)), 5U);
+	ASSERT_EQ(func.args_.size(), 5U);
+	EXPECT_EQ(func.args_[0].Type(), ScriptArg::SAT_Int);
+	EXPECT_EQ(func.args_[1].Type(), ScriptArg::SAT_UInt);
+	EXPECT_EQ(func.args_[2].Type(), ScriptArg::SAT_Float);
+	EXPECT_EQ(func.args_[3].String(), name);
+	EXPECT_EQ(func.args_[4].Bool(), false);
+
+	EXPECT_EQ(std::any_cast<uint32_t>(func.Call()), 0U);
+	EXPECT_TRUE(func.args_.empty());
+
+	// Braced lists still go through std::any
+	EXPECT_EQ(std::any_cast<uint32_t>(func.Call({ 1, 2, 3 })), 3U);
+	EXPECT_TRUE(func.args_.empty());
+}
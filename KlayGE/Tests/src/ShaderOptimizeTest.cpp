@@ -0,0 +1,376 @@
+/**
+ * @file ShaderOptimizeTest.cpp
+ * @author Minmin Gong
+ *
+ * @section DESCRIPTION
+ *
+ * This source file is part of KlayGE
+ * For the latest info, see http://www.klayge.org
+ *
+ * @section LICENSE
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * You may alternatively use this source under the terms of
+ * the KlayGE Proprietary License (KPL). You can obtained such a license
+ * from http://www.klayge.org/licensing/.
+ */
+
+#include <KlayGE/KlayGE.hpp>
+#include <DXBC2GLSL/Shader.hpp>
+
+#include <initializer_list>
+#include <memory>
+
+#include "KlayGETests.hpp"
+
+namespace
+{
+	uint8_t ComponentIndex(char c)
+	{
+		return static_cast<uint8_t>((c == 'w') ? 3 : (c - 'x'));
+	}
+
+	std::shared_ptr<ShaderOperand> MakeOperand(ShaderOperandType type, int64_t index)
+	{
+		auto op = std::make_shared<ShaderOperand>();
+		op->type = type;
+		op->comps = 4;
+		op->num_indices = 1;
+		op->indices[0].disp = index;
+		return op;
+	}
+
+	// Destination, e.g. Dst(SOT_TEMP, 0, "xy") is r0.xy
+	std::shared_ptr<ShaderOperand> Dst(ShaderOperandType type, int64_t index, char const * mask)
+	{
+		auto op = MakeOperand(type, index);
+		op->mode = SOSM_MASK;
+		for (char const * p = mask; *p; ++ p)
+		{
+			op->mask |= 1U << ComponentIndex(*p);
+		}
+		return op;
+	}
+
+	// Source, e.g. Src(SOT_INPUT, 1, "yxzw") is v1.yxzw, and Src(SOT_TEMP, 0, "x") is the scalar r0.x
+	std::shared_ptr<ShaderOperand> Src(ShaderOperandType type, int64_t index, char const * swizzle)
+	{
+		auto op = MakeOperand(type, index);
+		if (0 == swizzle[1])
+		{
+			// Like the parser, a scalar select is replicated to all the components
+			op->mode = SOSM_SCALAR;
+			for (uint32_t i = 0; i < 4; ++ i)
+			{
+				op->swizzle[i] = ComponentIndex(swizzle[0]);
+			}
+		}
+		else
+		{
+			op->mode = SOSM_SWIZZLE;
+			for (uint32_t i = 0; i < 4; ++ i)
+			{
+				op->swizzle[i] = ComponentIndex(swizzle[i]);
+			}
+		}
+		return op;
+	}
+
+	std::shared_ptr<ShaderInstruction> Insn(ShaderOpcode opcode, std::initializer_list<std::shared_ptr<ShaderOperand>> ops)
+	{
+		auto insn = std::make_shared<ShaderInstruction>();
+		memset(static_cast<TokenizedShaderInstruction*>(insn.get()), 0, sizeof(TokenizedShaderInstruction));
+		insn->opcode = opcode;
+		for (auto const & op : ops)
+		{
+			insn->ops[insn->num_ops] = op;
+			++ insn->num_ops;
+		}
+		return insn;
+	}
+
+	void ExpectSwizzle(ShaderOperand const & op, char const * swizzle)
+	{
+		for (uint32_t i = 0; i < 4; ++ i)
+		{
+			EXPECT_EQ(op.swizzle[i], ComponentIndex(swizzle[i])) << "component " << i;
+		}
+	}
+}
+
+TEST(ShaderOptimizeTest, DeadWriteRemoved)
+{
+	ShaderProgram program;
+	program.insns.push_back(Insn(SO_ADD, { Dst(SOT_TEMP, 0, "xyzw"), Src(SOT_INPUT, 0, "xyzw"), Src(SOT_INPUT, 1, "xyzw") }));
+	program.insns.push_back(Insn(SO_MOV, { Dst(SOT_OUTPUT, 0, "xyzw"), Src(SOT_INPUT, 0, "xyzw") }));
+
+	ShaderOptimize(program, SOP_DeadWriteElimination);
+
+	ASSERT_EQ(program.insns.size(), 1U);
+	EXPECT_EQ(program.insns[0]->opcode, SO_MOV);
+	EXPECT_EQ(program.insns[0]->ops[0]->type, SOT_OUTPUT);
+}
+
+TEST(ShaderOptimizeTest, DeadWritePartialMask)
+{
+	// mul r0.xyzw, v0.xyzw, v1.xyzw
+	// dp2 o0.x, r0.xyxx, v1.xyxx
+	// mov o1.xy, r0.zzzz
+	ShaderProgram program;
+	program.insns.push_back(Insn(SO_MUL, { Dst(SOT_TEMP, 0, "xyzw"), Src(SOT_INPUT, 0, "xyzw"), Src(SOT_INPUT, 1, "xyzw") }));
+	program.insns.push_back(Insn(SO_DP2, { Dst(SOT_OUTPUT, 0, "x"), Src(SOT_TEMP, 0, "xyxx"), Src(SOT_INPUT, 1, "xyxx") }));
+	program.insns.push_back(Insn(SO_MOV, { Dst(SOT_OUTPUT, 1, "xy"), Src(SOT_TEMP, 0, "zzzz") }));
+
+	ShaderOptimize(program, SOP_DeadWriteElimination);
+
+	ASSERT_EQ(program.insns.size(), 3U);
+	EXPECT_EQ(program.insns[0]->ops[0]->mask, 0x7U);
+	EXPECT_EQ(program.insns[1]->ops[0]->mask, 0x1U);
+	EXPECT_EQ(program.insns[2]->ops[0]->mask, 0x3U);
+}
+
+TEST(ShaderOptimizeTest, DeadWriteChain)
+{
+	// Removing the last reader makes the write before it dead too
+	ShaderProgram program;
+	program.insns.push_back(Insn(SO_MOV, { Dst(SOT_TEMP, 0, "xyzw"), Src(SOT_INPUT, 0, "xyzw") }));
+	program.insns.push_back(Insn(SO_ADD, { Dst(SOT_TEMP, 1, "xyzw"), Src(SOT_TEMP, 0, "xyzw"), Src(SOT_INPUT, 1, "xyzw") }));
+	program.insns.push_back(Insn(SO_MOV, { Dst(SOT_OUTPUT, 0, "xyzw"), Src(SOT_INPUT, 1, "xyzw") }));
+
+	ShaderOptimize(program, SOP_DeadWriteElimination);
+
+	ASSERT_EQ(program.insns.size(), 1U);
+	EXPECT_EQ(program.insns[0]->ops[0]->type, SOT_OUTPUT);
+}
+
+TEST(ShaderOptimizeTest, DeadWriteInPlaceSource)
+{
+	// mov r0.xyzw, v0.xyzw
+	// add r0.x, r0.x, v1.x
+	// mov o0.xyzw, r0.xxxx
+	ShaderProgram program;
+	program.insns.push_back(Insn(SO_MOV, { Dst(SOT_TEMP, 0, "xyzw"), Src(SOT_INPUT, 0, "xyzw") }));
+	program.insns.push_back(Insn(SO_ADD, { Dst(SOT_TEMP, 0, "x"), Src(SOT_TEMP, 0, "x"), Src(SOT_INPUT, 1, "x") }));
+	program.insns.push_back(Insn(SO_MOV, { Dst(SOT_OUTPUT, 0, "xyzw"), Src(SOT_TEMP, 0, "xxxx") }));
+
+	ShaderOptimize(program, SOP_DeadWriteElimination);
+
+	ASSERT_EQ(program.insns.size(), 3U);
+	EXPECT_EQ(program.insns[0]->ops[0]->mask, 0x1U);
+	EXPECT_EQ(program.insns[1]->ops[0]->mask, 0x1U);
+}
+
+TEST(ShaderOptimizeTest, DeadWriteKeepsIndexableTempsAndIndices)
+{
+	// mov r1.x, v1.x
+	// mov x0[0].xyzw, v0.xyzw
+	// mov o0.xyzw, x0[r1.x + 0].xyzw
+	auto indexed = std::make_shared<ShaderOperand>(*Src(SOT_INDEXABLE_TEMP, 0, "xyzw"));
+	indexed->num_indices = 2;
+	indexed->indices[1].disp = 0;
+	indexed->indices[1].reg = Src(SOT_TEMP, 1, "x");
+
+	auto indexable_dst = Dst(SOT_INDEXABLE_TEMP, 0, "xyzw");
+	indexable_dst->num_indices = 2;
+
+	ShaderProgram program;
+	program.insns.push_back(Insn(SO_MOV, { Dst(SOT_TEMP, 1, "x"), Src(SOT_INPUT, 1, "x") }));
+	program.insns.push_back(Insn(SO_MOV, { indexable_dst, Src(SOT_INPUT, 0, "xyzw") }));
+	program.insns.push_back(Insn(SO_MOV, { Dst(SOT_OUTPUT, 0, "xyzw"), indexed }));
+
+	ShaderOptimize(program, SOP_All);
+
+	ASSERT_EQ(program.insns.size(), 3U);
+	EXPECT_EQ(program.insns[0]->ops[0]->type, SOT_TEMP);
+	EXPECT_EQ(program.insns[1]->ops[0]->type, SOT_INDEXABLE_TEMP);
+	EXPECT_EQ(program.insns[2]->ops[1]->type, SOT_INDEXABLE_TEMP);
+}
+
+TEST(ShaderOptimizeTest, DeadWriteAcrossLoop)
+{
+	// The add reads r0 written later in the loop body, on the previous iteration
+	// mov r0.x, v0.x
+	// loop
+	//   add r1.x, r0.x, v1.x
+	//   breakc_nz r1.x
+	//   mov r0.x, r1.x
+	// endloop
+	ShaderProgram program;
+	program.insns.push_back(Insn(SO_MOV, { Dst(SOT_TEMP, 0, "x"), Src(SOT_INPUT, 0, "x") }));
+	program.insns.push_back(Insn(SO_LOOP, {}));
+	program.insns.push_back(Insn(SO_ADD, { Dst(SOT_TEMP, 1, "x"), Src(SOT_TEMP, 0, "x"), Src(SOT_INPUT, 1, "x") }));
+	program.insns.push_back(Insn(SO_BREAKC, { Src(SOT_TEMP, 1, "x") }));
+	program.insns.push_back(Insn(SO_MOV, { Dst(SOT_TEMP, 0, "x"), Src(SOT_TEMP, 1, "x") }));
+	program.insns.push_back(Insn(SO_ENDLOOP, {}));
+
+	ShaderOptimize(program, SOP_DeadWriteElimination);
+
+	EXPECT_EQ(program.insns.size(), 6U);
+}
+
+TEST(ShaderOptimizeTest, CopyPropagationForwardsSources)
+{
+	// mov r0.xyzw, v0.xyzw
+	// mov r1.xyzw, cb0[3].xyzw
+	// add o0.xyzw, -r0.xyzw, r1.xyzw
+	auto cb = Src(SOT_CONSTANT_BUFFER, 0, "xyzw");
+	cb->num_indices = 2;
+	cb->indices[1].disp = 3;
+
+	auto neg_r0 = Src(SOT_TEMP, 0, "xyzw");
+	neg_r0->neg = true;
+
+	ShaderProgram program;
+	program.insns.push_back(Insn(SO_MOV, { Dst(SOT_TEMP, 0, "xyzw"), Src(SOT_INPUT, 0, "xyzw") }));
+	program.insns.push_back(Insn(SO_MOV, { Dst(SOT_TEMP, 1, "xyzw"), cb }));
+	program.insns.push_back(Insn(SO_ADD, { Dst(SOT_OUTPUT, 0, "xyzw"), neg_r0, Src(SOT_TEMP, 1, "xyzw") }));
+
+	ShaderOptimize(program, SOP_CopyPropagation | SOP_DeadWriteElimination);
+
+	ASSERT_EQ(program.insns.size(), 1U);
+	ShaderOperand const & src0 = *program.insns[0]->ops[1];
+	EXPECT_EQ(src0.type, SOT_INPUT);
+	EXPECT_EQ(src0.indices[0].disp, 0);
+	EXPECT_TRUE(src0.neg);
+	ShaderOperand const & src1 = *program.insns[0]->ops[2];
+	EXPECT_EQ(src1.type, SOT_CONSTANT_BUFFER);
+	EXPECT_EQ(src1.num_indices, 2U);
+	EXPECT_EQ(src1.indices[1].disp, 3);
+}
+
+TEST(ShaderOptimizeTest, CopyPropagationSwizzleFolding)
+{
+	// mov r0.xyzw, v0.yxwz
+	// add o0.xyzw, r0.zwxy, v1.xyzw
+	// mul o1.xyzw, r0.y, v1.xyzw
+	auto make_program = []
+		{
+			ShaderProgram program;
+			program.insns.push_back(Insn(SO_MOV, { Dst(SOT_TEMP, 0, "xyzw"), Src(SOT_INPUT, 0, "yxwz") }));
+			program.insns.push_back(Insn(SO_ADD, { Dst(SOT_OUTPUT, 0, "xyzw"), Src(SOT_TEMP, 0, "zwxy"),
+				Src(SOT_INPUT, 1, "xyzw") }));
+			program.insns.push_back(Insn(SO_MUL, { Dst(SOT_OUTPUT, 1, "xyzw"), Src(SOT_TEMP, 0, "y"),
+				Src(SOT_INPUT, 1, "xyzw") }));
+			return program;
+		};
+
+	// Without folding, only identity swizzled copies are forwarded
+	{
+		ShaderProgram program = make_program();
+		ShaderOptimize(program, SOP_CopyPropagation);
+		EXPECT_EQ(program.insns[1]->ops[1]->type, SOT_TEMP);
+		EXPECT_EQ(program.insns[2]->ops[1]->type, SOT_TEMP);
+	}
+	{
+		ShaderProgram program = make_program();
+		ShaderOptimize(program, SOP_CopyPropagation | SOP_SwizzleFolding);
+
+		ShaderOperand const & swizzled = *program.insns[1]->ops[1];
+		EXPECT_EQ(swizzled.type, SOT_INPUT);
+		EXPECT_EQ(swizzled.mode, SOSM_SWIZZLE);
+		ExpectSwizzle(swizzled, "wzyx");
+
+		ShaderOperand const & scalar = *program.insns[2]->ops[1];
+		EXPECT_EQ(scalar.type, SOT_INPUT);
+		EXPECT_EQ(scalar.mode, SOSM_SCALAR);
+		ExpectSwizzle(scalar, "xxxx");
+	}
+}
+
+TEST(ShaderOptimizeTest, CopyPropagationPartialMask)
+{
+	// mov r0.xy, v0.xyzw
+	// add o0.xy, r0.xyxx, v1.xyxx
+	// add o1.xyzw, r0.xyzw, v1.xyzw
+	ShaderProgram program;
+	program.insns.push_back(Insn(SO_MOV, { Dst(SOT_TEMP, 0, "xy"), Src(SOT_INPUT, 0, "xyzw") }));
+	program.insns.push_back(Insn(SO_ADD, { Dst(SOT_OUTPUT, 0, "xy"), Src(SOT_TEMP, 0, "xyxx"), Src(SOT_INPUT, 1, "xyxx") }));
+	program.insns.push_back(Insn(SO_ADD, { Dst(SOT_OUTPUT, 1, "xyzw"), Src(SOT_TEMP, 0, "xyzw"), Src(SOT_INPUT, 1, "xyzw") }));
+
+	ShaderOptimize(program, SOP_CopyPropagation);
+
+	EXPECT_EQ(program.insns[1]->ops[1]->type, SOT_INPUT);
+	ExpectSwizzle(*program.insns[1]->ops[1], "xyxx");
+	// Reads zw, which the copy doesn't write
+	EXPECT_EQ(program.insns[2]->ops[1]->type, SOT_TEMP);
+}
+
+TEST(ShaderOptimizeTest, CopyPropagationStopsAtOverwrite)
+{
+	// mov r1.xyzw, r0.xyzw
+	// add r0.xyzw, r1.xyzw, v0.xyzw
+	// mul o0.xyzw, r1.xyzw, v1.xyzw
+	// mov r2.xyzw, v2.xyzw
+	// add r2.xyzw, r2.xyzw, v0.xyzw
+	// mul o1.xyzw, r2.xyzw, v1.xyzw
+	ShaderProgram program;
+	program.insns.push_back(Insn(SO_MOV, { Dst(SOT_TEMP, 1, "xyzw"), Src(SOT_TEMP, 0, "xyzw") }));
+	program.insns.push_back(Insn(SO_ADD, { Dst(SOT_TEMP, 0, "xyzw"), Src(SOT_TEMP, 1, "xyzw"), Src(SOT_INPUT, 0, "xyzw") }));
+	program.insns.push_back(Insn(SO_MUL, { Dst(SOT_OUTPUT, 0, "xyzw"), Src(SOT_TEMP, 1, "xyzw"), Src(SOT_INPUT, 1, "xyzw") }));
+	program.insns.push_back(Insn(SO_MOV, { Dst(SOT_TEMP, 2, "xyzw"), Src(SOT_INPUT, 2, "xyzw") }));
+	program.insns.push_back(Insn(SO_ADD, { Dst(SOT_TEMP, 2, "xyzw"), Src(SOT_TEMP, 2, "xyzw"), Src(SOT_INPUT, 0, "xyzw") }));
+	program.insns.push_back(Insn(SO_MUL, { Dst(SOT_OUTPUT, 1, "xyzw"), Src(SOT_TEMP, 2, "xyzw"), Src(SOT_INPUT, 1, "xyzw") }));
+
+	ShaderOptimize(program, SOP_CopyPropagation);
+
+	// The source r0 is overwritten by the add, which still reads it
+	EXPECT_EQ(program.insns[1]->ops[1]->type, SOT_TEMP);
+	EXPECT_EQ(program.insns[1]->ops[1]->indices[0].disp, 0);
+	EXPECT_EQ(program.insns[2]->ops[1]->type, SOT_TEMP);
+	EXPECT_EQ(program.insns[2]->ops[1]->indices[0].disp, 1);
+
+	// The copy r2 is overwritten in place
+	EXPECT_EQ(program.insns[4]->ops[1]->type, SOT_INPUT);
+	EXPECT_EQ(program.insns[4]->ops[1]->indices[0].disp, 2);
+	EXPECT_EQ(program.insns[5]->ops[1]->type, SOT_TEMP);
+	EXPECT_EQ(program.insns[5]->ops[1]->indices[0].disp, 2);
+}
+
+TEST(ShaderOptimizeTest, CopyPropagationStopsAtBlockBoundary)
+{
+	// mov r0.xyzw, v0.xyzw
+	// if_nz v1.x
+	//   add o0.xyzw, r0.xyzw, v1.xyzw
+	// endif
+	ShaderProgram program;
+	program.insns.push_back(Insn(SO_MOV, { Dst(SOT_TEMP, 0, "xyzw"), Src(SOT_INPUT, 0, "xyzw") }));
+	program.insns.push_back(Insn(SO_IF, { Src(SOT_INPUT, 1, "x") }));
+	program.insns.push_back(Insn(SO_ADD, { Dst(SOT_OUTPUT, 0, "xyzw"), Src(SOT_TEMP, 0, "xyzw"), Src(SOT_INPUT, 1, "xyzw") }));
+	program.insns.push_back(Insn(SO_ENDIF, {}));
+
+	ShaderOptimize(program, SOP_All);
+
+	ASSERT_EQ(program.insns.size(), 4U);
+	EXPECT_EQ(program.insns[2]->ops[1]->type, SOT_TEMP);
+}
+
+TEST(ShaderOptimizeTest, CopyPropagationSkipsIndexableTemps)
+{
+	// mov r0.xyzw, x0[1].xyzw
+	// add o0.xyzw, r0.xyzw, v0.xyzw
+	auto indexable = Src(SOT_INDEXABLE_TEMP, 0, "xyzw");
+	indexable->num_indices = 2;
+	indexable->indices[1].disp = 1;
+
+	ShaderProgram program;
+	program.insns.push_back(Insn(SO_MOV, { Dst(SOT_TEMP, 0, "xyzw"), indexable }));
+	program.insns.push_back(Insn(SO_ADD, { Dst(SOT_OUTPUT, 0, "xyzw"), Src(SOT_TEMP, 0, "xyzw"), Src(SOT_INPUT, 0, "xyzw") }));
+
+	ShaderOptimize(program, SOP_All);
+
+	ASSERT_EQ(program.insns.size(), 2U);
+	EXPECT_EQ(program.insns[1]->ops[1]->type, SOT_TEMP);
+}
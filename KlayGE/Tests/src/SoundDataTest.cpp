@@ -0,0 +1,190 @@
+#include <KlayGE/KlayGE.hpp>
+#include <KlayGE/AudioDataSource.hpp>
+#include <KlayGE/Audio.hpp>
+
+#include "KlayGETests.hpp"
+
+#include <vector>
+
+using namespace std;
+using namespace KlayGE;
+
+namespace
+{
+	// Counts the bytes decoded, to check that a sound is decoded only once
+	class CountingAudioDataSource : public AudioDataSource
+	{
+	public:
+		explicit CountingAudioDataSource(size_t size)
+			: size_(size), pos_(0), decoded_(0)
+		{
+			format_ = AF_Mono8;
+			freq_ = 22050;
+		}
+
+		void Open(ResIdentifierPtr const & file) override
+		{
+			KFL_UNUSED(file);
+		}
+
+		void Close() override
+		{
+		}
+
+		size_t Size() override
+		{
+			return size_;
+		}
+
+		size_t Read(void* data, size_t size) override
+		{
+			size_t const read_size = std::min(size, size_ - pos_);
+			uint8_t* p = static_cast<uint8_t*>(data);
+			for (size_t i = 0; i < read_size; ++ i)
+			{
+				p[i] = static_cast<uint8_t>(pos_ + i);
+			}
+			pos_ += read_size;
+			decoded_ += read_size;
+			return read_size;
+		}
+
+		void Reset() override
+		{
+			pos_ = 0;
+		}
+
+		size_t Decoded() const
+		{
+			return decoded_;
+		}
+
+	private:
+		size_t size_;
+		size_t pos_;
+		size_t decoded_;
+	};
+
+	class TestSoundBuffer : public SoundBuffer
+	{
+	public:
+		explicit TestSoundBuffer(AudioDataSourcePtr const & data_source)
+			: SoundBuffer(data_source)
+		{
+		}
+
+		void Play(bool loop) override
+		{
+			KFL_UNUSED(loop);
+		}
+		void Stop() override
+		{
+		}
+		void Volume(float vol) override
+		{
+			KFL_UNUSED(vol);
+		}
+		bool IsPlaying() const override
+		{
+			return false;
+		}
+		float3 Position() const override
+		{
+			return float3(0, 0, 0);
+		}
+		void Position(float3 const & v) override
+		{
+			KFL_UNUSED(v);
+		}
+		float3 Velocity() const override
+		{
+			return float3(0, 0, 0);
+		}
+		void Velocity(float3 const & v) override
+		{
+			KFL_UNUSED(v);
+		}
+		float3 Direction() const override
+		{
+			return float3(0, 0, 0);
+		}
+		void Direction(float3 const & v) override
+		{
+			KFL_UNUSED(v);
+		}
+
+		std::shared_ptr<std::vector<uint8_t> const> const & PCM() const
+		{
+			return pcm_;
+		}
+
+	private:
+		void DoReset() override
+		{
+		}
+	};
+
+	std::shared_ptr<std::vector<uint8_t> const> MakePCM(size_t size)
+	{
+		auto pcm = MakeSharedPtr<std::vector<uint8_t>>(size);
+		for (size_t i = 0; i < size; ++ i)
+		{
+			(*pcm)[i] = static_cast<uint8_t>(i * 7);
+		}
+		return pcm;
+	}
+}
+
+TEST(SoundDataTest, IndependentCursors)
+{
+	auto const pcm = MakePCM(1000);
+	PCMAudioDataSource a(AF_Stereo16, 44100, pcm);
+	PCMAudioDataSource b(AF_Stereo16, 44100, pcm);
+
+	EXPECT_EQ(a.Format(), AF_Stereo16);
+	EXPECT_EQ(a.Freq(), 44100U);
+	EXPECT_EQ(a.Size(), pcm->size());
+	EXPECT_EQ(a.SharedPCM(), pcm);
+	EXPECT_EQ(b.SharedPCM(), pcm);
+
+	vector<uint8_t> buff(600);
+	ASSERT_EQ(a.Read(buff.data(), 600), 600U);
+	EXPECT_TRUE(equal(buff.begin(), buff.end(), pcm->begin()));
+
+	ASSERT_EQ(b.Read(buff.data(), 100), 100U);
+	EXPECT_TRUE(equal(buff.begin(), buff.begin() + 100, pcm->begin()));
+
+	ASSERT_EQ(a.Read(buff.data(), 600), 400U);
+	EXPECT_TRUE(equal(buff.begin(), buff.begin() + 400, pcm->begin() + 600));
+	EXPECT_EQ(a.Read(buff.data(), 600), 0U);
+
+	a.Reset();
+	ASSERT_EQ(a.Read(buff.data(), 10), 10U);
+	EXPECT_TRUE(equal(buff.begin(), buff.begin() + 10, pcm->begin()));
+}
+
+TEST(SoundDataTest, BuffersSharePCM)
+{
+	auto const pcm = MakePCM(4096);
+	TestSoundBuffer a(MakeSharedPtr<PCMAudioDataSource>(AF_Mono16, 22050, pcm));
+	TestSoundBuffer b(MakeSharedPtr<PCMAudioDataSource>(AF_Mono16, 22050, pcm));
+
+	EXPECT_EQ(a.PCM(), pcm);
+	EXPECT_EQ(b.PCM(), pcm);
+}
+
+TEST(SoundDataTest, DecoderDecodedOnce)
+{
+	auto const source = MakeSharedPtr<CountingAudioDataSource>(3000);
+	TestSoundBuffer buffer(source);
+
+	EXPECT_EQ(source->Decoded(), 3000U);
+	ASSERT_TRUE(buffer.PCM());
+	ASSERT_EQ(buffer.PCM()->size(), 3000U);
+	for (size_t i = 0; i < 3000; ++ i)
+	{
+		EXPECT_EQ((*buffer.PCM())[i], static_cast<uint8_t>(i));
+	}
+
+	EXPECT_FALSE(source->SharedPCM());
+}
@@ -0,0 +1,114 @@
+/**
+ * @file StartupManifestTest.cpp
+ * @author Minmin Gong
+ *
+ * @section DESCRIPTION
+ *
+ * This source file is part of KlayGE
+ * For the latest info, see http://www.klayge.org
+ *
+ * @section LICENSE
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * You may alternatively use this source under the terms of
+ * the KlayGE Proprietary License (KPL). You can obtained such a license
+ * from http://www.klayge.org/licensing/.
+ */
+
+#include <KlayGE/KlayGE.hpp>
+#include <KlayGE/StartupManifest.hpp>
+
+#include <sstream>
+
+#include "KlayGETests.hpp"
+
+using namespace std;
+using namespace KlayGE;
+
+TEST(StartupManifestTest, RecordOnlyWhileRecording)
+{
+	StartupManifest manifest;
+
+	manifest.Record(StartupManifest::AK_Texture, "before.dds");
+	manifest.StartRecording();
+	manifest.Record(StartupManifest::AK_Texture, "during.dds", 3);
+	manifest.StopRecording();
+	manifest.Record(StartupManifest::AK_Texture, "after.dds");
+
+	auto const assets = manifest.RecordedAssets();
+	ASSERT_EQ(assets.size(), 1U);
+	EXPECT_EQ(assets[0].kind, StartupManifest::AK_Texture);
+	EXPECT_EQ(assets[0].access_hint, 3U);
+	EXPECT_EQ(assets[0].name, "during.dds");
+}
+
+TEST(StartupManifestTest, RecordWithoutDuplicates)
+{
+	StartupManifest manifest;
+
+	manifest.StartRecording();
+	manifest.Record(StartupManifest::AK_Effect, "Font.fxml");
+	manifest.Record(StartupManifest::AK_Texture, "a.dds", 1);
+	manifest.Record(StartupManifest::AK_Effect, "Font.fxml");
+	manifest.Record(StartupManifest::AK_Texture, "a.dds", 1);
+	manifest.Record(StartupManifest::AK_Texture, "a.dds", 2);
+	manifest.Record(StartupManifest::AK_Texture, "");
+
+	auto const assets = manifest.RecordedAssets();
+	ASSERT_EQ(assets.size(), 3U);
+	EXPECT_EQ(assets[0].name, "Font.fxml");
+	EXPECT_EQ(assets[1].access_hint, 1U);
+	EXPECT_EQ(assets[2].access_hint, 2U);
+}
+
+TEST(StartupManifestTest, SaveLoad)
+{
+	StartupManifest saved;
+	saved.StartRecording();
+	saved.Record(StartupManifest::AK_Effect, "Copy.fxml|Post Process.fxml");
+	saved.Record(StartupManifest::AK_Texture, "Textures/2D/noise.dds", 5);
+	saved.StopRecording();
+
+	std::stringstream ss;
+	saved.Save(ss);
+
+	StartupManifest loaded;
+	loaded.Load(ss);
+
+	auto const & assets = loaded.LastRunAssets();
+	ASSERT_EQ(assets.size(), 2U);
+	EXPECT_EQ(assets[0].kind, StartupManifest::AK_Effect);
+	EXPECT_EQ(assets[0].name, "Copy.fxml|Post Process.fxml");
+	EXPECT_EQ(assets[1].kind, StartupManifest::AK_Texture);
+	EXPECT_EQ(assets[1].access_hint, 5U);
+	EXPECT_EQ(assets[1].name, "Textures/2D/noise.dds");
+
+	EXPECT_TRUE(loaded.RecordedAssets().empty());
+}
+
+TEST(StartupManifestTest, LoadSkipsInvalidLines)
+{
+	std::istringstream ss("1 0 a.dds\r\n7 0 unknown.bin\n0 0 \n1 2 b.dds\n");
+
+	StartupManifest manifest;
+	manifest.Load(ss);
+
+	auto const & assets = manifest.LastRunAssets();
+	ASSERT_EQ(assets.size(), 2U);
+	EXPECT_EQ(assets[0].name, "a.dds");
+	EXPECT_EQ(assets[1].name, "b.dds");
+	EXPECT_EQ(assets[1].access_hint, 2U);
+}
@@ -221,3 +221,72 @@ TEST_F(TextureTest, UpdateCompressedCPUSubTexture)
 #endif
 	TestUpdateSubTexture("Lenna_bc1.dds", "Lenna_SubTexture_bc1.dds", false, tolerance);
 }
+
+TEST_F(TextureTest, ResizeFiltersPreserveConstant)
+{
+	uint32_t const src_width = 37;
+	uint32_t const src_height = 23;
+	uint32_t const dst_width = 16;
+	uint32_t const dst_height = 51;
+
+	std::vector<float4> src(src_width * src_height, float4(0.25f, 0.5f, 0.75f, 1.0f));
+	std::vector<float4> dst(dst_width * dst_height);
+	for (auto filter : { RF_Point, RF_Linear, RF_Box, RF_Kaiser, RF_Lanczos })
+	{
+		ResizeTexture(dst.data(), dst_width * sizeof(float4), dst_width * dst_height * sizeof(float4), EF_ABGR32F,
+			dst_width, dst_height, 1,
+			src.data(), src_width * sizeof(float4), src_width * src_height * sizeof(float4), EF_ABGR32F,
+			src_width, src_height, 1,
+			filter);
+
+		for (auto const & pixel : dst)
+		{
+			for (uint32_t c = 0; c < 4; ++ c)
+			{
+				EXPECT_NEAR(pixel[c], src[0][c], 1e-5f);
+			}
+		}
+	}
+}
+
+TEST_F(TextureTest, BuildMipChainBox)
+{
+	uint32_t const width = 8;
+	uint32_t const height = 4;
+
+	std::vector<float> level0(width * height);
+	for (uint32_t y = 0; y < height; ++ y)
+	{
+		for (uint32_t x = 0; x < width; ++ x)
+		{
+			level0[y * width + x] = static_cast<float>(y * width + x);
+		}
+	}
+	std::vector<float> level1(width / 2 * height / 2);
+	std::vector<float> level2(width / 4 * height / 4);
+
+	ElementInitData levels[3];
+	levels[0].data = level0.data();
+	levels[0].row_pitch = width * sizeof(float);
+	levels[0].slice_pitch = levels[0].row_pitch * height;
+	levels[1].data = level1.data();
+	levels[1].row_pitch = width / 2 * sizeof(float);
+	levels[1].slice_pitch = levels[1].row_pitch * height / 2;
+	levels[2].data = level2.data();
+	levels[2].row_pitch = width / 4 * sizeof(float);
+	levels[2].slice_pitch = levels[2].row_pitch * height / 4;
+
+	BuildMipChain(levels, EF_R32F, width, height, 1, RF_Box);
+
+	for (uint32_t y = 0; y < height / 2; ++ y)
+	{
+		for (uint32_t x = 0; x < width / 2; ++ x)
+		{
+			float const expected = (level0[(y * 2 + 0) * width + x * 2 + 0] + level0[(y * 2 + 0) * width + x * 2 + 1]
+				+ level0[(y * 2 + 1) * width + x * 2 + 0] + level0[(y * 2 + 1) * width + x * 2 + 1]) / 4;
+			EXPECT_NEAR(level1[y * width / 2 + x], expected, 1e-4f);
+		}
+	}
+	EXPECT_NEAR(level2[0], (level1[0] + level1[1] + level1[4] + level1[5]) / 4, 1e-4f);
+	EXPECT_NEAR(level2[1], (level1[2] + level1[3] + level1[6] + level1[7]) / 4, 1e-4f);
+}
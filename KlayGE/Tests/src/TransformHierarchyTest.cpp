@@ -0,0 +1,252 @@
+/**
+ * @file TransformHierarchyTest.cpp
+ * @author Minmin Gong
+ *
+ * @section DESCRIPTION
+ *
+ * This source file is part of KlayGE
+ * For the latest info, see http://www.klayge.org
+ *
+ * @section LICENSE
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * You may alternatively use this source under the terms of
+ * the KlayGE Proprietary License (KPL). You can obtained such a license
+ * from http://www.klayge.org/licensing/.
+ */
+
+#include <KlayGE/KlayGE.hpp>
+#include <KFL/Math.hpp>
+#include <KlayGE/Renderable.hpp>
+#include <KlayGE/SceneNode.hpp>
+#include <KlayGE/TransformHierarchy.hpp>
+
+#include <vector>
+
+#include "KlayGETests.hpp"
+
+using namespace std;
+using namespace KlayGE;
+
+namespace
+{
+	class BoxRenderable : public Renderable
+	{
+	public:
+		explicit BoxRenderable(AABBox const & aabb)
+		{
+			pos_aabb_ = aabb;
+		}
+	};
+
+	SceneNodePtr CreateNode(float3 const & pos, float size)
+	{
+		auto node = MakeSharedPtr<SceneNode>(MakeSharedPtr<BoxRenderable>(AABBox(float3(-size, -size, -size),
+			float3(+size, +size, +size))), SceneNode::SOA_Cullable | SceneNode::SOA_Moveable);
+		node->TransformToParent(MathLib::rotation_y(0.3f) * MathLib::translation(pos));
+		return node;
+	}
+
+	// A root with num_children children, each with a chain of 2 grandchildren
+	SceneNodePtr CreateTree(uint32_t num_children)
+	{
+		auto root = MakeSharedPtr<SceneNode>(L"Root", SceneNode::SOA_Cullable);
+		for (uint32_t i = 0; i < num_children; ++ i)
+		{
+			auto child = CreateNode(float3(static_cast<float>(i), 0, 0), 0.5f);
+			auto grandchild = CreateNode(float3(0, 1, 0), 0.25f);
+			grandchild->AddChild(CreateNode(float3(0, 0, 2), 0.125f));
+			child->AddChild(grandchild);
+			root->AddChild(child);
+		}
+		return root;
+	}
+
+	void UpdateRecursively(SceneNode& root)
+	{
+		root.Traverse([](SceneNode& node)
+			{
+				node.UpdateTransforms();
+				return true;
+			});
+		root.UpdatePosBoundSubtree();
+	}
+
+	void ExpectNear(float4x4 const & expected, float4x4 const & actual)
+	{
+		for (size_t i = 0; i < 16; ++ i)
+		{
+			EXPECT_NEAR(expected[i], actual[i], 1e-4f);
+		}
+	}
+
+	void ExpectNear(AABBox const & expected, AABBox const & actual)
+	{
+		for (size_t i = 0; i < 3; ++ i)
+		{
+			EXPECT_NEAR(expected.Min()[i], actual.Min()[i], 1e-4f);
+			EXPECT_NEAR(expected.Max()[i], actual.Max()[i], 1e-4f);
+		}
+	}
+
+	void CompareTrees(uint32_t num_children)
+	{
+		auto flat_root = CreateTree(num_children);
+		auto ref_root = CreateTree(num_children);
+
+		TransformHierarchy hierarchy;
+		hierarchy.Update(*flat_root);
+		UpdateRecursively(*ref_root);
+
+		EXPECT_EQ(1 + num_children * 3, hierarchy.NumNodes());
+		EXPECT_EQ(4U, hierarchy.NumLevels());
+		EXPECT_EQ(hierarchy.NumNodes(), hierarchy.NumNodesUpdated());
+
+		std::vector<SceneNode*> flat_nodes;
+		std::vector<SceneNode*> ref_nodes;
+		flat_root->Traverse([&flat_nodes](SceneNode& node)
+			{
+				flat_nodes.push_back(&node);
+				return true;
+			});
+		ref_root->Traverse([&ref_nodes](SceneNode& node)
+			{
+				ref_nodes.push_back(&node);
+				return true;
+			});
+		ASSERT_EQ(ref_nodes.size(), flat_nodes.size());
+		for (size_t i = 0; i < ref_nodes.size(); ++ i)
+		{
+			ExpectNear(ref_nodes[i]->TransformToWorld(), flat_nodes[i]->TransformToWorld());
+			ExpectNear(ref_nodes[i]->PosBoundOS(), flat_nodes[i]->PosBoundOS());
+			ExpectNear(ref_nodes[i]->PosBoundWS(), flat_nodes[i]->PosBoundWS());
+		}
+	}
+}
+
+TEST(TransformHierarchyTest, MatchesRecursiveUpdate)
+{
+	CompareTrees(5);
+}
+
+TEST(TransformHierarchyTest, MatchesRecursiveUpdateInParallel)
+{
+	// Wide enough for the levels to be updated on the thread pool
+	CompareTrees(2000);
+}
+
+TEST(TransformHierarchyTest, DepthOrder)
+{
+	auto root = CreateTree(3);
+
+	TransformHierarchy hierarchy;
+	hierarchy.Update(*root);
+
+	EXPECT_EQ(root.get(), hierarchy.Node(0));
+	EXPECT_EQ(~0U, hierarchy.ParentIndex(0));
+	for (uint32_t i = 1; i < hierarchy.NumNodes(); ++ i)
+	{
+		uint32_t const parent = hierarchy.ParentIndex(i);
+		EXPECT_LT(parent, i);
+		EXPECT_EQ(hierarchy.Node(parent), hierarchy.Node(i)->Parent());
+	}
+}
+
+TEST(TransformHierarchyTest, DirtyPropagation)
+{
+	auto root = CreateTree(4);
+
+	TransformHierarchy hierarchy;
+	hierarchy.Update(*root);
+
+	hierarchy.Update(*root);
+	EXPECT_EQ(0U, hierarchy.NumNodesUpdated());
+
+	// The moved child, its 2 descendants, and the root whose bound grows
+	auto const & child = root->Children()[2];
+	child->TransformToParent(MathLib::translation(0.0f, 10.0f, 0.0f));
+	hierarchy.Update(*root);
+	EXPECT_EQ(4U, hierarchy.NumNodesUpdated());
+
+	auto const & leaf = child->Children()[0]->Children()[0];
+	ExpectNear(leaf->TransformToParent() * child->Children()[0]->TransformToParent() * child->TransformToParent(),
+		leaf->TransformToWorld());
+	EXPECT_NEAR(10.0f + 1 - 0.25f, child->Children()[0]->PosBoundWS().Min().y(), 1e-4f);
+	EXPECT_GE(root->PosBoundWS().Max().y(), 10.0f + 1 + 0.25f - 1e-4f);
+}
+
+TEST(TransformHierarchyTest, StructureChange)
+{
+	auto root = CreateTree(2);
+
+	TransformHierarchy hierarchy;
+	hierarchy.Update(*root);
+	EXPECT_EQ(7U, hierarchy.NumNodes());
+
+	auto node = CreateNode(float3(0, 0, 100), 1);
+	root->AddChild(node);
+	hierarchy.Update(*root);
+	EXPECT_EQ(8U, hierarchy.NumNodes());
+	EXPECT_NEAR(101.0f, root->PosBoundWS().Max().z(), 0.5f);
+
+	// A destroyed node is dropped on the next update
+	auto removed = root->Children()[0];
+	root->RemoveChild(removed);
+	removed.reset();
+	hierarchy.Update(*root);
+	EXPECT_EQ(5U, hierarchy.NumNodes());
+
+	// A removed node no longer reports to the hierarchy
+	root->RemoveChild(node);
+	hierarchy.Update(*root);
+	node->TransformToParent(float4x4::Identity());
+	hierarchy.Update(*root);
+	EXPECT_EQ(0U, hierarchy.NumNodesUpdated());
+}
+
+TEST(TransformHierarchyTest, ChangeStamps)
+{
+	auto root = CreateTree(3);
+
+	TransformHierarchy hierarchy;
+	hierarchy.Update(*root);
+	uint32_t const build_version = hierarchy.BuildVersion();
+	uint32_t const first_stamp = hierarchy.UpdateStamp();
+	EXPECT_EQ(first_stamp, hierarchy.LastChangeStamp());
+
+	hierarchy.Update(*root);
+	EXPECT_EQ(first_stamp + 1, hierarchy.UpdateStamp());
+	EXPECT_EQ(first_stamp, hierarchy.LastChangeStamp());
+
+	auto const & moved = root->Children()[1];
+	moved->TransformToParent(MathLib::translation(0.0f, 5.0f, 0.0f));
+	hierarchy.Update(*root);
+	EXPECT_EQ(hierarchy.UpdateStamp(), hierarchy.LastChangeStamp());
+	EXPECT_EQ(hierarchy.UpdateStamp(), hierarchy.ChangeStamp(*moved));
+	EXPECT_EQ(hierarchy.UpdateStamp(), hierarchy.ChangeStamp(*moved->Children()[0]));
+	EXPECT_EQ(hierarchy.UpdateStamp(), hierarchy.ChangeStamp(*root));
+	EXPECT_EQ(first_stamp, hierarchy.ChangeStamp(*root->Children()[0]));
+	EXPECT_EQ(build_version, hierarchy.BuildVersion());
+
+	auto detached = CreateNode(float3(0, 0, 0), 1);
+	EXPECT_EQ(~0U, hierarchy.ChangeStamp(*detached));
+
+	root->AddChild(detached);
+	EXPECT_TRUE(hierarchy.StructureDirty());
+	hierarchy.Update(*root);
+	EXPECT_FALSE(hierarchy.StructureDirty());
+	EXPECT_EQ(build_version + 1, hierarchy.BuildVersion());
+}
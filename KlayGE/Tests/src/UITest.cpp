@@ -0,0 +1,97 @@
+/**
+ * @file UITest.cpp
+ * @author Minmin Gong
+ *
+ * @section DESCRIPTION
+ *
+ * This source file is part of KlayGE
+ * For the latest info, see http://www.klayge.org
+ *
+ * @section LICENSE
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * You may alternatively use this source under the terms of
+ * the KlayGE Proprietary License (KPL). You can obtained such a license
+ * from http://www.klayge.org/licensing/.
+ */
+
+#include <KlayGE/KlayGE.hpp>
+#include <KlayGE/ResLoader.hpp>
+#include <KlayGE/UI.hpp>
+
+#include <sstream>
+
+#include "KlayGETests.hpp"
+
+using namespace std;
+using namespace KlayGE;
+
+namespace
+{
+	char const UI_TEST_UIML[] =
+		"<?xml version='1.0' encoding='utf-8' standalone='no'?>"
+		"<ui>"
+		"<dialog id=\"UITest\" caption=\"UI Test\" x=\"0\" y=\"0\" width=\"160\" height=\"100\">"
+		"<control type=\"slider\" id=\"ValueSlider\" x=\"20\" y=\"20\" width=\"120\" height=\"24\" min=\"0\" max=\"100\" value=\"50\" is_default=\"0\"/>"
+		"</dialog>"
+		"</ui>";
+}
+
+TEST(UITest, RetainedGeometry)
+{
+	auto ss = MakeSharedPtr<std::stringstream>(UI_TEST_UIML);
+	UIManager::Instance().Load(MakeSharedPtr<ResIdentifier>("UITest.uiml", 0, ss));
+
+	auto const & dialog = UIManager::Instance().GetDialog("UITest");
+	ASSERT_TRUE(dialog);
+	auto slider = dialog->Control<UISlider>(dialog->IDFromName("ValueSlider"));
+	ASSERT_TRUE(slider);
+
+	UIManager::Instance().Render();
+	uint32_t const num_quads = UIManager::Instance().NumQuads();
+	EXPECT_GT(num_quads, 0U);
+	EXPECT_EQ(UIManager::Instance().NumQuadsRebuilt(), num_quads);
+
+	// Nothing changed, the geometry is replayed
+	UIManager::Instance().Render();
+	EXPECT_EQ(UIManager::Instance().NumQuads(), num_quads);
+	EXPECT_EQ(UIManager::Instance().NumQuadsRebuilt(), 0U);
+
+	slider->SetValue(70);
+	UIManager::Instance().Render();
+	EXPECT_EQ(UIManager::Instance().NumQuadsRebuilt(), num_quads);
+
+	UIManager::Instance().Render();
+	EXPECT_EQ(UIManager::Instance().NumQuadsRebuilt(), 0U);
+
+	slider->SetRange(0, 50);
+	EXPECT_EQ(slider->GetValue(), 50);
+	UIManager::Instance().Render();
+	EXPECT_EQ(UIManager::Instance().NumQuadsRebuilt(), num_quads);
+
+	slider->SetLocation(30, 20);
+	UIManager::Instance().Render();
+	EXPECT_EQ(UIManager::Instance().NumQuadsRebuilt(), num_quads);
+
+	slider->SetSize(100, 24);
+	UIManager::Instance().Render();
+	EXPECT_EQ(UIManager::Instance().NumQuadsRebuilt(), num_quads);
+
+	UIManager::Instance().Render();
+	EXPECT_EQ(UIManager::Instance().NumQuadsRebuilt(), 0U);
+
+	UIManager::Destroy();
+}
@@ -4,6 +4,7 @@
 #include <KlayGE/RenderFactory.hpp>
 #include <KlayGE/Context.hpp>
 #include <KlayGE/RenderSettings.hpp>
+#include <KlayGE/Texture.hpp>
 #include <KlayGE/FFT.hpp>
 
 #include <cmath>
@@ -58,16 +59,6 @@ int main(int argc, char* argv[])
 
 	RenderFactory& rf = Context::Instance().RenderFactoryInstance();
 
-	TexturePtr empty_tex;
-	{
-		std::vector<uint8_t> zero_data(WIDTH * HEIGHT, 0);
-		ElementInitData resized_data;
-		resized_data.data = &zero_data[0];
-		resized_data.row_pitch = WIDTH * sizeof(uint8_t);
-		resized_data.slice_pitch = WIDTH * HEIGHT * sizeof(uint8_t);
-		empty_tex = rf.MakeTexture2D(WIDTH, HEIGHT, 1, 1, EF_R8, 1, 0, EAH_GPU_Read | EAH_GPU_Write, resized_data);
-	}
-
 	TexturePtr pattern_raw = SyncLoadTexture(src_name, EAH_CPU_Read);
 	int width = static_cast<int>(pattern_raw->Width(0));
 	int height = static_cast<int>(pattern_raw->Height(0));
@@ -141,13 +132,17 @@ int main(int argc, char* argv[])
 	pattern_real_data.data = &pattern_real[0];
 	pattern_real_data.row_pitch = WIDTH * sizeof(float4);
 	pattern_real_data.slice_pitch = WIDTH * HEIGHT * sizeof(float4);
-	TexturePtr real_tex = rf.MakeTexture2D(WIDTH, HEIGHT, 1, 1, EF_ABGR32F, 1, 0, EAH_GPU_Read | EAH_GPU_Write, pattern_real_data);
+	TexturePtr real_tex = MakeSharedPtr<SoftwareTexture>(Texture::TT_2D, WIDTH, HEIGHT, 1, 1, 1, EF_ABGR32F, false);
+	real_tex->CreateHWResource(pattern_real_data, nullptr);
 
-	TexturePtr pattern_real_tex = rf.MakeTexture2D(WIDTH, HEIGHT, 1, 1, EF_ABGR16F, 1, 0, EAH_GPU_Read | EAH_GPU_Write);
-	TexturePtr pattern_imag_tex = rf.MakeTexture2D(WIDTH, HEIGHT, 1, 1, EF_ABGR16F, 1, 0, EAH_GPU_Read | EAH_GPU_Write);
+	TexturePtr pattern_real_tex = MakeSharedPtr<SoftwareTexture>(Texture::TT_2D, WIDTH, HEIGHT, 1, 1, 1, EF_ABGR16F, false);
+	pattern_real_tex->CreateHWResource({}, nullptr);
+	TexturePtr pattern_imag_tex = MakeSharedPtr<SoftwareTexture>(Texture::TT_2D, WIDTH, HEIGHT, 1, 1, 1, EF_ABGR16F, false);
+	pattern_imag_tex->CreateHWResource({}, nullptr);
 
-	GpuFftPS fft(WIDTH, HEIGHT, true);
-	fft.Execute(pattern_real_tex, pattern_imag_tex, real_tex, empty_tex);
+	// The transform runs on the CPU, so it doesn't depend on the shader support of the device
+	CpuFft fft(WIDTH, HEIGHT, true);
+	fft.Execute(pattern_real_tex, pattern_imag_tex, real_tex, TexturePtr());
 
 	SaveTexture(pattern_real_tex, "lens_effects_real.dds");
 	SaveTexture(pattern_imag_tex, "lens_effects_imag.dds");
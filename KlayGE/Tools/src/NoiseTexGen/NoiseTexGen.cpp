@@ -1,4 +1,5 @@
 #include <KlayGE/KlayGE.hpp>
+#include <KlayGE/Context.hpp>
 #include <KlayGE/Texture.hpp>
 #include <KlayGE/TexCompression.hpp>
 #include <KFL/Noise.hpp>
@@ -230,20 +231,32 @@ void GenfBmTexs()
 	uint32_t const TEX_SIZE = 512;
 	float const STRIDE = 8;
 
-	MathLib::SimplexNoise<float> noiser = MathLib::SimplexNoise<float>::Instance();
+	auto& noiser = MathLib::SimplexNoise<float>::Instance();
+	auto& pool = Context::Instance().ThreadPool();
 
-	std::vector<float> fdata(TEX_SIZE * TEX_SIZE);
+	// Samples the whole texture at once, offset by (dx, dy) texels
+	std::vector<float2> pos(TEX_SIZE * TEX_SIZE);
+	auto tileable_fBm = [&noiser, &pool, &pos, TEX_SIZE, STRIDE](float dx, float dy, std::vector<float>& out)
+		{
+			for (uint32_t y = 0; y < TEX_SIZE; ++ y)
+			{
+				for (uint32_t x = 0; x < TEX_SIZE; ++ x)
+				{
+					pos[y * TEX_SIZE + x] = float2((x + dx + 0.5f) / TEX_SIZE * STRIDE, (y + dy + 0.5f) / TEX_SIZE * STRIDE);
+				}
+			}
+			out.resize(pos.size());
+			noiser.tileable_fBm(pos, out.data(), out.size(), STRIDE, STRIDE, 5, 2, 0.5f, &pool);
+		};
+
+	std::vector<float> fdata;
+	tileable_fBm(0, 0, fdata);
 	float min_v = +1e10f;
 	float max_v = -1e10f;
-	for (uint32_t y = 0; y < TEX_SIZE; ++ y)
+	for (float v : fdata)
 	{
-		for (uint32_t x = 0; x < TEX_SIZE; ++ x)
-		{
-			float v = noiser.tileable_fBm((x + 0.5f) / TEX_SIZE * STRIDE, (y + 0.5f) / TEX_SIZE * STRIDE, STRIDE, STRIDE, 5, 2, 0.5f);
-			fdata[y * TEX_SIZE + x] = v;
-			min_v = std::min(min_v, v);
-			max_v = std::max(max_v, v);
-		}
+		min_v = std::min(min_v, v);
+		max_v = std::max(max_v, v);
 	}
 
 	{
@@ -279,17 +292,19 @@ void GenfBmTexs()
 	}
 
 	{
+		float const d = 2;
+		std::vector<float> fdata_x;
+		std::vector<float> fdata_y;
+		tileable_fBm(d, 0, fdata_x);
+		tileable_fBm(0, d, fdata_y);
+
 		std::vector<float3> fdata3(TEX_SIZE * TEX_SIZE);
-		for (uint32_t y = 0; y < TEX_SIZE; ++ y)
+		for (uint32_t i = 0; i < TEX_SIZE * TEX_SIZE; ++ i)
 		{
-			for (uint32_t x = 0; x < TEX_SIZE; ++ x)
-			{
-				float f0 = fdata[y * TEX_SIZE + x];
-				float d = 2;
-				float fx = noiser.tileable_fBm((x + d + 0.5f) / TEX_SIZE * STRIDE, (y + 0.5f) / TEX_SIZE * STRIDE, STRIDE, STRIDE, 5, 2, 0.5f);
-				float fy = noiser.tileable_fBm((x + 0.5f) / TEX_SIZE * STRIDE, (y + d + 0.5f) / TEX_SIZE * STRIDE, STRIDE, STRIDE, 5, 2, 0.5f);
-				fdata3[y * TEX_SIZE + x] = MathLib::normalize(float3(fx - f0, fy - f0, STRIDE * 16 / TEX_SIZE)) * 0.5f + 0.5f;
-			}
+			float f0 = fdata[i];
+			float fx = fdata_x[i];
+			float fy = fdata_y[i];
+			fdata3[i] = MathLib::normalize(float3(fx - f0, fy - f0, STRIDE * 16 / TEX_SIZE)) * 0.5f + 0.5f;
 		}
 		std::vector<uint8_t> rg_data(TEX_SIZE * TEX_SIZE * 2);
 		for (uint32_t i = 0; i < TEX_SIZE * TEX_SIZE; ++ i)